@@ -14,6 +14,7 @@
 #include <Geometry/Plane3.h>
 #include <Geometry/Sphere3.h>
 #include <Particle/ParticleSystemData3.h>
+#include <Solver/DFSPH/DFSPHSolver3.h>
 #include <Solver/PCISPH/PCISPHSolver3.h>
 #include <Solver/SPH/SPHSolver3.h>
 #include <Surface/Implicit/ImplicitSurfaceSet3.h>
@@ -84,7 +85,7 @@ void PrintUsage()
 		"   -l, --log: log filename (default is " APP_NAME ".log)\n"
 		"   -o, --output: output directory name (default is " APP_NAME "_output)\n"
 		"   -m, --format: particle output format (xyz or pos. default is xyz)\n"
-		"   -e, --example: example number (between 1 and 3, default is 1)\n"
+		"   -e, --example: example number (between 1 and 4, default is 1)\n"
 		"   -h, --help: print this message\n");
 }
 
@@ -232,20 +233,13 @@ void RunExample2(const std::string& rootDir, double targetSpacing, int numberOfF
 	RunSimulation(rootDir, solver, numberOfFrames, format, fps);
 }
 
-// Dam-breaking example
-void RunExample3(const std::string& rootDir, double targetSpacing, int numberOfFrames, const std::string& format, double fps)
+// Builds the emitter and the collider of the dam-breaking examples
+void SetUpDamBreaking(const SPHSolver3Ptr& solver, double targetSpacing)
 {
 	BoundingBox3D domain(Vector3D(), Vector3D(3, 2, 1.5));
 	const double lz = domain.Depth();
 
-	// Build solver
-	auto solver = PCISPHSolver3::GetBuilder()
-		.WithTargetDensity(1000.0)
-		.WithTargetSpacing(targetSpacing)
-		.MakeShared();
-
 	solver->SetPseudoViscosityCoefficient(0.0);
-	solver->SetTimeStepLimitScale(10.0);
 
 	// Build emitter
 	BoundingBox3D sourceBound(domain);
@@ -306,6 +300,20 @@ void RunExample3(const std::string& rootDir, double targetSpacing, int numberOfF
 		.MakeShared();
 
 	solver->SetCollider(collider);
+}
+
+// Dam-breaking example (PCISPH)
+void RunExample3(const std::string& rootDir, double targetSpacing, int numberOfFrames, const std::string& format, double fps)
+{
+	// Build solver
+	auto solver = PCISPHSolver3::GetBuilder()
+		.WithTargetDensity(1000.0)
+		.WithTargetSpacing(targetSpacing)
+		.MakeShared();
+
+	solver->SetTimeStepLimitScale(10.0);
+
+	SetUpDamBreaking(solver, targetSpacing);
 
 	// Print simulation info
 	printf("Running example 3 (dam-breaking with PCISPH)\n");
@@ -315,6 +323,25 @@ void RunExample3(const std::string& rootDir, double targetSpacing, int numberOfF
 	RunSimulation(rootDir, solver, numberOfFrames, format, fps);
 }
 
+// Dam-breaking example (DFSPH)
+void RunExample4(const std::string& rootDir, double targetSpacing, int numberOfFrames, const std::string& format, double fps)
+{
+	// Build solver
+	auto solver = DFSPHSolver3::GetBuilder()
+		.WithTargetDensity(1000.0)
+		.WithTargetSpacing(targetSpacing)
+		.MakeShared();
+
+	SetUpDamBreaking(solver, targetSpacing);
+
+	// Print simulation info
+	printf("Running example 4 (dam-breaking with DFSPH)\n");
+	PrintInfo(solver);
+
+	// Run simulation
+	RunSimulation(rootDir, solver, numberOfFrames, format, fps);
+}
+
 int main(int argc, char* argv[])
 {
 	double targetSpacing = 0.02;
@@ -403,6 +430,9 @@ int main(int argc, char* argv[])
 		case 3:
 			RunExample3(outputDir, targetSpacing, numberOfFrames, format, fps);
 			break;
+		case 4:
+			RunExample4(outputDir, targetSpacing, numberOfFrames, format, fps);
+			break;
 		default:
 			PrintUsage();
 			exit(EXIT_FAILURE);
@@ -283,6 +283,13 @@ namespace CubbyFlow
 		ConstAccessor().ParallelForEachIndex(func);
 	}
 
+	template <typename T>
+	template <typename Callback>
+	void Array<T, 3>::ParallelForEachTile(Callback func, const Size3& tileSize) const
+	{
+		ConstAccessor().ParallelForEachTile(func, tileSize);
+	}
+
 	template <typename T>
 	T& Array<T, 3>::operator[](size_t i)
 	{
@@ -331,6 +331,31 @@ namespace CubbyFlow
 		template <typename Callback>
 		void ParallelForEachIndex(Callback func) const;
 
+		//!
+		//! \brief Iterates the array tile by tile and invoke given \p func for
+		//!     each tile in parallel using multi-threading.
+		//!
+		//! This function splits the array into tiles of \p tileSize and invokes
+		//! the callback function \p func once per tile with the
+		//! (iBegin, iEnd, jBegin, jEnd, kBegin, kEnd) index ranges of the tile.
+		//! The order of execution will be non-deterministic since it runs in
+		//! parallel. Below is the sample usage:
+		//!
+		//! \code{.cpp}
+		//! Array<int, 3> array(100, 200, 150, 4);
+		//! array.ParallelForEachTile([&](size_t iBegin, size_t iEnd,
+		//!     size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+		//! {
+		//!     for (size_t k = kBegin; k < kEnd; ++k)
+		//!         for (size_t j = jBegin; j < jEnd; ++j)
+		//!             for (size_t i = iBegin; i < iEnd; ++i)
+		//!                 array(i, j, k) *= 2;
+		//! });
+		//! \endcode
+		//!
+		template <typename Callback>
+		void ParallelForEachTile(Callback func, const Size3& tileSize = ARRAY3_DEFAULT_TILE_SIZE) const;
+
 		//!
 		//! \brief Returns the reference to the i-th element.
 		//!
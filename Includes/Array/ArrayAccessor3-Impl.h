@@ -211,6 +211,14 @@ namespace CubbyFlow
 		ParallelFor(ZERO_SIZE, Width(), ZERO_SIZE, Height(), ZERO_SIZE, Depth(), func);
 	}
 
+	template <typename T>
+	template <typename Callback>
+	void ArrayAccessor<T, 3>::ParallelForEachTile(Callback func, const Size3& tileSize) const
+	{
+		ParallelTiledRangeFor(ZERO_SIZE, Width(), ZERO_SIZE, Height(), ZERO_SIZE, Depth(),
+			tileSize.x, tileSize.y, tileSize.z, func);
+	}
+
 	template <typename T>
 	size_t ArrayAccessor<T, 3>::Index(const Point3UI& pt) const
 	{
@@ -412,6 +420,14 @@ namespace CubbyFlow
 		ParallelFor(ZERO_SIZE, Width(), ZERO_SIZE, Height(), ZERO_SIZE, Depth(), func);
 	}
 
+	template <typename T>
+	template <typename Callback>
+	void ConstArrayAccessor<T, 3>::ParallelForEachTile(Callback func, const Size3& tileSize) const
+	{
+		ParallelTiledRangeFor(ZERO_SIZE, Width(), ZERO_SIZE, Height(), ZERO_SIZE, Depth(),
+			tileSize.x, tileSize.y, tileSize.z, func);
+	}
+
 	template <typename T>
 	size_t ConstArrayAccessor<T, 3>::Index(const Point3UI& pt) const
 	{
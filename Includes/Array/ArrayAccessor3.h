@@ -15,6 +15,14 @@
 
 namespace CubbyFlow
 {
+	//!
+	//! Default tile size of the tiled iteration of the 3-D arrays. The tiles
+	//! are long in X, which is contiguous in memory and keeps the hardware
+	//! prefetcher busy, and short in Y and Z, so the Y and Z neighbors of a
+	//! 7-point stencil are still in cache when they are read again.
+	//!
+	constexpr Size3 ARRAY3_DEFAULT_TILE_SIZE(256, 8, 8);
+
 	//!
 	//! \brief 3-D array accessor class.
 	//!
@@ -217,6 +225,31 @@ namespace CubbyFlow
 		template <typename Callback>
 		void ParallelForEachIndex(Callback func) const;
 
+		//!
+		//! \brief Iterates the array tile by tile and invoke given \p func for
+		//!     each tile in parallel using multi-threading.
+		//!
+		//! This function splits the array into tiles of \p tileSize and invokes
+		//! the callback function \p func once per tile with the index ranges of
+		//! the tile, so stencil kernels can loop over the tile directly and reuse
+		//! the neighbors while they are in cache. The callback function takes
+		//! the (iBegin, iEnd, jBegin, jEnd, kBegin, kEnd) ranges of the tile. The
+		//! order of execution will be non-deterministic since it runs in
+		//! parallel. Below is the sample usage:
+		//!
+		//! \code{.cpp}
+		//! acc.ParallelForEachTile([&](size_t iBegin, size_t iEnd,
+		//!     size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd) {
+		//!     for (size_t k = kBegin; k < kEnd; ++k)
+		//!         for (size_t j = jBegin; j < jEnd; ++j)
+		//!             for (size_t i = iBegin; i < iEnd; ++i)
+		//!                 acc(i, j, k) *= 2;
+		//! });
+		//! \endcode
+		//!
+		template <typename Callback>
+		void ParallelForEachTile(Callback func, const Size3& tileSize = ARRAY3_DEFAULT_TILE_SIZE) const;
+
 		//! Returns the linear index of the given 3-D coordinate (pt.x, pt.y, pt.z).
 		size_t Index(const Point3UI& pt) const;
 
@@ -408,6 +441,31 @@ namespace CubbyFlow
 		template <typename Callback>
 		void ParallelForEachIndex(Callback func) const;
 
+		//!
+		//! \brief Iterates the array tile by tile and invoke given \p func for
+		//!     each tile in parallel using multi-threading.
+		//!
+		//! This function splits the array into tiles of \p tileSize and invokes
+		//! the callback function \p func once per tile with the index ranges of
+		//! the tile, so stencil kernels can loop over the tile directly and reuse
+		//! the neighbors while they are in cache. The callback function takes
+		//! the (iBegin, iEnd, jBegin, jEnd, kBegin, kEnd) ranges of the tile. The
+		//! order of execution will be non-deterministic since it runs in
+		//! parallel. Below is the sample usage:
+		//!
+		//! \code{.cpp}
+		//! acc.ParallelForEachTile([&](size_t iBegin, size_t iEnd,
+		//!     size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd) {
+		//!     for (size_t k = kBegin; k < kEnd; ++k)
+		//!         for (size_t j = jBegin; j < jEnd; ++j)
+		//!             for (size_t i = iBegin; i < iEnd; ++i)
+		//!                 acc(i, j, k) *= 2;
+		//! });
+		//! \endcode
+		//!
+		template <typename Callback>
+		void ParallelForEachTile(Callback func, const Size3& tileSize = ARRAY3_DEFAULT_TILE_SIZE) const;
+
 		//! Returns the linear index of the given 3-D coordinate (pt.x, pt.y, pt.z).
 		size_t Index(const Point3UI& pt) const;
 
@@ -84,11 +84,22 @@ namespace CubbyFlow
 		index->z = std::min(static_cast<ssize_t>(k + fz + 0.5), kSize - 1);
 	}
 
+	template <typename T, typename R>
+	void NearestArraySampler<T, R, 3>::operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const
+	{
+		assert(pts.size() == result.size());
+
+		for (size_t i = 0; i < pts.size(); ++i)
+		{
+			result[i] = (*this)(pts[i]);
+		}
+	}
+
 	template <typename T, typename R>
 	std::function<T(const Vector3<R>&)> NearestArraySampler<T, R, 3>::Functor() const
 	{
 		NearestArraySampler sampler(*this);
-		return std::bind(&NearestArraySampler::operator(), sampler, std::placeholders::_1);
+		return sampler;
 	}
 
 	template <typename T, typename R>
@@ -236,11 +247,78 @@ namespace CubbyFlow
 		(*weights)[7] = Vector3<R>(m_invGridSpacing.x * fy * fz, fx * m_invGridSpacing.y * fz, fx * fy * m_invGridSpacing.z);
 	}
 
+	template <typename T, typename R>
+	void LinearArraySampler<T, R, 3>::operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const
+	{
+		assert(pts.size() == result.size());
+		assert(m_gridSpacing.x > std::numeric_limits<R>::epsilon());
+		assert(m_gridSpacing.y > std::numeric_limits<R>::epsilon());
+		assert(m_gridSpacing.z > std::numeric_limits<R>::epsilon());
+
+		// The points are processed in blocks of lanes. The cell indices and the
+		// weights are computed by branch-free loops over the lanes, which the
+		// compiler can map onto the SIMD registers of the target (SSE/AVX or
+		// NEON) or run as scalar code. The values are gathered afterwards, so
+		// the loads of the lanes are independent of each other.
+		constexpr size_t numLanes = 8;
+
+		const Size3 size = m_accessor.size();
+		const ssize_t iSize = static_cast<ssize_t>(size.x);
+		const ssize_t jSize = static_cast<ssize_t>(size.y);
+		const ssize_t kSize = static_cast<ssize_t>(size.z);
+		const T* data = m_accessor.data();
+
+		// Same clamping as GetBarycentric followed by min(i + 1, size - 1)
+		const auto barycentric = [](R x, ssize_t n, ssize_t* i, ssize_t* di, R* f)
+		{
+			const R s = std::floor(x);
+			const ssize_t is = static_cast<ssize_t>(s);
+			const bool isLow = (n == 1) || (is < 0);
+			const bool isHigh = !isLow && (is > n - 2);
+
+			*i = isLow ? 0 : (isHigh ? n - 2 : is);
+			*f = isLow ? static_cast<R>(0) : (isHigh ? static_cast<R>(1) : x - s);
+			*di = (n == 1) ? 0 : 1;
+		};
+
+		for (size_t begin = 0; begin < pts.size(); begin += numLanes)
+		{
+			const size_t count = std::min(numLanes, pts.size() - begin);
+
+			ssize_t i[numLanes], j[numLanes], k[numLanes];
+			ssize_t di[numLanes], dj[numLanes], dk[numLanes];
+			R fx[numLanes], fy[numLanes], fz[numLanes];
+
+			for (size_t l = 0; l < count; ++l)
+			{
+				const Vector3<R> normalizedX = (pts[begin + l] - m_origin) / m_gridSpacing;
+
+				barycentric(normalizedX.x, iSize, &i[l], &di[l], &fx[l]);
+				barycentric(normalizedX.y, jSize, &j[l], &dj[l], &fy[l]);
+				barycentric(normalizedX.z, kSize, &k[l], &dk[l], &fz[l]);
+			}
+
+			for (size_t l = 0; l < count; ++l)
+			{
+				const T* f000 = data + i[l] + iSize * (j[l] + jSize * k[l]);
+				const ssize_t dy = dj[l] * iSize;
+				const ssize_t dz = dk[l] * iSize * jSize;
+
+				result[begin + l] = TriLerp(
+					f000[0], f000[di[l]],
+					f000[dy], f000[di[l] + dy],
+					f000[dz], f000[di[l] + dz],
+					f000[dy + dz], f000[di[l] + dy + dz],
+					fx[l], fy[l], fz[l]);
+			}
+		}
+	}
+
 	template <typename T, typename R>
 	std::function<T(const Vector3<R>&)> LinearArraySampler<T, R, 3>::Functor() const
 	{
 		LinearArraySampler sampler(*this);
-		return std::bind(&LinearArraySampler::operator(), sampler, std::placeholders::_1);
+		return sampler;
 	}
 	
 	template <typename T, typename R>
@@ -308,11 +386,22 @@ namespace CubbyFlow
 		return MonotonicCatmullRom(kValues[0], kValues[1], kValues[2], kValues[3], fz);
 	}
 
+	template <typename T, typename R>
+	void CubicArraySampler<T, R, 3>::operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const
+	{
+		assert(pts.size() == result.size());
+
+		for (size_t i = 0; i < pts.size(); ++i)
+		{
+			result[i] = (*this)(pts[i]);
+		}
+	}
+
 	template <typename T, typename R>
 	std::function<T(const Vector3<R>&)> CubicArraySampler<T, R, 3>::Functor() const
 	{
 		CubicArraySampler sampler(*this);
-		return std::bind(&CubicArraySampler::operator(), sampler, std::placeholders::_1);
+		return sampler;
 	}
 }
 
@@ -9,6 +9,7 @@
 #ifndef CUBBYFLOW_ARRAY_SAMPLERS3_H
 #define CUBBYFLOW_ARRAY_SAMPLERS3_H
 
+#include <Array/ArrayAccessor1.h>
 #include <Array/ArrayAccessor3.h>
 #include <Array/ArraySamplers.h>
 #include <Vector/Vector3.h>
@@ -50,6 +51,19 @@ namespace CubbyFlow
 		//! Returns sampled value at point \p pt.
 		T operator()(const Vector3<R>& pt) const;
 
+		//!
+		//! \brief      Samples the values at the points \p pts and stores them
+		//!     in \p result.
+		//!
+		//! This function evaluates the points in one loop so the sampling code
+		//! is inlined into the loop. It runs serially; split \p pts into ranges
+		//! to sample in parallel.
+		//!
+		//! \param[in]  pts     The points to sample.
+		//! \param[out] result  The sampled values (same size as \p pts).
+		//!
+		void operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const;
+
 		//! Returns the nearest array index for point \p x.
 		void GetCoordinate(const Vector3<R>& pt, Point3UI* index) const;
 
@@ -99,6 +113,21 @@ namespace CubbyFlow
 		//! Returns sampled value at point \p pt.
 		T operator()(const Vector3<R>& pt) const;
 
+		//!
+		//! \brief      Samples the values at the points \p pts and stores them
+		//!     in \p result.
+		//!
+		//! This function processes the points in blocks of SIMD-width lanes:
+		//! the cell indices and weights of a block are computed first, and the
+		//! values are gathered and interpolated afterwards. The result is the
+		//! same as sampling each point with operator(). It runs serially; split
+		//! \p pts into ranges to sample in parallel.
+		//!
+		//! \param[in]  pts     The points to sample.
+		//! \param[out] result  The sampled values (same size as \p pts).
+		//!
+		void operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const;
+
 		//! Returns the indices of points and their sampling weight for given point.
 		void GetCoordinatesAndWeights(
 			const Vector3<R>& pt,
@@ -159,6 +188,19 @@ namespace CubbyFlow
 		//! Returns sampled value at point \p pt.
 		T operator()(const Vector3<R>& pt) const;
 
+		//!
+		//! \brief      Samples the values at the points \p pts and stores them
+		//!     in \p result.
+		//!
+		//! This function evaluates the points in one loop so the sampling code
+		//! is inlined into the loop. It runs serially; split \p pts into ranges
+		//! to sample in parallel.
+		//!
+		//! \param[in]  pts     The points to sample.
+		//! \param[out] result  The sampled values (same size as \p pts).
+		//!
+		void operator()(const ConstArrayAccessor1<Vector3<R>>& pts, ArrayAccessor1<T> result) const;
+
 		//! Returns a function object that wraps this instance.
 		std::function<T(const Vector3<R>&)> Functor() const;
 
@@ -0,0 +1,130 @@
+/*************************************************************************
+> File Name: SoAArray3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 1-D array of 3-D vectors stored as a structure of arrays.
+> Created Time: 2018/01/09
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_SOA_ARRAY3_IMPL_H
+#define CUBBYFLOW_SOA_ARRAY3_IMPL_H
+
+#include <Utils/Constants.h>
+#include <Utils/Parallel.h>
+
+#include <cassert>
+
+namespace CubbyFlow
+{
+	template <typename T>
+	SoAArray3<T>::SoAArray3()
+	{
+		// Do nothing
+	}
+
+	template <typename T>
+	SoAArray3<T>::SoAArray3(size_t size)
+	{
+		Resize(size);
+	}
+
+	template <typename T>
+	size_t SoAArray3<T>::size() const
+	{
+		return m_x.size();
+	}
+
+	template <typename T>
+	void SoAArray3<T>::Resize(size_t size)
+	{
+		m_x.resize(size, 0);
+		m_y.resize(size, 0);
+		m_z.resize(size, 0);
+	}
+
+	template <typename T>
+	void SoAArray3<T>::Clear()
+	{
+		m_x.clear();
+		m_y.clear();
+		m_z.clear();
+	}
+
+	template <typename T>
+	Vector3<T> SoAArray3<T>::At(size_t i) const
+	{
+		assert(i < size());
+		return Vector3<T>(m_x[i], m_y[i], m_z[i]);
+	}
+
+	template <typename T>
+	void SoAArray3<T>::Set(size_t i, const Vector3<T>& value)
+	{
+		assert(i < size());
+		m_x[i] = value.x;
+		m_y[i] = value.y;
+		m_z[i] = value.z;
+	}
+
+	template <typename T>
+	ArrayAccessor1<T> SoAArray3<T>::X()
+	{
+		return ArrayAccessor1<T>(m_x.size(), m_x.data());
+	}
+
+	template <typename T>
+	ConstArrayAccessor1<T> SoAArray3<T>::X() const
+	{
+		return ConstArrayAccessor1<T>(m_x.size(), m_x.data());
+	}
+
+	template <typename T>
+	ArrayAccessor1<T> SoAArray3<T>::Y()
+	{
+		return ArrayAccessor1<T>(m_y.size(), m_y.data());
+	}
+
+	template <typename T>
+	ConstArrayAccessor1<T> SoAArray3<T>::Y() const
+	{
+		return ConstArrayAccessor1<T>(m_y.size(), m_y.data());
+	}
+
+	template <typename T>
+	ArrayAccessor1<T> SoAArray3<T>::Z()
+	{
+		return ArrayAccessor1<T>(m_z.size(), m_z.data());
+	}
+
+	template <typename T>
+	ConstArrayAccessor1<T> SoAArray3<T>::Z() const
+	{
+		return ConstArrayAccessor1<T>(m_z.size(), m_z.data());
+	}
+
+	template <typename T>
+	void SoAArray3<T>::Load(const ConstArrayAccessor1<Vector3<T>>& values)
+	{
+		Resize(values.size());
+
+		ParallelFor(ZERO_SIZE, values.size(), [&](size_t i)
+		{
+			m_x[i] = values[i].x;
+			m_y[i] = values[i].y;
+			m_z[i] = values[i].z;
+		});
+	}
+
+	template <typename T>
+	void SoAArray3<T>::Store(ArrayAccessor1<Vector3<T>> values) const
+	{
+		assert(values.size() == size());
+
+		ParallelFor(ZERO_SIZE, values.size(), [&](size_t i)
+		{
+			values[i] = Vector3<T>(m_x[i], m_y[i], m_z[i]);
+		});
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*************************************************************************
+> File Name: SoAArray3.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 1-D array of 3-D vectors stored as a structure of arrays.
+> Created Time: 2018/01/09
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_SOA_ARRAY3_H
+#define CUBBYFLOW_SOA_ARRAY3_H
+
+#include <Array/ArrayAccessor1.h>
+#include <Utils/AlignedAllocator.h>
+#include <Vector/Vector3.h>
+
+#include <vector>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief 1-D array of 3-D vectors stored as a structure of arrays.
+	//!
+	//! The x, y and z components are stored in three separate channels, each of
+	//! which starts on a 64-byte boundary. Loops that read the channels with
+	//! unit stride can be vectorized by the compiler, unlike loops over
+	//! Array1<Vector3<T>>. The array can be loaded from and stored to an
+	//! array-of-structs accessor such as ParticleSystemData3::GetPositions().
+	//!
+	//! \tparam T - Real number type.
+	//!
+	template <typename T>
+	class SoAArray3 final
+	{
+	public:
+		//! Alignment of each channel in bytes.
+		static constexpr size_t ALIGNMENT = 64;
+
+		//! Constructs zero-sized array.
+		SoAArray3();
+
+		//! Constructs array with given \p size filled with zero vectors.
+		explicit SoAArray3(size_t size);
+
+		//! Returns the number of vectors.
+		size_t size() const;
+
+		//! Resizes the array. New vectors are filled with zero.
+		void Resize(size_t size);
+
+		//! Clears the array and resizes to zero.
+		void Clear();
+
+		//! Returns the i-th vector.
+		Vector3<T> At(size_t i) const;
+
+		//! Sets the i-th vector.
+		void Set(size_t i, const Vector3<T>& value);
+
+		//! Returns the x channel (mutable).
+		ArrayAccessor1<T> X();
+
+		//! Returns the x channel (immutable).
+		ConstArrayAccessor1<T> X() const;
+
+		//! Returns the y channel (mutable).
+		ArrayAccessor1<T> Y();
+
+		//! Returns the y channel (immutable).
+		ConstArrayAccessor1<T> Y() const;
+
+		//! Returns the z channel (mutable).
+		ArrayAccessor1<T> Z();
+
+		//! Returns the z channel (immutable).
+		ConstArrayAccessor1<T> Z() const;
+
+		//! Resizes to the size of \p values and copies them in parallel.
+		void Load(const ConstArrayAccessor1<Vector3<T>>& values);
+
+		//! Copies the vectors to \p values in parallel.
+		void Store(ArrayAccessor1<Vector3<T>> values) const;
+
+	private:
+		using ChannelType = std::vector<T, AlignedAllocator<T, ALIGNMENT>>;
+
+		ChannelType m_x;
+		ChannelType m_y;
+		ChannelType m_z;
+	};
+
+	//! Float-type SoA array of 3-D vectors.
+	using SoAArray3F = SoAArray3<float>;
+
+	//! Double-type SoA array of 3-D vectors.
+	using SoAArray3D = SoAArray3<double>;
+}
+
+#include <Array/SoAArray3-Impl.h>
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*************************************************************************
+> File Name: FDMCompressedSystemUtils3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Helpers for building 3-D compressed linear systems.
+> Created Time: 2018/01/27
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_FDM_COMPRESSED_SYSTEM_UTILS3_IMPL_H
+#define CUBBYFLOW_FDM_COMPRESSED_SYSTEM_UTILS3_IMPL_H
+
+#include <Utils/Parallel.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace CubbyFlow
+{
+	template <typename T, typename IsFluidFunc>
+	bool FDMCompressedSystemUtils3::NumberFluidCells(const Array3<T>& cells,
+		IsFluidFunc isFluid,
+		Array3<size_t>* coordToIndex,
+		std::vector<size_t>* rowToCoord)
+	{
+		const Size3 size = cells.size();
+		const auto cellAcc = cells.ConstAccessor();
+
+		std::vector<size_t> slabOffsets(size.z + 1, 0);
+		ParallelFor(ZERO_SIZE, size.z, [&](size_t k)
+		{
+			size_t count = 0;
+			for (size_t j = 0; j < size.y; ++j)
+			{
+				for (size_t i = 0; i < size.x; ++i)
+				{
+					if (isFluid(cellAcc(i, j, k)))
+					{
+						++count;
+					}
+				}
+			}
+
+			slabOffsets[k + 1] = count;
+		});
+
+		std::partial_sum(slabOffsets.begin(), slabOffsets.end(), slabOffsets.begin());
+
+		const size_t numRows = slabOffsets[size.z];
+		const bool isSameSize = (coordToIndex->size() == size && rowToCoord->size() == numRows);
+
+		coordToIndex->Resize(size);
+		rowToCoord->resize(numRows);
+
+		std::vector<char> isSlabChanged(size.z, 0);
+		ParallelFor(ZERO_SIZE, size.z, [&](size_t k)
+		{
+			size_t row = slabOffsets[k];
+			for (size_t j = 0; j < size.y; ++j)
+			{
+				for (size_t i = 0; i < size.x; ++i)
+				{
+					const size_t cIdx = cellAcc.Index(i, j, k);
+
+					if (isFluid(cellAcc[cIdx]))
+					{
+						if ((*rowToCoord)[row] != cIdx)
+						{
+							(*rowToCoord)[row] = cIdx;
+							isSlabChanged[k] = 1;
+						}
+
+						(*coordToIndex)[cIdx] = row++;
+					}
+				}
+			}
+		});
+
+		return isSameSize && std::find(isSlabChanged.begin(), isSlabChanged.end(), 1) == isSlabChanged.end();
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/*************************************************************************
+> File Name: FDMCompressedSystemUtils3.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Helpers for building 3-D compressed linear systems.
+> Created Time: 2018/01/27
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_FDM_COMPRESSED_SYSTEM_UTILS3_H
+#define CUBBYFLOW_FDM_COMPRESSED_SYSTEM_UTILS3_H
+
+#include <Array/Array3.h>
+
+#include <array>
+#include <vector>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief Row of the 7-point stencil of a compressed 3-D linear system.
+	//!
+	//! The slots are in the ascending order of the column indices: (k - 1),
+	//! (j - 1), (i - 1), center, (i + 1), (j + 1) and (k + 1).
+	//!
+	struct FDMStencilRow3
+	{
+		enum Slot { BACK, DOWN, LEFT, CENTER, RIGHT, UP, FRONT, NUM_SLOTS };
+
+		std::array<double, NUM_SLOTS> values{};
+		std::array<size_t, NUM_SLOTS> columns{};
+		std::array<bool, NUM_SLOTS> isUsed{};
+
+		//! Sets the value and the column index of given slot.
+		void Set(Slot slot, double value, size_t column);
+
+		//! Writes the used slots in the order of the column indices.
+		void Write(double* nonZeros, size_t* columnIndices) const;
+	};
+
+	//! Helper functions for building 3-D compressed linear systems.
+	class FDMCompressedSystemUtils3
+	{
+	public:
+		//!
+		//! \brief Numbers the fluid cells in the memory order of the grid.
+		//!
+		//! The cells for which \p isFluid returns true are numbered slab by slab
+		//! in parallel. Returns true if the fluid cells are the same as the ones
+		//! of the last numbering, which means the sparsity pattern of the system
+		//! can be reused.
+		//!
+		//! \param[in]    cells        The cell data passed to \p isFluid.
+		//! \param[in]    isFluid      Returns true if given cell value is fluid.
+		//! \param[inout] coordToIndex The row index of each fluid cell.
+		//! \param[inout] rowToCoord   The linear cell index of each row.
+		//!
+		template <typename T, typename IsFluidFunc>
+		static bool NumberFluidCells(const Array3<T>& cells,
+			IsFluidFunc isFluid,
+			Array3<size_t>* coordToIndex,
+			std::vector<size_t>* rowToCoord);
+	};
+}
+
+#include <FDM/FDMCompressedSystemUtils3-Impl.h>
+
+#endif
\ No newline at end of file
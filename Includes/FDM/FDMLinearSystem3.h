@@ -12,6 +12,7 @@
 #include <Array/Array3.h>
 #include <Matrix/MatrixCSR.h>
 #include <Size/Size3.h>
+#include <Vector/Vector3.h>
 #include <Vector/VectorN.h>
 
 namespace CubbyFlow
@@ -35,6 +36,9 @@ namespace CubbyFlow
 	//! Vector type for 3-D finite differencing.
 	using FDMVector3 = Array3<double>;
 
+	//! Single-precision vector type for 3-D finite differencing.
+	using FDMVector3F = Array3<float>;
+
 	//! Matrix type for 3-D finite differencing.
 	using FDMMatrix3 = Array3<FDMMatrixRow3>;
 
@@ -57,6 +61,68 @@ namespace CubbyFlow
 		void Resize(const Size3& size);
 	};
 
+	//!
+	//! \brief Matrix-free 3-D Poisson operator for finite differencing.
+	//!
+	//! Instead of storing an FDMMatrixRow3 per grid point, the operator is
+	//! evaluated on the fly from the cell markers and the grid spacing. A fluid
+	//! cell adds 1/h^2 to the diagonal for each face that is not blocked by a
+	//! boundary cell or the domain boundary, and couples to each fluid neighbor
+	//! with -1/h^2. The rows of the air and boundary cells are identity. This is
+	//! the operator that GridSinglePhasePressureSolver3 assembles into
+	//! FDMMatrix3, stored with one byte per grid point instead of 32.
+	//!
+	struct FDMMatrixFree3
+	{
+		//! Marker of a fluid cell.
+		static constexpr char FLUID = 0;
+
+		//! Marker of an air cell.
+		static constexpr char AIR = 1;
+
+		//! Marker of a boundary (solid) cell.
+		static constexpr char BOUNDARY = 2;
+
+		//! Cell markers.
+		Array3<char> markers;
+
+		//! Inverse of the squared grid spacing.
+		Vector3D invHSqr;
+
+		//! Returns the size of the operator.
+		Size3 size() const;
+
+		//! Clears the markers.
+		void Clear();
+
+		//!
+		//! \brief Evaluates the row of (i, j, k) grid point.
+		//!
+		//! (Ax)(i, j, k) = center * x(i, j, k) + offDiagonal.
+		//!
+		void Row(size_t i, size_t j, size_t k, const FDMVector3& x,
+			double* center, double* offDiagonal) const;
+	};
+
+	//! Matrix-free linear system (Ax=b) for 3-D finite differencing.
+	struct FDMMatrixFreeLinearSystem3
+	{
+		//! System operator.
+		FDMMatrixFree3 A;
+
+		//! Solution vector.
+		FDMVector3 x;
+
+		//! RHS vector.
+		FDMVector3 b;
+
+		//! Clears all the data.
+		void Clear();
+
+		//! Resizes the arrays with given grid size.
+		void Resize(const Size3& size);
+	};
+
     //! Compressed linear system (Ax=b) for 3-D finite differencing.
     struct FDMCompressedLinearSystem3
     {
@@ -109,6 +175,129 @@ namespace CubbyFlow
 
 		//! Returns Linf-norm of the given vector \p v.
 		static ScalarType LInfNorm(const VectorType& v);
+
+		//!
+		//! \brief Performs matrix-vector multiplication and returns the dot
+		//!        product of \p v and \p result in the same sweep.
+		//!
+		static double MVMDot(const MatrixType& m, const VectorType& v, VectorType* result);
+
+		//!
+		//! \brief Performs the CG update x = x + alpha * d and r = r - alpha * q
+		//!        and returns r.r in the same sweep.
+		//!
+		static double CGUpdate(double alpha, const VectorType& d, const VectorType& q,
+			VectorType* x, VectorType* r);
+
+		//!
+		//! \brief Performs the vector recurrences of the pipelined PCG in one
+		//!        sweep and returns the dot products of the next iteration.
+		//!
+		//! z = n + beta * z, q = m + beta * q, s = w + beta * s, p = u + beta * p,
+		//! x = x + alpha * p, r = r - alpha * s, u = u - alpha * q and
+		//! w = w - alpha * z, followed by \p ru = r.u and \p wu = w.u.
+		//!
+		static void PipelinedCGUpdate(double alpha, double beta,
+			const VectorType& n, const VectorType& m,
+			VectorType* z, VectorType* q, VectorType* s, VectorType* p,
+			VectorType* x, VectorType* r, VectorType* u, VectorType* w,
+			double* ru, double* wu);
+	};
+
+	//!
+	//! \brief BLAS operator wrapper for 3-D finite differencing with
+	//!        single-precision vectors.
+	//!
+	//! The vectors are stored in float to halve the memory traffic of the
+	//! solvers, while the matrix stays in double. Dot products and norms are
+	//! accumulated in double.
+	//!
+	struct FDMBLAS3F
+	{
+		using ScalarType = double;
+		using VectorType = FDMVector3F;
+		using MatrixType = FDMMatrix3;
+
+		//! Sets entire element of given vector \p result with scalar \p s.
+		static void Set(ScalarType s, VectorType* result);
+
+		//! Copies entire element of given vector \p result with other vector \p v.
+		static void Set(const VectorType& v, VectorType* result);
+
+		//! Sets entire element of given matrix \p result with scalar \p s.
+		static void Set(ScalarType s, MatrixType* result);
+
+		//! Copies entire element of given matrix \p result with other matrix \p v.
+		static void Set(const MatrixType& m, MatrixType* result);
+
+		//! Performs dot product with vector \p a and \p b.
+		static double Dot(const VectorType& a, const VectorType& b);
+
+		//! Performs ax + y operation where \p a is a matrix and \p x and \p y are vectors.
+		static void AXPlusY(double a, const VectorType& x, const VectorType& y, VectorType* result);
+
+		//! Performs matrix-vector multiplication.
+		static void MVM(const MatrixType& m, const VectorType& v, VectorType* result);
+
+		//! Computes residual vector (b - ax).
+		static void Residual(const MatrixType& a, const VectorType& x, const VectorType& b, VectorType* result);
+
+		//!
+		//! \brief Computes residual vector (b - ax) of a double-precision system.
+		//!
+		//! The residual is evaluated in double and only the result is rounded to
+		//! float, so it can drive the iterative refinement of a double-precision
+		//! solution with single-precision corrections.
+		//!
+		static void Residual(const MatrixType& a, const FDMVector3& x, const FDMVector3& b, VectorType* result);
+
+		//! Returns L2-norm of the given vector \p v.
+		static ScalarType L2Norm(const VectorType& v);
+
+		//! Returns Linf-norm of the given vector \p v.
+		static ScalarType LInfNorm(const VectorType& v);
+	};
+
+	//!
+	//! \brief BLAS operator wrapper for matrix-free 3-D finite differencing.
+	//!
+	//! MVM and Residual evaluate the stencil from the markers of FDMMatrixFree3.
+	//! The inner loop over each x-line has no boundary branches: the lines
+	//! outside the domain are replaced by boundary markers and the fluid/open
+	//! tests are turned into multiplications, so the compiler can vectorize it.
+	//!
+	struct FDMMatrixFreeBLAS3
+	{
+		using ScalarType = double;
+		using VectorType = FDMVector3;
+		using MatrixType = FDMMatrixFree3;
+
+		//! Sets entire element of given vector \p result with scalar \p s.
+		static void Set(ScalarType s, VectorType* result);
+
+		//! Copies entire element of given vector \p result with other vector \p v.
+		static void Set(const VectorType& v, VectorType* result);
+
+		//! Copies given operator \p m to \p result.
+		static void Set(const MatrixType& m, MatrixType* result);
+
+		//! Performs dot product with vector \p a and \p b.
+		static double Dot(const VectorType& a, const VectorType& b);
+
+		//! Performs ax + y operation where \p a is a matrix and \p x and \p y are vectors.
+		static void AXPlusY(double a, const VectorType& x, const VectorType& y, VectorType* result);
+
+		//! Performs matrix-vector multiplication.
+		static void MVM(const MatrixType& m, const VectorType& v, VectorType* result);
+
+		//! Computes residual vector (b - ax).
+		static void Residual(const MatrixType& a, const VectorType& x, const VectorType& b, VectorType* result);
+
+		//! Returns L2-norm of the given vector \p v.
+		static ScalarType L2Norm(const VectorType& v);
+
+		//! Returns Linf-norm of the given vector \p v.
+		static ScalarType LInfNorm(const VectorType& v);
 	};
 
 	//! BLAS operator wrapper for compressed 3-D finite differencing.
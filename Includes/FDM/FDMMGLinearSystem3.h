@@ -20,6 +20,12 @@ namespace CubbyFlow
 	//! Multigrid-style 3-D FDM vector.
 	using FDMMGVector3 = MGVector<FDMBLAS3>;
 
+	//! Multigrid-style 3-D matrix-free FDM operator.
+	using FDMMGMatrixFree3 = MGMatrix<FDMMatrixFreeBLAS3>;
+
+	//! Multigrid-style 3-D FDM vector for the matrix-free operator.
+	using FDMMGMatrixFreeVector3 = MGVector<FDMMatrixFreeBLAS3>;
+
 	//! Multigrid-syle 3-D linear system.
 	struct FDMMGLinearSystem3
 	{
@@ -53,6 +59,25 @@ namespace CubbyFlow
 		void ResizeWithFinest(const Size3& finestResolution, size_t maxNumberOfLevels);
 	};
 
+	//! Multigrid-syle 3-D matrix-free linear system.
+	struct FDMMGMatrixFreeLinearSystem3
+	{
+		//! The system operator.
+		FDMMGMatrixFree3 A;
+
+		//! The solution vector.
+		FDMMGMatrixFreeVector3 x;
+
+		//! The RHS vector.
+		FDMMGMatrixFreeVector3 b;
+
+		//! Clears the linear system.
+		void Clear();
+
+		//! Returns the number of multigrid levels.
+		size_t GetNumberOfLevels() const;
+	};
+
 	//! Multigrid utilities for 2-D FDM system.
 	class FDMMGUtils3
 	{
@@ -94,6 +94,24 @@ namespace CubbyFlow
 		//!
 		std::function<Vector3D(const Vector3D&)> Sampler() const override;
 
+		//!
+		//! \brief Returns the linear sampler of the grid data.
+		//!
+		//! Unlike Sampler(), the returned object is not type-erased, so the
+		//! kernels that sample the grid many times can inline the sampling.
+		//! The sampler refers to the grid data and is valid until the grid is
+		//! resized or swapped.
+		//!
+		const LinearArraySampler3<Vector3D, double>& LinearSampler() const;
+
+		//!
+		//! \brief Returns the cubic sampler of the grid data.
+		//!
+		//! The sampler uses the monotonic Catmull-Rom interpolation and is valid
+		//! until the grid is resized or swapped.
+		//!
+		CubicArraySampler3<Vector3D, double> CubicSampler() const;
+
 	protected:
 		//! Swaps the data storage and predefined samplers with given grid.
 		void SwapCollocatedVectorGrid(CollocatedVectorGrid3* other);
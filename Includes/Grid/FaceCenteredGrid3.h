@@ -11,6 +11,7 @@
 
 #include <Array/Array3.h>
 #include <Array/ArraySamplers3.h>
+#include <Grid/FaceCenteredGridSampler3.h>
 #include <Grid/VectorGrid3.h>
 
 namespace CubbyFlow
@@ -240,6 +241,24 @@ namespace CubbyFlow
 		//!
 		std::function<Vector3D(const Vector3D&)> Sampler() const override;
 
+		//!
+		//! \brief Returns the linear sampler of the grid data.
+		//!
+		//! Unlike Sampler(), the returned object is not type-erased, so the
+		//! kernels that sample the grid many times can inline the sampling.
+		//! The sampler refers to the grid data and is valid until the grid is
+		//! resized or swapped.
+		//!
+		FaceCenteredGridSampler3<LinearArraySampler3<double, double>> LinearSampler() const;
+
+		//!
+		//! \brief Returns the cubic sampler of the grid data.
+		//!
+		//! The sampler uses the monotonic Catmull-Rom interpolation and is valid
+		//! until the grid is resized or swapped.
+		//!
+		FaceCenteredGridSampler3<CubicArraySampler3<double, double>> CubicSampler() const;
+
 		//! Returns builder fox FaceCenteredGrid3.
 		static Builder GetBuilder();
 
@@ -0,0 +1,60 @@
+/*************************************************************************
+> File Name: FaceCenteredGridSampler3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D face-centered grid sampler class.
+> Created Time: 2018/01/23
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_FACE_CENTERED_GRID_SAMPLER3_IMPL_H
+#define CUBBYFLOW_FACE_CENTERED_GRID_SAMPLER3_IMPL_H
+
+#include <array>
+
+namespace CubbyFlow
+{
+	template <typename ArraySampler>
+	FaceCenteredGridSampler3<ArraySampler>::FaceCenteredGridSampler3(
+		const ArraySampler& uSampler,
+		const ArraySampler& vSampler,
+		const ArraySampler& wSampler) :
+		m_uSampler(uSampler), m_vSampler(vSampler), m_wSampler(wSampler)
+	{
+		// Do nothing
+	}
+
+	template <typename ArraySampler>
+	Vector3D FaceCenteredGridSampler3<ArraySampler>::operator()(const Vector3D& pt) const
+	{
+		return Vector3D(m_uSampler(pt), m_vSampler(pt), m_wSampler(pt));
+	}
+
+	template <typename ArraySampler>
+	void FaceCenteredGridSampler3<ArraySampler>::operator()(const ConstArrayAccessor1<Vector3D>& pts, ArrayAccessor1<Vector3D> result) const
+	{
+		assert(pts.size() == result.size());
+
+		// Samples each component over a block of points with the batch sampler
+		// of the component, so the block stays in cache for all three passes.
+		constexpr size_t blockSize = 64;
+
+		std::array<double, blockSize> u, v, w;
+
+		for (size_t begin = 0; begin < pts.size(); begin += blockSize)
+		{
+			const size_t count = std::min(blockSize, pts.size() - begin);
+			const ConstArrayAccessor1<Vector3D> blockPts(count, pts.data() + begin);
+
+			m_uSampler(blockPts, ArrayAccessor1<double>(count, u.data()));
+			m_vSampler(blockPts, ArrayAccessor1<double>(count, v.data()));
+			m_wSampler(blockPts, ArrayAccessor1<double>(count, w.data()));
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				result[begin + i] = Vector3D(u[i], v[i], w[i]);
+			}
+		}
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+/*************************************************************************
+> File Name: FaceCenteredGridSampler3.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D face-centered grid sampler class.
+> Created Time: 2018/01/23
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_FACE_CENTERED_GRID_SAMPLER3_H
+#define CUBBYFLOW_FACE_CENTERED_GRID_SAMPLER3_H
+
+#include <Array/ArraySamplers3.h>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief 3-D face-centered grid sampler class.
+	//!
+	//! This class samples the u, v, and w components of a face-centered grid
+	//! with the array sampler of each component. Unlike the function object
+	//! returned by FaceCenteredGrid3::Sampler, the type of the component
+	//! samplers is known at compile time, so the sampling can be inlined.
+	//!
+	//! \tparam ArraySampler - The sampler type of each component such as
+	//!     LinearArraySampler3<double, double>.
+	//!
+	template <typename ArraySampler>
+	class FaceCenteredGridSampler3 final
+	{
+	public:
+		//!
+		//! \brief      Constructs a sampler from the samplers of the u, v, and w
+		//!     components.
+		//!
+		//! \param[in]  uSampler    The sampler of the u component.
+		//! \param[in]  vSampler    The sampler of the v component.
+		//! \param[in]  wSampler    The sampler of the w component.
+		//!
+		FaceCenteredGridSampler3(
+			const ArraySampler& uSampler,
+			const ArraySampler& vSampler,
+			const ArraySampler& wSampler);
+
+		//! Returns sampled value at point \p pt.
+		Vector3D operator()(const Vector3D& pt) const;
+
+		//!
+		//! \brief      Samples the values at the points \p pts and stores them
+		//!     in \p result.
+		//!
+		//! The points are sampled in blocks; each component is sampled over a
+		//! block with the batch sampler of the component. This function runs
+		//! serially; split \p pts into ranges to sample in parallel.
+		//!
+		//! \param[in]  pts     The points to sample.
+		//! \param[out] result  The sampled values (same size as \p pts).
+		//!
+		void operator()(const ConstArrayAccessor1<Vector3D>& pts, ArrayAccessor1<Vector3D> result) const;
+
+	private:
+		ArraySampler m_uSampler;
+		ArraySampler m_vSampler;
+		ArraySampler m_wSampler;
+	};
+}
+
+#include <Grid/FaceCenteredGridSampler3-Impl.h>
+
+#endif
\ No newline at end of file
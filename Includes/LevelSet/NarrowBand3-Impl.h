@@ -0,0 +1,63 @@
+/*************************************************************************
+> File Name: NarrowBand3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D narrow band of grid points around a level set interface.
+> Created Time: 2018/01/11
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_NARROW_BAND3_IMPL_H
+#define CUBBYFLOW_NARROW_BAND3_IMPL_H
+
+#include <Utils/Constants.h>
+#include <Utils/Parallel.h>
+
+namespace CubbyFlow
+{
+	template <typename Callback>
+	void NarrowBand3::ForEachIndex(Callback func) const
+	{
+		for (const Point3UI& pt : m_points)
+		{
+			func(pt.x, pt.y, pt.z);
+		}
+	}
+
+	template <typename Callback>
+	void NarrowBand3::ParallelForEachIndex(Callback func) const
+	{
+		ParallelFor(ZERO_SIZE, m_points.size(), [&](size_t n)
+		{
+			const Point3UI& pt = m_points[n];
+			func(pt.x, pt.y, pt.z);
+		});
+	}
+
+	template <typename Callback>
+	void NarrowBand3::ForEachFaceIndex(size_t axis, Callback func) const
+	{
+		Point3UI face;
+		for (size_t f = 0; f < 2 * m_points.size(); ++f)
+		{
+			if (GetFace(axis, f, &face))
+			{
+				func(f, face.x, face.y, face.z);
+			}
+		}
+	}
+
+	template <typename Callback>
+	void NarrowBand3::ParallelForEachFaceIndex(size_t axis, Callback func) const
+	{
+		ParallelFor(ZERO_SIZE, 2 * m_points.size(), [&](size_t f)
+		{
+			Point3UI face;
+			if (GetFace(axis, f, &face))
+			{
+				func(f, face.x, face.y, face.z);
+			}
+		});
+	}
+}
+
+#endif
\ No newline at end of file
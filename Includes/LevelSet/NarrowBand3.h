@@ -0,0 +1,134 @@
+/*************************************************************************
+> File Name: NarrowBand3.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D narrow band of grid points around a level set interface.
+> Created Time: 2018/01/11
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_NARROW_BAND3_H
+#define CUBBYFLOW_NARROW_BAND3_H
+
+#include <Array/Array3.h>
+#include <Point/Point3.h>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief 3-D narrow band of grid points around a level set interface.
+	//!
+	//! This class keeps the list of the data points of a signed-distance grid
+	//! whose distance to the interface is less than the band width, together
+	//! with a dense index lookup. The points are sorted in (i, j, k) order with
+	//! i running fastest. Once built, the band is maintained incrementally with
+	//! Dilate and Trim, which only visit the points of the band and their
+	//! neighbors, so the cost scales with the interface area.
+	//!
+	//! The values of the points outside of the band are clamped to +/- width so
+	//! that the grid remains a valid distance bound everywhere.
+	//!
+	//! \see Peng, Danping, et al. "A PDE-based fast local level set method."
+	//!     Journal of Computational Physics 155.2 (1999): 410-438.
+	//!
+	class NarrowBand3
+	{
+	public:
+		//! Index returned for the points that are not in the band.
+		static constexpr size_t NOT_IN_BAND = std::numeric_limits<size_t>::max();
+
+		//! Constructs an empty band.
+		NarrowBand3();
+
+		//! Returns the number of points in the band.
+		size_t size() const;
+
+		//! Returns the size of the grid that the band is built for.
+		Size3 GetGridSize() const;
+
+		//! Returns the n-th point of the band.
+		const Point3UI& operator[](size_t n) const;
+
+		//! Returns the band index of the (i, j, k) point, or NOT_IN_BAND.
+		size_t IndexOf(size_t i, size_t j, size_t k) const;
+
+		//! Returns true if the (i, j, k) point is in the band.
+		bool Contains(size_t i, size_t j, size_t k) const;
+
+		//!
+		//! \brief Returns the band indices of the six neighbors of the n-th point.
+		//!
+		//! The neighbors are returned in (i - 1, i + 1, j - 1, j + 1, k - 1,
+		//! k + 1) order. Neighbors outside of the grid or the band are
+		//! NOT_IN_BAND.
+		//!
+		std::array<size_t, 6> GetNeighbors(size_t n) const;
+
+		//!
+		//! \brief Returns the face index of the (i, j, k) face along \p axis.
+		//!
+		//! The faces along \p axis are indexed on the (size.x + 1, size.y, size.z)
+		//! grid for the x-axis and so on, as in FaceCenteredGrid3. A face is in
+		//! the band if one of its two adjacent points is. The face index is in
+		//! [0, 2 * size()), or NOT_IN_BAND.
+		//!
+		size_t FaceIndexOf(size_t axis, size_t i, size_t j, size_t k) const;
+
+		//! Removes all the points and sets the grid size to zero.
+		void Clear();
+
+		//!
+		//! \brief Builds the band from the whole \p sdf grid.
+		//!
+		//! The points with |sdf| < \p width are added to the band and the rest
+		//! are clamped to +/- \p width. This visits every point of the grid and
+		//! is meant for the initial build only.
+		//!
+		void Build(ArrayAccessor3<double> sdf, double width);
+
+		//! Adds \p numberOfLayers layers of neighbors around the band.
+		void Dilate(size_t numberOfLayers = 1);
+
+		//!
+		//! \brief Removes the points with |sdf| >= \p width from the band.
+		//!
+		//! The values of the removed points are clamped to +/- \p width.
+		//!
+		void Trim(ArrayAccessor3<double> sdf, double width);
+
+		//! Invokes \p func for each point (i, j, k) of the band.
+		template <typename Callback>
+		void ForEachIndex(Callback func) const;
+
+		//! Invokes \p func for each point (i, j, k) of the band in parallel.
+		template <typename Callback>
+		void ParallelForEachIndex(Callback func) const;
+
+		//!
+		//! \brief Invokes \p func for each face of the band along \p axis.
+		//!
+		//! The callback takes (faceIndex, i, j, k) and is called once per face.
+		//!
+		template <typename Callback>
+		void ForEachFaceIndex(size_t axis, Callback func) const;
+
+		//! Invokes \p func for each face of the band along \p axis in parallel.
+		template <typename Callback>
+		void ParallelForEachFaceIndex(size_t axis, Callback func) const;
+
+	private:
+		Array3<size_t> m_indices;
+		std::vector<Point3UI> m_points;
+
+		void SortAndReindex();
+
+		bool GetFace(size_t axis, size_t faceIndex, Point3UI* face) const;
+	};
+}
+
+#include <LevelSet/NarrowBand3-Impl.h>
+
+#endif
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #include <Array/ArrayAccessor3.h>
 #include <Geometry/TriangleMesh3.h>
+#include <Utils/Parallel.h>
 #include <Vector/Vector3.h>
 
 namespace CubbyFlow
@@ -23,12 +24,17 @@ namespace CubbyFlow
 	//! the iso-value can be specified. For the boundaries (or the walls), it can be
 	//! specified whether to close or open.
 	//!
+	//! With the parallel execution policy, the cubes are triangulated in z-slabs
+	//! concurrently and the shared vertices on the slab boundaries are welded
+	//! with prefix sums. The output mesh is identical to the serial one.
+	//!
 	//! \param[in]  grid     The grid.
 	//! \param[in]  gridSize The grid size.
 	//! \param[in]  origin   The origin.
 	//! \param      mesh     The output triangle mesh.
 	//! \param[in]  isoValue The iso-surface value.
 	//! \param[in]  bndFlag  The boundary direction flag.
+	//! \param[in]  policy   The execution policy.
 	//!
 	void MarchingCubes(
 		const ConstArrayAccessor3<double>& grid,
@@ -36,7 +42,8 @@ namespace CubbyFlow
 		const Vector3D& origin,
 		TriangleMesh3* mesh,
 		double isoValue = 0,
-		int bndFlag = DIRECTION_ALL);
+		int bndFlag = DIRECTION_ALL,
+		ExecutionPolicy policy = ExecutionPolicy::Parallel);
 }
 
 #endif
\ No newline at end of file
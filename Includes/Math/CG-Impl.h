@@ -11,8 +11,31 @@
 
 #include <Math/MathUtils.h>
 
+#include <cmath>
+
 namespace CubbyFlow
 {
+	namespace Internal
+	{
+		// Appends the norm of given squared residual, clearing the history first
+		// if it is the initial one
+		inline void RecordResidual(double sigma, bool isInitial, std::vector<double>* residualHistory)
+		{
+			if (residualHistory == nullptr)
+			{
+				return;
+			}
+
+			if (isInitial)
+			{
+				residualHistory->clear();
+			}
+
+			// std::fabs(sigma) - Workaround for negative zero
+			residualHistory->push_back(std::sqrt(std::fabs(sigma)));
+		}
+	}
+
 	template <typename BLASType>
 	void CG(
 		const typename BLASType::MatrixType& A,
@@ -25,7 +48,8 @@ namespace CubbyFlow
 		typename BLASType::VectorType* q,
 		typename BLASType::VectorType* s,
 		unsigned int* lastNumberOfIterations,
-		double* lastResidualNorm)
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory)
 	{
 		using PrecondType = NullCGPreconditioner<BLASType>;
 		PrecondType precond;
@@ -42,7 +66,8 @@ namespace CubbyFlow
 			q,
 			s,
 			lastNumberOfIterations,
-			lastResidualNorm);
+			lastResidualNorm,
+			residualHistory);
 	}
 
 	template <typename BLASType, typename PrecondType>
@@ -58,7 +83,8 @@ namespace CubbyFlow
 		typename BLASType::VectorType* q,
 		typename BLASType::VectorType* s,
 		unsigned int* lastNumberOfIterations,
-		double* lastResidualNorm)
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory)
 	{
 		// Clear
 		BLASType::Set(0, r);
@@ -75,6 +101,8 @@ namespace CubbyFlow
 		// sigmaNew = r.d
 		double sigmaNew = BLASType::Dot(*r, *d);
 
+		Internal::RecordResidual(sigmaNew, true, residualHistory);
+
 		unsigned int iter = 0;
 		bool trigger = false;
 
@@ -122,6 +150,176 @@ namespace CubbyFlow
 			// d = s + beta*d
 			BLASType::AXPlusY(beta, *d, *s, d);
 
+			Internal::RecordResidual(sigmaNew, false, residualHistory);
+
+			++iter;
+		}
+
+		*lastNumberOfIterations = iter;
+
+		// std::fabs(sigmaNew) - Workaround for negative zero
+		*lastResidualNorm = std::sqrt(std::fabs(sigmaNew));
+	}
+
+	template <typename BLASType>
+	void FusedCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* d,
+		typename BLASType::VectorType* q,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory)
+	{
+		// Clear
+		BLASType::Set(0, r);
+		BLASType::Set(0, d);
+		BLASType::Set(0, q);
+
+		// r = b - Ax
+		BLASType::Residual(A, *x, b, r);
+
+		// d = r
+		BLASType::Set(*r, d);
+
+		// sigmaNew = r.r
+		double sigmaNew = BLASType::Dot(*r, *r);
+
+		Internal::RecordResidual(sigmaNew, true, residualHistory);
+
+		unsigned int iter = 0;
+		bool trigger = false;
+
+		while (sigmaNew > Square(tolerance) && iter < maxNumberOfIterations)
+		{
+			// q = Ad, alpha = sigmaNew / d.q
+			double alpha = sigmaNew / BLASType::MVMDot(A, *d, q);
+
+			// sigmaOld = sigmaNew
+			double sigmaOld = sigmaNew;
+
+			// if i is divisible by 50...
+			if (trigger || (iter % 50 == 0 && iter > 0))
+			{
+				// x = x + alpha * d
+				BLASType::AXPlusY(alpha, *d, *x, x);
+
+				// r = b - Ax
+				BLASType::Residual(A, *x, b, r);
+				sigmaNew = BLASType::Dot(*r, *r);
+				trigger = false;
+			}
+			else
+			{
+				// x = x + alpha * d, r = r - alpha * q, sigmaNew = r.r
+				sigmaNew = BLASType::CGUpdate(alpha, *d, *q, x, r);
+			}
+
+			if (sigmaNew > sigmaOld)
+			{
+				trigger = true;
+			}
+
+			// beta = sigmaNew / sigmaOld
+			double beta = sigmaNew / sigmaOld;
+
+			// d = r + beta*d
+			BLASType::AXPlusY(beta, *d, *r, d);
+
+			Internal::RecordResidual(sigmaNew, false, residualHistory);
+
+			++iter;
+		}
+
+		*lastNumberOfIterations = iter;
+
+		// std::fabs(sigmaNew) - Workaround for negative zero
+		*lastResidualNorm = std::sqrt(std::fabs(sigmaNew));
+	}
+
+	template <typename BLASType, typename PrecondType>
+	void FusedPCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		PrecondType* M,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* d,
+		typename BLASType::VectorType* q,
+		typename BLASType::VectorType* s,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory)
+	{
+		// Clear
+		BLASType::Set(0, r);
+		BLASType::Set(0, d);
+		BLASType::Set(0, q);
+		BLASType::Set(0, s);
+
+		// r = b - Ax
+		BLASType::Residual(A, *x, b, r);
+
+		// d = M^-1r
+		M->Solve(*r, d);
+
+		// sigmaNew = r.d
+		double sigmaNew = BLASType::Dot(*r, *d);
+
+		Internal::RecordResidual(sigmaNew, true, residualHistory);
+
+		unsigned int iter = 0;
+		bool trigger = false;
+
+		while (sigmaNew > Square(tolerance) && iter < maxNumberOfIterations)
+		{
+			// q = Ad, alpha = sigmaNew / d.q
+			double alpha = sigmaNew / BLASType::MVMDot(A, *d, q);
+
+			// if i is divisible by 50...
+			if (trigger || (iter % 50 == 0 && iter > 0))
+			{
+				// x = x + alpha * d
+				BLASType::AXPlusY(alpha, *d, *x, x);
+
+				// r = b - Ax
+				BLASType::Residual(A, *x, b, r);
+				trigger = false;
+			}
+			else
+			{
+				// x = x + alpha * d, r = r - alpha * q
+				BLASType::CGUpdate(alpha, *d, *q, x, r);
+			}
+
+			// s = M^-1r
+			M->Solve(*r, s);
+
+			// sigmaOld = sigmaNew
+			double sigmaOld = sigmaNew;
+
+			// sigmaNew = r.s
+			sigmaNew = BLASType::Dot(*r, *s);
+
+			if (sigmaNew > sigmaOld)
+			{
+				trigger = true;
+			}
+
+			// beta = sigmaNew / sigmaOld
+			double beta = sigmaNew / sigmaOld;
+
+			// d = s + beta*d
+			BLASType::AXPlusY(beta, *d, *s, d);
+
+			Internal::RecordResidual(sigmaNew, false, residualHistory);
+
 			++iter;
 		}
 
@@ -130,6 +328,110 @@ namespace CubbyFlow
 		// std::fabs(sigmaNew) - Workaround for negative zero
 		*lastResidualNorm = std::sqrt(std::fabs(sigmaNew));
 	}
+
+	template <typename BLASType, typename PrecondType>
+	void PipelinedPCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		PrecondType* M,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* u,
+		typename BLASType::VectorType* w,
+		typename BLASType::VectorType* m,
+		typename BLASType::VectorType* n,
+		typename BLASType::VectorType* z,
+		typename BLASType::VectorType* q,
+		typename BLASType::VectorType* s,
+		typename BLASType::VectorType* p,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory)
+	{
+		// Clear
+		BLASType::Set(0, r);
+		BLASType::Set(0, u);
+		BLASType::Set(0, w);
+		BLASType::Set(0, m);
+		BLASType::Set(0, n);
+		BLASType::Set(0, z);
+		BLASType::Set(0, q);
+		BLASType::Set(0, s);
+		BLASType::Set(0, p);
+
+		// r = b - Ax, u = M^-1r, w = Au
+		BLASType::Residual(A, *x, b, r);
+		M->Solve(*r, u);
+		BLASType::MVM(A, *u, w);
+
+		// gamma = r.u, delta = w.u
+		double gamma = BLASType::Dot(*r, *u);
+		double delta = BLASType::Dot(*w, *u);
+
+		Internal::RecordResidual(gamma, true, residualHistory);
+
+		double gammaOld = 0.0;
+		double alphaOld = 0.0;
+		unsigned int iter = 0;
+
+		while (gamma > Square(tolerance) && iter < maxNumberOfIterations)
+		{
+			// m = M^-1w, n = Am
+			// The recurrences assume that M^-1 is a fixed linear operator, so the
+			// pre-conditioner always starts from zero.
+			BLASType::Set(0, m);
+			M->Solve(*w, m);
+			BLASType::MVM(A, *m, n);
+
+			double alpha, beta;
+			if (iter > 0)
+			{
+				beta = gamma / gammaOld;
+				alpha = gamma / (delta - beta * gamma / alphaOld);
+			}
+			else
+			{
+				beta = 0.0;
+				alpha = gamma / delta;
+			}
+
+			gammaOld = gamma;
+			alphaOld = alpha;
+
+			// z = n + beta*z, q = m + beta*q, s = w + beta*s, p = u + beta*p,
+			// x = x + alpha*p, r = r - alpha*s, u = u - alpha*q, w = w - alpha*z,
+			// gamma = r.u, delta = w.u
+			BLASType::PipelinedCGUpdate(alpha, beta, *n, *m, z, q, s, p, x, r, u, w, &gamma, &delta);
+
+			++iter;
+
+			// if i is divisible by 50...
+			if (iter % 50 == 0)
+			{
+				// Replace the recurrences with their definitions
+				BLASType::Residual(A, *x, b, r);
+				BLASType::Set(0, u);
+				M->Solve(*r, u);
+				BLASType::MVM(A, *u, w);
+				BLASType::MVM(A, *p, s);
+				BLASType::Set(0, q);
+				M->Solve(*s, q);
+				BLASType::MVM(A, *q, z);
+
+				gamma = BLASType::Dot(*r, *u);
+				delta = BLASType::Dot(*w, *u);
+			}
+
+			Internal::RecordResidual(gamma, false, residualHistory);
+		}
+
+		*lastNumberOfIterations = iter;
+
+		// std::fabs(gamma) - Workaround for negative zero
+		*lastResidualNorm = std::sqrt(std::fabs(gamma));
+	}
 }
 
 #endif
\ No newline at end of file
@@ -11,8 +11,29 @@
 
 #include <Math/BLAS.h>
 
+#include <vector>
+
 namespace CubbyFlow
 {
+	//! Variants of the conjugate gradient iteration.
+	enum class CGMethod
+	{
+		//! Calls a BLAS operation for each step of the iteration.
+		Standard,
+
+		//!
+		//! Fuses the matrix-vector multiplication with d.q and the solution and
+		//! residual updates with r.r (see FusedCG and FusedPCG).
+		//!
+		Fused,
+
+		//!
+		//! Pipelined CG with a single reduction per iteration (see
+		//! PipelinedPCG).
+		//!
+		Pipelined
+	};
+
 	//!
 	//! \brief No-op pre-conditioner for conjugate gradient.
 	//!
@@ -36,6 +57,10 @@ namespace CubbyFlow
 	//!
 	//! \brief Solves conjugate gradient.
 	//!
+	//! If \p residualHistory is not null, it is filled with the residual norm
+	//! before the first iteration and after each iteration. The same holds for
+	//! the other variants below.
+	//!
 	template <typename BLASType>
 	void CG(
 		const typename BLASType::MatrixType& A,
@@ -48,7 +73,8 @@ namespace CubbyFlow
 		typename BLASType::VectorType* q,
 		typename BLASType::VectorType* s,
 		unsigned int* lastNumberOfIterations,
-		double* lastResidualNorm);
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory = nullptr);
 
 	//!
 	//! \brief Solves pre-conditioned conjugate gradient.
@@ -66,7 +92,85 @@ namespace CubbyFlow
 		typename BLASType::VectorType* q,
 		typename BLASType::VectorType* s,
 		unsigned int* lastNumberOfIterations,
-		double* lastResidualNorm);
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory = nullptr);
+
+	//!
+	//! \brief Solves conjugate gradient with fused kernels.
+	//!
+	//! Same iteration as CG, but q = Ad is computed together with d.q
+	//! (BLASType::MVMDot) and the solution and residual updates together with
+	//! r.r (BLASType::CGUpdate), so each iteration makes three sweeps over the
+	//! vectors instead of seven.
+	//!
+	template <typename BLASType>
+	void FusedCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* d,
+		typename BLASType::VectorType* q,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory = nullptr);
+
+	//!
+	//! \brief Solves pre-conditioned conjugate gradient with fused kernels.
+	//!
+	//! Same iteration as PCG, but q = Ad is computed together with d.q
+	//! (BLASType::MVMDot) and the solution and residual updates are done in one
+	//! sweep (BLASType::CGUpdate).
+	//!
+	template <typename BLASType, typename PrecondType>
+	void FusedPCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		PrecondType* M,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* d,
+		typename BLASType::VectorType* q,
+		typename BLASType::VectorType* s,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory = nullptr);
+
+	//!
+	//! \brief Solves pipelined pre-conditioned conjugate gradient.
+	//!
+	//! Ghysels and Vanroose's rearrangement of PCG, which applies the
+	//! pre-conditioner and the matrix to auxiliary vectors so that all the
+	//! vector recurrences and both dot products of an iteration are done in a
+	//! single sweep (BLASType::PipelinedCGUpdate). This leaves one reduction
+	//! per iteration at the cost of more vectors. The residual and the
+	//! auxiliary vectors are recomputed every 50 iterations to limit the drift
+	//! of the recurrences.
+	//!
+	template <typename BLASType, typename PrecondType>
+	void PipelinedPCG(
+		const typename BLASType::MatrixType& A,
+		const typename BLASType::VectorType& b,
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		PrecondType* M,
+		typename BLASType::VectorType* x,
+		typename BLASType::VectorType* r,
+		typename BLASType::VectorType* u,
+		typename BLASType::VectorType* w,
+		typename BLASType::VectorType* m,
+		typename BLASType::VectorType* n,
+		typename BLASType::VectorType* z,
+		typename BLASType::VectorType* q,
+		typename BLASType::VectorType* s,
+		typename BLASType::VectorType* p,
+		unsigned int* lastNumberOfIterations,
+		double* lastResidualNorm,
+		std::vector<double>* residualHistory = nullptr);
 }
 
 #include <Math/CG-Impl.h>
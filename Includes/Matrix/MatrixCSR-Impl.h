@@ -303,6 +303,41 @@ namespace CubbyFlow
 		m_rowPointers.push_back(m_nonZeros.size());
 	}
 
+	template <typename T>
+	template <typename CountFunc, typename FillFunc>
+	void MatrixCSR<T>::ParallelBuild(size_t rows, size_t cols, const CountFunc& countFunc, const FillFunc& fillFunc)
+	{
+		m_size = Size2(rows, cols);
+		m_rowPointers.resize(rows + 1);
+		m_rowPointers[0] = 0;
+
+		ParallelFor(ZERO_SIZE, rows, [&](size_t i)
+		{
+			m_rowPointers[i + 1] = countFunc(i);
+		});
+
+		std::partial_sum(m_rowPointers.begin(), m_rowPointers.end(), m_rowPointers.begin());
+
+		m_nonZeros.resize(m_rowPointers[rows]);
+		m_columnIndices.resize(m_rowPointers[rows]);
+
+		ParallelRefill(fillFunc);
+	}
+
+	template <typename T>
+	template <typename FillFunc>
+	void MatrixCSR<T>::ParallelRefill(const FillFunc& fillFunc)
+	{
+		T* nonZeros = m_nonZeros.data();
+		size_t* columnIndices = m_columnIndices.data();
+
+		ParallelFor(ZERO_SIZE, m_size.x, [&](size_t i)
+		{
+			const size_t offset = m_rowPointers[i];
+			fillFunc(i, nonZeros + offset, columnIndices + offset);
+		});
+	}
+
 	template <typename T>
 	void MatrixCSR<T>::SetElement(size_t i, size_t j, const T& value)
 	{
@@ -606,6 +641,72 @@ namespace CubbyFlow
 		return ret;
 	}
 
+	template <typename T>
+	template <typename VE>
+	void MatrixCSR<T>::MVM(const VectorExpression<T, VE>& v, VectorN<T>* result) const
+	{
+		assert(Cols() == v.size());
+
+		const VE& vec = v();
+		const T* nnz = m_nonZeros.data();
+		const size_t* rp = m_rowPointers.data();
+		const size_t* ci = m_columnIndices.data();
+
+		result->Resize(Rows());
+		T* out = result->data();
+
+		ParallelForEachRowRange([nnz, rp, ci, out, &vec](size_t rowBegin, size_t rowEnd)
+		{
+			for (size_t i = rowBegin; i < rowEnd; ++i)
+			{
+				T sum = 0;
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					sum += nnz[jj] * vec[ci[jj]];
+				}
+
+				out[i] = sum;
+			}
+		});
+	}
+
+	template <typename T>
+	template <typename Callback>
+	void MatrixCSR<T>::ParallelForEachRowRange(const Callback& func) const
+	{
+		const size_t numRows = Rows();
+		if (numRows == 0)
+		{
+			return;
+		}
+
+		// A few ranges per thread to absorb the imbalance left between the ranges
+		const size_t numRanges = std::min(numRows, static_cast<size_t>(4 * GetMaxNumberOfThreads()));
+		const size_t numNonZeros = m_rowPointers[numRows];
+
+		const auto rangeBegin = [&](size_t r)
+		{
+			if (r == numRanges)
+			{
+				return numRows;
+			}
+
+			const size_t target = r * numNonZeros / numRanges;
+			return static_cast<size_t>(std::lower_bound(m_rowPointers.begin(), m_rowPointers.begin() + numRows, target) - m_rowPointers.begin());
+		};
+
+		ParallelFor(ZERO_SIZE, numRanges, [&](size_t r)
+		{
+			const size_t rowBegin = rangeBegin(r);
+			const size_t rowEnd = rangeBegin(r + 1);
+
+			if (rowBegin < rowEnd)
+			{
+				func(rowBegin, rowEnd);
+			}
+		});
+	}
+
 	template <typename T>
 	MatrixCSR<T> MatrixCSR<T>::RAdd(const T& s) const
 	{
@@ -11,6 +11,7 @@
 
 #include <Matrix/MatrixExpression.h>
 #include <Vector/VectorExpression.h>
+#include <Vector/VectorN.h>
 
 namespace CubbyFlow
 {
@@ -221,6 +222,40 @@ namespace CubbyFlow
 		//!
 		void AddRow(const NonZeroContainerType& nonZeros, const IndexContainerType& columnIndices);
 
+		//!
+		//! \brief Builds the matrix row by row in parallel.
+		//!
+		//! The number of non-zeros of each row is counted in parallel, the row
+		//! pointers are computed by the prefix sum and then the rows are filled
+		//! in parallel into the preallocated arrays. The existing storage is
+		//! reused, so rebuilding a matrix of similar size does not reallocate.
+		//!
+		//! \param rows - Number of rows.
+		//! \param cols - Number of columns.
+		//! \param countFunc - Returns the number of non-zeros of the row i, as
+		//!                    size_t(size_t i).
+		//! \param fillFunc - Writes exactly the counted number of non-zeros and
+		//!                   their column indices of the row i in ascending
+		//!                   column order, as
+		//!                   void(size_t i, T* nonZeros, size_t* columnIndices).
+		//!
+		template <typename CountFunc, typename FillFunc>
+		void ParallelBuild(size_t rows, size_t cols, const CountFunc& countFunc, const FillFunc& fillFunc);
+
+		//!
+		//! \brief Refills the rows in parallel, keeping the sparsity pattern.
+		//!
+		//! This function is the fill phase of ParallelBuild without counting,
+		//! so it can be used when the number of non-zeros of each row has not
+		//! changed since the last build.
+		//!
+		//! \param fillFunc - Writes the non-zeros and their column indices of
+		//!                   the row i, as
+		//!                   void(size_t i, T* nonZeros, size_t* columnIndices).
+		//!
+		template <typename FillFunc>
+		void ParallelRefill(const FillFunc& fillFunc);
+
 		//! Sets non-zero element to (i, j).
 		void SetElement(size_t i, size_t j, const T& value);
 
@@ -335,6 +370,28 @@ namespace CubbyFlow
 		//! Returns this matrix / input scalar.
 		MatrixCSR Div(const T& s) const;
 
+		//!
+		//! \brief Computes \p result = this matrix * input vector in parallel.
+		//!
+		//! Unlike Mul, the product is written directly to \p result without
+		//! going through an expression, and the rows are processed by
+		//! ParallelForEachRowRange. \p result is resized to the number of rows
+		//! and should not be the input vector.
+		//!
+		template <typename VE>
+		void MVM(const VectorExpression<T, VE>& v, VectorN<T>* result) const;
+
+		//!
+		//! \brief Invokes the given function in parallel over ranges of rows.
+		//!
+		//! The rows are split into a few ranges per thread, each with about the
+		//! same number of non-zeros rather than the same number of rows, so the
+		//! rows of different lengths are balanced between the threads. The
+		//! function is called as func(rowBegin, rowEnd).
+		//!
+		template <typename Callback>
+		void ParallelForEachRowRange(const Callback& func) const;
+
 		// MARK: Binary operator methods - new instance = input (+) this instance
 		//! Returns input scalar + this matrix.
 		MatrixCSR RAdd(const T& s) const;
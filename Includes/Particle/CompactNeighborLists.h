@@ -0,0 +1,72 @@
+/*************************************************************************
+> File Name: CompactNeighborLists.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Neighbor lists stored in a compressed sparse row layout.
+> Created Time: 2018/01/08
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_COMPACT_NEIGHBOR_LISTS_H
+#define CUBBYFLOW_COMPACT_NEIGHBOR_LISTS_H
+
+#include <Array/Array1.h>
+
+#include <functional>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief Neighbor lists stored in a compressed sparse row layout.
+	//!
+	//! All the neighbor indices are stored in a single flat array. The
+	//! neighbors of the i-th list are Indices()[Starts()[i]] to
+	//! Indices()[Starts()[i + 1] - 1], so iterating the lists does not chase
+	//! per-particle heap allocations.
+	//!
+	class CompactNeighborLists
+	{
+	public:
+		//! Function that returns the number of neighbors of the given list.
+		using CountFunction = std::function<size_t(size_t)>;
+
+		//! Function that writes the neighbors of the given list to the buffer.
+		using FillFunction = std::function<void(size_t, size_t*)>;
+
+		//! Constructs empty neighbor lists.
+		CompactNeighborLists();
+
+		//! Returns the number of lists.
+		size_t size() const;
+
+		//! Returns the total number of neighbors of all the lists.
+		size_t NumberOfNeighbors() const;
+
+		//! Returns the neighbors of the i-th list.
+		ConstArrayAccessor1<size_t> operator[](size_t i) const;
+
+		//! Returns the start offsets of the lists (size() + 1 entries).
+		ConstArrayAccessor1<size_t> Starts() const;
+
+		//! Returns the flat array of neighbor indices.
+		ConstArrayAccessor1<size_t> Indices() const;
+
+		//! Removes all the lists.
+		void Clear();
+
+		//!
+		//! \brief Builds \p numberOfLists lists in parallel.
+		//!
+		//! The lists are built in two passes. The first pass calls \p count for
+		//! each list, the offsets are computed by a prefix sum, and the second
+		//! pass calls \p fill with the storage of each list, which must receive
+		//! exactly as many indices as returned by \p count.
+		//!
+		void Build(size_t numberOfLists, const CountFunction& count, const FillFunction& fill);
+
+	private:
+		Array1<size_t> m_starts;
+		Array1<size_t> m_indices;
+	};
+}
+
+#endif
\ No newline at end of file
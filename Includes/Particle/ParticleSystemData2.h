@@ -10,6 +10,7 @@
 #define CUBBYFLOW_PARTICLE_SYSTEM_DATA2_H
 
 #include <Array/Array1.h>
+#include <Particle/CompactNeighborLists.h>
 #include <Searcher/PointNeighborSearcher2.h>
 #include <Utils/Serialization.h>
 #include <Vector/Vector2.h>
@@ -197,12 +198,13 @@ namespace CubbyFlow
 		//! \brief      Returns neighbor lists.
 		//!
 		//! This function returns neighbor lists which is available after calling
-		//! PointParallelHashGridSearcher2::BuildNeighborLists. Each list stores
-		//! indices of the neighbors.
+		//! ParticleSystemData2::BuildNeighborLists. Each list stores indices of
+		//! the neighbors. All the lists share a single flat array; see
+		//! CompactNeighborLists.
 		//!
 		//! \return     Neighbor lists.
 		//!
-		const std::vector<std::vector<size_t>>& NeighborLists() const;
+		const CompactNeighborLists& NeighborLists() const;
 
 		//! Builds neighbor searcher with given search radius.
 		void BuildNeighborSearcher(double maxSearchRadius);
@@ -243,7 +245,7 @@ namespace CubbyFlow
 		std::vector<VectorData> m_vectorDataList;
 
 		PointNeighborSearcher2Ptr m_neighborSearcher;
-		std::vector<std::vector<size_t>> m_neighborLists;
+		CompactNeighborLists m_neighborLists;
 	};
 
 	//! Shared pointer type of ParticleSystemData2.
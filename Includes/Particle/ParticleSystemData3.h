@@ -10,9 +10,11 @@
 #define CUBBYFLOW_PARTICLE_SYSTEM_DATA3_H
 
 #include <Array/Array1.h>
+#include <Particle/CompactNeighborLists.h>
 #include <Searcher/PointNeighborSearcher3.h>
 #include <Utils/Serialization.h>
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -36,6 +38,8 @@ namespace CubbyFlow
 
 namespace CubbyFlow
 {
+	class PointParallelHashGridSearcher3;
+
 	//!
 	//! \brief      3-D particle system data.
 	//!
@@ -52,6 +56,14 @@ namespace CubbyFlow
 		//! Vector data chunk.
 		using VectorData = Array1<Vector3D>;
 
+		//!
+		//! \brief Callback function type for reordering.
+		//!
+		//! This type of callback function will take the particle system data
+		//! pointer and the new-to-old index map that has been applied.
+		//!
+		using OnReorderCallback = std::function<void(ParticleSystemData3*, const std::vector<size_t>&)>;
+
 		//! Default constructor.
 		ParticleSystemData3();
 
@@ -179,6 +191,50 @@ namespace CubbyFlow
 			const ConstArrayAccessor1<Vector3D>& newVelocities = ConstArrayAccessor1<Vector3D>(),
 			const ConstArrayAccessor1<Vector3D>& newForces = ConstArrayAccessor1<Vector3D>());
 
+		//!
+		//! \brief      Reorders the particles with given new-to-old index map.
+		//!
+		//! This function permutes all the data layers, including positions,
+		//! velocities, forces, and custom scalar and vector data, so that the
+		//! particle at index i is the one that was at index order[i] before the
+		//! call. The reorder callback is invoked afterwards with the same map so
+		//! that per-particle data kept outside of this container can be remapped.
+		//! The neighbor searcher is rebuilt from the reordered positions, so it
+		//! keeps returning the current indices. The neighbor lists are cleared,
+		//! and it is users responsibility to call
+		//! ParticleSystemData3::BuildNeighborLists to refresh them.
+		//!
+		//! \param[in]  order   The new-to-old index map. It should be a
+		//!                     permutation of [0, NumberOfParticles()).
+		//!
+		void Reorder(const std::vector<size_t>& order);
+
+		//!
+		//! \brief      Sorts the particles along the Z-order (Morton) curve.
+		//!
+		//! This function buckets the particles into a grid with given spacing
+		//! over their bounding box and reorders them by the Morton code of the
+		//! bucket, so that particles close in space are also close in memory.
+		//! Neighbor loops then touch far fewer cache lines once the emission
+		//! order has been mixed up by the flow. See
+		//! ParticleSystemData3::Reorder for what is invalidated.
+		//!
+		//! \param[in]  gridSpacing The bucket size. Throws std::invalid_argument
+		//!                         if it is not positive.
+		//!
+		void SortParticles(double gridSpacing);
+
+		//!
+		//! \brief      Sets the callback function to be called when the particles
+		//!             are reordered.
+		//!
+		//! Use this callback to remap any per-particle data that is indexed by
+		//! the particle index but not stored as a data layer of this container.
+		//!
+		//! \param[in]  callback The callback function.
+		//!
+		void SetOnReorderCallback(const OnReorderCallback& callback);
+
 		//!
 		//! \brief      Returns neighbor searcher.
 		//!
@@ -189,24 +245,39 @@ namespace CubbyFlow
 		//!
 		const PointNeighborSearcher3Ptr& GetNeighborSearcher() const;
 
-		//! Sets neighbor searcher.
+		//! Sets neighbor searcher. The neighbor lists are invalidated.
 		void SetNeighborSearcher(const PointNeighborSearcher3Ptr& newNeighborSearcher);
 
 		//!
 		//! \brief      Returns neighbor lists.
 		//!
 		//! This function returns neighbor lists which is available after calling
-		//! PointParallelHashGridSearcher3::BuildNeighborLists. Each list stores
-		//! indices of the neighbors.
+		//! ParticleSystemData3::BuildNeighborLists. Each list stores indices of
+		//! the neighbors. All the lists share a single flat array; see
+		//! CompactNeighborLists.
 		//!
 		//! \return     Neighbor lists.
 		//!
-		const std::vector<std::vector<size_t>>& NeighborLists() const;
+		const CompactNeighborLists& NeighborLists() const;
 
-		//! Builds neighbor searcher with given search radius.
+		//!
+		//! \brief      Returns true if the neighbor lists are built for the
+		//!             current particles.
+		//!
+		//! ParticleSystemData3::BuildNeighborLists sets this flag. Resizing,
+		//! reordering and rebuilding the neighbor searcher clear it.
+		//!
+		bool HasNeighborLists() const;
+
+		//!
+		//! \brief      Builds neighbor searcher with given search radius.
+		//!
+		//! The neighbor lists are cleared since they no longer match the
+		//! searcher.
+		//!
 		void BuildNeighborSearcher(double maxSearchRadius);
 
-		//! Builds neighbor lists with given search radius.
+		//! Builds neighbor lists with given search radius in parallel.
 		void BuildNeighborLists(double maxSearchRadius);
 
 		//! Serializes this particle system data to the buffer.
@@ -222,6 +293,13 @@ namespace CubbyFlow
 		ParticleSystemData3& operator=(const ParticleSystemData3& other);
 
 	protected:
+		//! Returns the neighbor searcher if it is a PointParallelHashGridSearcher3,
+		//! or nullptr otherwise.
+		const PointParallelHashGridSearcher3* GetParallelHashGridSearcher() const;
+
+		//! Clears the neighbor lists and marks them as not built.
+		void InvalidateNeighborLists();
+
 		void SerializeParticleSystemData(
 			flatbuffers::FlatBufferBuilder* builder,
 			flatbuffers::Offset<fbs::ParticleSystemData3>* fbsParticleSystemData)
@@ -242,7 +320,11 @@ namespace CubbyFlow
 		std::vector<VectorData> m_vectorDataList;
 
 		PointNeighborSearcher3Ptr m_neighborSearcher;
-		std::vector<std::vector<size_t>> m_neighborLists;
+		const PointParallelHashGridSearcher3* m_parallelHashGridSearcher = nullptr;
+		CompactNeighborLists m_neighborLists;
+		bool m_hasNeighborLists = false;
+
+		OnReorderCallback m_onReorderCallback;
 	};
 
 	//! Shared pointer type of ParticleSystemData3.
@@ -0,0 +1,51 @@
+/*************************************************************************
+> File Name: SPHSystemData3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D SPH particle system data.
+> Created Time: 2018/01/24
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_SPH_SYSTEM_DATA3_IMPL_H
+#define CUBBYFLOW_SPH_SYSTEM_DATA3_IMPL_H
+
+#include <Searcher/PointParallelHashGridSearcher3.h>
+
+namespace CubbyFlow
+{
+	template <typename Callback>
+	void SPHSystemData3::ForEachNeighbor(size_t i, const Callback& callback) const
+	{
+		if (HasNeighborLists())
+		{
+			for (size_t j : NeighborLists()[i])
+			{
+				callback(j);
+			}
+
+			return;
+		}
+
+		const auto visit = [&](size_t j, const Vector3D&)
+		{
+			if (j != i)
+			{
+				callback(j);
+			}
+		};
+
+		const Vector3D origin = GetPositions()[i];
+		const PointParallelHashGridSearcher3* searcher = GetParallelHashGridSearcher();
+
+		if (searcher != nullptr)
+		{
+			searcher->ForEachNearbyPointInline(origin, m_kernelRadius, visit);
+		}
+		else
+		{
+			GetNeighborSearcher()->ForEachNearbyPoint(origin, m_kernelRadius, visit);
+		}
+	}
+}
+
+#endif
\ No newline at end of file
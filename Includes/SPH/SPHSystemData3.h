@@ -64,7 +64,13 @@ namespace CubbyFlow
 		//! Returns the pressure array accessor (mutable).
 		ArrayAccessor1<double> GetPressures();
 
-		//! Updates the density array with the latest particle positions.
+		//!
+		//! \brief Updates the density array with the latest particle positions.
+		//!
+		//! The neighbors are visited by SPHSystemData3::ForEachNeighbor, so the
+		//! neighbor lists are used if they are built for the current particles.
+		//! Otherwise, the neighbor searcher is queried.
+		//!
 		void UpdateDensities();
 
 		//! Sets the target density of this particle system.
@@ -77,7 +83,8 @@ namespace CubbyFlow
 		//! \brief Sets the target particle spacing in meters.
 		//!
 		//! Once this function is called, hash grid and density should be
-		//! updated using UpdateHashGrid() and UpdateDensities).
+		//! updated using UpdateHashGrid() and UpdateDensities). The neighbor
+		//! lists are cleared.
 		//!
 		void SetTargetSpacing(double spacing);
 
@@ -90,7 +97,8 @@ namespace CubbyFlow
 		//! Sets the relative kernel radius compared to the target particle
 		//! spacing (i.e. kernel radius / target spacing).
 		//! Once this function is called, hash grid and density should
-		//! be updated using UpdateHashGrid() and UpdateDensities).
+		//! be updated using UpdateHashGrid() and UpdateDensities). The neighbor
+		//! lists are cleared.
 		//!
 		void SetRelativeKernelRadius(double relativeRadius);
 
@@ -108,7 +116,8 @@ namespace CubbyFlow
 		//! Sets the absolute kernel radius compared to the target particle
 		//! spacing (i.e. relative kernel radius * target spacing).
 		//! Once this function is called, hash grid and density should
-		//! be updated using UpdateHashGrid() and UpdateDensities).
+		//! be updated using UpdateHashGrid() and UpdateDensities). The neighbor
+		//! lists are cleared.
 		//!
 		void SetKernelRadius(double kernelRadius);
 
@@ -147,6 +156,25 @@ namespace CubbyFlow
 		//! Returns the Laplacian of the given values at i-th particle.
 		Vector3D LaplacianAt(size_t i, const ConstArrayAccessor1<Vector3D>& values) const;
 
+		//!
+		//! \brief Invokes the callback for each neighbor of the i-th particle.
+		//!
+		//! The neighbor lists are used if they are built for the current
+		//! particles (see ParticleSystemData3::HasNeighborLists). Otherwise, the
+		//! buckets of the neighbor searcher are walked
+		//! around the current position of the particle, so the neighbors can be
+		//! iterated without storing any per-particle list. Both give the same
+		//! neighbors until the positions change. The particle itself is not
+		//! visited.
+		//!
+		//! \param[in]  i        The particle index.
+		//! \param[in]  callback The callback function taking the neighbor index.
+		//!
+		//! \tparam     Callback The callback function type.
+		//!
+		template <typename Callback>
+		void ForEachNeighbor(size_t i, const Callback& callback) const;
+
 		//! Builds neighbor searcher with kernel radius.
 		void BuildNeighborSearcher();
 
@@ -191,4 +219,6 @@ namespace CubbyFlow
 	using SPHSystemData3Ptr = std::shared_ptr<SPHSystemData3>;
 }
 
+#include <SPH/SPHSystemData3-Impl.h>
+
 #endif
\ No newline at end of file
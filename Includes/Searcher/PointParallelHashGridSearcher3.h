@@ -76,6 +76,26 @@ namespace CubbyFlow
 		//!
 		void ForEachNearbyPoint(const Vector3D& origin, double radius, const ForEachNearbyPointFunc& callback) const override;
 
+		//!
+		//! \brief      Invokes the callback function for each nearby point around
+		//!             the origin within given radius.
+		//!
+		//! This function is the same as ForEachNearbyPoint, but takes the
+		//! callback as a template parameter so that it can be inlined. It walks
+		//! the sorted point ranges of the eight buckets around the origin, which
+		//! lets the callers iterate neighbors without materializing per-point
+		//! neighbor lists.
+		//!
+		//! \param[in]  origin   The origin position.
+		//! \param[in]  radius   The search radius.
+		//! \param[in]  callback The callback function taking the point index and
+		//!                      the point position.
+		//!
+		//! \tparam     Callback The callback function type.
+		//!
+		template <typename Callback>
+		void ForEachNearbyPointInline(const Vector3D& origin, double radius, const Callback& callback) const;
+
 		//!
 		//! Returns true if there are any nearby points for given origin within
 		//! radius.
@@ -244,4 +264,6 @@ namespace CubbyFlow
 	};
 }
 
+#include <Searcher/PointParallelHashGridSearcher3-Impl.h>
+
 #endif
\ No newline at end of file
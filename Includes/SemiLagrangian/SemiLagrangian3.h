@@ -23,6 +23,10 @@ namespace CubbyFlow
 	//! To extend the class using higher-order spatial interpolation, the inheriting
 	//! classes can override SemiLagrangian2::getScalarSamplerFunc and
 	//! SemiLagrangian2::getVectorSamplerFunc. See CubicSemiLagrangian2 for example.
+	//! If the returned function object holds one of the linear or cubic samplers
+	//! of the grids, the advection calls the sampler directly instead of going
+	//! through the function object. The same applies to the flow field when it
+	//! is a face-centered or collocated vector grid.
 	//!
 	class SemiLagrangian3 : public AdvectionSolver3
 	{
@@ -56,6 +60,29 @@ namespace CubbyFlow
 			ScalarGrid3* output,
 			const ScalarField3& boundarySDF = ConstantScalarField3(std::numeric_limits<double>::max())) final;
 
+		//!
+		//! \brief Computes semi-Lagrangian for the points of given narrow band.
+		//!
+		//! The back-traced values are computed into a buffer before being
+		//! written, so \p input and \p output may be the same grid. The points
+		//! outside of \p band are left untouched.
+		//!
+		//! \param input Input scalar grid.
+		//! \param flow Vector field that advects the input field.
+		//! \param dt Time-step for the advection.
+		//! \param band Narrow band of the data points to advect.
+		//! \param output Output scalar grid.
+		//! \param boundarySDF Boundary interface defined by signed-distance
+		//!     field.
+		//!
+		void AdvectNarrowBand(
+			const ScalarGrid3& input,
+			const VectorField3& flow,
+			double dt,
+			const NarrowBand3& band,
+			ScalarGrid3* output,
+			const ScalarField3& boundarySDF = ConstantScalarField3(std::numeric_limits<double>::max())) final;
+
 		//!
 		//! \brief Computes semi-Lagrangian for given collocated vector grid.
 		//!
@@ -141,8 +168,9 @@ namespace CubbyFlow
 		virtual std::function<Vector3D(const Vector3D&)> GetVectorSamplerFunc(const FaceCenteredGrid3& input) const;
 
 	private:
+		template <typename FlowSampler>
 		Vector3D BackTrace(
-			const VectorField3& flow,
+			const FlowSampler& flow,
 			double dt,
 			double h,
 			const Vector3D& pt0,
@@ -14,6 +14,7 @@
 #include <Grid/CollocatedVectorGrid3.h>
 #include <Grid/FaceCenteredGrid3.h>
 #include <Grid/ScalarGrid3.h>
+#include <LevelSet/NarrowBand3.h>
 
 namespace CubbyFlow
 {
@@ -56,6 +57,31 @@ namespace CubbyFlow
 			ScalarGrid3* output,
 			const ScalarField3& boundarySDF = ConstantScalarField3(std::numeric_limits<double>::max())) = 0;
 
+		//!
+		//! \brief Solves advection equation for the points of given narrow band.
+		//!
+		//! This function solves the same equation as the scalar grid version of
+		//! Advect, but only for the data points in \p band. The points outside of
+		//! the band are left untouched, and \p input and \p output may be the
+		//! same grid. By default, this function clones the input and advects the
+		//! whole grid.
+		//!
+		//! \param input Input scalar grid.
+		//! \param flow Vector field that advects the input field.
+		//! \param dt Time-step for the advection.
+		//! \param band Narrow band of the data points to advect.
+		//! \param output Output scalar grid.
+		//! \param boundarySDF Boundary interface defined by signed-distance
+		//!     field.
+		//!
+		virtual void AdvectNarrowBand(
+			const ScalarGrid3& input,
+			const VectorField3& flow,
+			double dt,
+			const NarrowBand3& band,
+			ScalarGrid3* output,
+			const ScalarField3& boundarySDF = ConstantScalarField3(std::numeric_limits<double>::max()));
+
 		//!
 		//! \brief Solves advection equation for given collocated vector grid.
 		//!
@@ -0,0 +1,127 @@
+/*************************************************************************
+> File Name: DFSPHSolver2.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 2-D DFSPH solver.
+> Created Time: 2018/01/22
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_DFSPH_SOLVER2_H
+#define CUBBYFLOW_DFSPH_SOLVER2_H
+
+#include <Solver/SPH/SPHSolver2.h>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief 2-D divergence-free SPH solver.
+	//!
+	//! This class implements 2-D divergence-free SPH solver. Two pressure solvers
+	//! run in each time-step: the divergence solver makes the velocity field
+	//! divergence-free at the beginning of the step, and the density solver
+	//! corrects the predicted velocities so that the advected particles keep the
+	//! target density. Both solvers share the per-particle factor that only
+	//! depends on the neighborhood, so each iteration is a single sweep over the
+	//! neighbor lists. Since the fluid is kept incompressible regardless of the
+	//! speed of sound, the time-step is limited by the CFL condition only.
+	//!
+	//! \see Bender and Koschier, Divergence-free smoothed particle hydrodynamics,
+	//!      SCA 2015.
+	//!
+	class DFSPHSolver2 : public SPHSolver2
+	{
+	public:
+		class Builder;
+
+		//! Constructs a solver with empty particle set.
+		DFSPHSolver2();
+
+		//! Constructs a solver with target density, spacing, and relative kernel radius.
+		DFSPHSolver2(double targetDensity, double targetSpacing, double relativeKernelRadius);
+
+		virtual ~DFSPHSolver2();
+
+		//! Returns max allowed density error ratio.
+		double GetMaxDensityErrorRatio() const;
+
+		//!
+		//! \brief Sets max allowed density error ratio.
+		//!
+		//! This function sets the max allowed density error ratio of the density
+		//! solver. Default is 0.01 (1%). The input value should be positive.
+		//!
+		void SetMaxDensityErrorRatio(double ratio);
+
+		//! Returns max allowed divergence error ratio.
+		double GetMaxDivergenceErrorRatio() const;
+
+		//!
+		//! \brief Sets max allowed divergence error ratio.
+		//!
+		//! This function sets the max allowed density change ratio per time-step
+		//! of the divergence solver. Default is 0.01 (1%). The input value should
+		//! be positive.
+		//!
+		void SetMaxDivergenceErrorRatio(double ratio);
+
+		//! Returns max number of iterations.
+		unsigned int GetMaxNumberOfIterations() const;
+
+		//!
+		//! \brief Sets max number of iterations.
+		//!
+		//! This function sets the max number of iterations of both the density
+		//! and the divergence solvers. Default is 100.
+		//!
+		void SetMaxNumberOfIterations(unsigned int n);
+
+		//! Returns builder fox DFSPHSolver2.
+		static Builder GetBuilder();
+
+	protected:
+		//! Returns the number of sub-time-steps from the CFL condition.
+		unsigned int NumberOfSubTimeSteps(double timeIntervalInSeconds) const override;
+
+		//! Accumulates the pressure force to the forces array in the particle system.
+		void AccumulatePressureForce(double timeIntervalInSeconds) override;
+
+		//! Performs pre-processing step before the simulation.
+		void OnBeginAdvanceTimeStep(double timeStepInSeconds) override;
+
+	private:
+		double m_maxDensityErrorRatio = 0.01;
+		double m_maxDivergenceErrorRatio = 0.01;
+		unsigned int m_maxNumberOfIterations = 100;
+
+		ParticleSystemData2::ScalarData m_factors;
+		ParticleSystemData2::ScalarData m_stiffnesses;
+		ParticleSystemData2::VectorData m_tempPositions;
+		ParticleSystemData2::VectorData m_tempVelocities;
+
+		void ComputeFactors();
+
+		double ComputeDensityError(const ConstArrayAccessor1<Vector2D>& velocities, double timeStepInSeconds);
+
+		double ComputeDivergenceError(const ConstArrayAccessor1<Vector2D>& velocities, double timeStepInSeconds);
+
+		void ApplyStiffness(ArrayAccessor1<Vector2D> velocities, double timeStepInSeconds);
+	};
+
+	//! Shared pointer type for the DFSPHSolver2.
+	using DFSPHSolver2Ptr = std::shared_ptr<DFSPHSolver2>;
+
+	//!
+	//! \brief Front-end to create DFSPHSolver2 objects step by step.
+	//!
+	class DFSPHSolver2::Builder final : public SPHSolverBuilderBase2<DFSPHSolver2::Builder>
+	{
+	public:
+		//! Builds DFSPHSolver2.
+		DFSPHSolver2 Build() const;
+
+		//! Builds shared pointer of DFSPHSolver2 instance.
+		DFSPHSolver2Ptr MakeShared() const;
+	};
+}
+
+#endif
\ No newline at end of file
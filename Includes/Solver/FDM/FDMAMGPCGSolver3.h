@@ -0,0 +1,147 @@
+/*************************************************************************
+> File Name: FDMAMGPCGSolver3.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D finite difference-type linear system solver using algebraic
+>          multigrid preconditioned conjugate gradient (AMGPCG).
+> Created Time: 2018/01/26
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_FDM_AMGPCG_SOLVER3_H
+#define CUBBYFLOW_FDM_AMGPCG_SOLVER3_H
+
+#include <Solver/FDM/FDMLinearSystemSolver3.h>
+
+#include <vector>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief 3-D finite difference-type linear system solver using algebraic
+	//!        multigrid preconditioned conjugate gradient (AMGPCG).
+	//!
+	//! Unlike FDMMGPCGSolver3, the multigrid hierarchy is built from the matrix
+	//! itself, so the solver works on the compressed system (MatrixCSRD) of
+	//! irregular fluid regions. The hierarchy uses smoothed aggregation: the
+	//! unknowns are grouped into aggregates of strongly coupled neighbors, the
+	//! piecewise constant prolongation is smoothed with one damped Jacobi step
+	//! and the coarse matrices are the Galerkin products R A P with R = P^T.
+	//! The preconditioner is one V-cycle with damped Jacobi smoothing and a
+	//! dense solve on the coarsest level. Everything but the aggregation runs
+	//! in parallel. The uncompressed system is converted to the compressed
+	//! form before solving.
+	//!
+	//! \see Vanek, Petr, Jan Mandel, and Marian Brezina. "Algebraic multigrid by
+	//!      smoothed aggregation for second and fourth order elliptic
+	//!      problems." Computing 56.3 (1996): 179-196.
+	//!
+	class FDMAMGPCGSolver3 final : public FDMLinearSystemSolver3
+	{
+	public:
+		//!
+		//! Constructs the solver with given parameters.
+		//!
+		//! \param maxNumberOfIterations - Number of max CG iterations.
+		//! \param tolerance - Max residual tolerance.
+		//! \param maxNumberOfLevels - Number of maximum AMG levels.
+		//! \param numberOfSmoothingIter - Number of pre- and post-smoothing iterations.
+		//! \param strengthThreshold - Threshold of the strong connections on the
+		//!                            finest level, halved on each coarser level.
+		//! \param maxCoarsestSize - Max number of unknowns at the coarsest level.
+		//!
+		FDMAMGPCGSolver3(
+			unsigned int maxNumberOfIterations,
+			double tolerance,
+			size_t maxNumberOfLevels = 20,
+			unsigned int numberOfSmoothingIter = 2,
+			double strengthThreshold = 0.08,
+			size_t maxCoarsestSize = 256);
+
+		//! Solves the given linear system.
+		bool Solve(FDMLinearSystem3* system) override;
+
+		//! Solves the given compressed linear system.
+		bool SolveCompressed(FDMCompressedLinearSystem3* system) override;
+
+		//! Returns the max number of CG iterations.
+		unsigned int GetMaxNumberOfIterations() const;
+
+		//! Returns the last number of CG iterations the solver made.
+		unsigned int GetLastNumberOfIterations() const override;
+
+		//! Returns the max residual tolerance for the CG method.
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the CG method.
+		void SetTolerance(double tolerance) override;
+
+		//! Returns the last residual after the CG iterations.
+		double GetLastResidual() const override;
+
+		//! Returns the number of levels of the last AMG hierarchy.
+		size_t GetNumberOfLevels() const;
+
+	private:
+		struct Level final
+		{
+			const MatrixCSRD* A = nullptr;
+
+			// Galerkin product of the coarse levels (A points to it)
+			MatrixCSRD coarseA;
+
+			// Prolongation from the next coarser level and its transpose
+			MatrixCSRD P;
+			MatrixCSRD R;
+
+			// Damped inverse of the diagonal
+			VectorND invDiag;
+
+			VectorND x;
+			VectorND b;
+			VectorND r;
+		};
+
+		struct Preconditioner final
+		{
+			std::vector<Level> levels;
+			unsigned int numberOfSmoothingIter;
+
+			// Dense factorization of the coarsest matrix
+			std::vector<double> coarsestL;
+			std::vector<char> coarsestPivots;
+
+			void Build(const MatrixCSRD& matrix, size_t maxNumberOfLevels,
+				double strengthThreshold, size_t maxCoarsestSize);
+
+			void Solve(const VectorND& b, VectorND* x);
+
+			void VCycle(size_t l);
+
+			void FactorizeCoarsest();
+
+			void SolveCoarsest();
+		};
+
+		unsigned int m_maxNumberOfIterations;
+		unsigned int m_lastNumberOfIterations;
+		double m_tolerance;
+		double m_lastResidualNorm;
+		size_t m_maxNumberOfLevels;
+		double m_strengthThreshold;
+		size_t m_maxCoarsestSize;
+
+		VectorND m_r;
+		VectorND m_d;
+		VectorND m_q;
+		VectorND m_s;
+		Preconditioner m_precond;
+
+		// Compressed copy of the uncompressed system
+		FDMCompressedLinearSystem3 m_compSystem;
+	};
+
+	//! Shared pointer type for the FDMAMGPCGSolver3.
+	using FDMAMGPCGSolver3Ptr = std::shared_ptr<FDMAMGPCGSolver3>;
+}
+
+#endif
\ No newline at end of file
@@ -9,6 +9,7 @@
 #ifndef CUBBYFLOW_FDM_CG_SOLVER3_H
 #define CUBBYFLOW_FDM_CG_SOLVER3_H
 
+#include <Math/CG.h>
 #include <Solver/FDM/FDMLinearSystemSolver3.h>
 
 namespace CubbyFlow
@@ -26,23 +27,44 @@ namespace CubbyFlow
         //! Solves the given compressed linear system.
         bool SolveCompressed(FDMCompressedLinearSystem3* system) override;
 
+		//! Solves the given matrix-free linear system.
+		bool SolveMatrixFree(FDMMatrixFreeLinearSystem3* system) override;
+
 		//! Returns the max number of Jacobi iterations.
 		unsigned int GetMaxNumberOfIterations() const;
 
 		//! Returns the last number of Jacobi iterations the solver made.
-		unsigned int GetLastNumberOfIterations() const;
+		unsigned int GetLastNumberOfIterations() const override;
 
 		//! Returns the max residual tolerance for the Jacobi method.
-		double GetTolerance() const;
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the Jacobi method.
+		void SetTolerance(double tolerance) override;
 
 		//! Returns the last residual after the Jacobi iterations.
-		double GetLastResidual() const;
+		double GetLastResidual() const override;
+
+		//! Returns the CG variant of the uncompressed solve.
+		CGMethod GetCGMethod() const;
+
+		//!
+		//! \brief Sets the CG variant of the uncompressed solve.
+		//!
+		//! CGMethod::Fused fuses the vector updates with the dot products that
+		//! follow them, which cuts the memory passes per iteration from seven
+		//! to three. CGMethod::Pipelined needs a single reduction per iteration
+		//! but keeps six more vectors. The compressed and the matrix-free solves
+		//! always use CGMethod::Standard.
+		//!
+		void SetCGMethod(CGMethod method);
 
 	private:
 		unsigned int m_maxNumberOfIterations;
 		unsigned int m_lastNumberOfIterations;
 		double m_tolerance;
 		double m_lastResidual;
+		CGMethod m_cgMethod = CGMethod::Standard;
 
         // Uncompressed vectors
         FDMVector3 m_r;
@@ -50,6 +72,14 @@ namespace CubbyFlow
         FDMVector3 m_q;
         FDMVector3 m_s;
 
+        // Pipelined vectors
+        FDMVector3 m_u;
+        FDMVector3 m_w;
+        FDMVector3 m_m;
+        FDMVector3 m_n;
+        FDMVector3 m_z;
+        FDMVector3 m_p;
+
         // Compressed vectors
         VectorND m_rComp;
         VectorND m_dComp;
@@ -58,6 +88,7 @@ namespace CubbyFlow
 
         void ClearUncompressedVectors();
         void ClearCompressedVectors();
+        void ClearPipelinedVectors();
 	};
 
 	//! Shared pointer type for the FDMCGSolver3.
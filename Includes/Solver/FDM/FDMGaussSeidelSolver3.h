@@ -35,13 +35,16 @@ namespace CubbyFlow
 		unsigned int GetMaxNumberOfIterations() const;
 
 		//! Returns the last number of Gauss-Seidel iterations the solver made.
-		unsigned int GetLastNumberOfIterations() const;
+		unsigned int GetLastNumberOfIterations() const override;
 
 		//! Returns the max residual tolerance for the Gauss-Seidel method.
-		double GetTolerance() const;
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the Gauss-Seidel method.
+		void SetTolerance(double tolerance) override;
 
 		//! Returns the last residual after the Gauss-Seidel iterations.
-		double GetLastResidual() const;
+		double GetLastResidual() const override;
 
 		//! Returns the SOR (Successive Over Relaxation) factor.
 		double GetSORFactor() const;
@@ -55,9 +58,15 @@ namespace CubbyFlow
         //! Performs single natural Gauss-Seidel relaxation step for compressed sys.
         static void Relax(const MatrixCSRD& A, const VectorND& b, double sorFactor, VectorND* x);
 
+		//! Performs single natural Gauss-Seidel relaxation step for matrix-free sys.
+		static void Relax(const FDMMatrixFree3& A, const FDMVector3& b, double sorFactor, FDMVector3* x);
+
 		//! Performs single Red-Black Gauss-Seidel relaxation step.
 		static void RelaxRedBlack(const FDMMatrix3& A, const FDMVector3& b, double sorFactor, FDMVector3* x);
 
+		//! Performs single Red-Black Gauss-Seidel relaxation step for matrix-free sys.
+		static void RelaxRedBlack(const FDMMatrixFree3& A, const FDMVector3& b, double sorFactor, FDMVector3* x);
+
 	private:
 		unsigned int m_maxNumberOfIterations;
 		unsigned int m_lastNumberOfIterations;
@@ -34,24 +34,64 @@ namespace CubbyFlow
 		unsigned int GetMaxNumberOfIterations() const;
 
 		//! Returns the last number of Jacobi iterations the solver made.
-		unsigned int GetLastNumberOfIterations() const;
+		unsigned int GetLastNumberOfIterations() const override;
 
 		//! Returns the max residual tolerance for the Jacobi method.
-		double GetTolerance() const;
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the Jacobi method.
+		void SetTolerance(double tolerance) override;
 
 		//! Returns the last residual after the Jacobi iterations.
-		double GetLastResidual() const;
+		double GetLastResidual() const override;
+
+		//! Returns true if the uncompressed solve uses single-precision vectors.
+		bool GetUseSinglePrecision() const;
+
+		//!
+		//! \brief Sets whether the uncompressed solve uses single-precision
+		//!        vectors.
+		//!
+		//! When enabled, the CG work vectors and the preconditioner are stored in
+		//! float (see FDMBLAS3F) and the solve runs as an iterative refinement:
+		//! the residual of the double-precision system is evaluated in double,
+		//! a float PCG solves for the correction to a relative tolerance, and
+		//! the correction is added to the double-precision solution. The
+		//! passes repeat until the residual meets the tolerance of the solver,
+		//! so the result is as accurate as the double-precision solve. The
+		//! matrix, the solution and the right-hand side stay in double.
+		//!
+		void SetUseSinglePrecision(bool useSinglePrecision);
+
+		//! Returns true if the multicolor preconditioner is used.
+		bool GetUseMulticolorPreconditioner() const;
+
+		//!
+		//! \brief Sets whether the solver uses the multicolor incomplete
+		//!        Cholesky preconditioner.
+		//!
+		//! The default preconditioner factorizes and substitutes in the natural
+		//! k/j/i order, which is inherently serial. The multicolor preconditioner
+		//! reorders the unknowns so that no two coupled units share a color; the
+		//! colors are processed one after another while the units of a color are
+		//! processed in parallel. The uncompressed system colors the x-lines by
+		//! the parities of j and k (four colors) and substitutes along each line
+		//! in order. The compressed system uses a greedy coloring of the matrix
+		//! graph. The reordering usually costs a few more iterations.
+		//!
+		void SetUseMulticolorPreconditioner(bool useMulticolorPreconditioner);
 
 	private:
+		template <typename T>
 		struct Preconditioner final
 		{
 			ConstArrayAccessor3<FDMMatrixRow3> A;
-			FDMVector3 d;
-			FDMVector3 y;
+			Array3<T> d;
+			Array3<T> y;
 
 			void Build(const FDMMatrix3& matrix);
 
-			void Solve(const FDMVector3& b, FDMVector3* x);
+			void Solve(const Array3<T>& b, Array3<T>* x);
 		};
 
         struct PreconditionerCompressed final
@@ -65,17 +105,58 @@ namespace CubbyFlow
             void Solve(const VectorND& b, VectorND* x);
         };
 
+		template <typename T>
+		struct MulticolorPreconditioner final
+		{
+			ConstArrayAccessor3<FDMMatrixRow3> A;
+			Array3<T> d;
+			Array3<T> y;
+
+			void Build(const FDMMatrix3& matrix);
+
+			void Solve(const Array3<T>& b, Array3<T>* x);
+
+			template <typename Callback>
+			void ParallelForEachLineOfColor(size_t color, Callback func) const;
+		};
+
+		struct MulticolorPreconditionerCompressed final
+		{
+			const MatrixCSRD* A;
+			VectorND d;
+			VectorND y;
+			std::vector<size_t> colors;
+			std::vector<std::vector<size_t>> rowsOfColor;
+
+			void Build(const MatrixCSRD& matrix);
+
+			void Solve(const VectorND& b, VectorND* x);
+		};
+
 		unsigned int m_maxNumberOfIterations;
 		unsigned int m_lastNumberOfIterations;
 		double m_tolerance;
 		double m_lastResidualNorm;
+		bool m_useSinglePrecision = false;
+		bool m_useMulticolorPreconditioner = false;
 
         // Uncompressed vectors and preconditioner
         FDMVector3 m_r;
         FDMVector3 m_d;
         FDMVector3 m_q;
         FDMVector3 m_s;
-        Preconditioner m_precond;
+        Preconditioner<double> m_precond;
+        MulticolorPreconditioner<double> m_mcPrecond;
+
+        FDMVector3F m_eF;
+        FDMVector3F m_bF;
+        FDMVector3F m_rF;
+        FDMVector3F m_dF;
+        FDMVector3F m_qF;
+        FDMVector3F m_sF;
+        Preconditioner<float> m_precondF;
+        MulticolorPreconditioner<float> m_mcPrecondF;
+        std::vector<double> m_correctionResidualHistory;
 
         // Compressed vectors and preconditioner
         VectorND m_rComp;
@@ -83,8 +164,15 @@ namespace CubbyFlow
         VectorND m_qComp;
         VectorND m_sComp;
         PreconditionerCompressed m_precondComp;
+        MulticolorPreconditionerCompressed m_mcPrecondComp;
+
+        bool SolveSinglePrecision(FDMLinearSystem3* system);
+
+        template <typename PrecondType>
+        void SolveWithSinglePrecisionCorrections(FDMLinearSystem3* system, PrecondType* precond);
 
         void ClearUncompressedVectors();
+        void ClearSinglePrecisionVectors();
         void ClearCompressedVectors();
 	};
 
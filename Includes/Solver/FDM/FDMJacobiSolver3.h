@@ -33,13 +33,16 @@ namespace CubbyFlow
 		unsigned int GetMaxNumberOfIterations() const;
 
 		//! Returns the last number of Jacobi iterations the solver made.
-		unsigned int GetLastNumberOfIterations() const;
+		unsigned int GetLastNumberOfIterations() const override;
 
 		//! Returns the max residual tolerance for the Jacobi method.
-		double GetTolerance() const;
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the Jacobi method.
+		void SetTolerance(double tolerance) override;
 
 		//! Returns the last residual after the Jacobi iterations.
-		double GetLastResidual() const;
+		double GetLastResidual() const override;
 
 		//! Performs single Jacobi relaxation step.
 		static void Relax(const FDMMatrix3& A, const FDMVector3& b, FDMVector3* x, FDMVector3* xTemp);
@@ -11,6 +11,8 @@
 
 #include <FDM/FDMLinearSystem3.h>
 
+#include <vector>
+
 namespace CubbyFlow
 {
 	//! Abstract base class for 3-D finite difference-type linear system solver.
@@ -27,6 +29,72 @@ namespace CubbyFlow
         {
             return false;
         }
+
+		//! Solves the given matrix-free linear system.
+		virtual bool SolveMatrixFree(FDMMatrixFreeLinearSystem3*)
+		{
+			return false;
+		}
+
+		//! Returns the last number of iterations the solver made.
+		virtual unsigned int GetLastNumberOfIterations() const
+		{
+			return 0;
+		}
+
+		//! Returns the last residual after the iterations.
+		virtual double GetLastResidual() const
+		{
+			return 0.0;
+		}
+
+		//!
+		//! \brief Returns the residual norms of the last solve.
+		//!
+		//! The first entry is the residual before the first iteration and each
+		//! following entry is the residual after an iteration. Empty for the
+		//! solvers that do not record it.
+		//!
+		const std::vector<double>& GetLastResidualHistory() const
+		{
+			return m_lastResidualHistory;
+		}
+
+		//! Returns the max residual tolerance.
+		virtual double GetTolerance() const
+		{
+			return 0.0;
+		}
+
+		//! Sets the max residual tolerance.
+		virtual void SetTolerance(double)
+		{
+			// Do nothing
+		}
+
+		//! Returns true if the solver starts from the given solution vector.
+		bool GetUseInitialGuess() const
+		{
+			return m_useInitialGuess;
+		}
+
+		//!
+		//! \brief Sets whether the solver starts from the given solution vector.
+		//!
+		//! By default, the Krylov solvers clear the solution vector and start
+		//! from zero. When enabled, the solution vector of the system is used as
+		//! the initial guess, which saves iterations when a good estimate (such
+		//! as the pressure of the previous time step) is known. The relaxation
+		//! solvers always start from the given solution vector.
+		//!
+		void SetUseInitialGuess(bool useInitialGuess)
+		{
+			m_useInitialGuess = useInitialGuess;
+		}
+
+	protected:
+		bool m_useInitialGuess = false;
+		std::vector<double> m_lastResidualHistory;
 	};
 
 	//! Shared pointer type for the FDMLinearSystemSolver3.
@@ -10,6 +10,7 @@
 #ifndef CUBBYFLOW_FDM_MGPCG_SOLVER3_H
 #define CUBBYFLOW_FDM_MGPCG_SOLVER3_H
 
+#include <Math/CG.h>
 #include <Solver/FDM/FDMMGSolver3.h>
 
 namespace CubbyFlow
@@ -50,17 +51,38 @@ namespace CubbyFlow
 		//! Solves the given linear system.
 		bool Solve(FDMMGLinearSystem3* system) override;
 
+		//! Solves the given matrix-free linear system.
+		bool SolveMatrixFree(FDMMGMatrixFreeLinearSystem3* system) override;
+
 		//! Returns the max number of Jacobi iterations.
 		unsigned int GetMaxNumberOfIterations() const;
 
 		//! Returns the last number of Jacobi iterations the solver made.
-		unsigned int GetLastNumberOfIterations() const;
+		unsigned int GetLastNumberOfIterations() const override;
 
 		//! Returns the max residual tolerance for the Jacobi method.
-		double GetTolerance() const;
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance for the Jacobi method.
+		void SetTolerance(double tolerance) override;
 
 		//! Returns the last residual after the Jacobi iterations.
-		double GetLastResidual() const;
+		double GetLastResidual() const override;
+
+		//! Returns the CG variant of the stored-matrix solve.
+		CGMethod GetCGMethod() const;
+
+		//!
+		//! \brief Sets the CG variant of the stored-matrix solve.
+		//!
+		//! CGMethod::Fused fuses the matrix-vector multiplication with d.q and
+		//! the solution and residual updates. CGMethod::Pipelined applies the
+		//! V-cycle to an auxiliary vector so that the rest of the iteration is a
+		//! single sweep with a single reduction. The V-cycle dominates the cost
+		//! of an iteration, so the savings are smaller than in FDMCGSolver3. The
+		//! matrix-free solve always uses CGMethod::Standard.
+		//!
+		void SetCGMethod(CGMethod method);
 
 	private:
 		struct Preconditioner final
@@ -73,16 +95,38 @@ namespace CubbyFlow
 			void Solve(const FDMVector3& b, FDMVector3* x) const;
 		};
 
+		struct MatrixFreePreconditioner final
+		{
+			FDMMGMatrixFreeLinearSystem3* system;
+			MGParameters<FDMMatrixFreeBLAS3> mgParams;
+
+			void Build(FDMMGMatrixFreeLinearSystem3* system, MGParameters<FDMMatrixFreeBLAS3> mgParams);
+
+			void Solve(const FDMVector3& b, FDMVector3* x) const;
+		};
+
 		unsigned int m_maxNumberOfIterations;
 		unsigned int m_lastNumberOfIterations;
 		double m_tolerance;
 		double m_lastResidualNorm;
+		CGMethod m_cgMethod = CGMethod::Standard;
 
 		FDMVector3 m_r;
 		FDMVector3 m_d;
 		FDMVector3 m_q;
 		FDMVector3 m_s;
+
+		// Pipelined vectors
+		FDMVector3 m_u;
+		FDMVector3 m_w;
+		FDMVector3 m_m;
+		FDMVector3 m_n;
+		FDMVector3 m_z;
+		FDMVector3 m_p;
 		Preconditioner m_precond;
+		MatrixFreePreconditioner m_matrixFreePrecond;
+
+		void ClearPipelinedVectors();
 	};
 
 	//! Shared pointer type for the FDMMGPCGSolver3.
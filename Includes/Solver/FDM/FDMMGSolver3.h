@@ -33,22 +33,42 @@ namespace CubbyFlow
 		//! Returns the Multigrid parameters.
 		const MGParameters<FDMBLAS3>& GetParams() const;
 
+		//! Returns the Multigrid parameters for the matrix-free system.
+		const MGParameters<FDMMatrixFreeBLAS3>& GetMatrixFreeParams() const;
+
 		//! Returns the SOR (Successive Over Relaxation) factor.
 		double GetSORFactor() const;
 
 		//! Returns true if red-black ordering is enabled.
 		bool GetUseRedBlackOrdering() const;
 
+		//! Returns the max residual tolerance.
+		double GetTolerance() const override;
+
+		//! Sets the max residual tolerance.
+		void SetTolerance(double tolerance) override;
+
+		//! Returns the last residual after the V-cycle.
+		double GetLastResidual() const override;
+
 		//! No-op. Multigrid-type solvers do not solve FDMLinearSystem3.
 		bool Solve(FDMLinearSystem3* system) final;
 
 		//! Solves Multigrid linear system.
 		virtual bool Solve(FDMMGLinearSystem3* system);
 
+		//! No-op. Multigrid-type solvers do not solve FDMMatrixFreeLinearSystem3.
+		bool SolveMatrixFree(FDMMatrixFreeLinearSystem3* system) final;
+
+		//! Solves matrix-free Multigrid linear system.
+		virtual bool SolveMatrixFree(FDMMGMatrixFreeLinearSystem3* system);
+
 	private:
 		MGParameters<FDMBLAS3> m_mgParams;
+		MGParameters<FDMMatrixFreeBLAS3> m_mgMatrixFreeParams;
 		double m_sorFactor;
 		bool m_useRedBlackOrdering;
+		double m_lastResidualNorm = std::numeric_limits<double>::max();
 	};
 
 	//! Shared pointer type for the FDMMGSolver3.
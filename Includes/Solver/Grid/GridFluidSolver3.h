@@ -231,6 +231,14 @@ namespace CubbyFlow
 		//! Computes the advection term using the advection solver.
 		virtual void ComputeAdvection(double timeIntervalInSeconds);
 
+		//!
+		//! \brief Advects the advectable scalar data at \p index.
+		//!
+		//! This function is called by ComputeAdvection for each advectable scalar
+		//! data. Override this function to customize the advection of a field.
+		//!
+		virtual void ComputeScalarDataAdvection(size_t index, double timeIntervalInSeconds);
+
 		//!
 		//! \brief Returns the signed-distance representation of the fluid.
 		//!
@@ -113,6 +113,14 @@ namespace CubbyFlow
 
 		std::function<Vector3D(const Vector3D&)> m_boundaryVel;
 
+		// Numbering of the fluid cells of the compressed system
+		Array3<size_t> m_coordToIndex;
+		std::vector<size_t> m_rowToCoord;
+
+		// Warm start
+		Array3<char> m_fluidMask;
+		FDMVector3 m_warmStartPressure;
+
 		void BuildWeights(
 			const FaceCenteredGrid3& input,
 			const ScalarField3& boundarySDF,
@@ -121,6 +129,10 @@ namespace CubbyFlow
 
 		void DecompressSolution();
 
+		void SetInitialGuess(bool useCompressed);
+
+		double GetMaxDivergence(bool useCompressed) const;
+
 		virtual void BuildSystem(const FaceCenteredGrid3& input, bool useCompressed);
 
 		virtual void ApplyPressureGradient(const FaceCenteredGrid3& input, FaceCenteredGrid3* output);
@@ -12,10 +12,46 @@
 #include <Field/ConstantScalarField3.h>
 #include <Field/ConstantVectorField3.h>
 #include <Grid/FaceCenteredGrid3.h>
+#include <FDM/FDMLinearSystem3.h>
+#include <Solver/FDM/FDMLinearSystemSolver3.h>
 #include <Solver/Grid/GridBoundaryConditionSolver3.h>
 
+#include <deque>
+#include <vector>
+
 namespace CubbyFlow
 {
+	//! Statistics of a single pressure solve.
+	struct GridPressureSolverStats3
+	{
+		//! Number of iterations the linear system solver made.
+		unsigned int numberOfIterations = 0;
+
+		//! Residual after the iterations.
+		double lastResidual = 0.0;
+
+		//!
+		//! Residual norms before the first iteration and after each iteration.
+		//! Empty if the linear system solver does not record them.
+		//!
+		std::vector<double> residualHistory;
+
+		//! Residual tolerance the linear system solver used.
+		double tolerance = 0.0;
+
+		//! Max absolute value of the RHS (the divergence of the input velocity).
+		double maxDivergence = 0.0;
+
+		//! CFL number of the input velocity.
+		double cfl = 0.0;
+
+		//! True if the solve started from the pressure of the previous solve.
+		bool isWarmStarted = false;
+
+		//! Wall-clock time of the solve including the system build.
+		double elapsedTimeInSeconds = 0.0;
+	};
+
 	//!
 	//! \brief Abstract base class for 2-D grid-based pressure solver.
 	//!
@@ -72,6 +108,144 @@ namespace CubbyFlow
 		//! implementation, different boundary condition solver might be used.
 		//!
 		virtual GridBoundaryConditionSolver3Ptr SuggestedBoundaryConditionSolver() const = 0;
+
+		//! Returns true if the solve starts from the previous pressure.
+		bool GetUseWarmStart() const;
+
+		//!
+		//! \brief Sets whether the solve starts from the previous pressure.
+		//!
+		//! When enabled, the linear system is seeded with the pressure of the
+		//! previous solve. Cells that became fluid take the average pressure of
+		//! their neighbors that were fluid, and the pressure is rescaled by the
+		//! ratio of the time intervals since the solved pressure is scaled by
+		//! the time interval. The seed is dropped when the resolution changes.
+		//!
+		void SetUseWarmStart(bool useWarmStart);
+
+		//! Returns true if the tolerance adapts to the divergence and CFL.
+		bool GetUseAdaptiveTolerance() const;
+
+		//!
+		//! \brief Sets whether the tolerance adapts to the divergence and CFL.
+		//!
+		//! When enabled, the tolerance of the linear system solver is set before
+		//! each solve to
+		//!
+		//!     max(minTolerance, relativeTolerance * maxDivergence / max(1, CFL))
+		//!
+		//! so that the residual is small relative to the divergence being
+		//! removed, and tighter at large time steps where the remaining
+		//! divergence is carried further by the advection. The tolerance of the
+		//! linear system solver is restored after each solve.
+		//!
+		void SetUseAdaptiveTolerance(bool useAdaptiveTolerance);
+
+		//! Returns the tolerance relative to the max divergence.
+		double GetRelativeTolerance() const;
+
+		//! Sets the tolerance relative to the max divergence.
+		void SetRelativeTolerance(double relativeTolerance);
+
+		//! Returns the lower bound of the adaptive tolerance.
+		double GetMinTolerance() const;
+
+		//! Sets the lower bound of the adaptive tolerance.
+		void SetMinTolerance(double minTolerance);
+
+		//! Returns the statistics of the last solve.
+		const GridPressureSolverStats3& GetLastStats() const;
+
+		//!
+		//! \brief Returns the statistics of the recent solves, oldest first.
+		//!
+		//! The history keeps up to GetMaxStatsHistoryLength() solves since it
+		//! was cleared and drops the oldest one when a new solve exceeds it.
+		//!
+		const std::deque<GridPressureSolverStats3>& GetStatsHistory() const;
+
+		//! Clears the history of the statistics.
+		void ClearStatsHistory();
+
+		//! Returns the max number of solves kept in the history.
+		size_t GetMaxStatsHistoryLength() const;
+
+		//! Sets the max number of solves kept in the history.
+		void SetMaxStatsHistoryLength(size_t maxLength);
+
+	protected:
+		//!
+		//! \brief Restores the tolerance and the initial guess setting of a linear
+		//!        system solver when it goes out of scope.
+		//!
+		//! Solve changes these settings for a single solve. The guard puts the
+		//! user's settings back even if the solve throws.
+		//!
+		class SystemSolverSettingsGuard final
+		{
+		public:
+			//! Stores the current settings of \p solver.
+			explicit SystemSolverSettingsGuard(FDMLinearSystemSolver3* solver);
+
+			//! Restores the stored settings.
+			~SystemSolverSettingsGuard();
+
+			//! Deleted copy constructor.
+			SystemSolverSettingsGuard(const SystemSolverSettingsGuard&) = delete;
+
+			//! Deleted copy assignment operator.
+			SystemSolverSettingsGuard& operator=(const SystemSolverSettingsGuard&) = delete;
+
+		private:
+			FDMLinearSystemSolver3* m_solver;
+			bool m_useInitialGuess;
+			double m_tolerance;
+		};
+
+		//! Returns the tolerance for given max divergence and CFL number.
+		double ComputeAdaptiveTolerance(double maxDivergence, double cfl) const;
+
+		//! Appends the statistics of a solve to the history.
+		void AddStats(GridPressureSolverStats3 stats);
+
+		//! Returns the CFL number of given velocity field.
+		static double ComputeCFL(const FaceCenteredGrid3& input, double timeIntervalInSeconds);
+
+		//!
+		//! \brief Computes the warm start pressure from the previous solve.
+		//!
+		//! The previous pressure is remapped onto the current fluid region and
+		//! rescaled by the ratio of the time intervals. Returns false if there is
+		//! no previous pressure of the same resolution.
+		//!
+		//! \param[in]  fluid                 Non-zero where the cell is fluid.
+		//! \param[in]  timeIntervalInSeconds The time interval for the sim.
+		//! \param[out] result                The pressure, zero outside the fluid.
+		//!
+		bool ComputeWarmStartPressure(
+			const Array3<char>& fluid,
+			double timeIntervalInSeconds,
+			FDMVector3* result) const;
+
+		//! Stores the solved pressure for the warm start of the next solve.
+		void StoreWarmStartPressure(
+			const FDMVector3& pressure,
+			const Array3<char>& fluid,
+			double timeIntervalInSeconds);
+
+		bool m_useWarmStart = false;
+		bool m_useAdaptiveTolerance = false;
+		double m_relativeTolerance = 1e-3;
+		double m_minTolerance = 1e-9;
+
+	private:
+		GridPressureSolverStats3 m_lastStats;
+		std::deque<GridPressureSolverStats3> m_statsHistory;
+		size_t m_maxStatsHistoryLength = 100;
+
+		FDMVector3 m_prevPressure;
+		Array3<char> m_prevFluid;
+		double m_prevTimeInterval = 0.0;
 	};
 
 	//! Shared pointer type for the GridPressureSolver3.
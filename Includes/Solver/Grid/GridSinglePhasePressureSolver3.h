@@ -91,16 +91,42 @@ namespace CubbyFlow
 		//! Returns the pressure field.
 		const FDMVector3& GetPressure() const;
 
+		//! Returns true if the matrix-free system is used.
+		bool GetUseMatrixFree() const;
+
+		//!
+		//! \brief Sets whether the solver uses the matrix-free system.
+		//!
+		//! When enabled, the Poisson operator is evaluated from the cell markers
+		//! (see FDMMatrixFree3) instead of being assembled into FDMMatrix3, and
+		//! the compressed flag of Solve is ignored. The linear system solver must
+		//! support the matrix-free system, such as FDMCGSolver3, FDMMGSolver3 and
+		//! FDMMGPCGSolver3.
+		//!
+		void SetUseMatrixFree(bool useMatrixFree);
+
 	private:
 		FDMLinearSystem3 m_system;
 		FDMCompressedLinearSystem3 m_compSystem;
+		FDMMatrixFreeLinearSystem3 m_matrixFreeSystem;
 		FDMLinearSystemSolver3Ptr m_systemSolver;
 
 		FDMMGLinearSystem3 m_mgSystem;
+		FDMMGMatrixFreeLinearSystem3 m_mgMatrixFreeSystem;
 		FDMMGSolver3Ptr m_mgSystemSolver;
 
+		bool m_useMatrixFree = false;
+
 		std::vector<Array3<char>> m_markers;
 
+		// Numbering of the fluid cells of the compressed system
+		Array3<size_t> m_coordToIndex;
+		std::vector<size_t> m_rowToCoord;
+
+		// Warm start
+		Array3<char> m_fluidMask;
+		FDMVector3 m_warmStartPressure;
+
 		void BuildMarkers(
 			const Size3& size,
 			const std::function<Vector3D(size_t, size_t, size_t)>& pos,
@@ -109,8 +135,14 @@ namespace CubbyFlow
 
 		void DecompressSolution();
 
+		void SetInitialGuess(bool useCompressed);
+
+		double GetMaxDivergence(bool useCompressed) const;
+
 		virtual void BuildSystem(const FaceCenteredGrid3& input, bool useCompressed);
 
+		void BuildMatrixFreeSystem(const FaceCenteredGrid3& input);
+
 		virtual void ApplyPressureGradient(const FaceCenteredGrid3& input, FaceCenteredGrid3* output);
 	};
 
@@ -42,6 +42,23 @@ namespace CubbyFlow
 			double maxDistance,
 			ScalarGrid3* outputSDF) override;
 
+		//!
+		//! Reinitializes the points of given narrow band to signed-distance.
+		//!
+		//! The marching only visits the points of \p band, so the cost scales
+		//! with the band instead of the grid.
+		//!
+		//! \param inputSDF Input signed-distance field which can be distorted.
+		//! \param band Narrow band of the data points to reinitialize.
+		//! \param maxDistance Max range of reinitialization.
+		//! \param outputSDF Output signed-distance field.
+		//!
+		void ReinitializeNarrowBand(
+			const ScalarGrid3& inputSDF,
+			const NarrowBand3& band,
+			double maxDistance,
+			ScalarGrid3* outputSDF) override;
+
 		//!
 		//! Extrapolates given scalar field from negative to positive SDF region.
 		//!
@@ -86,6 +103,26 @@ namespace CubbyFlow
 			double maxDistance,
 			FaceCenteredGrid3* output) override;
 
+		//!
+		//! Extrapolates given face-centered vector field from negative to positive
+		//! SDF region within the faces of given narrow band.
+		//!
+		//! A face is in the band if one of its adjacent cells is in \p band.
+		//! The faces outside of the band are left untouched.
+		//!
+		//! \param input Input face-centered field to be extrapolated.
+		//! \param sdf Reference signed-distance field.
+		//! \param band Narrow band of the cells of the face-centered grid.
+		//! \param maxDistance Max range of extrapolation.
+		//! \param output Output face-centered vector field.
+		//!
+		void ExtrapolateNarrowBand(
+			const FaceCenteredGrid3& input,
+			const ScalarField3& sdf,
+			const NarrowBand3& band,
+			double maxDistance,
+			FaceCenteredGrid3* output);
+
 	private:
 		void Extrapolate(
 			const ConstArrayAccessor3<double>& input,
@@ -93,6 +130,16 @@ namespace CubbyFlow
 			const Vector3D& gridSpacing,
 			double maxDistance,
 			ArrayAccessor3<double> output);
+
+		void ExtrapolateNarrowBand(
+			const ConstArrayAccessor3<double>& input,
+			const Grid3::DataPositionFunc& inputPosition,
+			const ScalarField3& sdf,
+			const NarrowBand3& band,
+			size_t axis,
+			const Vector3D& gridSpacing,
+			double maxDistance,
+			ArrayAccessor3<double> output);
 	};
 
 	//! Shared pointer type for the FMMLevelSetSolver3.
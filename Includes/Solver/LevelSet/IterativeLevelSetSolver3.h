@@ -45,6 +45,23 @@ namespace CubbyFlow
 			double maxDistance,
 			ScalarGrid3* outputSDF) override;
 
+		//!
+		//! Reinitializes the points of given narrow band to signed-distance.
+		//!
+		//! The pseudo-time iterations only update the points of \p band. The
+		//! points outside of the band are read as fixed boundary values.
+		//!
+		//! \param inputSDF Input signed-distance field which can be distorted.
+		//! \param band Narrow band of the data points to reinitialize.
+		//! \param maxDistance Max range of reinitialization.
+		//! \param outputSDF Output signed-distance field.
+		//!
+		void ReinitializeNarrowBand(
+			const ScalarGrid3& inputSDF,
+			const NarrowBand3& band,
+			double maxDistance,
+			ScalarGrid3* outputSDF) override;
+
 		//!
 		//! Extrapolates given scalar field from negative to positive SDF region.
 		//!
@@ -128,6 +145,17 @@ namespace CubbyFlow
 		double PseudoTimeStep(
 			ConstArrayAccessor3<double> sdf,
 			const Vector3D& gridSpacing) const;
+
+		double PseudoTimeStep(
+			ConstArrayAccessor3<double> sdf,
+			const Vector3D& gridSpacing,
+			const NarrowBand3& band) const;
+
+		double ComputeReinitializeStep(
+			ConstArrayAccessor3<double> sdf,
+			const Vector3D& gridSpacing,
+			double dtau,
+			size_t i, size_t j, size_t k) const;
 	};
 }
 
@@ -10,6 +10,7 @@
 #define CUBBYFLOW_LEVEL_SET_LIQUID_SOLVER3_H
 
 #include <Solver/Grid/GridFluidSolver3.h>
+#include <LevelSet/NarrowBand3.h>
 #include <Solver/LevelSet/LevelSetSolver3.h>
 
 namespace CubbyFlow
@@ -68,6 +69,34 @@ namespace CubbyFlow
 		//!
 		void SetIsGlobalCompensationEnabled(bool isEnabled);
 
+		//!
+		//! \brief Enables (or disables) the narrow band mode.
+		//!
+		//! When \p isEnabled is true, the advection and the reinitialization of
+		//! the signed-distance field and the velocity extrapolation only visit
+		//! the points within the narrow band width of the interface. The band is
+		//! rebuilt incrementally every step, and the values outside of the band
+		//! are clamped to +/- the band width. The velocity advection and the
+		//! pressure projection still run on the whole grid, and the air
+		//! velocity outside of the band is reset to zero as in the dense mode.
+		//!
+		void SetIsNarrowBandEnabled(bool isEnabled);
+
+		//! Returns the narrow band width in number of grid cells.
+		double GetNarrowBandWidth() const;
+
+		//!
+		//! \brief Sets the narrow band width in number of grid cells.
+		//!
+		//! The reinitialization and the velocity extrapolation are limited to
+		//! this width in the narrow band mode. The input is clamped to 3 so that
+		//! the high-order stencils stay inside of the band.
+		//!
+		void SetNarrowBandWidth(double width);
+
+		//! Returns the narrow band of the signed-distance field.
+		const NarrowBand3& GetNarrowBand() const;
+
 		//!
 		//! \brief Returns liquid volume measured by smeared Heaviside function.
 		//!
@@ -90,6 +119,9 @@ namespace CubbyFlow
 		//! Customizes advection step.
 		void ComputeAdvection(double timeIntervalInSeconds) override;
 
+		//! Advects the signed-distance field within the narrow band if enabled.
+		void ComputeScalarDataAdvection(size_t index, double timeIntervalInSeconds) override;
+
 		//!
 		//! \brief Returns fluid region as a signed-distance field.
 		//!
@@ -105,11 +137,18 @@ namespace CubbyFlow
 		double m_minReinitializeDistance = 10.0;
 		bool m_isGlobalCompensationEnabled = false;
 		double m_lastKnownVolume = 0.0;
+		bool m_isNarrowBandEnabled = false;
+		double m_narrowBandWidth = 6.0;
+		NarrowBand3 m_narrowBand;
 
 		void Reinitialize(double currentCFL);
 
+		void BuildNarrowBand();
+
 		void ExtrapolateVelocityToAir(double currentCFL);
 
+		void ExtrapolateVelocityToAirNarrowBand(double currentCFL);
+
 		void AddVolume(double volDiff);
 	};
 
@@ -12,6 +12,7 @@
 #include <Grid/CollocatedVectorGrid3.h>
 #include <Grid/FaceCenteredGrid3.h>
 #include <Grid/ScalarGrid3.h>
+#include <LevelSet/NarrowBand3.h>
 
 #include <memory>
 
@@ -39,6 +40,25 @@ namespace CubbyFlow
 			double maxDistance,
 			ScalarGrid3* outputSDF) = 0;
 
+		//!
+		//! \brief Reinitializes the points of given narrow band to signed-distance.
+		//!
+		//! Only the points in \p band are computed, and the points outside of the
+		//! band are copied from \p inputSDF. \p inputSDF and \p outputSDF may be
+		//! the same grid. By default, this function clones the input and calls
+		//! the full-grid Reinitialize.
+		//!
+		//! \param inputSDF Input signed-distance field which can be distorted.
+		//! \param band Narrow band of the data points to reinitialize.
+		//! \param maxDistance Max range of reinitialization.
+		//! \param outputSDF Output signed-distance field.
+		//!
+		virtual void ReinitializeNarrowBand(
+			const ScalarGrid3& inputSDF,
+			const NarrowBand3& band,
+			double maxDistance,
+			ScalarGrid3* outputSDF);
+
 		//!
 		//! Extrapolates given scalar field from negative to positive SDF region.
 		//!
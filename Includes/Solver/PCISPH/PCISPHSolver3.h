@@ -75,8 +75,15 @@ namespace CubbyFlow
 		ParticleSystemData3::VectorData m_pressureForces;
 		ParticleSystemData3::ScalarData m_densityErrors;
 
-		double ComputeDelta(double timeStepInSeconds) const;
+		// Lattice sum of ComputeDelta and the parameters it was computed with
+		double m_deltaDenom = 0.0;
+		double m_deltaKernelRadius = 0.0;
+		double m_deltaTargetSpacing = 0.0;
+
+		double ComputeDelta(double timeStepInSeconds);
 		double ComputeBeta(double timeStepInSeconds) const;
+
+		static double ComputeDeltaDenom(double kernelRadius, double targetSpacing);
 	};
 
 	//! Shared pointer type for the PCISPHSolver3.
@@ -0,0 +1,48 @@
+/*************************************************************************
+> File Name: PICSolver3-Impl.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D Particle-in-Cell (PIC) implementation.
+> Created Time: 2018/01/25
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_PIC_SOLVER3_IMPL_H
+#define CUBBYFLOW_PIC_SOLVER3_IMPL_H
+
+#include <Utils/Parallel.h>
+
+namespace CubbyFlow
+{
+	template <typename Callback>
+	void PICSolver3::ParallelForEachParticleInBlocks(const Callback& function)
+	{
+		BinParticlesIntoBlocks();
+
+		const Size3 numBlocks = m_numberOfParticleBlocks;
+
+		// Visit the blocks color by color
+		for (size_t color = 0; color < 8; ++color)
+		{
+			const Size3 offset(color & 1, (color >> 1) & 1, (color >> 2) & 1);
+			const Size3 numColoredBlocks(
+				(numBlocks.x + 1 - offset.x) / 2,
+				(numBlocks.y + 1 - offset.y) / 2,
+				(numBlocks.z + 1 - offset.z) / 2);
+
+			ParallelFor(ZERO_SIZE, numColoredBlocks.x * numColoredBlocks.y * numColoredBlocks.z, [&](size_t n)
+			{
+				const size_t bi = 2 * (n % numColoredBlocks.x) + offset.x;
+				const size_t bj = 2 * ((n / numColoredBlocks.x) % numColoredBlocks.y) + offset.y;
+				const size_t bk = 2 * (n / (numColoredBlocks.x * numColoredBlocks.y)) + offset.z;
+				const size_t block = bi + numBlocks.x * (bj + numBlocks.y * bk);
+
+				for (size_t p = m_blockStarts[block]; p < m_blockStarts[block + 1]; ++p)
+				{
+					function(m_particlesSortedByBlock[p]);
+				}
+			});
+		}
+	}
+}
+
+#endif
\ No newline at end of file
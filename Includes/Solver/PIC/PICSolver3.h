@@ -83,10 +83,34 @@ namespace CubbyFlow
 		//! Moves particles.
 		virtual void MoveParticles(double timeIntervalInSeconds);
 
+		//!
+		//! \brief Invokes \p function for every particle in parallel so that
+		//!        concurrent calls never scatter into the same grid point.
+		//!
+		//! Particles are binned into blocks of cells and the blocks are visited
+		//! in eight colors, one color at a time. Blocks with the same color are
+		//! at least one block apart, which is wider than the trilinear stencil
+		//! of the face-centered velocity grid. Particles within a block are
+		//! visited in the order of their indices, so the result is deterministic
+		//! and differs from the serial scatter only by round-off.
+		//!
+		//! \param[in] function The callback function.
+		//!
+		//! \tparam    Callback The callback function type.
+		//!
+		template <typename Callback>
+		void ParallelForEachParticleInBlocks(const Callback& function);
+
 	private:
 		size_t m_signedDistanceFieldID;
 		ParticleSystemData3Ptr m_particles;
 		ParticleEmitter3Ptr m_particleEmitter;
+		Size3 m_numberOfParticleBlocks;
+		Array1<size_t> m_particleBlockIndices;
+		Array1<size_t> m_particlesSortedByBlock;
+		std::vector<size_t> m_blockStarts;
+
+		void BinParticlesIntoBlocks();
 
 		void ExtrapolateVelocityToAir() const;
 
@@ -112,4 +136,6 @@ namespace CubbyFlow
 	};
 }
 
+#include <Solver/PIC/PICSolver3-Impl.h>
+
 #endif
\ No newline at end of file
@@ -113,6 +113,22 @@ namespace CubbyFlow
 		//!
 		void SetWind(const VectorField3Ptr& newWind);
 
+		//! Returns the number of time-steps between particle sorting.
+		unsigned int GetParticleSortingInterval() const;
+
+		//!
+		//! \brief      Sets the number of time-steps between particle sorting.
+		//!
+		//! When the interval is positive, the particles are sorted along the
+		//! Z-order curve (see ParticleSystemData3::SortParticles) at the
+		//! beginning of every \p interval time-steps, after the emitter has
+		//! run. This keeps the neighbor loops cache-coherent while the flow
+		//! keeps mixing the particles. Default is 0, which disables sorting.
+		//!
+		//! \param[in]  interval The new interval in time-steps.
+		//!
+		void SetParticleSortingInterval(unsigned int interval);
+
 		//! Returns builder fox ParticleSystemSolver3.
 		static Builder GetBuilder();
 
@@ -146,6 +162,8 @@ namespace CubbyFlow
 		double m_dragCoefficient = 1e-4;
 		double m_restitutionCoefficient = 0.0;
 		Vector3D m_gravity = Vector3D(0.0, GRAVITY, 0.0);
+		unsigned int m_particleSortingInterval = 0;
+		unsigned int m_numberOfTimeStepsSinceSorting = 0;
 
 		ParticleSystemData3Ptr m_particleSystemData;
 		ParticleSystemData3::VectorData m_newPositions;
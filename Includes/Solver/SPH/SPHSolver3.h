@@ -9,6 +9,7 @@
 #ifndef CUBBYFLOW_SPH_SOLVER3_H
 #define CUBBYFLOW_SPH_SOLVER3_H
 
+#include <Array/SoAArray3.h>
 #include <Solver/Particle/ParticleSystemSolver3.h>
 #include <SPH/SPHSystemData3.h>
 
@@ -113,6 +114,20 @@ namespace CubbyFlow
 		//!
 		void SetTimeStepLimitScale(double newScale);
 
+		//! Returns true if the solver builds neighbor lists.
+		bool GetUseNeighborLists() const;
+
+		//!
+		//! \brief Sets true to build neighbor lists in each time-step.
+		//!
+		//! When the lists are not built, the neighbor loops walk the buckets of
+		//! the neighbor searcher directly (see SPHSystemData3::ForEachNeighbor).
+		//! This keeps the memory usage linear in the number of particles, instead
+		//! of growing with the number of neighbors, at the cost of more distance
+		//! tests per loop. Default is true.
+		//!
+		void SetUseNeighborLists(bool onoff);
+
 		//! Returns the SPH system data.
 		SPHSystemData3Ptr GetSPHSystemData() const;
 
@@ -132,6 +147,15 @@ namespace CubbyFlow
 		//! Performs post-processing step before the simulation.
 		void OnEndAdvanceTimeStep(double timeStepInSeconds) override;
 
+		//!
+		//! \brief Copies the particle positions and velocities into the SoA
+		//!        arrays read by the neighbor force loops.
+		//!
+		//! AccumulateForces calls this function once per time-step, before any
+		//! force is accumulated.
+		//!
+		void UpdateSoAArrays();
+
 		//! Accumulates the non-pressure forces to the forces array in the particle
 		//! system.
 		virtual void AccumulateNonPressureForces(double timeStepInSeconds);
@@ -143,15 +167,43 @@ namespace CubbyFlow
 		//! Computes the pressure.
 		void ComputePressure();
 
-		//! Accumulates the pressure force to the given \p pressureForces array.
+		//!
+		//! \brief Accumulates the pressure force to the given \p pressureForces
+		//!        array.
+		//!
+		//! The \p positions are copied into SoA scratch arrays on every call,
+		//! since they are typically the predicted positions that change between
+		//! calls.
+		//!
 		void AccumulatePressureForce(
 			const ConstArrayAccessor1<Vector3D>& positions,
 			const ConstArrayAccessor1<double>& densities,
 			const ConstArrayAccessor1<double>& pressures,
 			ArrayAccessor1<Vector3D> pressureForces);
 
-		//! Accumulates the viscosity force to the forces array in the particle
-		//! system.
+		//!
+		//! \brief Accumulates the pressure force to the given \p pressureForces
+		//!        array, reading the positions from the given SoA arrays.
+		//!
+		//! Unlike the overload above, nothing is copied, so this is the one to
+		//! call in a loop when the positions do not change between the calls.
+		//!
+		void AccumulatePressureForceSoA(
+			const SoAArray3D& positions,
+			const ConstArrayAccessor1<double>& densities,
+			const ConstArrayAccessor1<double>& pressures,
+			ArrayAccessor1<Vector3D> pressureForces);
+
+		//! Returns the positions copied by the last UpdateSoAArrays call.
+		const SoAArray3D& GetPositionsSoA() const;
+
+		//!
+		//! \brief Accumulates the viscosity force to the forces array in the
+		//!        particle system.
+		//!
+		//! The positions and velocities are read from the SoA arrays, so
+		//! UpdateSoAArrays should be called after the particles have changed.
+		//!
 		void AccumulateViscosityForce();
 
 		//! Computes pseudo viscosity.
@@ -180,6 +232,16 @@ namespace CubbyFlow
 
 		//! Scales the max allowed time-step.
 		double m_timeStepLimitScale = 1.0;
+
+		//! Builds neighbor lists in each time-step if true.
+		bool m_useNeighborLists = true;
+
+		//! Positions and velocities in SoA layout for the neighbor loops.
+		SoAArray3D m_positionsSoA;
+		SoAArray3D m_velocitiesSoA;
+
+		//! Scratch for the positions passed to AccumulatePressureForce.
+		SoAArray3D m_tempPositionsSoA;
 	};
 
 	//! Shared pointer type for the SPHSolver3.
@@ -0,0 +1,73 @@
+/*************************************************************************
+> File Name: AlignedAllocator.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Allocator that aligns the storage to the given boundary.
+> Created Time: 2018/01/09
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_ALIGNED_ALLOCATOR_H
+#define CUBBYFLOW_ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief Standard allocator that aligns the storage to \p Alignment bytes.
+	//!
+	//! Used for the containers whose data are processed by SIMD loops, so that
+	//! the first element of each container starts on a cache line.
+	//!
+	//! \tparam T         Value type.
+	//! \tparam Alignment Alignment in bytes.
+	//!
+	template <typename T, size_t Alignment>
+	class AlignedAllocator
+	{
+	public:
+		static_assert(Alignment >= alignof(T), "Alignment must not be smaller than the alignment of T.");
+		static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two.");
+
+		using value_type = T;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = AlignedAllocator<U, Alignment>;
+		};
+
+		AlignedAllocator() = default;
+
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+		{
+			// Do nothing
+		}
+
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T* p, size_t)
+		{
+			::operator delete(p, std::align_val_t(Alignment));
+		}
+	};
+
+	template <typename T, typename U, size_t Alignment>
+	bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+	{
+		return true;
+	}
+
+	template <typename T, typename U, size_t Alignment>
+	bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+	{
+		return false;
+	}
+}
+
+#endif
\ No newline at end of file
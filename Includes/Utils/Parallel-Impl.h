@@ -10,16 +10,112 @@
 #define CUBBYFLOW_PARALLEL_IMPL_H
 
 #include <Utils/Constants.h>
+#include <Utils/ThreadPool.h>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
-#include <thread>
 #include <vector>
 
 namespace CubbyFlow
 {
 	namespace Internal
 	{
+		// Number of tasks issued per thread so that the work-stealing workers can
+		// balance uneven loads.
+		constexpr unsigned int NUM_TASKS_PER_THREAD = 4;
+
+		// Task group that splits [beginIndex, endIndex) into contiguous slices.
+		template <typename IndexType, typename Function>
+		class RangeTaskGroup final : public ThreadPool::TaskGroup
+		{
+		public:
+			RangeTaskGroup(IndexType beginIndex, IndexType endIndex, IndexType slice, const Function& function) :
+				m_beginIndex(beginIndex), m_endIndex(endIndex), m_slice(slice), m_function(function)
+			{
+				// Do nothing
+			}
+
+			void Execute(size_t taskIndex) override
+			{
+				const IndexType k1 = m_beginIndex + static_cast<IndexType>(taskIndex) * m_slice;
+				const IndexType k2 = std::min(static_cast<IndexType>(k1 + m_slice), m_endIndex);
+				m_function(taskIndex, k1, k2);
+			}
+
+		private:
+			IndexType m_beginIndex;
+			IndexType m_endIndex;
+			IndexType m_slice;
+			const Function& m_function;
+		};
+
+		// Task group that runs two functions.
+		template <typename Function1, typename Function2>
+		class InvokeTaskGroup final : public ThreadPool::TaskGroup
+		{
+		public:
+			InvokeTaskGroup(const Function1& function1, const Function2& function2) :
+				m_function1(function1), m_function2(function2)
+			{
+				// Do nothing
+			}
+
+			void Execute(size_t taskIndex) override
+			{
+				if (taskIndex == 0)
+				{
+					m_function1();
+				}
+				else
+				{
+					m_function2();
+				}
+			}
+
+		private:
+			const Function1& m_function1;
+			const Function2& m_function2;
+		};
+
+		// Returns the number of threads to use for given execution policy.
+		inline unsigned int GetNumberOfThreads(ExecutionPolicy policy)
+		{
+			return (policy == ExecutionPolicy::Parallel) ? std::max(GetMaxNumberOfThreads(), 1u) : 1u;
+		}
+
+		// Returns the number of tasks for a range of size \p n.
+		inline size_t GetNumberOfTasks(size_t n, ExecutionPolicy policy)
+		{
+			const unsigned int numThreads = GetNumberOfThreads(policy);
+			const size_t numTasks = (numThreads > 1) ? numThreads * NUM_TASKS_PER_THREAD : 1;
+			return std::min(n, numTasks);
+		}
+
+		// Splits [beginIndex, endIndex) into \p numTasks slices and calls
+		// function(taskIndex, sliceBegin, sliceEnd) for each slice on the thread
+		// pool. The slices only depend on the range and the number of tasks.
+		template <typename IndexType, typename Function>
+		void ParallelRangeForTasks(
+			IndexType beginIndex, IndexType endIndex,
+			size_t numTasks, const Function& function)
+		{
+			const size_t n = static_cast<size_t>(endIndex - beginIndex);
+			const size_t slice = (n + numTasks - 1) / numTasks;
+			numTasks = (n + slice - 1) / slice;
+
+			RangeTaskGroup<IndexType, Function> group(beginIndex, endIndex, static_cast<IndexType>(slice), function);
+			ThreadPool::GetInstance().Run(group, numTasks);
+		}
+
+		// Runs \p function1 and \p function2 concurrently on the thread pool.
+		template <typename Function1, typename Function2>
+		void ParallelInvoke(const Function1& function1, const Function2& function2)
+		{
+			InvokeTaskGroup<Function1, Function2> group(function1, function2);
+			ThreadPool::GetInstance().Run(group, 2);
+		}
+
 		// Adopted from:
 		// Radenski, A.
 		// Shared Memory, Message Passing, and Hybrid Merge Sorts for Standalone and
@@ -79,25 +175,13 @@ namespace CubbyFlow
 			}
 			else if (numThreads > 1)
 			{
-				std::vector<std::thread> pool;
-				pool.reserve(2);
-
-				auto launchRange = [compareFunction](RandomIterator begin, size_t k2, RandomIterator2 temp, unsigned int numThreads)
+				ParallelInvoke([&]()
 				{
-					ParallelMergeSort(begin, k2, temp, numThreads, compareFunction);
-				};
-
-				pool.emplace_back(launchRange, a, size / 2, temp, numThreads / 2);
-				pool.emplace_back(launchRange, a + size / 2, size - size / 2, temp + size / 2, numThreads - numThreads / 2);
-
-				// Wait for jobs to finish
-				for (std::thread& t : pool)
+					ParallelMergeSort(a, size / 2, temp, numThreads / 2, compareFunction);
+				}, [&]()
 				{
-					if (t.joinable())
-					{
-						t.join();
-					}
-				}
+					ParallelMergeSort(a + size / 2, size - size / 2, temp + size / 2, numThreads - numThreads / 2, compareFunction);
+				});
 
 				Merge(a, size, temp, compareFunction);
 			}
@@ -122,62 +206,18 @@ namespace CubbyFlow
 		}, policy);
 	}
 
-	// Adopted from http://ideone.com/Z7zldb
 	template <typename IndexType, typename Function>
 	void ParallelFor(
 		IndexType beginIndex, IndexType endIndex,
 		const Function& function, ExecutionPolicy policy)
 	{
-		if (beginIndex > endIndex)
-		{
-			return;
-		}
-
-		// Estimate number of threads in the pool
-		const unsigned int numThreadsHint = GetMaxNumberOfThreads();
-		const unsigned int numThreads = (policy == ExecutionPolicy::Parallel) ?
-			(numThreadsHint == 0u ? 8u : numThreadsHint) : 1;
-
-		// Size of a slice for the range functions
-		IndexType n = endIndex - beginIndex + 1;
-		IndexType slice = static_cast<IndexType>(std::round(n / static_cast<double>(numThreads)));
-		slice = std::max(slice, IndexType(1));
-
-		// [Helper] Inner loop
-		auto launchRange = [&function](IndexType k1, IndexType k2)
+		ParallelRangeFor(beginIndex, endIndex, [&function](IndexType k1, IndexType k2)
 		{
 			for (IndexType k = k1; k < k2; ++k)
 			{
 				function(k);
 			}
-		};
-
-		// Create pool and launch jobs
-		std::vector<std::thread> pool;
-		pool.reserve(numThreads);
-		IndexType i1 = beginIndex;
-		IndexType i2 = std::min(beginIndex + slice, endIndex);
-
-		for (unsigned int i = 0; i + 1 < numThreads && i1 < endIndex; ++i)
-		{
-			pool.emplace_back(launchRange, i1, i2);
-			i1 = i2;
-			i2 = std::min(i2 + slice, endIndex);
-		}
-
-		if (i1 < endIndex)
-		{
-			pool.emplace_back(launchRange, i1, endIndex);
-		}
-
-		// Wait for jobs to finish
-		for (std::thread& t : pool)
-		{
-			if (t.joinable())
-			{
-				t.join();
-			}
-		}
+		}, policy);
 	}
 
 	template <typename IndexType, typename Function>
@@ -185,47 +225,18 @@ namespace CubbyFlow
 		IndexType beginIndex, IndexType endIndex,
 		const Function& function, ExecutionPolicy policy)
 	{
-		if (beginIndex > endIndex)
+		if (beginIndex >= endIndex)
 		{
 			return;
 		}
 
-		// Estimate number of threads in the pool
-		const unsigned int numThreadsHint = GetMaxNumberOfThreads();
-		const unsigned int numThreads = (policy == ExecutionPolicy::Parallel) ?
-			(numThreadsHint == 0u ? 8u : numThreadsHint) : 1;
-
-		// Size of a slice for the range functions
-		IndexType n = endIndex - beginIndex + 1;
-		IndexType slice = static_cast<IndexType>(std::round(n / static_cast<double>(numThreads)));
-		slice = std::max(slice, IndexType(1));
-
-		// Create pool and launch jobs
-		std::vector<std::thread> pool;
-		pool.reserve(numThreads);
-		IndexType i1 = beginIndex;
-		IndexType i2 = std::min(beginIndex + slice, endIndex);
-
-		for (unsigned int i = 0; i + 1 < numThreads && i1 < endIndex; ++i)
-		{
-			pool.emplace_back(function, i1, i2);
-			i1 = i2;
-			i2 = std::min(i2 + slice, endIndex);
-		}
-
-		if (i1 < endIndex)
-		{
-			pool.emplace_back(function, i1, endIndex);
-		}
+		const size_t numTasks = Internal::GetNumberOfTasks(static_cast<size_t>(endIndex - beginIndex), policy);
 
-		// Wait for jobs to finish
-		for (std::thread& t : pool)
+		Internal::ParallelRangeForTasks(beginIndex, endIndex, numTasks,
+			[&function](size_t, IndexType k1, IndexType k2)
 		{
-			if (t.joinable())
-			{
-				t.join();
-			}
-		}
+			function(k1, k2);
+		});
 	}
 
 	template <typename IndexType, typename Function>
@@ -289,66 +300,61 @@ namespace CubbyFlow
 		}, policy);
 	}
 
+	template <typename IndexType, typename Function>
+	void ParallelTiledRangeFor(
+		IndexType beginIndexX, IndexType endIndexX,
+		IndexType beginIndexY, IndexType endIndexY,
+		IndexType beginIndexZ, IndexType endIndexZ,
+		IndexType tileSizeX, IndexType tileSizeY, IndexType tileSizeZ,
+		const Function& function, ExecutionPolicy policy)
+	{
+		if (beginIndexX >= endIndexX || beginIndexY >= endIndexY || beginIndexZ >= endIndexZ)
+		{
+			return;
+		}
+
+		assert(tileSizeX > 0 && tileSizeY > 0 && tileSizeZ > 0);
+
+		const IndexType numTilesX = (endIndexX - beginIndexX + tileSizeX - 1) / tileSizeX;
+		const IndexType numTilesY = (endIndexY - beginIndexY + tileSizeY - 1) / tileSizeY;
+		const IndexType numTilesZ = (endIndexZ - beginIndexZ + tileSizeZ - 1) / tileSizeZ;
+
+		ParallelFor(static_cast<IndexType>(0), numTilesX * numTilesY * numTilesZ, [&](IndexType tile)
+		{
+			const IndexType iBegin = beginIndexX + (tile % numTilesX) * tileSizeX;
+			const IndexType jBegin = beginIndexY + ((tile / numTilesX) % numTilesY) * tileSizeY;
+			const IndexType kBegin = beginIndexZ + (tile / (numTilesX * numTilesY)) * tileSizeZ;
+
+			function(
+				iBegin, std::min(iBegin + tileSizeX, endIndexX),
+				jBegin, std::min(jBegin + tileSizeY, endIndexY),
+				kBegin, std::min(kBegin + tileSizeZ, endIndexZ));
+		}, policy);
+	}
+
 	template <typename IndexType, typename Value, typename Function, typename Reduce>
 	Value ParallelReduce(
 		IndexType start, IndexType end,
 		const Value& identity, const Function& func,
 		const Reduce& reduce, ExecutionPolicy policy)
 	{
-		if (start > end)
+		if (start >= end)
 		{
 			return identity;	
 		}
-		
-		// Estimate number of threads in the pool
-		const unsigned int numThreadsHint = GetMaxNumberOfThreads();
-		const unsigned int numThreads = (policy == ExecutionPolicy::Parallel) ?
-			(numThreadsHint == 0u ? 8u : numThreadsHint) : 1;
-		
-		// Size of a slice for the range functions
-		IndexType n = end - start + 1;
-		IndexType slice = static_cast<IndexType>(std::round(n / static_cast<double>(numThreads)));
-		slice = std::max(slice, IndexType(1));
-		
+
+		const size_t numTasks = Internal::GetNumberOfTasks(static_cast<size_t>(end - start), policy);
+
 		// Results
-		std::vector<Value> results(numThreads, identity);
-		
-		// [Helper] Inner loop
-		auto launchRange = [&](IndexType k1, IndexType k2, unsigned int tid)
-		{
-			results[tid] = func(k1, k2, identity);
-		};
-		
-		// Create pool and launch jobs
-		std::vector<std::thread> pool;
-		pool.reserve(numThreads);
+		std::vector<Value> results(numTasks, identity);
 
-		IndexType i1 = start;
-		IndexType i2 = std::min(start + slice, end);
-		unsigned int threadID = 0;
-		
-		for (; threadID + 1 < numThreads && i1 < end; ++threadID)
+		Internal::ParallelRangeForTasks(start, end, numTasks,
+			[&](size_t taskIndex, IndexType k1, IndexType k2)
 		{
-			pool.emplace_back(launchRange, i1, i2, threadID);
-			i1 = i2;
-			i2 = std::min(i2 + slice, end);
-		}
-		
-		if (i1 < end)
-		{
-			pool.emplace_back(launchRange, i1, end, threadID);	
-		}
-		
-		// Wait for jobs to finish
-		for (std::thread& t : pool)
-		{
-			if (t.joinable())
-			{
-				t.join();	
-			}
-		}
-		
-		// Gather
+			results[taskIndex] = func(k1, k2, identity);
+		});
+
+		// Gather in task order so that the result only depends on the number of threads
 		Value finalResult = identity;
 		for (const Value& val : results)
 		{
@@ -381,10 +387,7 @@ namespace CubbyFlow
 		using value_type = typename std::iterator_traits<RandomIterator>::value_type;
 		std::vector<value_type> temp(size);
 
-		// Estimate number of threads in the pool
-		const unsigned int numThreadsHint = GetMaxNumberOfThreads();
-		const unsigned int numThreads = (policy == ExecutionPolicy::Parallel) ?
-			(numThreadsHint == 0u ? 8u : numThreadsHint) : 1;
+		const unsigned int numThreads = Internal::GetNumberOfThreads(policy);
 
 		Internal::ParallelMergeSort(begin, size, temp.begin(), numThreads, compareFunction);
 	}
@@ -187,6 +187,42 @@ namespace CubbyFlow
 		const Function& function,
 		ExecutionPolicy policy = ExecutionPolicy::Parallel);
 
+	//!
+	//! \brief      Makes a 3D tiled range-loop in parallel.
+	//!
+	//! This function splits the 3D index range into tiles of the given size and
+	//! calls the function once per tile with the index range of the tile, so
+	//! the neighbors touched by a stencil stay in cache while the tile is
+	//! processed. X is the inner-most tile direction and the consecutive tiles
+	//! are given to the same thread. The tiles at the upper ends can be smaller
+	//! than the tile size. The order of the visit is not guaranteed due to the
+	//! nature of parallel execution.
+	//!
+	//! \param[in]  beginIndexX The begin index in X dimension.
+	//! \param[in]  endIndexX   The end index in X dimension.
+	//! \param[in]  beginIndexY The begin index in Y dimension.
+	//! \param[in]  endIndexY   The end index in Y dimension.
+	//! \param[in]  beginIndexZ The begin index in Z dimension.
+	//! \param[in]  endIndexZ   The end index in Z dimension.
+	//! \param[in]  tileSizeX   The tile size in X dimension.
+	//! \param[in]  tileSizeY   The tile size in Y dimension.
+	//! \param[in]  tileSizeZ   The tile size in Z dimension.
+	//! \param[in]  function    The function to call for each tile
+	//!                         (iBegin, iEnd, jBegin, jEnd, kBegin, kEnd).
+	//! \param[in]  policy      The execution policy (parallel or serial).
+	//!
+	//! \tparam     IndexType   Index type.
+	//! \tparam     Function    Function type.
+	//!
+	template <typename IndexType, typename Function>
+	void ParallelTiledRangeFor(
+		IndexType beginIndexX, IndexType endIndexX,
+		IndexType beginIndexY, IndexType endIndexY,
+		IndexType beginIndexZ, IndexType endIndexZ,
+		IndexType tileSizeX, IndexType tileSizeY, IndexType tileSizeZ,
+		const Function& function,
+		ExecutionPolicy policy = ExecutionPolicy::Parallel);
+
 	//!
 	//! \brief      Performs reduce operation in parallel.
 	//!
@@ -248,7 +284,15 @@ namespace CubbyFlow
 		CompareFunction compare,
 		ExecutionPolicy policy = ExecutionPolicy::Parallel);
 
-	//! Sets maximum number of threads to use.
+	//!
+	//! \brief      Sets maximum number of threads to use.
+	//!
+	//! All the parallel functions run on a persistent work-stealing thread pool
+	//! (see ThreadPool) which is resized to match this number. The default is
+	//! the value of the CUBBYFLOW_NUM_THREADS environment variable if set, or
+	//! the hardware concurrency otherwise. This function must not be called from
+	//! inside a parallel function.
+	//!
 	void SetMaxNumberOfThreads(unsigned int numThreads);
 
 	//! Returns maximum number of threads to use.
@@ -0,0 +1,134 @@
+/*************************************************************************
+> File Name: ThreadPool.h
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Persistent work-stealing thread pool for CubbyFlow.
+> Created Time: 2018/01/06
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#ifndef CUBBYFLOW_THREAD_POOL_H
+#define CUBBYFLOW_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CubbyFlow
+{
+	//!
+	//! \brief Persistent work-stealing thread pool.
+	//!
+	//! This class owns the process-wide worker threads that execute the tasks
+	//! issued by the parallel functions (ParallelFor, ParallelRangeFor,
+	//! ParallelReduce and ParallelSort). Each worker has its own task deque. A
+	//! worker pops its own tasks from the back and steals tasks from the front of
+	//! the other deques when it runs out of work. The thread that submits a task
+	//! group also executes tasks until the whole group is finished. Nested
+	//! parallel calls therefore reuse the existing workers instead of spawning
+	//! new threads.
+	//!
+	class ThreadPool final
+	{
+	public:
+		//! Group of tasks executed by the thread pool.
+		class TaskGroup
+		{
+		public:
+			//! Default destructor.
+			virtual ~TaskGroup() = default;
+
+			//! Executes the task with given index.
+			virtual void Execute(size_t taskIndex) = 0;
+
+		private:
+			friend class ThreadPool;
+
+			std::atomic<size_t> m_numPendingTasks{ 0 };
+
+			// First exception thrown by a task of the group
+			std::atomic<bool> m_hasException{ false };
+			std::exception_ptr m_exception;
+		};
+
+		//! Returns the process-wide thread pool.
+		static ThreadPool& GetInstance();
+
+		//! Stops and joins all the workers.
+		~ThreadPool();
+
+		//! Deleted copy constructor.
+		ThreadPool(const ThreadPool&) = delete;
+
+		//! Deleted copy assignment operator.
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		//!
+		//! \brief Resizes the pool to have \p numWorkers worker threads.
+		//!
+		//! The thread that submits the tasks also takes part in the execution,
+		//! so a pool with N - 1 workers keeps N threads busy. This function must
+		//! not be called while a task group is being executed.
+		//!
+		void Resize(unsigned int numWorkers);
+
+		//! Returns the number of worker threads.
+		unsigned int NumberOfWorkers() const;
+
+		//!
+		//! \brief Executes the tasks [0, numTasks) of \p group.
+		//!
+		//! This function blocks until all the tasks in the group are finished.
+		//! The calling thread executes the tasks as well while it waits. If a
+		//! task throws, the first exception is rethrown from this function once
+		//! no task of the group is running anymore.
+		//!
+		void Run(TaskGroup& group, size_t numTasks);
+
+	private:
+		struct Task
+		{
+			TaskGroup* group;
+			size_t index;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		ThreadPool();
+
+		void StartWorkers(unsigned int numWorkers);
+
+		void StopWorkers();
+
+		void WorkerLoop(size_t queueIndex);
+
+		size_t CurrentQueueIndex() const;
+
+		bool TryPopOrSteal(size_t queueIndex, Task* task);
+
+		void WakeWorkers();
+
+		static void ExecuteTask(const Task& task);
+
+		std::vector<std::thread> m_workers;
+
+		// One queue per worker plus the shared queue for non-worker threads.
+		std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+		std::mutex m_sleepMutex;
+		std::condition_variable m_sleepCondition;
+		std::atomic<size_t> m_numQueuedTasks{ 0 };
+		std::atomic<unsigned int> m_numSleepingWorkers{ 0 };
+		std::atomic<bool> m_isStopping{ false };
+	};
+}
+
+#endif
\ No newline at end of file
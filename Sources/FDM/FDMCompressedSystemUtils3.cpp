@@ -0,0 +1,33 @@
+/*************************************************************************
+> File Name: FDMCompressedSystemUtils3.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Helpers for building 3-D compressed linear systems.
+> Created Time: 2018/01/27
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <FDM/FDMCompressedSystemUtils3.h>
+
+namespace CubbyFlow
+{
+	void FDMStencilRow3::Set(Slot slot, double value, size_t column)
+	{
+		values[slot] = value;
+		columns[slot] = column;
+		isUsed[slot] = true;
+	}
+
+	void FDMStencilRow3::Write(double* nonZeros, size_t* columnIndices) const
+	{
+		size_t n = 0;
+		for (size_t s = 0; s < NUM_SLOTS; ++s)
+		{
+			if (isUsed[s])
+			{
+				nonZeros[n] = values[s];
+				columnIndices[n] = columns[s];
+				++n;
+			}
+		}
+	}
+}
\ No newline at end of file
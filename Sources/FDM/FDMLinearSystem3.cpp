@@ -8,11 +8,206 @@
 *************************************************************************/
 #include <FDM/FDMLinearSystem3.h>
 #include <Math/MathUtils.h>
+#include <Utils/Parallel.h>
+#include <Vector/Vector2.h>
 
 #include <cassert>
+#include <vector>
 
 namespace CubbyFlow
 {
+	// Dot product over [begin, end) of two contiguous arrays. Four partial sums
+	// break the dependency chain so that the loop can be unrolled and
+	// vectorized; the summation order is fixed, so the result is reproducible.
+	// Single-precision inputs are accumulated in double.
+	template <typename T>
+	static double DotRange(const T* a, const T* b, size_t begin, size_t end)
+	{
+		double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			sum0 += static_cast<double>(a[i]) * b[i];
+			sum1 += static_cast<double>(a[i + 1]) * b[i + 1];
+			sum2 += static_cast<double>(a[i + 2]) * b[i + 2];
+			sum3 += static_cast<double>(a[i + 3]) * b[i + 3];
+		}
+
+		for (; i < end; ++i)
+		{
+			sum0 += static_cast<double>(a[i]) * b[i];
+		}
+
+		return (sum0 + sum1) + (sum2 + sum3);
+	}
+
+	// Number of elements that the fused kernels update before reducing them,
+	// so that the reduction reads the block from the cache.
+	static const size_t FUSED_BLOCK_SIZE = 1024;
+
+	// Maximum absolute value over [begin, end) of a contiguous array.
+	template <typename T>
+	static double AbsMaxRange(const T* v, size_t begin, size_t end)
+	{
+		double max0 = 0.0, max1 = 0.0, max2 = 0.0, max3 = 0.0;
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			max0 = std::max(max0, std::fabs(static_cast<double>(v[i])));
+			max1 = std::max(max1, std::fabs(static_cast<double>(v[i + 1])));
+			max2 = std::max(max2, std::fabs(static_cast<double>(v[i + 2])));
+			max3 = std::max(max3, std::fabs(static_cast<double>(v[i + 3])));
+		}
+
+		for (; i < end; ++i)
+		{
+			max0 = std::max(max0, std::fabs(static_cast<double>(v[i])));
+		}
+
+		return std::max(std::max(max0, max1), std::max(max2, max3));
+	}
+
+	namespace
+	{
+		// Matrix rows and vector elements of the 7-point stencil on the line (j, k).
+		// The neighbor lines outside the domain point to the zero lines, so the
+		// stencil has no branch in Y and Z and the terms are summed in the same
+		// order as with the branches.
+		struct StencilLine3
+		{
+			StencilLine3(const FDMMatrix3& m, const FDMVector3& v, size_t j, size_t k,
+				const FDMMatrixRow3* zeroRows, const double* zeroLine)
+			{
+				const Size3 size = m.size();
+
+				mc = &m(0, j, k);
+				md = (j > 0) ? &m(0, j - 1, k) : zeroRows;
+				mb = (k > 0) ? &m(0, j, k - 1) : zeroRows;
+				vc = &v(0, j, k);
+				vd = (j > 0) ? &v(0, j - 1, k) : zeroLine;
+				vu = (j + 1 < size.y) ? &v(0, j + 1, k) : zeroLine;
+				vb = (k > 0) ? &v(0, j, k - 1) : zeroLine;
+				vf = (k + 1 < size.z) ? &v(0, j, k + 1) : zeroLine;
+			}
+
+			const FDMMatrixRow3* mc;
+			const FDMMatrixRow3* md;
+			const FDMMatrixRow3* mb;
+			const double* vc;
+			const double* vd;
+			const double* vu;
+			const double* vb;
+			const double* vf;
+		};
+	}
+
+	// Parallel dot product. The partial sums are gathered in a fixed order, so
+	// the result is bitwise identical for a given number of threads.
+	template <typename T>
+	static double ParallelDot(const T* a, const T* b, size_t n)
+	{
+		return ParallelReduce(ZERO_SIZE, n, 0.0,
+			[&](size_t start, size_t end, double init)
+		{
+			return init + DotRange(a, b, start, end);
+		}, std::plus<double>());
+	}
+
+	template <typename T>
+	static double ParallelAbsMax(const T* v, size_t n)
+	{
+		const double& (*_max)(const double&, const double&) = std::max<double>;
+
+		return ParallelReduce(ZERO_SIZE, n, 0.0,
+			[&](size_t start, size_t end, double init)
+		{
+			return std::max(init, AbsMaxRange(v, start, end));
+		}, _max);
+	}
+
+	// Evaluates Ax (or b - Ax if IsResidual) of the matrix-free operator along
+	// all x-lines. The neighbor lines outside the domain point to a line of
+	// boundary markers and zeros, and the marker tests are converted to 0/1
+	// factors, so the loop over the interior points is branch-free.
+	template <bool IsResidual>
+	static void MatrixFreeStencil(const FDMMatrixFree3& a, const FDMVector3& x, const FDMVector3* b, FDMVector3* result)
+	{
+		const Size3 size = a.size();
+
+		assert(size == x.size());
+		assert(size == result->size());
+
+		if (size.x == 0 || size.y == 0 || size.z == 0)
+		{
+			return;
+		}
+
+		const std::vector<char> boundaryLine(size.x, FDMMatrixFree3::BOUNDARY);
+		const std::vector<double> zeroLine(size.x, 0.0);
+		const Vector3D invHSqr = a.invHSqr;
+
+		ParallelFor(ZERO_SIZE, size.y * size.z, [&](size_t n)
+		{
+			const size_t j = n % size.y;
+			const size_t k = n / size.y;
+			const bool hasDown = j > 0;
+			const bool hasUp = j + 1 < size.y;
+			const bool hasBack = k > 0;
+			const bool hasFront = k + 1 < size.z;
+
+			const char* m = &a.markers(0, j, k);
+			const char* mDown = hasDown ? &a.markers(0, j - 1, k) : boundaryLine.data();
+			const char* mUp = hasUp ? &a.markers(0, j + 1, k) : boundaryLine.data();
+			const char* mBack = hasBack ? &a.markers(0, j, k - 1) : boundaryLine.data();
+			const char* mFront = hasFront ? &a.markers(0, j, k + 1) : boundaryLine.data();
+
+			const double* xc = &x(0, j, k);
+			const double* xDown = hasDown ? &x(0, j - 1, k) : zeroLine.data();
+			const double* xUp = hasUp ? &x(0, j + 1, k) : zeroLine.data();
+			const double* xBack = hasBack ? &x(0, j, k - 1) : zeroLine.data();
+			const double* xFront = hasFront ? &x(0, j, k + 1) : zeroLine.data();
+
+			const double* rhs = IsResidual ? &(*b)(0, j, k) : nullptr;
+			double* out = &(*result)(0, j, k);
+
+			auto apply = [&](size_t i, char mLeft, double xLeft, char mRight, double xRight)
+			{
+				const double center =
+					invHSqr.x * (static_cast<double>(mLeft != FDMMatrixFree3::BOUNDARY) + static_cast<double>(mRight != FDMMatrixFree3::BOUNDARY)) +
+					invHSqr.y * (static_cast<double>(mDown[i] != FDMMatrixFree3::BOUNDARY) + static_cast<double>(mUp[i] != FDMMatrixFree3::BOUNDARY)) +
+					invHSqr.z * (static_cast<double>(mBack[i] != FDMMatrixFree3::BOUNDARY) + static_cast<double>(mFront[i] != FDMMatrixFree3::BOUNDARY));
+
+				const double neighbors =
+					invHSqr.x * (static_cast<double>(mLeft == FDMMatrixFree3::FLUID) * xLeft + static_cast<double>(mRight == FDMMatrixFree3::FLUID) * xRight) +
+					invHSqr.y * (static_cast<double>(mDown[i] == FDMMatrixFree3::FLUID) * xDown[i] + static_cast<double>(mUp[i] == FDMMatrixFree3::FLUID) * xUp[i]) +
+					invHSqr.z * (static_cast<double>(mBack[i] == FDMMatrixFree3::FLUID) * xBack[i] + static_cast<double>(mFront[i] == FDMMatrixFree3::FLUID) * xFront[i]);
+
+				const double ax = (m[i] == FDMMatrixFree3::FLUID) ? center * xc[i] - neighbors : xc[i];
+
+				out[i] = IsResidual ? rhs[i] - ax : ax;
+			};
+
+			const size_t last = size.x - 1;
+
+			if (size.x == 1)
+			{
+				apply(0, FDMMatrixFree3::BOUNDARY, 0.0, FDMMatrixFree3::BOUNDARY, 0.0);
+				return;
+			}
+
+			apply(0, FDMMatrixFree3::BOUNDARY, 0.0, m[1], xc[1]);
+
+			for (size_t i = 1; i < last; ++i)
+			{
+				apply(i, m[i - 1], xc[i - 1], m[i + 1], xc[i + 1]);
+			}
+
+			apply(last, m[last - 1], xc[last - 1], FDMMatrixFree3::BOUNDARY, 0.0);
+		});
+	}
+
 	void FDMLinearSystem3::Clear()
 	{
 		A.Clear();
@@ -34,6 +229,69 @@ namespace CubbyFlow
         b.Clear();
 	}
 
+	constexpr char FDMMatrixFree3::FLUID;
+	constexpr char FDMMatrixFree3::AIR;
+	constexpr char FDMMatrixFree3::BOUNDARY;
+
+	Size3 FDMMatrixFree3::size() const
+	{
+		return markers.size();
+	}
+
+	void FDMMatrixFree3::Clear()
+	{
+		markers.Clear();
+	}
+
+	void FDMMatrixFree3::Row(size_t i, size_t j, size_t k, const FDMVector3& x,
+		double* center, double* offDiagonal) const
+	{
+		*center = 1.0;
+		*offDiagonal = 0.0;
+
+		if (markers(i, j, k) != FLUID)
+		{
+			return;
+		}
+
+		const Size3 size = markers.size();
+		*center = 0.0;
+
+		auto addNeighbor = [&](bool isInside, size_t ni, size_t nj, size_t nk, double invHSqrAxis)
+		{
+			if (isInside && markers(ni, nj, nk) != BOUNDARY)
+			{
+				*center += invHSqrAxis;
+
+				if (markers(ni, nj, nk) == FLUID)
+				{
+					*offDiagonal -= invHSqrAxis * x(ni, nj, nk);
+				}
+			}
+		};
+
+		addNeighbor(i > 0, i - 1, j, k, invHSqr.x);
+		addNeighbor(i + 1 < size.x, i + 1, j, k, invHSqr.x);
+		addNeighbor(j > 0, i, j - 1, k, invHSqr.y);
+		addNeighbor(j + 1 < size.y, i, j + 1, k, invHSqr.y);
+		addNeighbor(k > 0, i, j, k - 1, invHSqr.z);
+		addNeighbor(k + 1 < size.z, i, j, k + 1, invHSqr.z);
+	}
+
+	void FDMMatrixFreeLinearSystem3::Clear()
+	{
+		A.Clear();
+		x.Clear();
+		b.Clear();
+	}
+
+	void FDMMatrixFreeLinearSystem3::Resize(const Size3& size)
+	{
+		A.markers.Resize(size, FDMMatrixFree3::AIR);
+		x.Resize(size);
+		b.Resize(size);
+	}
+
 	void FDMBLAS3::Set(double s, FDMVector3* result)
 	{
 		result->Set(s);
@@ -62,34 +320,279 @@ namespace CubbyFlow
 
 		assert(size == b.size());
 
-		double result = 0.0;
+		return ParallelDot(a.data(), b.data(), size.x * size.y * size.z);
+	}
+
+	void FDMBLAS3::AXPlusY(double a, const FDMVector3& x, const FDMVector3& y, FDMVector3* result)
+	{
+		assert(x.size() == y.size());
+		assert(x.size() == result->size());
 
-		for (size_t k = 0; k < size.z; ++k)
+		x.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
-			for (size_t j = 0; j < size.y; ++j)
+			(*result)(i, j, k) = a * x(i, j, k) + y(i, j, k);
+		});
+	}
+
+	void FDMBLAS3::MVM(const FDMMatrix3& m, const FDMVector3& v, FDMVector3* result)
+	{
+		Size3 size = m.size();
+
+		assert(size == v.size());
+		assert(size == result->size());
+
+		const std::vector<FDMMatrixRow3> zeroRows(size.x);
+		const std::vector<double> zeroLine(size.x, 0.0);
+
+		m.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+		{
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				for (size_t i = 0; i < size.x; ++i)
+				for (size_t j = jBegin; j < jEnd; ++j)
 				{
-					result += a(i, j, k) * b(i, j, k);
+					const StencilLine3 s(m, v, j, k, zeroRows.data(), zeroLine.data());
+					double* out = &(*result)(0, j, k);
+
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						const double left = (i > 0) ? s.mc[i - 1].right * s.vc[i - 1] : 0.0;
+						const double right = (i + 1 < size.x) ? s.mc[i].right * s.vc[i + 1] : 0.0;
+
+						out[i] =
+							s.mc[i].center * s.vc[i] + left + right +
+							s.md[i].up * s.vd[i] + s.mc[i].up * s.vu[i] +
+							s.mb[i].front * s.vb[i] + s.mc[i].front * s.vf[i];
+					}
 				}
 			}
+		});
+	}
+
+	void FDMBLAS3::Residual(const FDMMatrix3& a, const FDMVector3& x, const FDMVector3& b, FDMVector3* result)
+	{
+		Size3 size = a.size();
+
+		assert(size == x.size());
+		assert(size == b.size());
+		assert(size == result->size());
+
+		const std::vector<FDMMatrixRow3> zeroRows(size.x);
+		const std::vector<double> zeroLine(size.x, 0.0);
+
+		a.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+		{
+			for (size_t k = kBegin; k < kEnd; ++k)
+			{
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					const StencilLine3 s(a, x, j, k, zeroRows.data(), zeroLine.data());
+					const double* bc = &b(0, j, k);
+					double* out = &(*result)(0, j, k);
+
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						const double left = (i > 0) ? s.mc[i - 1].right * s.vc[i - 1] : 0.0;
+						const double right = (i + 1 < size.x) ? s.mc[i].right * s.vc[i + 1] : 0.0;
+
+						out[i] =
+							bc[i] - s.mc[i].center * s.vc[i] - left - right -
+							s.md[i].up * s.vd[i] - s.mc[i].up * s.vu[i] -
+							s.mb[i].front * s.vb[i] - s.mc[i].front * s.vf[i];
+					}
+				}
+			}
+		});
+	}
+
+	double FDMBLAS3::L2Norm(const FDMVector3& v)
+	{
+		return std::sqrt(Dot(v, v));
+	}
+
+	double FDMBLAS3::LInfNorm(const FDMVector3& v)
+	{
+		Size3 size = v.size();
+
+		return ParallelAbsMax(v.data(), size.x * size.y * size.z);
+	}
+
+	double FDMBLAS3::MVMDot(const FDMMatrix3& m, const FDMVector3& v, FDMVector3* result)
+	{
+		const Size3 size = m.size();
+
+		assert(size == v.size());
+		assert(size == result->size());
+
+		if (size.x == 0 || size.y == 0 || size.z == 0)
+		{
+			return 0.0;
 		}
 
-		return result;
+		// The neighbor lines outside the domain point to zero lines, so the
+		// terms are summed in the same order as MVM without a branch per point.
+		const std::vector<FDMMatrixRow3> zeroRows(size.x);
+		const std::vector<double> zeroLine(size.x, 0.0);
+
+		return ParallelReduce(ZERO_SIZE, size.y * size.z, 0.0,
+			[&](size_t start, size_t end, double init)
+		{
+			for (size_t line = start; line < end; ++line)
+			{
+				const size_t j = line % size.y;
+				const size_t k = line / size.y;
+
+				const StencilLine3 s(m, v, j, k, zeroRows.data(), zeroLine.data());
+				double* out = &(*result)(0, j, k);
+
+				double sum = 0.0;
+				for (size_t i = 0; i < size.x; ++i)
+				{
+					const double left = (i > 0) ? s.mc[i - 1].right * s.vc[i - 1] : 0.0;
+					const double right = (i + 1 < size.x) ? s.mc[i].right * s.vc[i + 1] : 0.0;
+
+					const double ax =
+						s.mc[i].center * s.vc[i] + left + right +
+						s.md[i].up * s.vd[i] + s.mc[i].up * s.vu[i] +
+						s.mb[i].front * s.vb[i] + s.mc[i].front * s.vf[i];
+
+					out[i] = ax;
+					sum += s.vc[i] * ax;
+				}
+
+				init += sum;
+			}
+
+			return init;
+		}, std::plus<double>());
 	}
 
-	void FDMBLAS3::AXPlusY(double a, const FDMVector3& x, const FDMVector3& y, FDMVector3* result)
+	double FDMBLAS3::CGUpdate(double alpha, const FDMVector3& d, const FDMVector3& q,
+		FDMVector3* x, FDMVector3* r)
+	{
+		const Size3 size = d.size();
+
+		assert(size == q.size());
+		assert(size == x->size());
+		assert(size == r->size());
+
+		const double* dp = d.data();
+		const double* qp = q.data();
+		double* xp = x->data();
+		double* rp = r->data();
+
+		return ParallelReduce(ZERO_SIZE, size.x * size.y * size.z, 0.0,
+			[&](size_t start, size_t end, double init)
+		{
+			for (size_t blockStart = start; blockStart < end; blockStart += FUSED_BLOCK_SIZE)
+			{
+				const size_t blockEnd = std::min(blockStart + FUSED_BLOCK_SIZE, end);
+
+				for (size_t i = blockStart; i < blockEnd; ++i)
+				{
+					xp[i] = alpha * dp[i] + xp[i];
+					rp[i] = -alpha * qp[i] + rp[i];
+				}
+
+				init += DotRange(rp, rp, blockStart, blockEnd);
+			}
+
+			return init;
+		}, std::plus<double>());
+	}
+
+	void FDMBLAS3::PipelinedCGUpdate(double alpha, double beta,
+		const FDMVector3& n, const FDMVector3& m,
+		FDMVector3* z, FDMVector3* q, FDMVector3* s, FDMVector3* p,
+		FDMVector3* x, FDMVector3* r, FDMVector3* u, FDMVector3* w,
+		double* ru, double* wu)
+	{
+		const Size3 size = n.size();
+
+		assert(size == m.size());
+		assert(size == z->size() && size == q->size() && size == s->size() && size == p->size());
+		assert(size == x->size() && size == r->size() && size == u->size() && size == w->size());
+
+		const double* np = n.data();
+		const double* mp = m.data();
+		double* zp = z->data();
+		double* qp = q->data();
+		double* sp = s->data();
+		double* pp = p->data();
+		double* xp = x->data();
+		double* rp = r->data();
+		double* up = u->data();
+		double* wp = w->data();
+
+		const Vector2D dots = ParallelReduce(ZERO_SIZE, size.x * size.y * size.z, Vector2D(),
+			[&](size_t start, size_t end, Vector2D init)
+		{
+			for (size_t blockStart = start; blockStart < end; blockStart += FUSED_BLOCK_SIZE)
+			{
+				const size_t blockEnd = std::min(blockStart + FUSED_BLOCK_SIZE, end);
+
+				for (size_t i = blockStart; i < blockEnd; ++i)
+				{
+					zp[i] = beta * zp[i] + np[i];
+					qp[i] = beta * qp[i] + mp[i];
+					sp[i] = beta * sp[i] + wp[i];
+					pp[i] = beta * pp[i] + up[i];
+					xp[i] = alpha * pp[i] + xp[i];
+					rp[i] = -alpha * sp[i] + rp[i];
+					up[i] = -alpha * qp[i] + up[i];
+					wp[i] = -alpha * zp[i] + wp[i];
+				}
+
+				init += Vector2D(DotRange(rp, up, blockStart, blockEnd), DotRange(wp, up, blockStart, blockEnd));
+			}
+
+			return init;
+		}, std::plus<Vector2D>());
+
+		*ru = dots.x;
+		*wu = dots.y;
+	}
+
+	void FDMBLAS3F::Set(double s, FDMVector3F* result)
+	{
+		result->Set(static_cast<float>(s));
+	}
+
+	void FDMBLAS3F::Set(const FDMVector3F& v, FDMVector3F* result)
+	{
+		result->Set(v);
+	}
+
+	void FDMBLAS3F::Set(double s, FDMMatrix3* result)
+	{
+		FDMBLAS3::Set(s, result);
+	}
+
+	void FDMBLAS3F::Set(const FDMMatrix3& m, FDMMatrix3* result)
+	{
+		FDMBLAS3::Set(m, result);
+	}
+
+	double FDMBLAS3F::Dot(const FDMVector3F& a, const FDMVector3F& b)
+	{
+		Size3 size = a.size();
+
+		assert(size == b.size());
+
+		return ParallelDot(a.data(), b.data(), size.x * size.y * size.z);
+	}
+
+	void FDMBLAS3F::AXPlusY(double a, const FDMVector3F& x, const FDMVector3F& y, FDMVector3F* result)
 	{
 		assert(x.size() == y.size());
 		assert(x.size() == result->size());
 
 		x.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
-			(*result)(i, j, k) = a * x(i, j, k) + y(i, j, k);
+			(*result)(i, j, k) = static_cast<float>(a * x(i, j, k) + y(i, j, k));
 		});
 	}
 
-	void FDMBLAS3::MVM(const FDMMatrix3& m, const FDMVector3& v, FDMVector3* result)
+	void FDMBLAS3F::MVM(const FDMMatrix3& m, const FDMVector3F& v, FDMVector3F* result)
 	{
 		Size3 size = m.size();
 
@@ -98,18 +601,18 @@ namespace CubbyFlow
 
 		m.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
-			(*result)(i, j, k) =
+			(*result)(i, j, k) = static_cast<float>(
 				m(i, j, k).center * v(i, j, k) +
 				((i > 0) ? m(i - 1, j, k).right * v(i - 1, j, k) : 0.0) +
 				((i + 1 < size.x) ? m(i, j, k).right * v(i + 1, j, k) : 0.0) +
 				((j > 0) ? m(i, j - 1, k).up * v(i, j - 1, k) : 0.0) +
 				((j + 1 < size.y) ? m(i, j, k).up * v(i, j + 1, k) : 0.0) +
 				((k > 0) ? m(i, j, k - 1).front * v(i, j, k - 1) : 0.0) +
-				((k + 1 < size.z) ? m(i, j, k).front * v(i, j, k + 1) : 0.0);
+				((k + 1 < size.z) ? m(i, j, k).front * v(i, j, k + 1) : 0.0));
 		});
 	}
 
-	void FDMBLAS3::Residual(const FDMMatrix3& a, const FDMVector3& x, const FDMVector3& b, FDMVector3* result)
+	void FDMBLAS3F::Residual(const FDMMatrix3& a, const FDMVector3F& x, const FDMVector3F& b, FDMVector3F* result)
 	{
 		Size3 size = a.size();
 
@@ -119,7 +622,7 @@ namespace CubbyFlow
 
 		a.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
-			(*result)(i, j, k) =
+			(*result)(i, j, k) = static_cast<float>(
 				b(i, j, k) -
 				a(i, j, k).center * x(i, j, k) -
 				((i > 0) ? a(i - 1, j, k).right * x(i - 1, j, k) : 0.0) -
@@ -127,32 +630,90 @@ namespace CubbyFlow
 				((j > 0) ? a(i, j - 1, k).up * x(i, j - 1, k) : 0.0) -
 				((j + 1 < size.y) ? a(i, j, k).up * x(i, j + 1, k) : 0.0) -
 				((k > 0) ? a(i, j, k - 1).front * x(i, j, k - 1) : 0.0) -
-				((k + 1 < size.z) ? a(i, j, k).front * x(i, j, k + 1) : 0.0);
+				((k + 1 < size.z) ? a(i, j, k).front * x(i, j, k + 1) : 0.0));
 		});
 	}
 
-	double FDMBLAS3::L2Norm(const FDMVector3& v)
+	void FDMBLAS3F::Residual(const FDMMatrix3& a, const FDMVector3& x, const FDMVector3& b, FDMVector3F* result)
+	{
+		Size3 size = a.size();
+
+		assert(size == x.size());
+		assert(size == b.size());
+		assert(size == result->size());
+
+		a.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			(*result)(i, j, k) = static_cast<float>(
+				b(i, j, k) -
+				a(i, j, k).center * x(i, j, k) -
+				((i > 0) ? a(i - 1, j, k).right * x(i - 1, j, k) : 0.0) -
+				((i + 1 < size.x) ? a(i, j, k).right * x(i + 1, j, k) : 0.0) -
+				((j > 0) ? a(i, j - 1, k).up * x(i, j - 1, k) : 0.0) -
+				((j + 1 < size.y) ? a(i, j, k).up * x(i, j + 1, k) : 0.0) -
+				((k > 0) ? a(i, j, k - 1).front * x(i, j, k - 1) : 0.0) -
+				((k + 1 < size.z) ? a(i, j, k).front * x(i, j, k + 1) : 0.0));
+		});
+	}
+
+	double FDMBLAS3F::L2Norm(const FDMVector3F& v)
 	{
 		return std::sqrt(Dot(v, v));
 	}
 
-	double FDMBLAS3::LInfNorm(const FDMVector3& v)
+	double FDMBLAS3F::LInfNorm(const FDMVector3F& v)
 	{
 		Size3 size = v.size();
-		double result = 0.0;
 
-		for (size_t k = 0; k < size.z; ++k)
-		{
-			for (size_t j = 0; j < size.y; ++j)
-			{
-				for (size_t i = 0; i < size.x; ++i)
-				{
-					result = AbsMax(result, v(i, j, k));
-				}
-			}
-		}
+		return ParallelAbsMax(v.data(), size.x * size.y * size.z);
+	}
+
+	void FDMMatrixFreeBLAS3::Set(double s, FDMVector3* result)
+	{
+		result->Set(s);
+	}
+
+	void FDMMatrixFreeBLAS3::Set(const FDMVector3& v, FDMVector3* result)
+	{
+		result->Set(v);
+	}
+
+	void FDMMatrixFreeBLAS3::Set(const FDMMatrixFree3& m, FDMMatrixFree3* result)
+	{
+		result->markers.Set(m.markers);
+		result->invHSqr = m.invHSqr;
+	}
+
+	double FDMMatrixFreeBLAS3::Dot(const FDMVector3& a, const FDMVector3& b)
+	{
+		return FDMBLAS3::Dot(a, b);
+	}
 
-		return std::fabs(result);
+	void FDMMatrixFreeBLAS3::AXPlusY(double a, const FDMVector3& x, const FDMVector3& y, FDMVector3* result)
+	{
+		FDMBLAS3::AXPlusY(a, x, y, result);
+	}
+
+	void FDMMatrixFreeBLAS3::MVM(const FDMMatrixFree3& m, const FDMVector3& v, FDMVector3* result)
+	{
+		MatrixFreeStencil<false>(m, v, nullptr, result);
+	}
+
+	void FDMMatrixFreeBLAS3::Residual(const FDMMatrixFree3& a, const FDMVector3& x, const FDMVector3& b, FDMVector3* result)
+	{
+		assert(a.size() == b.size());
+
+		MatrixFreeStencil<true>(a, x, &b, result);
+	}
+
+	double FDMMatrixFreeBLAS3::L2Norm(const FDMVector3& v)
+	{
+		return FDMBLAS3::L2Norm(v);
+	}
+
+	double FDMMatrixFreeBLAS3::LInfNorm(const FDMVector3& v)
+	{
+		return FDMBLAS3::LInfNorm(v);
 	}
 
     void FDMCompressedBLAS3::Set(double s, VectorND* result)
@@ -177,7 +738,9 @@ namespace CubbyFlow
 
     double FDMCompressedBLAS3::Dot(const VectorND& a, const VectorND& b)
     {
-        return a.Dot(b);
+        assert(a.size() == b.size());
+
+        return ParallelDot(a.data(), b.data(), a.size());
     }
 
     void FDMCompressedBLAS3::AXPlusY(double a, const VectorND& x, const VectorND& y, VectorND* result)
@@ -187,25 +750,7 @@ namespace CubbyFlow
 
     void FDMCompressedBLAS3::MVM(const MatrixCSRD& m, const VectorND& v, VectorND* result)
     {
-        const auto rp = m.RowPointersBegin();
-        const auto ci = m.ColumnIndicesBegin();
-        const auto nnz = m.NonZeroBegin();
-
-        v.ParallelForEachIndex([&](size_t i)
-        {
-            const size_t rowBegin = rp[i];
-            const size_t rowEnd = rp[i + 1];
-
-            double sum = 0.0;
-
-            for (size_t jj = rowBegin; jj < rowEnd; ++jj)
-            {
-                size_t j = ci[jj];
-                sum += nnz[jj] * v[j];
-            }
-
-            (*result)[i] = sum;
-        });
+        m.MVM(v, result);
     }
 
     void FDMCompressedBLAS3::Residual(const MatrixCSRD& a, const VectorND& x, const VectorND& b, VectorND* result)
@@ -214,30 +759,30 @@ namespace CubbyFlow
         const auto ci = a.ColumnIndicesBegin();
         const auto nnz = a.NonZeroBegin();
 
-        x.ParallelForEachIndex([&](size_t i)
+        a.ParallelForEachRowRange([&](size_t rowBegin, size_t rowEnd)
         {
-            const size_t rowBegin = rp[i];
-            const size_t rowEnd = rp[i + 1];
+            for (size_t i = rowBegin; i < rowEnd; ++i)
+            {
+                double sum = 0.0;
 
-            double sum = 0.0;
+                for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+                {
+                    size_t j = ci[jj];
+                    sum += nnz[jj] * x[j];
+                }
 
-            for (size_t jj = rowBegin; jj < rowEnd; ++jj)
-            {
-                size_t j = ci[jj];
-                sum += nnz[jj] * x[j];
+                (*result)[i] = b[i] - sum;
             }
-
-            (*result)[i] = b[i] - sum;
         });
     }
 
     double FDMCompressedBLAS3::L2Norm(const VectorND& v)
     {
-        return std::sqrt(v.Dot(v));
+        return std::sqrt(Dot(v, v));
     }
 
     double FDMCompressedBLAS3::LInfNorm(const VectorND& v)
     {
-        return std::fabs(v.AbsMax());
+        return ParallelAbsMax(v.data(), v.size());
     }
 }
\ No newline at end of file
@@ -36,6 +36,18 @@ namespace CubbyFlow
 		FDMMGUtils3::ResizeArrayWithFinest(finestResolution, maxNumberOfLevels, &b.levels);
 	}
 
+	void FDMMGMatrixFreeLinearSystem3::Clear()
+	{
+		A.levels.clear();
+		x.levels.clear();
+		b.levels.clear();
+	}
+
+	size_t FDMMGMatrixFreeLinearSystem3::GetNumberOfLevels() const
+	{
+		return A.levels.size();
+	}
+
 	void FDMMGUtils3::Restrict(const FDMVector3 &finer, FDMVector3 *coarser)
 	{
 		assert(finer.size().x == 2 * coarser->size().x);
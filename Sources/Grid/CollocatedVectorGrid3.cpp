@@ -88,7 +88,7 @@ namespace CubbyFlow
 
 	Vector3D CollocatedVectorGrid3::Sample(const Vector3D& x) const
 	{
-		return m_sampler(x);
+		return m_linearSampler(x);
 	}
 
 	double CollocatedVectorGrid3::Divergence(const Vector3D& x) const
@@ -126,6 +126,16 @@ namespace CubbyFlow
 		return m_sampler;
 	}
 
+	const LinearArraySampler3<Vector3D, double>& CollocatedVectorGrid3::LinearSampler() const
+	{
+		return m_linearSampler;
+	}
+
+	CubicArraySampler3<Vector3D, double> CollocatedVectorGrid3::CubicSampler() const
+	{
+		return CubicArraySampler3<Vector3D, double>(m_data.ConstAccessor(), GridSpacing(), GetDataOrigin());
+	}
+
 	VectorGrid3::VectorDataAccessor CollocatedVectorGrid3::GetDataAccessor()
 	{
 		return m_data.Accessor();
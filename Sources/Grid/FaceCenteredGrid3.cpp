@@ -400,7 +400,7 @@ namespace CubbyFlow
 
 	Vector3D FaceCenteredGrid3::Sample(const Vector3D& x) const
 	{
-		return m_sampler(x);
+		return Vector3D(m_uLinearSampler(x), m_vLinearSampler(x), m_wLinearSampler(x));
 	}
 
 	std::function<Vector3D(const Vector3D&)> FaceCenteredGrid3::Sampler() const
@@ -408,6 +408,19 @@ namespace CubbyFlow
 		return m_sampler;
 	}
 
+	FaceCenteredGridSampler3<LinearArraySampler3<double, double>> FaceCenteredGrid3::LinearSampler() const
+	{
+		return FaceCenteredGridSampler3<LinearArraySampler3<double, double>>(m_uLinearSampler, m_vLinearSampler, m_wLinearSampler);
+	}
+
+	FaceCenteredGridSampler3<CubicArraySampler3<double, double>> FaceCenteredGrid3::CubicSampler() const
+	{
+		return FaceCenteredGridSampler3<CubicArraySampler3<double, double>>(
+			CubicArraySampler3<double, double>(m_dataU.ConstAccessor(), GridSpacing(), m_dataOriginU),
+			CubicArraySampler3<double, double>(m_dataV.ConstAccessor(), GridSpacing(), m_dataOriginV),
+			CubicArraySampler3<double, double>(m_dataW.ConstAccessor(), GridSpacing(), m_dataOriginW));
+	}
+
 	double FaceCenteredGrid3::Divergence(const Vector3D& x) const
 	{
 		Size3 res = Resolution();
@@ -529,13 +542,7 @@ namespace CubbyFlow
 		m_vLinearSampler = vSampler;
 		m_wLinearSampler = wSampler;
 
-		m_sampler = [uSampler, vSampler, wSampler](const Vector3D& x) -> Vector3D
-		{
-			double u = uSampler(x);
-			double v = vSampler(x);
-			double w = wSampler(x);
-			return Vector3D(u, v, w);
-		};
+		m_sampler = FaceCenteredGridSampler3<LinearArraySampler3<double, double>>(uSampler, vSampler, wSampler);
 	}
 
 	FaceCenteredGrid3::Builder FaceCenteredGrid3::GetBuilder()
@@ -92,7 +92,7 @@ namespace CubbyFlow
 
 	double ScalarGrid3::Sample(const Vector3D& x) const
 	{
-		return m_sampler(x);
+		return m_linearSampler(x);
 	}
 
 	std::function<double(const Vector3D&)> ScalarGrid3::Sampler() const
@@ -100,6 +100,16 @@ namespace CubbyFlow
 		return m_sampler;
 	}
 
+	const LinearArraySampler3<double, double>& ScalarGrid3::LinearSampler() const
+	{
+		return m_linearSampler;
+	}
+
+	CubicArraySampler3<double, double> ScalarGrid3::CubicSampler() const
+	{
+		return CubicArraySampler3<double, double>(m_data.ConstAccessor(), GridSpacing(), GetDataOrigin());
+	}
+
 	Vector3D ScalarGrid3::Gradient(const Vector3D& x) const
 	{
 		std::array<Point3UI, 8> indices;
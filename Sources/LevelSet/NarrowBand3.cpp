@@ -0,0 +1,235 @@
+/*************************************************************************
+> File Name: NarrowBand3.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D narrow band of grid points around a level set interface.
+> Created Time: 2018/01/11
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <LevelSet/NarrowBand3.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CubbyFlow
+{
+	NarrowBand3::NarrowBand3()
+	{
+		// Do nothing
+	}
+
+	size_t NarrowBand3::size() const
+	{
+		return m_points.size();
+	}
+
+	Size3 NarrowBand3::GetGridSize() const
+	{
+		return m_indices.size();
+	}
+
+	const Point3UI& NarrowBand3::operator[](size_t n) const
+	{
+		return m_points[n];
+	}
+
+	size_t NarrowBand3::IndexOf(size_t i, size_t j, size_t k) const
+	{
+		return m_indices(i, j, k);
+	}
+
+	bool NarrowBand3::Contains(size_t i, size_t j, size_t k) const
+	{
+		return m_indices(i, j, k) != NOT_IN_BAND;
+	}
+
+	std::array<size_t, 6> NarrowBand3::GetNeighbors(size_t n) const
+	{
+		const Size3 size = m_indices.size();
+		const Point3UI& pt = m_points[n];
+
+		std::array<size_t, 6> neighbors;
+		neighbors[0] = (pt.x > 0) ? m_indices(pt.x - 1, pt.y, pt.z) : NOT_IN_BAND;
+		neighbors[1] = (pt.x + 1 < size.x) ? m_indices(pt.x + 1, pt.y, pt.z) : NOT_IN_BAND;
+		neighbors[2] = (pt.y > 0) ? m_indices(pt.x, pt.y - 1, pt.z) : NOT_IN_BAND;
+		neighbors[3] = (pt.y + 1 < size.y) ? m_indices(pt.x, pt.y + 1, pt.z) : NOT_IN_BAND;
+		neighbors[4] = (pt.z > 0) ? m_indices(pt.x, pt.y, pt.z - 1) : NOT_IN_BAND;
+		neighbors[5] = (pt.z + 1 < size.z) ? m_indices(pt.x, pt.y, pt.z + 1) : NOT_IN_BAND;
+
+		return neighbors;
+	}
+
+	size_t NarrowBand3::FaceIndexOf(size_t axis, size_t i, size_t j, size_t k) const
+	{
+		const Size3 size = m_indices.size();
+		Point3UI face(i, j, k);
+
+		for (size_t d = 0; d < 3; ++d)
+		{
+			if (face[d] >= size[d] + (d == axis ? 1 : 0))
+			{
+				return NOT_IN_BAND;
+			}
+		}
+
+		// The low face of the point on the positive side owns the face
+		if (face[axis] < size[axis] && m_indices(face) != NOT_IN_BAND)
+		{
+			return 2 * m_indices(face);
+		}
+
+		if (face[axis] > 0)
+		{
+			--face[axis];
+			if (m_indices(face) != NOT_IN_BAND)
+			{
+				return 2 * m_indices(face) + 1;
+			}
+		}
+
+		return NOT_IN_BAND;
+	}
+
+	void NarrowBand3::Clear()
+	{
+		m_indices.Clear();
+		m_points.clear();
+	}
+
+	void NarrowBand3::Build(ArrayAccessor3<double> sdf, double width)
+	{
+		const Size3 size = sdf.size();
+
+		m_indices.Resize(size, NOT_IN_BAND);
+		m_indices.Set(NOT_IN_BAND);
+		m_points.clear();
+
+		for (size_t k = 0; k < size.z; ++k)
+		{
+			for (size_t j = 0; j < size.y; ++j)
+			{
+				for (size_t i = 0; i < size.x; ++i)
+				{
+					double& phi = sdf(i, j, k);
+					if (std::fabs(phi) < width)
+					{
+						m_indices(i, j, k) = m_points.size();
+						m_points.emplace_back(i, j, k);
+					}
+					else
+					{
+						phi = std::copysign(width, phi);
+					}
+				}
+			}
+		}
+	}
+
+	void NarrowBand3::Dilate(size_t numberOfLayers)
+	{
+		const Size3 size = m_indices.size();
+
+		size_t layerBegin = 0;
+		for (size_t layer = 0; layer < numberOfLayers; ++layer)
+		{
+			const size_t layerEnd = m_points.size();
+
+			for (size_t n = layerBegin; n < layerEnd; ++n)
+			{
+				const Point3UI pt = m_points[n];
+
+				for (size_t d = 0; d < 3; ++d)
+				{
+					Point3UI lower = pt;
+					Point3UI upper = pt;
+
+					if (pt[d] > 0)
+					{
+						--lower[d];
+						if (m_indices(lower) == NOT_IN_BAND)
+						{
+							m_indices(lower) = m_points.size();
+							m_points.push_back(lower);
+						}
+					}
+
+					if (pt[d] + 1 < size[d])
+					{
+						++upper[d];
+						if (m_indices(upper) == NOT_IN_BAND)
+						{
+							m_indices(upper) = m_points.size();
+							m_points.push_back(upper);
+						}
+					}
+				}
+			}
+
+			layerBegin = layerEnd;
+		}
+
+		SortAndReindex();
+	}
+
+	void NarrowBand3::Trim(ArrayAccessor3<double> sdf, double width)
+	{
+		size_t numberOfKeptPoints = 0;
+
+		for (size_t n = 0; n < m_points.size(); ++n)
+		{
+			const Point3UI pt = m_points[n];
+			double& phi = sdf(pt);
+
+			if (std::fabs(phi) < width)
+			{
+				m_indices(pt) = numberOfKeptPoints;
+				m_points[numberOfKeptPoints++] = pt;
+			}
+			else
+			{
+				m_indices(pt) = NOT_IN_BAND;
+				phi = std::copysign(width, phi);
+			}
+		}
+
+		m_points.resize(numberOfKeptPoints);
+	}
+
+	void NarrowBand3::SortAndReindex()
+	{
+		std::sort(m_points.begin(), m_points.end(), [](const Point3UI& a, const Point3UI& b)
+		{
+			if (a.z != b.z)
+			{
+				return a.z < b.z;
+			}
+
+			if (a.y != b.y)
+			{
+				return a.y < b.y;
+			}
+
+			return a.x < b.x;
+		});
+
+		ParallelFor(ZERO_SIZE, m_points.size(), [&](size_t n)
+		{
+			m_indices(m_points[n]) = n;
+		});
+	}
+
+	bool NarrowBand3::GetFace(size_t axis, size_t faceIndex, Point3UI* face) const
+	{
+		*face = m_points[faceIndex / 2];
+
+		if (faceIndex % 2 == 0)
+		{
+			return true;
+		}
+
+		// The high face is skipped if it is the low face of another point
+		++(*face)[axis];
+
+		return (*face)[axis] >= m_indices.size()[axis] || m_indices(*face) == NOT_IN_BAND;
+	}
+}
\ No newline at end of file
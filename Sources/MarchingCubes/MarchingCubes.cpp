@@ -24,8 +24,11 @@
 #include <MarchingCubes/MarchingCubes.h>
 #include <MarchingCubes/MarchingCubesTable.h>
 #include <MarchingCubes/MarchingSquaresTable.h>
+#include <Utils/Parallel.h>
 
+#include <algorithm>
 #include <unordered_map>
+#include <vector>
 
 namespace CubbyFlow
 {
@@ -280,14 +283,14 @@ namespace CubbyFlow
 		}
 	}
 
+	template <typename VertexIDFunc, typename TriangleFunc>
 	static void SingleCube(
 		const std::array<double, 8>& data,
-		const std::array<size_t, 12>& edgeIDs,
 		const std::array<Vector3D, 8>& normals,
 		const BoundingBox3D& bound,
-		MarchingCubeVertexMap* vertexMap,
-		TriangleMesh3* mesh,
-		double isoValue)
+		double isoValue,
+		const VertexIDFunc& getVertexID,
+		const TriangleFunc& addTriangle)
 	{
 		int idxFlagSize = 0;
 		int idxVertexOfTheEdge[2];
@@ -370,36 +373,23 @@ namespace CubbyFlow
 
 			for (int j = 0; j < 3; ++j)
 			{
-				int k = 3 * iterTri + j;
-				MarchingCubeVertexHashKey vKey = edgeIDs[triangleConnectionTable3D[idxFlagSize][k]];
-				MarchingCubeVertexID vID;
+				int edge = triangleConnectionTable3D[idxFlagSize][3 * iterTri + j];
 
-				if (QueryVertexID(*vertexMap, vKey, &vID))
-				{
-					face[j] = vID;
-				}
-				else
-				{
-					// If vertex does not exist from the map
-					face[j] = mesh->NumberOfPoints();
-					mesh->AddNormal(SafeNormalize(n[triangleConnectionTable3D[idxFlagSize][k]]));
-					mesh->AddPoint(e[triangleConnectionTable3D[idxFlagSize][k]]);
-					mesh->AddUV(Vector2D());
-					vertexMap->insert(std::make_pair(vKey, face[j]));
-				}
+				face[j] = getVertexID(edge, e[edge], n[edge]);
 			}
 
-			mesh->AddPointUVNormalTriangle(face, face, face);
+			addTriangle(face);
 		}
 	}
 
-	void MarchingCubes(
+	// Triangulates the cubes with serial k/j/i loops and welds the vertices
+	// through a hash map of the global edge IDs.
+	static void TriangulateCubesSerial(
 		const ConstArrayAccessor3<double>& grid,
 		const Vector3D& gridSize,
 		const Vector3D& origin,
 		TriangleMesh3* mesh,
-		double isoValue,
-		int bndFlag)
+		double isoValue)
 	{
 		MarchingCubeVertexMap vertexMap;
 
@@ -452,11 +442,336 @@ namespace CubbyFlow
 					bound.lowerCorner = pos(i, j, k);
 					bound.upperCorner = pos(i + 1, j + 1, k + 1);
 
-					SingleCube(data, edgeIDs, normals, bound, &vertexMap, mesh, isoValue);
+					SingleCube(data, normals, bound, isoValue,
+						[&](int edge, const Vector3D& point, const Vector3D& normal)
+					{
+						MarchingCubeVertexHashKey vKey = edgeIDs[edge];
+						MarchingCubeVertexID vID;
+
+						if (!QueryVertexID(vertexMap, vKey, &vID))
+						{
+							// If vertex does not exist from the map
+							vID = mesh->NumberOfPoints();
+							mesh->AddNormal(SafeNormalize(normal));
+							mesh->AddPoint(point);
+							mesh->AddUV(Vector2D());
+							vertexMap.insert(std::make_pair(vKey, vID));
+						}
+
+						return vID;
+					},
+						[&](const Point3UI& face)
+					{
+						mesh->AddPointUVNormalTriangle(face, face, face);
+					});
+				}
+			}
+		}
+	}
+
+	// Triangles and vertices of a z-slab of cubes. The vertex IDs are local to
+	// the slab until the slabs are stitched together.
+	struct MarchingCubesSlab
+	{
+		std::vector<Vector3D> points;
+		std::vector<Vector3D> normals;
+		std::vector<Point3UI> triangles;
+
+		// (edge index in the plane, local vertex ID) of the bottom and the top planes
+		std::vector<std::pair<size_t, size_t>> bottomVertices;
+		std::vector<std::pair<size_t, size_t>> topVertices;
+
+		// Local vertex ID to global vertex ID
+		std::vector<size_t> globalIDs;
+		size_t numberOfNewVertices = 0;
+	};
+
+	// Triangulates the cubes of [kBegin, kEnd) z-slab. The edge vertices are
+	// welded with dense per-plane ID arrays, in the same order as the serial
+	// k/j/i loops.
+	static void TriangulateSlab(
+		const ConstArrayAccessor3<double>& grid,
+		const Vector3D& gridSize,
+		const Vector3D& origin,
+		double isoValue,
+		size_t kBegin, size_t kEnd,
+		MarchingCubesSlab* slab)
+	{
+		static const size_t NO_VERTEX = std::numeric_limits<size_t>::max();
+
+		const Size3 dim = grid.size();
+		const Vector3D invGridSize = 1.0 / gridSize;
+		const size_t planeSize = dim.x * dim.y;
+
+		auto pos = [origin, gridSize](ssize_t i, ssize_t j, ssize_t k)
+		{
+			return origin + gridSize * Vector3D({ i, j, k });
+		};
+
+		// x-edges and then y-edges of the bottom and the top planes, and the
+		// z-edges in between
+		std::vector<size_t> bottomPlane(2 * planeSize, NO_VERTEX);
+		std::vector<size_t> topPlane(2 * planeSize, NO_VERTEX);
+		std::vector<size_t> zEdges(planeSize, NO_VERTEX);
+
+		for (size_t k = kBegin; k < kEnd; ++k)
+		{
+			for (size_t j = 0; j + 1 < dim.y; ++j)
+			{
+				for (size_t i = 0; i + 1 < dim.x; ++i)
+				{
+					std::array<double, 8> data;
+
+					data[0] = grid(i, j, k);
+					data[1] = grid(i + 1, j, k);
+					data[4] = grid(i, j + 1, k);
+					data[5] = grid(i + 1, j + 1, k);
+					data[3] = grid(i, j, k + 1);
+					data[2] = grid(i + 1, j, k + 1);
+					data[7] = grid(i, j + 1, k + 1);
+					data[6] = grid(i + 1, j + 1, k + 1);
+
+					// Skip the cubes that do not intersect the surface
+					size_t numberOfInsideVertices = 0;
+					for (double value : data)
+					{
+						numberOfInsideVertices += (value <= isoValue) ? 1 : 0;
+					}
+
+					if (numberOfInsideVertices == 0 || numberOfInsideVertices == 8)
+					{
+						continue;
+					}
+
+					std::array<Vector3D, 8> normals;
+					const ssize_t si = static_cast<ssize_t>(i);
+					const ssize_t sj = static_cast<ssize_t>(j);
+					const ssize_t sk = static_cast<ssize_t>(k);
+
+					normals[0] = Grad(grid, si, sj, sk, invGridSize);
+					normals[1] = Grad(grid, si + 1, sj, sk, invGridSize);
+					normals[4] = Grad(grid, si, sj + 1, sk, invGridSize);
+					normals[5] = Grad(grid, si + 1, sj + 1, sk, invGridSize);
+					normals[3] = Grad(grid, si, sj, sk + 1, invGridSize);
+					normals[2] = Grad(grid, si + 1, sj, sk + 1, invGridSize);
+					normals[7] = Grad(grid, si, sj + 1, sk + 1, invGridSize);
+					normals[6] = Grad(grid, si + 1, sj + 1, sk + 1, invGridSize);
+
+					BoundingBox3D bound;
+					bound.lowerCorner = pos(si, sj, sk);
+					bound.upperCorner = pos(si + 1, sj + 1, sk + 1);
+
+					// See edgeConnection in MarchingCubesTable.h for the edge ordering.
+					const size_t c = j * dim.x + i;
+					const std::array<size_t*, 12> edgeVertices =
+					{
+						&bottomPlane[c], &zEdges[c + 1], &topPlane[c], &zEdges[c],
+						&bottomPlane[c + dim.x], &zEdges[c + dim.x + 1], &topPlane[c + dim.x], &zEdges[c + dim.x],
+						&bottomPlane[planeSize + c], &bottomPlane[planeSize + c + 1],
+						&topPlane[planeSize + c + 1], &topPlane[planeSize + c]
+					};
+
+					SingleCube(data, normals, bound, isoValue,
+						[&](int edge, const Vector3D& point, const Vector3D& normal)
+					{
+						size_t& vID = *edgeVertices[edge];
+
+						if (vID == NO_VERTEX)
+						{
+							vID = slab->points.size();
+							slab->points.push_back(point);
+							slab->normals.push_back(SafeNormalize(normal));
+
+							// Bottom plane of the slab can be shared with the previous slab
+							const bool isBottomEdge = (edge == 0 || edge == 4 || edge == 8 || edge == 9);
+							if (k == kBegin && isBottomEdge)
+							{
+								slab->bottomVertices.emplace_back(edgeVertices[edge] - bottomPlane.data(), vID);
+							}
+						}
+
+						return vID;
+					},
+						[&](const Point3UI& face)
+					{
+						slab->triangles.push_back(face);
+					});
+				}
+			}
+
+			std::swap(bottomPlane, topPlane);
+			std::fill(topPlane.begin(), topPlane.end(), NO_VERTEX);
+			std::fill(zEdges.begin(), zEdges.end(), NO_VERTEX);
+		}
+
+		// After the swap, the top plane of the last layer is in bottomPlane
+		for (size_t e = 0; e < bottomPlane.size(); ++e)
+		{
+			if (bottomPlane[e] != NO_VERTEX)
+			{
+				slab->topVertices.emplace_back(e, bottomPlane[e]);
+			}
+		}
+	}
+
+	// Triangulates the cubes of z-slabs in parallel and stitches the slabs.
+	// The vertex IDs are assigned with prefix sums over the slabs, so the
+	// output is identical to TriangulateCubesSerial.
+	static void TriangulateCubesParallel(
+		const ConstArrayAccessor3<double>& grid,
+		const Vector3D& gridSize,
+		const Vector3D& origin,
+		TriangleMesh3* mesh,
+		double isoValue)
+	{
+		const Size3 dim = grid.size();
+
+		if (dim.x < 2 || dim.y < 2 || dim.z < 2)
+		{
+			return;
+		}
+
+		const size_t numberOfLayers = dim.z - 1;
+		const size_t numberOfSlabs = std::min(numberOfLayers, static_cast<size_t>(4 * GetMaxNumberOfThreads()));
+		std::vector<MarchingCubesSlab> slabs(numberOfSlabs);
+
+		auto slabBegin = [&](size_t s)
+		{
+			return s * numberOfLayers / numberOfSlabs;
+		};
+
+		ParallelFor(ZERO_SIZE, numberOfSlabs, [&](size_t s)
+		{
+			TriangulateSlab(grid, gridSize, origin, isoValue, slabBegin(s), slabBegin(s + 1), &slabs[s]);
+		});
+
+		// Find the bottom vertices that are already created by the previous slab
+		const size_t NOT_SHARED = std::numeric_limits<size_t>::max();
+		std::vector<std::vector<size_t>> sharedWith(numberOfSlabs);
+
+		ParallelFor(ZERO_SIZE, numberOfSlabs, [&](size_t s)
+		{
+			MarchingCubesSlab& slab = slabs[s];
+			sharedWith[s].assign(slab.points.size(), NOT_SHARED);
+
+			if (s > 0)
+			{
+				const auto& prevTop = slabs[s - 1].topVertices;
+
+				for (const auto& bottom : slab.bottomVertices)
+				{
+					auto iter = std::lower_bound(prevTop.begin(), prevTop.end(), std::make_pair(bottom.first, ZERO_SIZE));
+					if (iter != prevTop.end() && iter->first == bottom.first)
+					{
+						sharedWith[s][bottom.second] = iter->second;
+					}
 				}
 			}
+
+			slab.numberOfNewVertices = 0;
+			for (size_t v : sharedWith[s])
+			{
+				slab.numberOfNewVertices += (v == NOT_SHARED) ? 1 : 0;
+			}
+		});
+
+		// Prefix sums of the new vertices and the triangles
+		std::vector<size_t> vertexOffsets(numberOfSlabs + 1, mesh->NumberOfPoints());
+		for (size_t s = 0; s < numberOfSlabs; ++s)
+		{
+			vertexOffsets[s + 1] = vertexOffsets[s] + slabs[s].numberOfNewVertices;
 		}
 
+		ParallelFor(ZERO_SIZE, numberOfSlabs, [&](size_t s)
+		{
+			MarchingCubesSlab& slab = slabs[s];
+			size_t nextID = vertexOffsets[s];
+
+			slab.globalIDs.resize(slab.points.size());
+			for (size_t v = 0; v < slab.points.size(); ++v)
+			{
+				if (sharedWith[s][v] == NOT_SHARED)
+				{
+					slab.globalIDs[v] = nextID++;
+				}
+			}
+		});
+
+		ParallelFor(ONE_SIZE, numberOfSlabs, [&](size_t s)
+		{
+			for (const auto& bottom : slabs[s].bottomVertices)
+			{
+				const size_t shared = sharedWith[s][bottom.second];
+				if (shared != NOT_SHARED)
+				{
+					slabs[s].globalIDs[bottom.second] = slabs[s - 1].globalIDs[shared];
+				}
+			}
+		});
+
+		// Append to the mesh in the slab order
+		for (size_t s = 0; s < numberOfSlabs; ++s)
+		{
+			const MarchingCubesSlab& slab = slabs[s];
+
+			for (size_t v = 0; v < slab.points.size(); ++v)
+			{
+				if (sharedWith[s][v] == NOT_SHARED)
+				{
+					mesh->AddNormal(slab.normals[v]);
+					mesh->AddPoint(slab.points[v]);
+					mesh->AddUV(Vector2D());
+				}
+			}
+		}
+
+		for (size_t s = 0; s < numberOfSlabs; ++s)
+		{
+			const MarchingCubesSlab& slab = slabs[s];
+
+			for (const Point3UI& triangle : slab.triangles)
+			{
+				const Point3UI face(
+					slab.globalIDs[triangle.x],
+					slab.globalIDs[triangle.y],
+					slab.globalIDs[triangle.z]);
+
+				mesh->AddPointUVNormalTriangle(face, face, face);
+			}
+		}
+	}
+
+	void MarchingCubes(
+		const ConstArrayAccessor3<double>& grid,
+		const Vector3D& gridSize,
+		const Vector3D& origin,
+		TriangleMesh3* mesh,
+		double isoValue,
+		int bndFlag,
+		ExecutionPolicy policy)
+	{
+		if (policy == ExecutionPolicy::Parallel)
+		{
+			TriangulateCubesParallel(grid, gridSize, origin, mesh, isoValue);
+		}
+		else
+		{
+			TriangulateCubesSerial(grid, gridSize, origin, mesh, isoValue);
+		}
+
+		MarchingCubeVertexMap vertexMap;
+
+		const Size3 dim = grid.size();
+
+		auto pos = [origin, gridSize](ssize_t i, ssize_t j, ssize_t k)
+		{
+			return origin + gridSize * Vector3D({ i, j, k });
+		};
+
+		ssize_t dimX = static_cast<ssize_t>(dim.x);
+		ssize_t dimY = static_cast<ssize_t>(dim.y);
+		ssize_t dimZ = static_cast<ssize_t>(dim.z);
+
 		// Construct boundaries parallel to x-y plane
 		vertexMap.clear();
 
@@ -0,0 +1,78 @@
+/*************************************************************************
+> File Name: CompactNeighborLists.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Neighbor lists stored in a compressed sparse row layout.
+> Created Time: 2018/01/08
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <Particle/CompactNeighborLists.h>
+#include <Utils/Constants.h>
+#include <Utils/Parallel.h>
+
+namespace CubbyFlow
+{
+	CompactNeighborLists::CompactNeighborLists() :
+		m_starts(1, 0)
+	{
+		// Do nothing
+	}
+
+	size_t CompactNeighborLists::size() const
+	{
+		return m_starts.size() - 1;
+	}
+
+	size_t CompactNeighborLists::NumberOfNeighbors() const
+	{
+		return m_indices.size();
+	}
+
+	ConstArrayAccessor1<size_t> CompactNeighborLists::operator[](size_t i) const
+	{
+		return ConstArrayAccessor1<size_t>(m_starts[i + 1] - m_starts[i], m_indices.data() + m_starts[i]);
+	}
+
+	ConstArrayAccessor1<size_t> CompactNeighborLists::Starts() const
+	{
+		return m_starts.ConstAccessor();
+	}
+
+	ConstArrayAccessor1<size_t> CompactNeighborLists::Indices() const
+	{
+		return m_indices.ConstAccessor();
+	}
+
+	void CompactNeighborLists::Clear()
+	{
+		m_starts.Resize(1);
+		m_starts[0] = 0;
+		m_indices.Clear();
+	}
+
+	void CompactNeighborLists::Build(size_t numberOfLists, const CountFunction& count, const FillFunction& fill)
+	{
+		m_starts.Resize(numberOfLists + 1);
+
+		// Count pass; the counts are stored shifted by one for the prefix sum
+		ParallelFor(ZERO_SIZE, numberOfLists, [&](size_t i)
+		{
+			m_starts[i + 1] = count(i);
+		});
+
+		m_starts[0] = 0;
+		for (size_t i = 0; i < numberOfLists; ++i)
+		{
+			m_starts[i + 1] += m_starts[i];
+		}
+
+		// Fill pass
+		m_indices.Resize(m_starts[numberOfLists]);
+		size_t* indices = m_indices.data();
+
+		ParallelFor(ZERO_SIZE, numberOfLists, [&](size_t i)
+		{
+			fill(i, indices + m_starts[i]);
+		});
+	}
+}
\ No newline at end of file
@@ -222,7 +222,7 @@ namespace CubbyFlow
 		m_neighborSearcher = newNeighborSearcher;
 	}
 
-	const std::vector<std::vector<size_t>>& ParticleSystemData2::NeighborLists() const
+	const CompactNeighborLists& ParticleSystemData2::NeighborLists() const
 	{
 		return m_neighborLists;
 	}
@@ -248,23 +248,31 @@ namespace CubbyFlow
 	{
 		Timer timer;
 
-		m_neighborLists.resize(NumberOfParticles());
-
 		auto points = GetPositions();
 
-		for (size_t i = 0; i < NumberOfParticles(); ++i)
+		m_neighborLists.Build(NumberOfParticles(), [&](size_t i)
 		{
-			Vector2D origin = points[i];
-			m_neighborLists[i].clear();
+			size_t numberOfNeighbors = 0;
 
-			m_neighborSearcher->ForEachNearbyPoint(origin, maxSearchRadius, [&](size_t j, const Vector2D&)
+			m_neighborSearcher->ForEachNearbyPoint(points[i], maxSearchRadius, [&](size_t j, const Vector2D&)
 			{
 				if (i != j)
 				{
-					m_neighborLists[i].push_back(j);
+					++numberOfNeighbors;
 				}
 			});
-		}
+
+			return numberOfNeighbors;
+		}, [&](size_t i, size_t* neighbors)
+		{
+			m_neighborSearcher->ForEachNearbyPoint(points[i], maxSearchRadius, [&](size_t j, const Vector2D&)
+			{
+				if (i != j)
+				{
+					*neighbors++ = j;
+				}
+			});
+		});
 
 		CUBBYFLOW_INFO << "Building neighbor list took: "
 			<< timer.DurationInSeconds()
@@ -364,8 +372,9 @@ namespace CubbyFlow
 
 		// Copy neighbor lists
 		std::vector<flatbuffers::Offset<fbs::ParticleNeighborList2>> neighborLists;
-		for (const auto& neighbors : m_neighborLists)
+		for (size_t i = 0; i < m_neighborLists.size(); ++i)
 		{
+			const auto neighbors = m_neighborLists[i];
 			std::vector<uint64_t> neighbors64(neighbors.begin(), neighbors.end());
 			flatbuffers::Offset<fbs::ParticleNeighborList2> fbsNeighborList
 				= fbs::CreateParticleNeighborList2(*builder,
@@ -442,20 +451,20 @@ namespace CubbyFlow
 
 		// Copy neighbor list
 		auto fbsNeighborLists = fbsParticleSystemData->neighborLists();
-		m_neighborLists.resize(fbsNeighborLists->size());
-		
-		for (uint32_t i = 0; i < fbsNeighborLists->size(); ++i)
+		m_neighborLists.Build(fbsNeighborLists->size(), [&](size_t i)
 		{
-			auto fbsNeighborList = fbsNeighborLists->Get(i);
-			m_neighborLists[i].resize(fbsNeighborList->data()->size());
+			return static_cast<size_t>(fbsNeighborLists->Get(static_cast<uint32_t>(i))->data()->size());
+		}, [&](size_t i, size_t* neighbors)
+		{
+			auto fbsNeighborList = fbsNeighborLists->Get(static_cast<uint32_t>(i));
 			std::transform(
 				fbsNeighborList->data()->begin(),
 				fbsNeighborList->data()->end(),
-				m_neighborLists[i].begin(),
+				neighbors,
 				[](uint64_t val)
 			{
 				return static_cast<size_t>(val);
 			});
-		}
+		});
 	}
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 > Created Time: 2017/05/09
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
+#include <BoundingBox/BoundingBox3.h>
+#include <Math/MathUtils.h>
 #include <Particle/ParticleSystemData3.h>
 #include <Searcher/PointNeighborSearcher3.h>
 #include <Searcher/PointParallelHashGridSearcher3.h>
@@ -18,10 +20,37 @@
 
 #include <Flatbuffers/generated/ParticleSystemData3_generated.h>
 
+#include <numeric>
+
 namespace CubbyFlow
 {
 	static const size_t DEFAULT_HASH_GRID_RESOLUTION = 64;
 
+	// Number of bits per axis of the Morton code
+	static const size_t MORTON_CODE_BITS = 21;
+
+	// Inserts two zero bits after each of the lower 21 bits of x
+	static uint64_t SpreadBits(uint64_t x)
+	{
+		x &= 0x1fffff;
+		x = (x | x << 32) & 0x1f00000000ffff;
+		x = (x | x << 16) & 0x1f0000ff0000ff;
+		x = (x | x << 8) & 0x100f00f00f00f00f;
+		x = (x | x << 4) & 0x10c30c30c30c30c3;
+		x = (x | x << 2) & 0x1249249249249249;
+		return x;
+	}
+
+	static uint64_t MortonCode(const Vector3D& bucket)
+	{
+		const double maxBucket = static_cast<double>((1 << MORTON_CODE_BITS) - 1);
+		const auto x = static_cast<uint64_t>(Clamp(bucket.x, 0.0, maxBucket));
+		const auto y = static_cast<uint64_t>(Clamp(bucket.y, 0.0, maxBucket));
+		const auto z = static_cast<uint64_t>(Clamp(bucket.z, 0.0, maxBucket));
+
+		return SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+	}
+
 	ParticleSystemData3::ParticleSystemData3() :
 		ParticleSystemData3(0)
 	{
@@ -40,6 +69,7 @@ namespace CubbyFlow
 			DEFAULT_HASH_GRID_RESOLUTION,
 			DEFAULT_HASH_GRID_RESOLUTION,
 			2.0 * m_radius);
+		m_parallelHashGridSearcher = dynamic_cast<const PointParallelHashGridSearcher3*>(m_neighborSearcher.get());
 
 		Resize(NumberOfParticles);
 	}
@@ -56,6 +86,11 @@ namespace CubbyFlow
 
 	void ParticleSystemData3::Resize(size_t newNumberOfParticles)
 	{
+		if (newNumberOfParticles != m_numberOfParticles)
+		{
+			m_hasNeighborLists = false;
+		}
+
 		m_numberOfParticles = newNumberOfParticles;
 
 		for (auto& attr : m_scalarDataList)
@@ -216,6 +251,90 @@ namespace CubbyFlow
 		}
 	}
 
+	void ParticleSystemData3::Reorder(const std::vector<size_t>& order)
+	{
+		if (order.size() != NumberOfParticles())
+		{
+			throw std::invalid_argument("order.size() != NumberOfParticles()");
+		}
+
+		ScalarData newScalarData(m_numberOfParticles);
+		for (auto& attr : m_scalarDataList)
+		{
+			ParallelFor(ZERO_SIZE, m_numberOfParticles, [&](size_t i)
+			{
+				newScalarData[i] = attr[order[i]];
+			});
+
+			attr.Swap(newScalarData);
+		}
+
+		VectorData newVectorData(m_numberOfParticles);
+		for (auto& attr : m_vectorDataList)
+		{
+			ParallelFor(ZERO_SIZE, m_numberOfParticles, [&](size_t i)
+			{
+				newVectorData[i] = attr[order[i]];
+			});
+
+			attr.Swap(newVectorData);
+		}
+
+		// The searcher stores particle indices, so it is rebuilt on the new order
+		m_neighborSearcher->Build(GetPositions());
+		InvalidateNeighborLists();
+
+		if (m_onReorderCallback)
+		{
+			m_onReorderCallback(this, order);
+		}
+	}
+
+	void ParticleSystemData3::SortParticles(double gridSpacing)
+	{
+		// Written so that NaN is rejected as well
+		if (!(gridSpacing > 0.0))
+		{
+			throw std::invalid_argument("gridSpacing <= 0.0");
+		}
+
+		Timer timer;
+
+		auto positions = GetPositions();
+
+		BoundingBox3D bound;
+		for (size_t i = 0; i < m_numberOfParticles; ++i)
+		{
+			bound.Merge(positions[i]);
+		}
+
+		const double invGridSpacing = 1.0 / gridSpacing;
+		std::vector<uint64_t> codes(m_numberOfParticles);
+		ParallelFor(ZERO_SIZE, m_numberOfParticles, [&](size_t i)
+		{
+			codes[i] = MortonCode((positions[i] - bound.lowerCorner) * invGridSpacing);
+		});
+
+		// Ties are broken by the old index so that the order is deterministic
+		std::vector<size_t> order(m_numberOfParticles);
+		std::iota(order.begin(), order.end(), ZERO_SIZE);
+		ParallelSort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			return codes[a] < codes[b] || (codes[a] == codes[b] && a < b);
+		});
+
+		Reorder(order);
+
+		CUBBYFLOW_INFO << "Sorting particles took: "
+			<< timer.DurationInSeconds()
+			<< " seconds";
+	}
+
+	void ParticleSystemData3::SetOnReorderCallback(const OnReorderCallback& callback)
+	{
+		m_onReorderCallback = callback;
+	}
+
 	const PointNeighborSearcher3Ptr& ParticleSystemData3::GetNeighborSearcher() const
 	{
 		return m_neighborSearcher;
@@ -224,13 +343,22 @@ namespace CubbyFlow
 	void ParticleSystemData3::SetNeighborSearcher(const PointNeighborSearcher3Ptr& newNeighborSearcher)
 	{
 		m_neighborSearcher = newNeighborSearcher;
+		m_parallelHashGridSearcher = dynamic_cast<const PointParallelHashGridSearcher3*>(m_neighborSearcher.get());
+
+		// The lists were built by the old searcher
+		InvalidateNeighborLists();
 	}
 
-	const std::vector<std::vector<size_t>>& ParticleSystemData3::NeighborLists() const
+	const CompactNeighborLists& ParticleSystemData3::NeighborLists() const
 	{
 		return m_neighborLists;
 	}
 
+	bool ParticleSystemData3::HasNeighborLists() const
+	{
+		return m_hasNeighborLists;
+	}
+
 	void ParticleSystemData3::BuildNeighborSearcher(double maxSearchRadius)
 	{
 		Timer timer;
@@ -242,7 +370,10 @@ namespace CubbyFlow
 			DEFAULT_HASH_GRID_RESOLUTION,
 			2.0 * maxSearchRadius);
 
+		m_parallelHashGridSearcher = dynamic_cast<const PointParallelHashGridSearcher3*>(m_neighborSearcher.get());
+
 		m_neighborSearcher->Build(GetPositions());
+		InvalidateNeighborLists();
 
 		CUBBYFLOW_INFO << "Building neighbor searcher took: "
 			<< timer.DurationInSeconds()
@@ -253,23 +384,33 @@ namespace CubbyFlow
 	{
 		Timer timer;
 
-		m_neighborLists.resize(NumberOfParticles());
-
 		auto points = GetPositions();
 
-		for (size_t i = 0; i < NumberOfParticles(); ++i)
+		m_neighborLists.Build(NumberOfParticles(), [&](size_t i)
 		{
-			Vector3D origin = points[i];
-			m_neighborLists[i].clear();
+			size_t numberOfNeighbors = 0;
 
-			m_neighborSearcher->ForEachNearbyPoint(origin, maxSearchRadius, [&](size_t j, const Vector3D&)
+			m_neighborSearcher->ForEachNearbyPoint(points[i], maxSearchRadius, [&](size_t j, const Vector3D&)
 			{
 				if (i != j)
 				{
-					m_neighborLists[i].push_back(j);
+					++numberOfNeighbors;
 				}
 			});
-		}
+
+			return numberOfNeighbors;
+		}, [&](size_t i, size_t* neighbors)
+		{
+			m_neighborSearcher->ForEachNearbyPoint(points[i], maxSearchRadius, [&](size_t j, const Vector3D&)
+			{
+				if (i != j)
+				{
+					*neighbors++ = j;
+				}
+			});
+		});
+
+		m_hasNeighborLists = true;
 
 		CUBBYFLOW_INFO << "Building neighbor list took: "
 			<< timer.DurationInSeconds()
@@ -318,7 +459,9 @@ namespace CubbyFlow
 		}
 
 		m_neighborSearcher = other.m_neighborSearcher->Clone();
+		m_parallelHashGridSearcher = dynamic_cast<const PointParallelHashGridSearcher3*>(m_neighborSearcher.get());
 		m_neighborLists = other.m_neighborLists;
+		m_hasNeighborLists = other.m_hasNeighborLists;
 	}
 
 	ParticleSystemData3& ParticleSystemData3::operator=(const ParticleSystemData3& other)
@@ -327,6 +470,17 @@ namespace CubbyFlow
 		return *this;
 	}
 
+	const PointParallelHashGridSearcher3* ParticleSystemData3::GetParallelHashGridSearcher() const
+	{
+		return m_parallelHashGridSearcher;
+	}
+
+	void ParticleSystemData3::InvalidateNeighborLists()
+	{
+		m_neighborLists.Clear();
+		m_hasNeighborLists = false;
+	}
+
 	void ParticleSystemData3::SerializeParticleSystemData(
 		flatbuffers::FlatBufferBuilder* builder,
 		flatbuffers::Offset<fbs::ParticleSystemData3>* fbsParticleSystemData)
@@ -369,8 +523,9 @@ namespace CubbyFlow
 
 		// Copy neighbor lists
 		std::vector<flatbuffers::Offset<fbs::ParticleNeighborList3>> neighborLists;
-		for (const auto& neighbors : m_neighborLists)
+		for (size_t i = 0; i < m_neighborLists.size(); ++i)
 		{
+			const auto neighbors = m_neighborLists[i];
 			std::vector<uint64_t> neighbors64(neighbors.begin(), neighbors.end());
 			flatbuffers::Offset<fbs::ParticleNeighborList3> fbsNeighborList
 				= fbs::CreateParticleNeighborList3( *builder,
@@ -444,23 +599,27 @@ namespace CubbyFlow
 			fbsNeighborSearcher->data()->begin(),
 			fbsNeighborSearcher->data()->end());
 		m_neighborSearcher->Deserialize(neighborSearcherSerialized);
+		m_parallelHashGridSearcher = dynamic_cast<const PointParallelHashGridSearcher3*>(m_neighborSearcher.get());
 
 		// Copy neighbor list
 		auto fbsNeighborLists = fbsParticleSystemData->neighborLists();
-		m_neighborLists.resize(fbsNeighborLists->size());
-
-		for (uint32_t i = 0; i < fbsNeighborLists->size(); ++i)
+		m_neighborLists.Build(fbsNeighborLists->size(), [&](size_t i)
+		{
+			return static_cast<size_t>(fbsNeighborLists->Get(static_cast<uint32_t>(i))->data()->size());
+		}, [&](size_t i, size_t* neighbors)
 		{
-			auto fbsNeighborList = fbsNeighborLists->Get(i);
-			m_neighborLists[i].resize(fbsNeighborList->data()->size());
+			auto fbsNeighborList = fbsNeighborLists->Get(static_cast<uint32_t>(i));
 			std::transform(
 				fbsNeighborList->data()->begin(),
 				fbsNeighborList->data()->end(),
-				m_neighborLists[i].begin(),
+				neighbors,
 				[](uint64_t val)
 			{
 				return static_cast<size_t>(val);
 			});
-		}
+		});
+
+		// Only a complete set of lists is stored for the particles
+		m_hasNeighborLists = (m_neighborLists.size() == m_numberOfParticles);
 	}
 }
\ No newline at end of file
@@ -78,10 +78,16 @@ namespace CubbyFlow
 		auto p = GetPositions();
 		auto d = GetDensities();
 		const double m = GetMass();
+		SPHStdKernel3 kernel(m_kernelRadius);
 
 		ParallelFor(ZERO_SIZE, NumberOfParticles(), [&](size_t i)
 		{
-			double sum = SumOfKernelNearby(p[i]);
+			double sum = kernel(0.0);
+			ForEachNeighbor(i, [&](size_t j)
+			{
+				sum += kernel(p[i].DistanceTo(p[j]));
+			});
+
 			d[i] = m * sum;
 		});
 	}
@@ -104,6 +110,7 @@ namespace CubbyFlow
 
 		m_targetSpacing = spacing;
 		m_kernelRadius = m_kernelRadiusOverTargetSpacing * m_targetSpacing;
+		InvalidateNeighborLists();
 
 		ComputeMass();
 	}
@@ -117,6 +124,7 @@ namespace CubbyFlow
 	{
 		m_kernelRadiusOverTargetSpacing = relativeRadius;
 		m_kernelRadius = m_kernelRadiusOverTargetSpacing * m_targetSpacing;
+		InvalidateNeighborLists();
 
 		ComputeMass();
 	}
@@ -130,6 +138,7 @@ namespace CubbyFlow
 	{
 		m_kernelRadius = kernelRadius;
 		m_targetSpacing = kernelRadius / m_kernelRadiusOverTargetSpacing;
+		InvalidateNeighborLists();
 
 		ComputeMass();
 	}
@@ -197,12 +206,11 @@ namespace CubbyFlow
 		Vector3D sum;
 		auto p = GetPositions();
 		auto d = GetDensities();
-		const auto& neighbors = NeighborLists()[i];
 		Vector3D origin = p[i];
 		SPHSpikyKernel3 kernel(m_kernelRadius);
 		const double m = GetMass();
 
-		for (size_t j : neighbors)
+		ForEachNeighbor(i, [&](size_t j)
 		{
 			Vector3D neighborPosition = p[j];
 			double dist = origin.DistanceTo(neighborPosition);
@@ -212,7 +220,7 @@ namespace CubbyFlow
 				Vector3D dir = (neighborPosition - origin) / dist;
 				sum += d[i] * m * (values[i] / Square(d[i]) + values[j] / Square(d[j])) * kernel.Gradient(dist, dir);
 			}
-		}
+		});
 
 		return sum;
 	}
@@ -222,17 +230,16 @@ namespace CubbyFlow
 		double sum = 0.0;
 		auto p = GetPositions();
 		auto d = GetDensities();
-		const auto& neighbors = NeighborLists()[i];
 		Vector3D origin = p[i];
 		SPHSpikyKernel3 kernel(m_kernelRadius);
 		const double m = GetMass();
 
-		for (size_t j : neighbors)
+		ForEachNeighbor(i, [&](size_t j)
 		{
 			Vector3D neighborPosition = p[j];
 			double dist = origin.DistanceTo(neighborPosition);
 			sum += m * (values[j] - values[i]) / d[j] * kernel.SecondDerivative(dist);
-		}
+		});
 
 		return sum;
 	}
@@ -242,17 +249,16 @@ namespace CubbyFlow
 		Vector3D sum;
 		auto p = GetPositions();
 		auto d = GetDensities();
-		const auto& neighbors = NeighborLists()[i];
 		Vector3D origin = p[i];
 		SPHSpikyKernel3 kernel(m_kernelRadius);
 		const double m = GetMass();
 
-		for (size_t j : neighbors)
+		ForEachNeighbor(i, [&](size_t j)
 		{
 			Vector3D neighborPosition = p[j];
 			double dist = origin.DistanceTo(neighborPosition);
 			sum += m * (values[j] - values[i]) / d[j] * kernel.SecondDerivative(dist);
-		}
+		});
 
 		return sum;
 	}
@@ -15,6 +15,8 @@
 
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
+
 namespace CubbyFlow
 {
 	PointParallelHashGridSearcher3::PointParallelHashGridSearcher3(const Size3& resolution, double gridSpacing) :
@@ -63,18 +65,73 @@ namespace CubbyFlow
 			return;
 		}
 
-		// Initialize indices array and generate hash key for each point
+		// Generate hash key for each point
 		ParallelFor(ZERO_SIZE, numberOfPoints, [&](size_t i)
 		{
-			m_sortedIndices[i] = i;
-			m_points[i] = points[i];
 			tempKeys[i] = GetHashKeyFromPosition(points[i]);
 		});
 
-		// Sort indices based on hash key
-		ParallelSort(m_sortedIndices.begin(), m_sortedIndices.end(), [&tempKeys](size_t indexA, size_t indexB)
+		// Sort the points by their hash keys with a counting sort. The keys are
+		// bounded by the number of buckets, so the points are split into a few
+		// chunks, each chunk counts its points per bucket, and the counts are
+		// scanned into the write offsets of each chunk. The sort is stable, so
+		// points in the same bucket keep their input order regardless of the
+		// number of threads.
+		const size_t numberOfBuckets = m_startIndexTable.size();
+		const size_t numberOfChunks = std::clamp(
+			numberOfPoints / numberOfBuckets,
+			ONE_SIZE,
+			static_cast<size_t>(GetMaxNumberOfThreads()));
+		const size_t chunkSize = (numberOfPoints + numberOfChunks - 1) / numberOfChunks;
+
+		// offsets[c * numberOfBuckets + k] is the number of points with key k
+		// in chunk c
+		std::vector<size_t> offsets(numberOfChunks * numberOfBuckets, 0);
+
+		ParallelFor(ZERO_SIZE, numberOfChunks, [&](size_t c)
 		{
-			return tempKeys[indexA] < tempKeys[indexB];
+			size_t* counts = offsets.data() + c * numberOfBuckets;
+			const size_t end = std::min((c + 1) * chunkSize, numberOfPoints);
+
+			for (size_t i = c * chunkSize; i < end; ++i)
+			{
+				++counts[tempKeys[i]];
+			}
+		});
+
+		// Turn the counts into offsets within each bucket, then lay the buckets
+		// out in key order. The bucket sizes are parked in the end index table.
+		ParallelFor(ZERO_SIZE, numberOfBuckets, [&](size_t k)
+		{
+			size_t count = 0;
+			for (size_t c = 0; c < numberOfChunks; ++c)
+			{
+				const size_t n = offsets[c * numberOfBuckets + k];
+				offsets[c * numberOfBuckets + k] = count;
+				count += n;
+			}
+
+			m_endIndexTable[k] = count;
+		});
+
+		size_t bucketStart = 0;
+		for (size_t k = 0; k < numberOfBuckets; ++k)
+		{
+			m_startIndexTable[k] = bucketStart;
+			bucketStart += m_endIndexTable[k];
+		}
+
+		// Scatter the indices to their sorted positions
+		ParallelFor(ZERO_SIZE, numberOfChunks, [&](size_t c)
+		{
+			size_t* chunkOffsets = offsets.data() + c * numberOfBuckets;
+			const size_t end = std::min((c + 1) * chunkSize, numberOfPoints);
+
+			for (size_t i = c * chunkSize; i < end; ++i)
+			{
+				const size_t key = tempKeys[i];
+				m_sortedIndices[m_startIndexTable[key] + chunkOffsets[key]++] = i;
+			}
 		});
 
 		// Re-order point and key arrays
@@ -84,27 +141,19 @@ namespace CubbyFlow
 			m_keys[i] = tempKeys[m_sortedIndices[i]];
 		});
 
-		// Now m_points and m_keys are sorted by points' hash key values.
-		// Let's fill in start/end index table with m_keys.
-
-		// Assume that m_keys array looks like:
-		// [5|8|8|10|10|10]
-		// Then m_startIndexTable and m_endIndexTable should be like:
-		// [.....|0|...|1|..|3|..]
-		// [.....|1|...|3|..|6|..]
-		//       ^5    ^8   ^10
-		// So that m_endIndexTable[i] - m_startIndexTable[i] is the number points
-		// in i-th table bucket.
-
-		m_startIndexTable[m_keys[0]] = 0;
-		m_endIndexTable[m_keys[numberOfPoints - 1]] = numberOfPoints;
-
-		ParallelFor(static_cast<size_t>(1), numberOfPoints, [&](size_t i)
+		// Now m_points and m_keys are sorted by points' hash key values. Fill
+		// in the start/end index tables, where empty buckets are marked with
+		// the max value.
+		ParallelFor(ZERO_SIZE, numberOfBuckets, [&](size_t k)
 		{
-			if (m_keys[i] > m_keys[i - 1])
+			if (m_endIndexTable[k] == 0)
 			{
-				m_startIndexTable[m_keys[i]] = i;
-				m_endIndexTable[m_keys[i - 1]] = i;
+				m_startIndexTable[k] = std::numeric_limits<size_t>::max();
+				m_endIndexTable[k] = std::numeric_limits<size_t>::max();
+			}
+			else
+			{
+				m_endIndexTable[k] += m_startIndexTable[k];
 			}
 		});
 
@@ -130,33 +179,7 @@ namespace CubbyFlow
 
 	void PointParallelHashGridSearcher3::ForEachNearbyPoint(const Vector3D& origin, double radius, const ForEachNearbyPointFunc& callback) const
 	{
-		size_t nearbyKeys[8];
-		GetNearbyKeys(origin, nearbyKeys);
-
-		const double queryRadiusSquared = radius * radius;
-
-		for (int i = 0; i < 8; ++i)
-		{
-			size_t nearbyKey = nearbyKeys[i];
-			size_t start = m_startIndexTable[nearbyKey];
-			size_t end = m_endIndexTable[nearbyKey];
-
-			// Empty bucket -- continue to next bucket
-			if (start == std::numeric_limits<size_t>::max())
-			{
-				continue;
-			}
-
-			for (size_t j = start; j < end; ++j)
-			{
-				Vector3D direction = m_points[j] - origin;
-				double distanceSquared = direction.LengthSquared();
-				if (distanceSquared <= queryRadiusSquared)
-				{
-					callback(m_sortedIndices[j], m_points[j]);
-				}
-			}
-		}
+		ForEachNearbyPointInline(origin, radius, callback);
 	}
 
 	bool PointParallelHashGridSearcher3::HasNearbyPoint(const Vector3D& origin, double radius) const
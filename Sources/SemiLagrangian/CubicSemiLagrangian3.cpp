@@ -17,39 +17,16 @@ namespace CubbyFlow
 
 	std::function<double(const Vector3D&)> CubicSemiLagrangian3::GetScalarSamplerFunc(const ScalarGrid3& source) const
 	{
-		auto sourceSampler = CubicArraySampler3<double, double>(
-			source.GetConstDataAccessor(),
-			source.GridSpacing(),
-			source.GetDataOrigin());
-		return sourceSampler.Functor();
+		return source.CubicSampler();
 	}
 
 	std::function<Vector3D(const Vector3D&)> CubicSemiLagrangian3::GetVectorSamplerFunc(const CollocatedVectorGrid3& source) const
 	{
-		auto sourceSampler = CubicArraySampler3<Vector3D, double>(
-			source.GetConstDataAccessor(),
-			source.GridSpacing(),
-			source.GetDataOrigin());
-		return sourceSampler.Functor();
+		return source.CubicSampler();
 	}
 
 	std::function<Vector3D(const Vector3D&)> CubicSemiLagrangian3::GetVectorSamplerFunc(const FaceCenteredGrid3& source) const
 	{
-		auto uSourceSampler = CubicArraySampler3<double, double>(
-			source.GetUConstAccessor(),
-			source.GridSpacing(),
-			source.GetUOrigin());
-		auto vSourceSampler = CubicArraySampler3<double, double>(
-			source.GetVConstAccessor(),
-			source.GridSpacing(),
-			source.GetVOrigin());
-		auto wSourceSampler = CubicArraySampler3<double, double>(
-			source.GetWConstAccessor(),
-			source.GridSpacing(),
-			source.GetWOrigin());
-		return [uSourceSampler, vSourceSampler, wSourceSampler](const Vector3D& x)
-		{
-			return Vector3D(uSourceSampler(x), vSourceSampler(x), wSourceSampler(x));
-		};
+		return source.CubicSampler();
 	}
 }
\ No newline at end of file
@@ -7,9 +7,62 @@
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
 #include <SemiLagrangian/SemiLagrangian3.h>
+#include <Utils/Parallel.h>
+
+#include <vector>
 
 namespace CubbyFlow
 {
+	namespace
+	{
+		//!
+		//! Calls \p callback with the sampler held by \p samplerFunc if it is a
+		//! \p LinearSampler or a \p CubicSampler, so the callback can inline the
+		//! sampling. Otherwise, calls \p callback with \p samplerFunc itself.
+		//!
+		template <typename LinearSampler, typename CubicSampler, typename T, typename Callback>
+		void DispatchSampler(const std::function<T(const Vector3D&)>& samplerFunc, const Callback& callback)
+		{
+			if (const LinearSampler* linearSampler = samplerFunc.template target<LinearSampler>())
+			{
+				callback(*linearSampler);
+			}
+			else if (const CubicSampler* cubicSampler = samplerFunc.template target<CubicSampler>())
+			{
+				callback(*cubicSampler);
+			}
+			else
+			{
+				callback(samplerFunc);
+			}
+		}
+
+		//!
+		//! Calls \p callback with the linear sampler of \p flow if it is a
+		//! face-centered or collocated vector grid. Otherwise, calls \p callback
+		//! with a function object that calls VectorField3::Sample.
+		//!
+		template <typename Callback>
+		void DispatchFlowSampler(const VectorField3& flow, const Callback& callback)
+		{
+			if (const FaceCenteredGrid3* faceFlow = dynamic_cast<const FaceCenteredGrid3*>(&flow))
+			{
+				callback(faceFlow->LinearSampler());
+			}
+			else if (const CollocatedVectorGrid3* collocatedFlow = dynamic_cast<const CollocatedVectorGrid3*>(&flow))
+			{
+				callback(collocatedFlow->LinearSampler());
+			}
+			else
+			{
+				callback([&flow](const Vector3D& pt)
+				{
+					return flow.Sample(pt);
+				});
+			}
+		}
+	}
+
 	SemiLagrangian3::SemiLagrangian3()
 	{
 		// Do nothing
@@ -27,20 +80,70 @@ namespace CubbyFlow
 		ScalarGrid3* output,
 		const ScalarField3& boundarySDF)
 	{
-		auto inputSamplerFunc = GetScalarSamplerFunc(input);
 		double h = std::min(output->GridSpacing().x, output->GridSpacing().y);
 
 		auto inputDataPos = input.GetDataPosition();
 		auto outputDataPos = output->GetDataPosition();
 		auto outputDataAcc = output->GetDataAccessor();
 
-		output->ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		DispatchSampler<LinearArraySampler3<double, double>, CubicArraySampler3<double, double>>(
+			GetScalarSamplerFunc(input), [&](const auto& inputSampler)
 		{
-			if (boundarySDF.Sample(inputDataPos(i, j, k)) > 0.0)
+			DispatchFlowSampler(flow, [&](const auto& flowSampler)
 			{
-				Vector3D pt = BackTrace(flow, dt, h, outputDataPos(i, j, k), boundarySDF);
-				outputDataAcc(i, j, k) = inputSamplerFunc(pt);
-			}
+				outputDataAcc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					if (boundarySDF.Sample(inputDataPos(i, j, k)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, outputDataPos(i, j, k), boundarySDF);
+						outputDataAcc(i, j, k) = inputSampler(pt);
+					}
+				});
+			});
+		});
+	}
+
+	void SemiLagrangian3::AdvectNarrowBand(
+		const ScalarGrid3& input,
+		const VectorField3& flow,
+		double dt,
+		const NarrowBand3& band,
+		ScalarGrid3* output,
+		const ScalarField3& boundarySDF)
+	{
+		double h = std::min(output->GridSpacing().x, output->GridSpacing().y);
+
+		auto inputDataPos = input.GetDataPosition();
+		auto outputDataPos = output->GetDataPosition();
+		auto outputDataAcc = output->GetDataAccessor();
+
+		std::vector<double> values(band.size());
+
+		DispatchSampler<LinearArraySampler3<double, double>, CubicArraySampler3<double, double>>(
+			GetScalarSamplerFunc(input), [&](const auto& inputSampler)
+		{
+			DispatchFlowSampler(flow, [&](const auto& flowSampler)
+			{
+				ParallelFor(ZERO_SIZE, band.size(), [&](size_t n)
+				{
+					const Point3UI& idx = band[n];
+
+					if (boundarySDF.Sample(inputDataPos(idx.x, idx.y, idx.z)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, outputDataPos(idx.x, idx.y, idx.z), boundarySDF);
+						values[n] = inputSampler(pt);
+					}
+					else
+					{
+						values[n] = outputDataAcc(idx);
+					}
+				});
+			});
+		});
+
+		ParallelFor(ZERO_SIZE, band.size(), [&](size_t n)
+		{
+			outputDataAcc(band[n]) = values[n];
 		});
 	}
 
@@ -51,20 +154,26 @@ namespace CubbyFlow
 		CollocatedVectorGrid3* output,
 		const ScalarField3& boundarySDF)
 	{
-		auto inputSamplerFunc = GetVectorSamplerFunc(input);
 		double h = std::min(output->GridSpacing().x, output->GridSpacing().y);
 
 		auto inputDataPos = input.GetDataPosition();
 		auto outputDataPos = output->GetDataPosition();
 		auto outputDataAcc = output->GetDataAccessor();
 
-		output->ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		DispatchSampler<LinearArraySampler3<Vector3D, double>, CubicArraySampler3<Vector3D, double>>(
+			GetVectorSamplerFunc(input), [&](const auto& inputSampler)
 		{
-			if (boundarySDF.Sample(inputDataPos(i, j, k)) > 0.0)
+			DispatchFlowSampler(flow, [&](const auto& flowSampler)
 			{
-				Vector3D pt = BackTrace(flow, dt, h, outputDataPos(i, j, k), boundarySDF);
-				outputDataAcc(i, j, k) = inputSamplerFunc(pt);
-			}
+				outputDataAcc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					if (boundarySDF.Sample(inputDataPos(i, j, k)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, outputDataPos(i, j, k), boundarySDF);
+						outputDataAcc(i, j, k) = inputSampler(pt);
+					}
+				});
+			});
 		});
 	}
 
@@ -75,51 +184,58 @@ namespace CubbyFlow
 		FaceCenteredGrid3* output,
 		const ScalarField3& boundarySDF)
 	{
-		auto inputSamplerFunc = GetVectorSamplerFunc(input);
 		double h = std::min(output->GridSpacing().x, output->GridSpacing().y);
 
 		auto uSourceDataPos = input.GetUPosition();
 		auto uTargetDataPos = output->GetUPosition();
 		auto uTargetDataAcc = output->GetUAccessor();
-
-		output->ParallelForEachUIndex([&](size_t i, size_t j, size_t k)
-		{
-			if (boundarySDF.Sample(uSourceDataPos(i, j, k)) > 0.0)
-			{
-				Vector3D pt = BackTrace(flow, dt, h, uTargetDataPos(i, j, k), boundarySDF);
-				uTargetDataAcc(i, j, k) = inputSamplerFunc(pt).x;
-			}
-		});
-
 		auto vSourceDataPos = input.GetVPosition();
 		auto vTargetDataPos = output->GetVPosition();
 		auto vTargetDataAcc = output->GetVAccessor();
-
-		output->ParallelForEachVIndex([&](size_t i, size_t j, size_t k)
-		{
-			if (boundarySDF.Sample(vSourceDataPos(i, j, k)) > 0.0)
-			{
-				Vector3D pt = BackTrace(flow, dt, h, vTargetDataPos(i, j, k), boundarySDF);
-				vTargetDataAcc(i, j, k) = inputSamplerFunc(pt).y;
-			}
-		});
-
+		auto wSourceDataPos = input.GetWPosition();
 		auto wTargetDataPos = output->GetWPosition();
 		auto wTargetDataAcc = output->GetWAccessor();
-		auto wSourceDataPos = input.GetWPosition();
 
-		output->ParallelForEachWIndex([&](size_t i, size_t j, size_t k)
+		DispatchSampler<
+			FaceCenteredGridSampler3<LinearArraySampler3<double, double>>,
+			FaceCenteredGridSampler3<CubicArraySampler3<double, double>>>(
+			GetVectorSamplerFunc(input), [&](const auto& inputSampler)
 		{
-			if (boundarySDF.Sample(wSourceDataPos(i, j, k)) > 0.0)
+			DispatchFlowSampler(flow, [&](const auto& flowSampler)
 			{
-				Vector3D pt = BackTrace(flow, dt, h, wTargetDataPos(i, j, k), boundarySDF);
-				wTargetDataAcc(i, j, k) = inputSamplerFunc(pt).z;
-			}
+				uTargetDataAcc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					if (boundarySDF.Sample(uSourceDataPos(i, j, k)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, uTargetDataPos(i, j, k), boundarySDF);
+						uTargetDataAcc(i, j, k) = inputSampler(pt).x;
+					}
+				});
+
+				vTargetDataAcc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					if (boundarySDF.Sample(vSourceDataPos(i, j, k)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, vTargetDataPos(i, j, k), boundarySDF);
+						vTargetDataAcc(i, j, k) = inputSampler(pt).y;
+					}
+				});
+
+				wTargetDataAcc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					if (boundarySDF.Sample(wSourceDataPos(i, j, k)) > 0.0)
+					{
+						Vector3D pt = BackTrace(flowSampler, dt, h, wTargetDataPos(i, j, k), boundarySDF);
+						wTargetDataAcc(i, j, k) = inputSampler(pt).z;
+					}
+				});
+			});
 		});
 	}
 
+	template <typename FlowSampler>
 	Vector3D SemiLagrangian3::BackTrace(
-		const VectorField3& flow,
+		const FlowSampler& flow,
 		double dt,
 		double h,
 		const Vector3D& startPt,
@@ -132,13 +248,13 @@ namespace CubbyFlow
 		while (remainingT > std::numeric_limits<double>::epsilon())
 		{
 			// Adaptive time-stepping
-			Vector3D vel0 = flow.Sample(pt0);
+			Vector3D vel0 = flow(pt0);
 			double numSubSteps = std::max(std::ceil(vel0.Length() * remainingT / h), 1.0);
 			dt = remainingT / numSubSteps;
 
 			// Mid-point rule
 			Vector3D midPt = pt0 - 0.5 * dt * vel0;
-			Vector3D midVel = flow.Sample(midPt);
+			Vector3D midVel = flow(midPt);
 			pt1 = pt0 - dt * midVel;
 
 			// Boundary handling
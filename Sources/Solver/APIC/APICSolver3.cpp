@@ -77,7 +77,7 @@ namespace CubbyFlow
             flow->GridSpacing(),
             flow->GetWOrigin());
 
-        for (size_t i = 0; i < numberOfParticles; ++i)
+        ParallelForEachParticleInBlocks([&](size_t i)
         {
             std::array<Point3UI, 8> indices;
             std::array<double, 8> weights;
@@ -126,7 +126,7 @@ namespace CubbyFlow
                 wWeight(indices[j]) += weights[j];
                 m_wMarkers(indices[j]) = 1;
             }
-        }
+        });
 
         uWeight.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
         {
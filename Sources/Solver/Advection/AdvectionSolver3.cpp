@@ -20,6 +20,20 @@ namespace CubbyFlow
 		// Do nothing
 	}
 
+	void AdvectionSolver3::AdvectNarrowBand(
+		const ScalarGrid3& input,
+		const VectorField3& flow,
+		double dt,
+		const NarrowBand3& band,
+		ScalarGrid3* output,
+		const ScalarField3& boundarySDF)
+	{
+		UNUSED_VARIABLE(band);
+
+		const auto input0 = input.Clone();
+		Advect(*input0, flow, dt, output, boundarySDF);
+	}
+
 	void AdvectionSolver3::Advect(
 		const CollocatedVectorGrid3& source,
 		const VectorField3& flow,
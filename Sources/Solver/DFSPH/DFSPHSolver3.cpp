@@ -0,0 +1,363 @@
+/*************************************************************************
+> File Name: DFSPHSolver3.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D DFSPH solver.
+> Created Time: 2018/01/22
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <Solver/DFSPH/DFSPHSolver3.h>
+#include <Utils/Logger.h>
+#include <Utils/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CubbyFlow
+{
+	static constexpr double TIME_STEP_LIMIT_BY_SPEED_FACTOR = 0.4;
+
+	DFSPHSolver3::DFSPHSolver3()
+	{
+		// Do nothing
+	}
+
+	DFSPHSolver3::DFSPHSolver3(double targetDensity, double targetSpacing, double relativeKernelRadius) :
+		SPHSolver3(targetDensity, targetSpacing, relativeKernelRadius)
+	{
+		// Do nothing
+	}
+
+	DFSPHSolver3::~DFSPHSolver3()
+	{
+		// Do nothing
+	}
+
+	double DFSPHSolver3::GetMaxDensityErrorRatio() const
+	{
+		return m_maxDensityErrorRatio;
+	}
+
+	void DFSPHSolver3::SetMaxDensityErrorRatio(double ratio)
+	{
+		m_maxDensityErrorRatio = std::max(ratio, 0.0);
+	}
+
+	double DFSPHSolver3::GetMaxDivergenceErrorRatio() const
+	{
+		return m_maxDivergenceErrorRatio;
+	}
+
+	void DFSPHSolver3::SetMaxDivergenceErrorRatio(double ratio)
+	{
+		m_maxDivergenceErrorRatio = std::max(ratio, 0.0);
+	}
+
+	unsigned int DFSPHSolver3::GetMaxNumberOfIterations() const
+	{
+		return m_maxNumberOfIterations;
+	}
+
+	void DFSPHSolver3::SetMaxNumberOfIterations(unsigned int n)
+	{
+		m_maxNumberOfIterations = n;
+	}
+
+	unsigned int DFSPHSolver3::NumberOfSubTimeSteps(double timeIntervalInSeconds) const
+	{
+		auto particles = GetSPHSystemData();
+		size_t numberOfParticles = particles->NumberOfParticles();
+		auto v = particles->GetVelocities();
+
+		const double& (*_max)(const double&, const double&) = std::max<double>;
+
+		const double maxSpeedSquared = ParallelReduce(ZERO_SIZE, numberOfParticles, 0.0,
+			[&](size_t begin, size_t end, double init)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				init = std::max(init, v[i].LengthSquared());
+			}
+
+			return init;
+		}, _max);
+
+		// Bound the speed the particles can reach within the interval so that
+		// the fluid at rest does not take the whole interval at once.
+		const double maxSpeed = std::sqrt(maxSpeedSquared) + timeIntervalInSeconds * GetGravity().Length();
+		if (maxSpeed <= 0.0)
+		{
+			return 1;
+		}
+
+		double desiredTimeStep = GetTimeStepLimitScale() * TIME_STEP_LIMIT_BY_SPEED_FACTOR * particles->GetKernelRadius() / maxSpeed;
+
+		return std::max(static_cast<unsigned int>(std::ceil(timeIntervalInSeconds / desiredTimeStep)), 1u);
+	}
+
+	void DFSPHSolver3::AccumulatePressureForce(double timeIntervalInSeconds)
+	{
+		auto particles = GetSPHSystemData();
+		const size_t numberOfParticles = particles->NumberOfParticles();
+		const double targetDensity = particles->GetTargetDensity();
+		const double mass = particles->GetMass();
+
+		auto x = particles->GetPositions();
+		auto v = particles->GetVelocities();
+		auto f = particles->GetForces();
+
+		// Predict velocity with the non-pressure forces
+		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		{
+			m_tempVelocities[i] = v[i] + timeIntervalInSeconds / mass * f[i];
+			m_tempPositions[i] = x[i] + timeIntervalInSeconds * m_tempVelocities[i];
+		});
+
+		// Let the collider act on the predicted state so that the particles
+		// pressed against it are seen as being at rest by the density solver
+		ResolveCollision(m_tempPositions, m_tempVelocities);
+
+		unsigned int numIter = 0;
+		double densityErrorRatio = 0.0;
+
+		for (; numIter < m_maxNumberOfIterations; ++numIter)
+		{
+			densityErrorRatio = ComputeDensityError(m_tempVelocities.ConstAccessor(), timeIntervalInSeconds) / targetDensity;
+
+			if (densityErrorRatio <= m_maxDensityErrorRatio)
+			{
+				break;
+			}
+
+			ApplyStiffness(m_tempVelocities.Accessor(), timeIntervalInSeconds);
+		}
+
+		CUBBYFLOW_INFO << "Number of density solver iterations: " << numIter;
+		CUBBYFLOW_INFO << "Max density error ratio: " << densityErrorRatio;
+
+		if (densityErrorRatio > m_maxDensityErrorRatio)
+		{
+			CUBBYFLOW_WARN << "Max density error ratio is greater than the threshold!";
+			CUBBYFLOW_WARN << "Ratio: " << densityErrorRatio
+				<< " Threshold: " << m_maxDensityErrorRatio;
+		}
+
+		// Replace the forces with the ones that yield the corrected velocity
+		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		{
+			f[i] = mass / timeIntervalInSeconds * (m_tempVelocities[i] - v[i]);
+		});
+	}
+
+	void DFSPHSolver3::OnBeginAdvanceTimeStep(double timeStepInSeconds)
+	{
+		SPHSolver3::OnBeginAdvanceTimeStep(timeStepInSeconds);
+
+		// Allocate temp buffers
+		size_t numberOfParticles = GetParticleSystemData()->NumberOfParticles();
+		m_factors.Resize(numberOfParticles);
+		m_stiffnesses.Resize(numberOfParticles);
+		m_tempPositions.Resize(numberOfParticles);
+		m_tempVelocities.Resize(numberOfParticles);
+
+		ComputeFactors();
+
+		// Make the velocity field divergence-free before any force is applied
+		auto particles = GetSPHSystemData();
+		auto v = particles->GetVelocities();
+		const double targetDensity = particles->GetTargetDensity();
+
+		unsigned int numIter = 0;
+		double divergenceErrorRatio = 0.0;
+
+		for (; numIter < m_maxNumberOfIterations; ++numIter)
+		{
+			divergenceErrorRatio = ComputeDivergenceError(v, timeStepInSeconds) * timeStepInSeconds / targetDensity;
+
+			if (divergenceErrorRatio <= m_maxDivergenceErrorRatio)
+			{
+				break;
+			}
+
+			ApplyStiffness(v, timeStepInSeconds);
+		}
+
+		CUBBYFLOW_INFO << "Number of divergence solver iterations: " << numIter;
+		CUBBYFLOW_INFO << "Max divergence error ratio: " << divergenceErrorRatio;
+	}
+
+	void DFSPHSolver3::ComputeFactors()
+	{
+		auto particles = GetSPHSystemData();
+		const size_t numberOfParticles = particles->NumberOfParticles();
+		auto x = particles->GetPositions();
+		auto d = particles->GetDensities();
+
+		const double mass = particles->GetMass();
+		const double h = particles->GetKernelRadius();
+
+		// Spiky kernel gradient magnitude is c * (1 - r / h)^2
+		const double gradientCoefficient = 45.0 / (PI_DOUBLE * h * h * h * h);
+		const double invH = 1.0 / h;
+
+		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		{
+			Vector3D gradientSum;
+			double gradientSquaredSum = 0.0;
+
+			particles->ForEachNeighbor(i, [&](size_t j)
+			{
+				const Vector3D r = x[j] - x[i];
+				const double dist = r.Length();
+				const double invDist = (dist > 0.0) ? 1.0 / dist : 0.0;
+				const double s = std::max(1.0 - dist * invH, 0.0);
+
+				// m * grad(Wij)
+				const Vector3D gradient = (mass * gradientCoefficient * s * s * invDist) * r;
+				gradientSum += gradient;
+				gradientSquaredSum += gradient.LengthSquared();
+			});
+
+			const double denom = gradientSum.LengthSquared() + gradientSquaredSum;
+			m_factors[i] = (denom > 0.0) ? d[i] / denom : 0.0;
+		});
+	}
+
+	double DFSPHSolver3::ComputeDensityError(const ConstArrayAccessor1<Vector3D>& velocities, double timeStepInSeconds)
+	{
+		auto particles = GetSPHSystemData();
+		const size_t numberOfParticles = particles->NumberOfParticles();
+		auto x = particles->GetPositions();
+		auto d = particles->GetDensities();
+
+		const double targetDensity = particles->GetTargetDensity();
+		const double mass = particles->GetMass();
+		const double h = particles->GetKernelRadius();
+		const double gradientCoefficient = 45.0 / (PI_DOUBLE * h * h * h * h);
+		const double invH = 1.0 / h;
+		const double invTimeStepSquared = 1.0 / (timeStepInSeconds * timeStepInSeconds);
+
+		const double& (*_max)(const double&, const double&) = std::max<double>;
+
+		return ParallelReduce(ZERO_SIZE, numberOfParticles, 0.0,
+			[&](size_t begin, size_t end, double init)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				double densityChange = 0.0;
+
+				particles->ForEachNeighbor(i, [&](size_t j)
+				{
+					const Vector3D r = x[j] - x[i];
+					const double dist = r.Length();
+					const double invDist = (dist > 0.0) ? 1.0 / dist : 0.0;
+					const double s = std::max(1.0 - dist * invH, 0.0);
+
+					densityChange += (gradientCoefficient * s * s * invDist) * (velocities[i] - velocities[j]).Dot(r);
+				});
+
+				// Only compression is corrected, which prevents particle clumping
+				// at the free surface
+				const double predictedDensity = d[i] + timeStepInSeconds * mass * densityChange;
+				const double densityError = std::max(predictedDensity - targetDensity, 0.0);
+
+				m_stiffnesses[i] = densityError * invTimeStepSquared * m_factors[i];
+				init = std::max(init, densityError);
+			}
+
+			return init;
+		}, _max);
+	}
+
+	double DFSPHSolver3::ComputeDivergenceError(const ConstArrayAccessor1<Vector3D>& velocities, double timeStepInSeconds)
+	{
+		auto particles = GetSPHSystemData();
+		const size_t numberOfParticles = particles->NumberOfParticles();
+		auto x = particles->GetPositions();
+
+		const double mass = particles->GetMass();
+		const double h = particles->GetKernelRadius();
+		const double gradientCoefficient = 45.0 / (PI_DOUBLE * h * h * h * h);
+		const double invH = 1.0 / h;
+		const double invTimeStep = 1.0 / timeStepInSeconds;
+
+		const double& (*_max)(const double&, const double&) = std::max<double>;
+
+		return ParallelReduce(ZERO_SIZE, numberOfParticles, 0.0,
+			[&](size_t begin, size_t end, double init)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				double densityChange = 0.0;
+
+				particles->ForEachNeighbor(i, [&](size_t j)
+				{
+					const Vector3D r = x[j] - x[i];
+					const double dist = r.Length();
+					const double invDist = (dist > 0.0) ? 1.0 / dist : 0.0;
+					const double s = std::max(1.0 - dist * invH, 0.0);
+
+					densityChange += (gradientCoefficient * s * s * invDist) * (velocities[i] - velocities[j]).Dot(r);
+				});
+
+				const double divergenceError = std::max(mass * densityChange, 0.0);
+
+				m_stiffnesses[i] = divergenceError * invTimeStep * m_factors[i];
+				init = std::max(init, divergenceError);
+			}
+
+			return init;
+		}, _max);
+	}
+
+	void DFSPHSolver3::ApplyStiffness(ArrayAccessor1<Vector3D> velocities, double timeStepInSeconds)
+	{
+		auto particles = GetSPHSystemData();
+		const size_t numberOfParticles = particles->NumberOfParticles();
+		auto x = particles->GetPositions();
+		auto d = particles->GetDensities();
+
+		const double mass = particles->GetMass();
+		const double h = particles->GetKernelRadius();
+		const double gradientCoefficient = 45.0 / (PI_DOUBLE * h * h * h * h);
+		const double invH = 1.0 / h;
+
+		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		{
+			const double stiffnessOverDensity = m_stiffnesses[i] / d[i];
+			Vector3D sum;
+
+			particles->ForEachNeighbor(i, [&](size_t j)
+			{
+				const Vector3D r = x[j] - x[i];
+				const double dist = r.Length();
+				const double invDist = (dist > 0.0) ? 1.0 / dist : 0.0;
+				const double s = std::max(1.0 - dist * invH, 0.0);
+
+				sum += ((stiffnessOverDensity + m_stiffnesses[j] / d[j]) * gradientCoefficient * s * s * invDist) * r;
+			});
+
+			velocities[i] -= timeStepInSeconds * mass * sum;
+		});
+	}
+
+	DFSPHSolver3::Builder DFSPHSolver3::GetBuilder()
+	{
+		return Builder();
+	}
+
+	DFSPHSolver3 DFSPHSolver3::Builder::Build() const
+	{
+		return DFSPHSolver3(m_targetDensity, m_targetSpacing, m_relativeKernelRadius);
+	}
+
+	DFSPHSolver3Ptr DFSPHSolver3::Builder::MakeShared() const
+	{
+		return std::shared_ptr<DFSPHSolver3>(
+			new DFSPHSolver3(m_targetDensity, m_targetSpacing, m_relativeKernelRadius),
+			[](DFSPHSolver3* obj)
+		{
+			delete obj;
+		});
+	}
+}
\ No newline at end of file
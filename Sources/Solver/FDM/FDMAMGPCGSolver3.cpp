@@ -0,0 +1,734 @@
+/*************************************************************************
+> File Name: FDMAMGPCGSolver3.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: 3-D finite difference-type linear system solver using algebraic
+>          multigrid preconditioned conjugate gradient (AMGPCG).
+> Created Time: 2018/01/26
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <Math/CG.h>
+#include <Solver/FDM/FDMAMGPCGSolver3.h>
+#include <Utils/Logger.h>
+#include <Utils/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace CubbyFlow
+{
+	namespace
+	{
+		const size_t NO_AGGREGATE = std::numeric_limits<size_t>::max();
+
+		// Builds a CSR matrix from rows that are evaluated independently in
+		// parallel. rowFunc(i, add) calls add(column, value) for the entries of
+		// the i-th row in any order; duplicated columns are summed with a dense
+		// accumulator per range of rows (Gustavson's algorithm).
+		template <typename RowFunc>
+		void BuildMatrixByRows(size_t rows, size_t cols, const RowFunc& rowFunc, MatrixCSRD* result)
+		{
+			struct RowBlock
+			{
+				size_t begin;
+				std::vector<size_t> columns;
+				std::vector<double> values;
+			};
+
+			std::vector<size_t> rowPointers(rows + 1, 0);
+			std::vector<RowBlock> blocks;
+			std::mutex blocksMutex;
+
+			ParallelRangeFor(ZERO_SIZE, rows, [&](size_t begin, size_t end)
+			{
+				std::vector<double> accumulator(cols, 0.0);
+				std::vector<char> isUsed(cols, 0);
+				std::vector<size_t> usedColumns;
+
+				const auto add = [&](size_t col, double value)
+				{
+					if (!isUsed[col])
+					{
+						isUsed[col] = 1;
+						usedColumns.push_back(col);
+					}
+
+					accumulator[col] += value;
+				};
+
+				RowBlock block;
+				block.begin = begin;
+
+				for (size_t i = begin; i < end; ++i)
+				{
+					usedColumns.clear();
+					rowFunc(i, add);
+
+					std::sort(usedColumns.begin(), usedColumns.end());
+					for (size_t col : usedColumns)
+					{
+						block.columns.push_back(col);
+						block.values.push_back(accumulator[col]);
+						accumulator[col] = 0.0;
+						isUsed[col] = 0;
+					}
+
+					rowPointers[i + 1] = usedColumns.size();
+				}
+
+				std::lock_guard<std::mutex> lock(blocksMutex);
+				blocks.push_back(std::move(block));
+			});
+
+			for (size_t i = 0; i < rows; ++i)
+			{
+				rowPointers[i + 1] += rowPointers[i];
+			}
+
+			result->Reserve(rows, cols, rowPointers[rows]);
+
+			auto rp = result->RowPointersBegin();
+			auto ci = result->ColumnIndicesBegin();
+			auto nnz = result->NonZeroBegin();
+
+			std::copy(rowPointers.begin(), rowPointers.end(), rp);
+
+			ParallelFor(ZERO_SIZE, blocks.size(), [&](size_t b)
+			{
+				const RowBlock& block = blocks[b];
+				const size_t offset = rowPointers[block.begin];
+
+				std::copy(block.columns.begin(), block.columns.end(), ci + offset);
+				std::copy(block.values.begin(), block.values.end(), nnz + offset);
+			});
+		}
+
+		// Computes result = a * b.
+		void Multiply(const MatrixCSRD& a, const MatrixCSRD& b, MatrixCSRD* result)
+		{
+			const auto arp = a.RowPointersBegin();
+			const auto aci = a.ColumnIndicesBegin();
+			const auto annz = a.NonZeroBegin();
+			const auto brp = b.RowPointersBegin();
+			const auto bci = b.ColumnIndicesBegin();
+			const auto bnnz = b.NonZeroBegin();
+
+			BuildMatrixByRows(a.Rows(), b.Cols(),
+				[&](size_t i, const auto& add)
+			{
+				for (size_t kk = arp[i]; kk < arp[i + 1]; ++kk)
+				{
+					const size_t k = aci[kk];
+					const double aik = annz[kk];
+
+					for (size_t jj = brp[k]; jj < brp[k + 1]; ++jj)
+					{
+						add(bci[jj], aik * bnnz[jj]);
+					}
+				}
+			}, result);
+		}
+
+		// Computes result = m^T.
+		void Transpose(const MatrixCSRD& m, MatrixCSRD* result)
+		{
+			const size_t rows = m.Rows();
+			const size_t cols = m.Cols();
+
+			const auto rp = m.RowPointersBegin();
+			const auto ci = m.ColumnIndicesBegin();
+			const auto nnz = m.NonZeroBegin();
+
+			result->Reserve(cols, rows, m.NumberOfNonZeros());
+
+			auto trp = result->RowPointersBegin();
+			auto tci = result->ColumnIndicesBegin();
+			auto tnnz = result->NonZeroBegin();
+
+			// Count the entries of each column, then scatter the rows in order
+			// so that the columns of each transposed row stay sorted.
+			std::vector<size_t> offsets(cols + 1, 0);
+			for (size_t jj = 0; jj < m.NumberOfNonZeros(); ++jj)
+			{
+				++offsets[ci[jj] + 1];
+			}
+
+			for (size_t j = 0; j < cols; ++j)
+			{
+				offsets[j + 1] += offsets[j];
+			}
+
+			std::copy(offsets.begin(), offsets.end(), trp);
+
+			for (size_t i = 0; i < rows; ++i)
+			{
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t dst = offsets[ci[jj]]++;
+					tci[dst] = i;
+					tnnz[dst] = nnz[jj];
+				}
+			}
+		}
+
+		// Estimates the spectral radius of D^-1 A with the power iteration.
+		double EstimateSpectralRadius(const MatrixCSRD& a, const VectorND& diag)
+		{
+			const size_t n = a.Rows();
+			const unsigned int numberOfIterations = 15;
+
+			// Deterministic pseudo-random signs, so that the start vector is rich
+			// in the high frequencies that dominate the spectrum. A smooth start
+			// vector underestimates the radius and makes the smoother unstable.
+			VectorND v(n);
+			VectorND av(n);
+			v.ParallelForEachIndex([&](size_t i)
+			{
+				const size_t hash = (i * 2654435761u) >> 13;
+				v[i] = (hash & 1) ? 1.0 : -1.0;
+			});
+
+			double rho = 0.0;
+			for (unsigned int iter = 0; iter < numberOfIterations; ++iter)
+			{
+				const double norm = FDMCompressedBLAS3::L2Norm(v);
+				if (norm == 0.0)
+				{
+					return 0.0;
+				}
+
+				FDMCompressedBLAS3::MVM(a, v, &av);
+				av.ParallelForEachIndex([&](size_t i)
+				{
+					av[i] = (diag[i] != 0.0) ? av[i] / diag[i] : 0.0;
+				});
+
+				rho = FDMCompressedBLAS3::L2Norm(av) / norm;
+				v.Swap(av);
+			}
+
+			return rho;
+		}
+
+		// Groups the unknowns into aggregates of strongly coupled neighbors and
+		// returns the number of aggregates. The unknowns without a strong
+		// neighbor are not aggregated.
+		size_t Aggregate(const MatrixCSRD& a, const VectorND& diag, double theta,
+			std::vector<size_t>* aggregates)
+		{
+			const size_t n = a.Rows();
+
+			const auto rp = a.RowPointersBegin();
+			const auto ci = a.ColumnIndicesBegin();
+			const auto nnz = a.NonZeroBegin();
+
+			// |a_ij| >= theta * sqrt(|a_ii * a_jj|)
+			std::vector<char> isStrong(a.NumberOfNonZeros(), 0);
+			std::vector<char> hasStrong(n, 0);
+			ParallelFor(ZERO_SIZE, n, [&](size_t i)
+			{
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t j = ci[jj];
+
+					if (j != i && std::fabs(nnz[jj]) >= theta * std::sqrt(std::fabs(diag[i] * diag[j])) && nnz[jj] != 0.0)
+					{
+						isStrong[jj] = 1;
+						hasStrong[i] = 1;
+					}
+				}
+			});
+
+			auto& agg = *aggregates;
+			agg.assign(n, NO_AGGREGATE);
+			size_t numAggregates = 0;
+
+			// Phase 1: the unknowns whose strong neighbors are all free become the
+			// roots of new aggregates with their strong neighbors.
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (!hasStrong[i] || agg[i] != NO_AGGREGATE)
+				{
+					continue;
+				}
+
+				bool isFree = true;
+				for (size_t jj = rp[i]; jj < rp[i + 1] && isFree; ++jj)
+				{
+					isFree = !isStrong[jj] || agg[ci[jj]] == NO_AGGREGATE;
+				}
+
+				if (isFree)
+				{
+					agg[i] = numAggregates;
+					for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+					{
+						if (isStrong[jj])
+						{
+							agg[ci[jj]] = numAggregates;
+						}
+					}
+
+					++numAggregates;
+				}
+			}
+
+			// Phase 2: the remaining unknowns join the aggregate of their
+			// strongest aggregated neighbor.
+			std::vector<size_t> phase1 = agg;
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (!hasStrong[i] || agg[i] != NO_AGGREGATE)
+				{
+					continue;
+				}
+
+				double strongest = 0.0;
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					if (isStrong[jj] && phase1[ci[jj]] != NO_AGGREGATE && std::fabs(nnz[jj]) > strongest)
+					{
+						strongest = std::fabs(nnz[jj]);
+						agg[i] = phase1[ci[jj]];
+					}
+				}
+			}
+
+			// Phase 3: the rest form aggregates with their free strong neighbors.
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (!hasStrong[i] || agg[i] != NO_AGGREGATE)
+				{
+					continue;
+				}
+
+				agg[i] = numAggregates;
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					if (isStrong[jj] && agg[ci[jj]] == NO_AGGREGATE)
+					{
+						agg[ci[jj]] = numAggregates;
+					}
+				}
+
+				++numAggregates;
+			}
+
+			return numAggregates;
+		}
+
+		// Extracts the diagonal of the matrix.
+		void ExtractDiagonal(const MatrixCSRD& a, VectorND* diag)
+		{
+			const auto rp = a.RowPointersBegin();
+			const auto ci = a.ColumnIndicesBegin();
+			const auto nnz = a.NonZeroBegin();
+
+			diag->Resize(a.Rows(), 0.0);
+			diag->ParallelForEachIndex([&](size_t i)
+			{
+				double d = 0.0;
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					if (ci[jj] == i)
+					{
+						d += nnz[jj];
+					}
+				}
+
+				(*diag)[i] = d;
+			});
+		}
+	}
+
+	void FDMAMGPCGSolver3::Preconditioner::Build(const MatrixCSRD& matrix, size_t maxNumberOfLevels,
+		double strengthThreshold, size_t maxCoarsestSize)
+	{
+		// Reserved, so that the pointers to the coarse matrices stay valid
+		levels.clear();
+		levels.reserve(std::max(maxNumberOfLevels, ONE_SIZE));
+		levels.emplace_back();
+		levels.front().A = &matrix;
+
+		VectorND diag;
+		std::vector<size_t> aggregates;
+
+		for (size_t l = 0; ; ++l)
+		{
+			Level& level = levels[l];
+			const MatrixCSRD& a = *level.A;
+			const size_t n = a.Rows();
+
+			ExtractDiagonal(a, &diag);
+
+			// Jacobi damping that keeps the smoother convergent
+			const double rho = EstimateSpectralRadius(a, diag);
+			const double omega = (rho > 0.0) ? 4.0 / (3.0 * rho) : 0.0;
+
+			level.invDiag.Resize(n, 0.0);
+			level.invDiag.ParallelForEachIndex([&](size_t i)
+			{
+				level.invDiag[i] = (diag[i] != 0.0) ? omega / diag[i] : 0.0;
+			});
+
+			level.x.Resize(n, 0.0);
+			level.b.Resize(n, 0.0);
+			level.r.Resize(n, 0.0);
+
+			if (n <= maxCoarsestSize || l + 1 >= maxNumberOfLevels)
+			{
+				break;
+			}
+
+			// The threshold is halved on each level as the coarse matrices get denser
+			const double theta = strengthThreshold * std::pow(0.5, static_cast<double>(l));
+			const size_t numAggregates = Aggregate(a, diag, theta, &aggregates);
+			if (numAggregates == 0 || numAggregates >= n)
+			{
+				break;
+			}
+
+			// P = (I - omega D^-1 A) P_tent where P_tent is 1 at (i, aggregate of i)
+			const auto rp = a.RowPointersBegin();
+			const auto ci = a.ColumnIndicesBegin();
+			const auto nnz = a.NonZeroBegin();
+
+			BuildMatrixByRows(n, numAggregates,
+				[&](size_t i, const auto& add)
+			{
+				if (aggregates[i] != NO_AGGREGATE)
+				{
+					add(aggregates[i], 1.0);
+				}
+
+				if (diag[i] == 0.0)
+				{
+					return;
+				}
+
+				const double scale = -omega / diag[i];
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t j = ci[jj];
+					if (aggregates[j] != NO_AGGREGATE)
+					{
+						add(aggregates[j], scale * nnz[jj]);
+					}
+				}
+			}, &level.P);
+
+			Transpose(level.P, &level.R);
+
+			// A_c = R A P
+			MatrixCSRD ap;
+			Multiply(a, level.P, &ap);
+
+			levels.emplace_back();
+			Level& coarser = levels.back();
+			Multiply(level.R, ap, &coarser.coarseA);
+			coarser.A = &coarser.coarseA;
+		}
+
+		FactorizeCoarsest();
+	}
+
+	void FDMAMGPCGSolver3::Preconditioner::FactorizeCoarsest()
+	{
+		const MatrixCSRD& a = *levels.back().A;
+		const size_t n = a.Rows();
+
+		const auto rp = a.RowPointersBegin();
+		const auto ci = a.ColumnIndicesBegin();
+		const auto nnz = a.NonZeroBegin();
+
+		coarsestL.assign(n * n, 0.0);
+		coarsestPivots.assign(n, 0);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+			{
+				coarsestL[i * n + ci[jj]] = nnz[jj];
+			}
+		}
+
+		// Cholesky factorization. The near-zero pivots of the singular matrices
+		// (such as the pure Neumann problem) are skipped, which gives a
+		// symmetric pseudo-inverse.
+		std::vector<double> diag(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			diag[i] = coarsestL[i * n + i];
+		}
+
+		for (size_t j = 0; j < n; ++j)
+		{
+			double d = coarsestL[j * n + j];
+			for (size_t k = 0; k < j; ++k)
+			{
+				d -= Square(coarsestL[j * n + k]);
+			}
+
+			if (d <= 1e-10 * std::fabs(diag[j]))
+			{
+				for (size_t i = j; i < n; ++i)
+				{
+					coarsestL[i * n + j] = 0.0;
+				}
+
+				continue;
+			}
+
+			const double ljj = std::sqrt(d);
+			coarsestL[j * n + j] = ljj;
+			coarsestPivots[j] = 1;
+
+			for (size_t i = j + 1; i < n; ++i)
+			{
+				double sum = coarsestL[i * n + j];
+				for (size_t k = 0; k < j; ++k)
+				{
+					sum -= coarsestL[i * n + k] * coarsestL[j * n + k];
+				}
+
+				coarsestL[i * n + j] = sum / ljj;
+			}
+		}
+	}
+
+	void FDMAMGPCGSolver3::Preconditioner::SolveCoarsest()
+	{
+		Level& level = levels.back();
+		const size_t n = level.A->Rows();
+
+		// L y = b
+		for (size_t i = 0; i < n; ++i)
+		{
+			double sum = level.b[i];
+			for (size_t k = 0; k < i; ++k)
+			{
+				sum -= coarsestL[i * n + k] * level.x[k];
+			}
+
+			level.x[i] = coarsestPivots[i] ? sum / coarsestL[i * n + i] : 0.0;
+		}
+
+		// L^T x = y
+		for (size_t i = n; i-- > 0;)
+		{
+			double sum = level.x[i];
+			for (size_t k = i + 1; k < n; ++k)
+			{
+				sum -= coarsestL[k * n + i] * level.x[k];
+			}
+
+			level.x[i] = coarsestPivots[i] ? sum / coarsestL[i * n + i] : 0.0;
+		}
+	}
+
+	void FDMAMGPCGSolver3::Preconditioner::VCycle(size_t l)
+	{
+		if (l + 1 == levels.size())
+		{
+			SolveCoarsest();
+			return;
+		}
+
+		Level& level = levels[l];
+		Level& coarser = levels[l + 1];
+
+		const auto smooth = [&]()
+		{
+			FDMCompressedBLAS3::Residual(*level.A, level.x, level.b, &level.r);
+			level.x.ParallelForEachIndex([&](size_t i)
+			{
+				level.x[i] += level.invDiag[i] * level.r[i];
+			});
+		};
+
+		// Pre-smoothing from zero
+		level.x.Set(0.0);
+		for (unsigned int iter = 0; iter < numberOfSmoothingIter; ++iter)
+		{
+			smooth();
+		}
+
+		// Restrict the residual
+		FDMCompressedBLAS3::Residual(*level.A, level.x, level.b, &level.r);
+		level.R.MVM(level.r, &coarser.b);
+
+		VCycle(l + 1);
+
+		// Prolongate the correction
+		level.P.MVM(coarser.x, &level.r);
+		level.x.ParallelForEachIndex([&](size_t i)
+		{
+			level.x[i] += level.r[i];
+		});
+
+		// Post-smoothing
+		for (unsigned int iter = 0; iter < numberOfSmoothingIter; ++iter)
+		{
+			smooth();
+		}
+	}
+
+	void FDMAMGPCGSolver3::Preconditioner::Solve(const VectorND& b, VectorND* x)
+	{
+		levels.front().b.Set(b);
+		VCycle(0);
+		x->Set(levels.front().x);
+	}
+
+	FDMAMGPCGSolver3::FDMAMGPCGSolver3(
+		unsigned int maxNumberOfIterations,
+		double tolerance,
+		size_t maxNumberOfLevels,
+		unsigned int numberOfSmoothingIter,
+		double strengthThreshold,
+		size_t maxCoarsestSize) :
+		m_maxNumberOfIterations(maxNumberOfIterations),
+		m_lastNumberOfIterations(0),
+		m_tolerance(tolerance),
+		m_lastResidualNorm(std::numeric_limits<double>::max()),
+		m_maxNumberOfLevels(maxNumberOfLevels),
+		m_strengthThreshold(strengthThreshold),
+		m_maxCoarsestSize(maxCoarsestSize)
+	{
+		m_precond.numberOfSmoothingIter = numberOfSmoothingIter;
+	}
+
+	bool FDMAMGPCGSolver3::Solve(FDMLinearSystem3* system)
+	{
+		const FDMMatrix3& a = system->A;
+		const Size3 size = a.size();
+		const size_t n = size.x * size.y * size.z;
+		const auto acc = a.ConstAccessor();
+
+		// Convert to the compressed system with one row per grid point
+		m_compSystem.Clear();
+		BuildMatrixByRows(n, n,
+			[&](size_t idx, const auto& add)
+		{
+			const size_t i = idx % size.x;
+			const size_t j = (idx / size.x) % size.y;
+			const size_t k = idx / (size.x * size.y);
+
+			const auto addOffDiagonal = [&](size_t col, double value)
+			{
+				if (value != 0.0)
+				{
+					add(col, value);
+				}
+			};
+
+			add(idx, a[idx].center);
+			if (i > 0)
+			{
+				addOffDiagonal(acc.Index(i - 1, j, k), a(i - 1, j, k).right);
+			}
+			if (i + 1 < size.x)
+			{
+				addOffDiagonal(acc.Index(i + 1, j, k), a[idx].right);
+			}
+			if (j > 0)
+			{
+				addOffDiagonal(acc.Index(i, j - 1, k), a(i, j - 1, k).up);
+			}
+			if (j + 1 < size.y)
+			{
+				addOffDiagonal(acc.Index(i, j + 1, k), a[idx].up);
+			}
+			if (k > 0)
+			{
+				addOffDiagonal(acc.Index(i, j, k - 1), a(i, j, k - 1).front);
+			}
+			if (k + 1 < size.z)
+			{
+				addOffDiagonal(acc.Index(i, j, k + 1), a[idx].front);
+			}
+		}, &m_compSystem.A);
+
+		m_compSystem.b.Resize(n);
+		m_compSystem.x.Resize(n);
+		std::copy(system->b.data(), system->b.data() + n, m_compSystem.b.data());
+		if (m_useInitialGuess)
+		{
+			std::copy(system->x.data(), system->x.data() + n, m_compSystem.x.data());
+		}
+
+		const bool result = SolveCompressed(&m_compSystem);
+
+		std::copy(m_compSystem.x.data(), m_compSystem.x.data() + n, system->x.data());
+
+		return result;
+	}
+
+	bool FDMAMGPCGSolver3::SolveCompressed(FDMCompressedLinearSystem3* system)
+	{
+		MatrixCSRD& matrix = system->A;
+		VectorND& solution = system->x;
+		VectorND& rhs = system->b;
+
+		const size_t size = solution.size();
+		m_r.Resize(size);
+		m_d.Resize(size);
+		m_q.Resize(size);
+		m_s.Resize(size);
+
+		if (!m_useInitialGuess)
+		{
+			system->x.Set(0.0);
+		}
+
+		m_r.Set(0.0);
+		m_d.Set(0.0);
+		m_q.Set(0.0);
+		m_s.Set(0.0);
+
+		m_precond.Build(matrix, m_maxNumberOfLevels, m_strengthThreshold, m_maxCoarsestSize);
+
+		PCG<FDMCompressedBLAS3, Preconditioner>(
+			matrix, rhs,
+			m_maxNumberOfIterations, m_tolerance, &m_precond,
+			&solution, &m_r, &m_d, &m_q, &m_s,
+			&m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+
+		CUBBYFLOW_INFO << "Residual after solving AMGPCG: " << m_lastResidualNorm
+			<< " Number of AMGPCG iterations: " << m_lastNumberOfIterations
+			<< " Number of AMG levels: " << m_precond.levels.size();
+
+		return m_lastResidualNorm <= m_tolerance || m_lastNumberOfIterations < m_maxNumberOfIterations;
+	}
+
+	unsigned int FDMAMGPCGSolver3::GetMaxNumberOfIterations() const
+	{
+		return m_maxNumberOfIterations;
+	}
+
+	unsigned int FDMAMGPCGSolver3::GetLastNumberOfIterations() const
+	{
+		return m_lastNumberOfIterations;
+	}
+
+	double FDMAMGPCGSolver3::GetTolerance() const
+	{
+		return m_tolerance;
+	}
+
+	void FDMAMGPCGSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
+	double FDMAMGPCGSolver3::GetLastResidual() const
+	{
+		return m_lastResidualNorm;
+	}
+
+	size_t FDMAMGPCGSolver3::GetNumberOfLevels() const
+	{
+		return m_precond.levels.size();
+	}
+}
\ No newline at end of file
@@ -6,7 +6,6 @@
 > Created Time: 2017/08/16
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
-#include <Math/CG.h>
 #include <Solver/FDM/FDMCGSolver3.h>
 
 namespace CubbyFlow
@@ -37,14 +36,45 @@ namespace CubbyFlow
 		m_q.Resize(size);
 		m_s.Resize(size);
 
-		system->x.Set(0.0);
+		if (!m_useInitialGuess)
+		{
+			system->x.Set(0.0);
+		}
+
 		m_r.Set(0.0);
 		m_d.Set(0.0);
 		m_q.Set(0.0);
 		m_s.Set(0.0);
 
-		CG<FDMBLAS3>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &solution,
-			&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidual);
+		if (m_cgMethod == CGMethod::Fused)
+		{
+			ClearPipelinedVectors();
+
+			FusedCG<FDMBLAS3>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &solution,
+				&m_r, &m_d, &m_q, &m_lastNumberOfIterations, &m_lastResidual, &m_lastResidualHistory);
+		}
+		else if (m_cgMethod == CGMethod::Pipelined)
+		{
+			m_u.Resize(size);
+			m_w.Resize(size);
+			m_m.Resize(size);
+			m_n.Resize(size);
+			m_z.Resize(size);
+			m_p.Resize(size);
+
+			NullCGPreconditioner<FDMBLAS3> precond;
+			PipelinedPCG<FDMBLAS3, NullCGPreconditioner<FDMBLAS3>>(matrix, rhs,
+				m_maxNumberOfIterations, m_tolerance, &precond, &solution,
+				&m_r, &m_u, &m_w, &m_m, &m_n, &m_z, &m_q, &m_s, &m_p,
+				&m_lastNumberOfIterations, &m_lastResidual, &m_lastResidualHistory);
+		}
+		else
+		{
+			ClearPipelinedVectors();
+
+			CG<FDMBLAS3>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &solution,
+				&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidual, &m_lastResidualHistory);
+		}
 
 		return (m_lastResidual <= m_tolerance) || (m_lastNumberOfIterations < m_maxNumberOfIterations);
 	}
@@ -56,6 +86,7 @@ namespace CubbyFlow
         VectorND& rhs = system->b;
 
         ClearUncompressedVectors();
+        ClearPipelinedVectors();
 
         const size_t size = solution.size();
         m_rComp.Resize(size);
@@ -63,18 +94,56 @@ namespace CubbyFlow
         m_qComp.Resize(size);
         m_sComp.Resize(size);
 
-        system->x.Set(0.0);
+        if (!m_useInitialGuess)
+        {
+            system->x.Set(0.0);
+        }
+
         m_rComp.Set(0.0);
         m_dComp.Set(0.0);
         m_qComp.Set(0.0);
         m_sComp.Set(0.0);
 
         CG<FDMCompressedBLAS3>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &solution,
-            &m_rComp, &m_dComp, &m_qComp, &m_sComp, &m_lastNumberOfIterations, &m_lastResidual);
+            &m_rComp, &m_dComp, &m_qComp, &m_sComp, &m_lastNumberOfIterations, &m_lastResidual, &m_lastResidualHistory);
 
         return (m_lastResidual <= m_tolerance) || (m_lastNumberOfIterations < m_maxNumberOfIterations);
     }
 
+	bool FDMCGSolver3::SolveMatrixFree(FDMMatrixFreeLinearSystem3* system)
+	{
+		FDMMatrixFree3& matrix = system->A;
+		FDMVector3& solution = system->x;
+		FDMVector3& rhs = system->b;
+
+		assert(matrix.size() == rhs.size());
+		assert(matrix.size() == solution.size());
+
+		ClearCompressedVectors();
+		ClearPipelinedVectors();
+
+		const Size3 size = matrix.size();
+		m_r.Resize(size);
+		m_d.Resize(size);
+		m_q.Resize(size);
+		m_s.Resize(size);
+
+		if (!m_useInitialGuess)
+		{
+			system->x.Set(0.0);
+		}
+
+		m_r.Set(0.0);
+		m_d.Set(0.0);
+		m_q.Set(0.0);
+		m_s.Set(0.0);
+
+		CG<FDMMatrixFreeBLAS3>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &solution,
+			&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidual, &m_lastResidualHistory);
+
+		return (m_lastResidual <= m_tolerance) || (m_lastNumberOfIterations < m_maxNumberOfIterations);
+	}
+
 	unsigned int FDMCGSolver3::GetMaxNumberOfIterations() const
 	{
 		return m_maxNumberOfIterations;
@@ -90,11 +159,26 @@ namespace CubbyFlow
 		return m_tolerance;
 	}
 
+	void FDMCGSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
 	double FDMCGSolver3::GetLastResidual() const
 	{
 		return m_lastResidual;
 	}
 
+	CGMethod FDMCGSolver3::GetCGMethod() const
+	{
+		return m_cgMethod;
+	}
+
+	void FDMCGSolver3::SetCGMethod(CGMethod method)
+	{
+		m_cgMethod = method;
+	}
+
     void FDMCGSolver3::ClearUncompressedVectors()
     {
         m_r.Clear();
@@ -110,4 +194,14 @@ namespace CubbyFlow
         m_qComp.Clear();
         m_sComp.Clear();
     }
+
+    void FDMCGSolver3::ClearPipelinedVectors()
+    {
+        m_u.Clear();
+        m_w.Clear();
+        m_m.Clear();
+        m_n.Clear();
+        m_z.Clear();
+        m_p.Clear();
+    }
 }
\ No newline at end of file
@@ -109,6 +109,11 @@ namespace CubbyFlow
 		return m_tolerance;
 	}
 
+	void FDMGaussSeidelSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
 	double FDMGaussSeidelSolver3::GetLastResidual() const
 	{
 		return m_lastResidual;
@@ -241,6 +246,47 @@ namespace CubbyFlow
 		});
 	}
 
+	void FDMGaussSeidelSolver3::Relax(const FDMMatrixFree3& A, const FDMVector3& b,
+		double sorFactor, FDMVector3* x)
+	{
+		FDMVector3& refX = *x;
+
+		A.markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			double center, offDiagonal;
+			A.Row(i, j, k, refX, &center, &offDiagonal);
+
+			refX(i, j, k) = (1.0 - sorFactor) * refX(i, j, k) +
+				sorFactor * (b(i, j, k) - offDiagonal) / center;
+		});
+	}
+
+	void FDMGaussSeidelSolver3::RelaxRedBlack(const FDMMatrixFree3& A, const FDMVector3& b,
+		double sorFactor, FDMVector3* x)
+	{
+		Size3 size = A.size();
+		FDMVector3& refX = *x;
+
+		// Red update (color 0) and black update (color 1)
+		for (size_t color = 0; color < 2; ++color)
+		{
+			ParallelFor(ZERO_SIZE, size.y * size.z, [&](size_t n)
+			{
+				const size_t j = n % size.y;
+				const size_t k = n / size.y;
+
+				for (size_t i = (j + k + color) % 2; i < size.x; i += 2)
+				{
+					double center, offDiagonal;
+					A.Row(i, j, k, refX, &center, &offDiagonal);
+
+					refX(i, j, k) = (1.0 - sorFactor) * refX(i, j, k) +
+						sorFactor * (b(i, j, k) - offDiagonal) / center;
+				}
+			});
+		}
+	}
+
     void FDMGaussSeidelSolver3::ClearUncompressedVectors()
     {
         m_residual.Clear();
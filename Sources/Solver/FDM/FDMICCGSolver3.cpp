@@ -10,10 +10,18 @@
 #include <Math/CG.h>
 #include <Solver/FDM/FDMICCGSolver3.h>
 #include <Utils/Logger.h>
+#include <Utils/Parallel.h>
+
+#include <algorithm>
 
 namespace CubbyFlow
 {
-	void FDMICCGSolver3::Preconditioner::Build(const FDMMatrix3& matrix)
+	// Residual reduction of each single-precision correction solve. Float
+	// carries about seven digits, so four digits per pass are safely reachable.
+	static const double SINGLE_PRECISION_RELATIVE_TOLERANCE = 1e-4;
+
+	template <typename T>
+	void FDMICCGSolver3::Preconditioner<T>::Build(const FDMMatrix3& matrix)
 	{
 		const Size3 size = matrix.size();
 		A = matrix.ConstAccessor();
@@ -31,7 +39,7 @@ namespace CubbyFlow
 
 			if (std::fabs(denom) > 0.0)
 			{
-				d(i, j, k) = 1.0 / denom;
+				d(i, j, k) = static_cast<T>(1.0 / denom);
 			}
 			else
 			{
@@ -40,7 +48,8 @@ namespace CubbyFlow
 		});
 	}
 
-	void FDMICCGSolver3::Preconditioner::Solve(const FDMVector3& b, FDMVector3* x)
+	template <typename T>
+	void FDMICCGSolver3::Preconditioner<T>::Solve(const Array3<T>& b, Array3<T>* x)
 	{
 		const Size3 size = b.size();
 		const ssize_t sx = static_cast<ssize_t>(size.x);
@@ -49,12 +58,12 @@ namespace CubbyFlow
 
 		b.ForEachIndex([&](size_t i, size_t j, size_t k)
 		{
-			y(i, j, k) =
+			y(i, j, k) = static_cast<T>(
 				(b(i, j, k) -
 				((i > 0) ? A(i - 1, j, k).right * y(i - 1, j, k) : 0.0) -
 				((j > 0) ? A(i, j - 1, k).up    * y(i, j - 1, k) : 0.0) -
 				((k > 0) ? A(i, j, k - 1).front * y(i, j, k - 1) : 0.0)) *
-				d(i, j, k);
+				d(i, j, k));
 		});
 
 		for (ssize_t k = sz - 1; k >= 0; --k)
@@ -63,12 +72,12 @@ namespace CubbyFlow
 			{
 				for (ssize_t i = sx - 1; i >= 0; --i)
 				{
-					(*x)(i, j, k) =
+					(*x)(i, j, k) = static_cast<T>(
 						(y(i, j, k) -
 						((i + 1 < sx) ? A(i, j, k).right * (*x)(i + 1, j, k) : 0.0) -
 						((j + 1 < sy) ? A(i, j, k).up    * (*x)(i, j + 1, k) : 0.0) -
 						((k + 1 < sz) ? A(i, j, k).front * (*x)(i, j, k + 1) : 0.0)) *
-						d(i, j, k);
+						d(i, j, k));
 				}
 			}
 		}
@@ -164,6 +173,294 @@ namespace CubbyFlow
 		}
 	}
 
+	template <typename T>
+	template <typename Callback>
+	void FDMICCGSolver3::MulticolorPreconditioner<T>::ParallelForEachLineOfColor(size_t color, Callback func) const
+	{
+		// The color of the x-line (j, k) is the parity of j and k
+		const Size3 size = d.size();
+		const size_t py = color & 1;
+		const size_t pz = (color >> 1) & 1;
+
+		if (size.y <= py || size.z <= pz)
+		{
+			return;
+		}
+
+		const size_t numberOfLinesY = (size.y - py + 1) / 2;
+		const size_t numberOfLinesZ = (size.z - pz + 1) / 2;
+
+		ParallelFor(ZERO_SIZE, numberOfLinesY * numberOfLinesZ, [&](size_t n)
+		{
+			func(py + 2 * (n % numberOfLinesY), pz + 2 * (n / numberOfLinesY));
+		});
+	}
+
+	template <typename T>
+	void FDMICCGSolver3::MulticolorPreconditioner<T>::Build(const FDMMatrix3& matrix)
+	{
+		const Size3 size = matrix.size();
+		A = matrix.ConstAccessor();
+
+		d.Resize(size, 0.0);
+		y.Resize(size, 0.0);
+
+		// A neighboring line along y (or z) has a lower color iff the parity of
+		// j (or k) is one.
+		for (size_t color = 0; color < 4; ++color)
+		{
+			const bool lowerY = (color & 1) != 0;
+			const bool lowerZ = (color & 2) != 0;
+
+			ParallelForEachLineOfColor(color, [&](size_t j, size_t k)
+			{
+				for (size_t i = 0; i < size.x; ++i)
+				{
+					double denom =
+						matrix(i, j, k).center -
+						((i > 0) ? Square(matrix(i - 1, j, k).right) * d(i - 1, j, k) : 0.0);
+
+					if (lowerY)
+					{
+						denom -= (j > 0) ? Square(matrix(i, j - 1, k).up) * d(i, j - 1, k) : 0.0;
+						denom -= (j + 1 < size.y) ? Square(matrix(i, j, k).up) * d(i, j + 1, k) : 0.0;
+					}
+					if (lowerZ)
+					{
+						denom -= (k > 0) ? Square(matrix(i, j, k - 1).front) * d(i, j, k - 1) : 0.0;
+						denom -= (k + 1 < size.z) ? Square(matrix(i, j, k).front) * d(i, j, k + 1) : 0.0;
+					}
+
+					if (std::fabs(denom) > 0.0)
+					{
+						d(i, j, k) = static_cast<T>(1.0 / denom);
+					}
+					else
+					{
+						d(i, j, k) = 0.0;
+					}
+				}
+			});
+		}
+	}
+
+	template <typename T>
+	void FDMICCGSolver3::MulticolorPreconditioner<T>::Solve(const Array3<T>& b, Array3<T>* x)
+	{
+		const Size3 size = b.size();
+
+		// Computes v = (rhs - (off-diagonal terms) * v) * d along the x-line
+		// (j, k), coupling with the neighboring lines only if they are enabled.
+		auto substituteLine = [&](const Array3<T>& rhs, Array3<T>& v, bool forward, bool withY, bool withZ, size_t j, size_t k)
+		{
+			const FDMMatrixRow3* a = &A(0, j, k);
+			const FDMMatrixRow3* aDown = (withY && j > 0) ? &A(0, j - 1, k) : nullptr;
+			const FDMMatrixRow3* aBack = (withZ && k > 0) ? &A(0, j, k - 1) : nullptr;
+			const T* vDown = (aDown != nullptr) ? &v(0, j - 1, k) : nullptr;
+			const T* vUp = (withY && j + 1 < size.y) ? &v(0, j + 1, k) : nullptr;
+			const T* vBack = (aBack != nullptr) ? &v(0, j, k - 1) : nullptr;
+			const T* vFront = (withZ && k + 1 < size.z) ? &v(0, j, k + 1) : nullptr;
+			const T* r = &rhs(0, j, k);
+			const T* dd = &d(0, j, k);
+			T* vv = &v(0, j, k);
+
+			for (size_t n = 0; n < size.x; ++n)
+			{
+				const size_t i = forward ? n : size.x - 1 - n;
+				double sum = r[i];
+
+				if (forward && i > 0)
+				{
+					sum -= a[i - 1].right * vv[i - 1];
+				}
+				if (!forward && i + 1 < size.x)
+				{
+					sum -= a[i].right * vv[i + 1];
+				}
+				if (vDown != nullptr)
+				{
+					sum -= aDown[i].up * vDown[i];
+				}
+				if (vUp != nullptr)
+				{
+					sum -= a[i].up * vUp[i];
+				}
+				if (vBack != nullptr)
+				{
+					sum -= aBack[i].front * vBack[i];
+				}
+				if (vFront != nullptr)
+				{
+					sum -= a[i].front * vFront[i];
+				}
+
+				vv[i] = static_cast<T>(sum * dd[i]);
+			}
+		};
+
+		// Forward substitution with the lines of the lower colors
+		for (size_t color = 0; color < 4; ++color)
+		{
+			const bool lowerY = (color & 1) != 0;
+			const bool lowerZ = (color & 2) != 0;
+
+			ParallelForEachLineOfColor(color, [&](size_t j, size_t k)
+			{
+				substituteLine(b, y, true, lowerY, lowerZ, j, k);
+			});
+		}
+
+		// Backward substitution with the lines of the higher colors
+		for (size_t color = 4; color-- > 0;)
+		{
+			const bool lowerY = (color & 1) != 0;
+			const bool lowerZ = (color & 2) != 0;
+
+			ParallelForEachLineOfColor(color, [&](size_t j, size_t k)
+			{
+				substituteLine(y, *x, false, !lowerY, !lowerZ, j, k);
+			});
+		}
+	}
+
+	void FDMICCGSolver3::MulticolorPreconditionerCompressed::Build(const MatrixCSRD& matrix)
+	{
+		const size_t size = matrix.Cols();
+		A = &matrix;
+
+		d.Resize(size, 0.0);
+		y.Resize(size, 0.0);
+
+		const auto rp = A->RowPointersBegin();
+		const auto ci = A->ColumnIndicesBegin();
+		const auto nnz = A->NonZeroBegin();
+
+		// Greedy coloring of the matrix graph
+		const size_t NO_COLOR = std::numeric_limits<size_t>::max();
+		std::vector<size_t> neighborColors;
+
+		colors.assign(size, NO_COLOR);
+		rowsOfColor.clear();
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			neighborColors.clear();
+			for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+			{
+				const size_t j = ci[jj];
+				if (j != i && colors[j] != NO_COLOR)
+				{
+					neighborColors.push_back(colors[j]);
+				}
+			}
+
+			std::sort(neighborColors.begin(), neighborColors.end());
+
+			size_t color = 0;
+			for (size_t c : neighborColors)
+			{
+				if (c == color)
+				{
+					++color;
+				}
+				else if (c > color)
+				{
+					break;
+				}
+			}
+
+			colors[i] = color;
+			if (color >= rowsOfColor.size())
+			{
+				rowsOfColor.resize(color + 1);
+			}
+			rowsOfColor[color].push_back(i);
+		}
+
+		for (const std::vector<size_t>& rows : rowsOfColor)
+		{
+			ParallelFor(ZERO_SIZE, rows.size(), [&](size_t n)
+			{
+				const size_t i = rows[n];
+
+				double denom = 0.0;
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t j = ci[jj];
+
+					if (j == i)
+					{
+						denom += nnz[jj];
+					}
+					else if (colors[j] < colors[i])
+					{
+						denom -= Square(nnz[jj]) * d[j];
+					}
+				}
+
+				if (std::fabs(denom) > 0.0)
+				{
+					d[i] = 1.0 / denom;
+				}
+				else
+				{
+					d[i] = 0.0;
+				}
+			});
+		}
+	}
+
+	void FDMICCGSolver3::MulticolorPreconditionerCompressed::Solve(const VectorND& b, VectorND* x)
+	{
+		const auto rp = A->RowPointersBegin();
+		const auto ci = A->ColumnIndicesBegin();
+		const auto nnz = A->NonZeroBegin();
+
+		for (const std::vector<size_t>& rows : rowsOfColor)
+		{
+			ParallelFor(ZERO_SIZE, rows.size(), [&](size_t n)
+			{
+				const size_t i = rows[n];
+
+				double sum = b[i];
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t j = ci[jj];
+
+					if (colors[j] < colors[i])
+					{
+						sum -= nnz[jj] * y[j];
+					}
+				}
+
+				y[i] = sum * d[i];
+			});
+		}
+
+		for (auto iter = rowsOfColor.rbegin(); iter != rowsOfColor.rend(); ++iter)
+		{
+			const std::vector<size_t>& rows = *iter;
+
+			ParallelFor(ZERO_SIZE, rows.size(), [&](size_t n)
+			{
+				const size_t i = rows[n];
+
+				double sum = y[i];
+				for (size_t jj = rp[i]; jj < rp[i + 1]; ++jj)
+				{
+					const size_t j = ci[jj];
+
+					if (colors[j] > colors[i])
+					{
+						sum -= nnz[jj] * (*x)[j];
+					}
+				}
+
+				(*x)[i] = sum * d[i];
+			});
+		}
+	}
+
 	FDMICCGSolver3::FDMICCGSolver3(unsigned int maxNumberOfIterations, double tolerance) :
 		m_maxNumberOfIterations(maxNumberOfIterations),
 		m_lastNumberOfIterations(0),
@@ -181,6 +478,13 @@ namespace CubbyFlow
 
 		ClearCompressedVectors();
 
+		if (m_useSinglePrecision)
+		{
+			return SolveSinglePrecision(system);
+		}
+
+		ClearSinglePrecisionVectors();
+
 		assert(matrix.size() == rhs.size());
 		assert(matrix.size() == solution.size());
 
@@ -190,16 +494,30 @@ namespace CubbyFlow
 		m_q.Resize(size);
 		m_s.Resize(size);
 
-		system->x.Set(0.0);
+		if (!m_useInitialGuess)
+		{
+			system->x.Set(0.0);
+		}
+
 		m_r.Set(0.0);
 		m_d.Set(0.0);
 		m_q.Set(0.0);
 		m_s.Set(0.0);
 
-		m_precond.Build(matrix);
+		if (m_useMulticolorPreconditioner)
+		{
+			m_mcPrecond.Build(matrix);
 
-		PCG<FDMBLAS3, Preconditioner>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_precond, &solution,
-			&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidualNorm);
+			PCG<FDMBLAS3, MulticolorPreconditioner<double>>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_mcPrecond, &solution,
+				&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
+		else
+		{
+			m_precond.Build(matrix);
+
+			PCG<FDMBLAS3, Preconditioner<double>>(matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_precond, &solution,
+				&m_r, &m_d, &m_q, &m_s, &m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
 
 		CUBBYFLOW_INFO << "Residual norm after solving ICCG: " << m_lastResidualNorm
 			<< " Number of ICCG iterations: " << m_lastNumberOfIterations;
@@ -214,6 +532,7 @@ namespace CubbyFlow
 		VectorND& rhs = system->b;
 
 		ClearUncompressedVectors();
+		ClearSinglePrecisionVectors();
 
 		const size_t size = solution.size();
 		m_rComp.Resize(size);
@@ -221,17 +540,32 @@ namespace CubbyFlow
 		m_qComp.Resize(size);
 		m_sComp.Resize(size);
 
-		system->x.Set(0.0);
+		if (!m_useInitialGuess)
+		{
+			system->x.Set(0.0);
+		}
+
 		m_rComp.Set(0.0);
 		m_dComp.Set(0.0);
 		m_qComp.Set(0.0);
 		m_sComp.Set(0.0);
 
-		m_precondComp.Build(matrix);
+		if (m_useMulticolorPreconditioner)
+		{
+			m_mcPrecondComp.Build(matrix);
+
+			PCG<FDMCompressedBLAS3, MulticolorPreconditionerCompressed>(
+				matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_mcPrecondComp, &solution,
+				&m_rComp, &m_dComp, &m_qComp, &m_sComp, &m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
+		else
+		{
+			m_precondComp.Build(matrix);
 
-		PCG<FDMCompressedBLAS3, PreconditionerCompressed>(
-			matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_precondComp, &solution,
-			&m_rComp, &m_dComp, &m_qComp, &m_sComp, &m_lastNumberOfIterations, &m_lastResidualNorm);
+			PCG<FDMCompressedBLAS3, PreconditionerCompressed>(
+				matrix, rhs, m_maxNumberOfIterations, m_tolerance, &m_precondComp, &solution,
+				&m_rComp, &m_dComp, &m_qComp, &m_sComp, &m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
 
 		CUBBYFLOW_INFO << "Residual after solving ICCG: " << m_lastResidualNorm
 			<< " Number of ICCG iterations: " << m_lastNumberOfIterations;
@@ -254,11 +588,146 @@ namespace CubbyFlow
 		return m_tolerance;
 	}
 
+	void FDMICCGSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
 	double FDMICCGSolver3::GetLastResidual() const
 	{
 		return m_lastResidualNorm;
 	}
 
+	bool FDMICCGSolver3::GetUseSinglePrecision() const
+	{
+		return m_useSinglePrecision;
+	}
+
+	void FDMICCGSolver3::SetUseSinglePrecision(bool useSinglePrecision)
+	{
+		m_useSinglePrecision = useSinglePrecision;
+	}
+
+	bool FDMICCGSolver3::GetUseMulticolorPreconditioner() const
+	{
+		return m_useMulticolorPreconditioner;
+	}
+
+	void FDMICCGSolver3::SetUseMulticolorPreconditioner(bool useMulticolorPreconditioner)
+	{
+		m_useMulticolorPreconditioner = useMulticolorPreconditioner;
+	}
+
+	bool FDMICCGSolver3::SolveSinglePrecision(FDMLinearSystem3* system)
+	{
+		FDMMatrix3& matrix = system->A;
+		FDMVector3& solution = system->x;
+
+		ClearUncompressedVectors();
+
+		assert(matrix.size() == system->b.size());
+		assert(matrix.size() == solution.size());
+
+		const Size3 size = matrix.size();
+		m_eF.Resize(size);
+		m_bF.Resize(size);
+		m_rF.Resize(size);
+		m_dF.Resize(size);
+		m_qF.Resize(size);
+		m_sF.Resize(size);
+
+		if (!m_useInitialGuess)
+		{
+			solution.Set(0.0);
+		}
+
+		if (m_useMulticolorPreconditioner)
+		{
+			m_mcPrecondF.Build(matrix);
+
+			SolveWithSinglePrecisionCorrections(system, &m_mcPrecondF);
+		}
+		else
+		{
+			m_precondF.Build(matrix);
+
+			SolveWithSinglePrecisionCorrections(system, &m_precondF);
+		}
+
+		CUBBYFLOW_INFO << "Residual norm after solving single-precision ICCG: " << m_lastResidualNorm
+			<< " Number of ICCG iterations: " << m_lastNumberOfIterations;
+
+		return (m_lastResidualNorm <= m_tolerance) || (m_lastNumberOfIterations < m_maxNumberOfIterations);
+	}
+
+	template <typename PrecondType>
+	void FDMICCGSolver3::SolveWithSinglePrecisionCorrections(FDMLinearSystem3* system, PrecondType* precond)
+	{
+		FDMMatrix3& matrix = system->A;
+		FDMVector3& solution = system->x;
+		FDMVector3& rhs = system->b;
+
+		unsigned int numberOfIterations = 0;
+		double residualNorm = std::numeric_limits<double>::max();
+
+		m_lastResidualHistory.clear();
+
+		while (true)
+		{
+			// r = b - Ax, evaluated in double and rounded to float
+			FDMBLAS3F::Residual(matrix, solution, rhs, &m_bF);
+
+			// Measure it the same way as PCG does: sqrt(r.M^-1r)
+			precond->Solve(m_bF, &m_sF);
+
+			const double lastResidualNorm = residualNorm;
+			residualNorm = std::sqrt(std::fabs(FDMBLAS3F::Dot(m_bF, m_sF)));
+
+			// The last entry of a pass is the float estimate of this residual
+			if (m_lastResidualHistory.empty())
+			{
+				m_lastResidualHistory.push_back(residualNorm);
+			}
+			else
+			{
+				m_lastResidualHistory.back() = residualNorm;
+			}
+
+			if (residualNorm <= m_tolerance ||
+				numberOfIterations >= m_maxNumberOfIterations ||
+				residualNorm >= lastResidualNorm)
+			{
+				break;
+			}
+
+			// Solve Ae = r in float. Float cannot reach an absolute tolerance far
+			// below its epsilon relative to r, so each pass only reduces the
+			// residual by a fixed ratio and the next pass corrects the rest.
+			const double tolerance = std::max(m_tolerance, SINGLE_PRECISION_RELATIVE_TOLERANCE * residualNorm);
+			unsigned int numberOfCorrectionIterations = 0;
+			double correctionResidualNorm = 0.0;
+
+			m_eF.Set(0.0f);
+			PCG<FDMBLAS3F, PrecondType>(matrix, m_bF, m_maxNumberOfIterations - numberOfIterations, tolerance, precond, &m_eF,
+				&m_rF, &m_dF, &m_qF, &m_sF, &numberOfCorrectionIterations, &correctionResidualNorm, &m_correctionResidualHistory);
+
+			numberOfIterations += numberOfCorrectionIterations;
+
+			// The residual of Ae = r is the residual of Ax = b
+			m_lastResidualHistory.insert(m_lastResidualHistory.end(),
+				m_correctionResidualHistory.begin() + 1, m_correctionResidualHistory.end());
+
+			// x = x + e
+			solution.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				solution(i, j, k) += m_eF(i, j, k);
+			});
+		}
+
+		m_lastNumberOfIterations = numberOfIterations;
+		m_lastResidualNorm = residualNorm;
+	}
+
 	void FDMICCGSolver3::ClearUncompressedVectors()
 	{
 		m_r.Clear();
@@ -274,4 +743,14 @@ namespace CubbyFlow
 		m_q.Clear();
 		m_s.Clear();
 	}
+
+	void FDMICCGSolver3::ClearSinglePrecisionVectors()
+	{
+		m_eF.Clear();
+		m_bF.Clear();
+		m_rF.Clear();
+		m_dF.Clear();
+		m_qF.Clear();
+		m_sF.Clear();
+	}
 }
\ No newline at end of file
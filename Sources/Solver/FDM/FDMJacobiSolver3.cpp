@@ -103,6 +103,11 @@ namespace CubbyFlow
 		return m_tolerance;
 	}
 
+	void FDMJacobiSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
 	double FDMJacobiSolver3::GetLastResidual() const
 	{
 		return m_lastResidual;
@@ -7,7 +7,6 @@
 > Created Time: 2017/11/05
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
-#include <Math/CG.h>
 #include <Solver/FDM/FDMMGPCGSolver3.h>
 #include <Utils/Logger.h>
 
@@ -36,6 +35,29 @@ namespace CubbyFlow
 		x->Set(mgX.levels.front());
 	}
 
+	void FDMMGPCGSolver3::MatrixFreePreconditioner::Build(FDMMGMatrixFreeLinearSystem3* _system, MGParameters<FDMMatrixFreeBLAS3> _mgParams)
+	{
+		system = _system;
+		mgParams = _mgParams;
+	}
+
+	void FDMMGPCGSolver3::MatrixFreePreconditioner::Solve(const FDMVector3& b, FDMVector3* x) const
+	{
+		// Copy dimension
+		FDMMGMatrixFreeVector3 mgX = system->x;
+		FDMMGMatrixFreeVector3 mgB = system->x;
+		FDMMGMatrixFreeVector3 mgBuffer = system->x;
+
+		// Copy input to the top
+		mgX.levels.front().Set(*x);
+		mgB.levels.front().Set(b);
+
+		MGVCycle(system->A, mgParams, &mgX, &mgB, &mgBuffer);
+
+		// Copy result to the output
+		x->Set(mgX.levels.front());
+	}
+
 	FDMMGPCGSolver3::FDMMGPCGSolver3(
 		unsigned int numberOfCGIter,
 		size_t maxNumberOfLevels,
@@ -66,7 +88,11 @@ namespace CubbyFlow
 		m_q.Resize(size);
 		m_s.Resize(size);
 
-		system->x.levels.front().Set(0.0);
+		if (!m_useInitialGuess)
+		{
+			system->x.levels.front().Set(0.0);
+		}
+
 		m_r.Set(0.0);
 		m_d.Set(0.0);
 		m_q.Set(0.0);
@@ -74,14 +100,82 @@ namespace CubbyFlow
 
 		m_precond.Build(system, GetParams());
 
-		PCG<FDMBLAS3, Preconditioner>(
+		if (m_cgMethod == CGMethod::Fused)
+		{
+			ClearPipelinedVectors();
+
+			FusedPCG<FDMBLAS3, Preconditioner>(
+				system->A.levels.front(),
+				system->b.levels.front(),
+				m_maxNumberOfIterations, m_tolerance, &m_precond,
+				&system->x.levels.front(), &m_r, &m_d, &m_q, &m_s,
+				&m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
+		else if (m_cgMethod == CGMethod::Pipelined)
+		{
+			m_u.Resize(size);
+			m_w.Resize(size);
+			m_m.Resize(size);
+			m_n.Resize(size);
+			m_z.Resize(size);
+			m_p.Resize(size);
+
+			PipelinedPCG<FDMBLAS3, Preconditioner>(
+				system->A.levels.front(),
+				system->b.levels.front(),
+				m_maxNumberOfIterations, m_tolerance, &m_precond,
+				&system->x.levels.front(), &m_r, &m_u, &m_w, &m_m, &m_n,
+				&m_z, &m_q, &m_s, &m_p,
+				&m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
+		else
+		{
+			ClearPipelinedVectors();
+
+			PCG<FDMBLAS3, Preconditioner>(
+				system->A.levels.front(),
+				system->b.levels.front(),
+				m_maxNumberOfIterations, m_tolerance, &m_precond,
+				&system->x.levels.front(), &m_r, &m_d, &m_q, &m_s,
+				&m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
+		}
+
+		CUBBYFLOW_INFO << "Residual after solving MGPCG: " << m_lastResidualNorm
+			<< " Number of MGPCG iterations: " << m_lastNumberOfIterations;
+
+		return m_lastResidualNorm <= m_tolerance || m_lastNumberOfIterations < m_maxNumberOfIterations;
+	}
+
+	bool FDMMGPCGSolver3::SolveMatrixFree(FDMMGMatrixFreeLinearSystem3* system)
+	{
+		const Size3 size = system->A.levels.front().size();
+		m_r.Resize(size);
+		m_d.Resize(size);
+		m_q.Resize(size);
+		m_s.Resize(size);
+
+		if (!m_useInitialGuess)
+		{
+			system->x.levels.front().Set(0.0);
+		}
+
+		m_r.Set(0.0);
+		m_d.Set(0.0);
+		m_q.Set(0.0);
+		m_s.Set(0.0);
+
+		ClearPipelinedVectors();
+
+		m_matrixFreePrecond.Build(system, GetMatrixFreeParams());
+
+		PCG<FDMMatrixFreeBLAS3, MatrixFreePreconditioner>(
 			system->A.levels.front(),
 			system->b.levels.front(),
-			m_maxNumberOfIterations, m_tolerance, &m_precond,
+			m_maxNumberOfIterations, m_tolerance, &m_matrixFreePrecond,
 			&system->x.levels.front(), &m_r, &m_d, &m_q, &m_s,
-			&m_lastNumberOfIterations, &m_lastResidualNorm);
+			&m_lastNumberOfIterations, &m_lastResidualNorm, &m_lastResidualHistory);
 
-		CUBBYFLOW_INFO << "Residual after solving MGPCG: " << m_lastResidualNorm
+		CUBBYFLOW_INFO << "Residual after solving matrix-free MGPCG: " << m_lastResidualNorm
 			<< " Number of MGPCG iterations: " << m_lastNumberOfIterations;
 
 		return m_lastResidualNorm <= m_tolerance || m_lastNumberOfIterations < m_maxNumberOfIterations;
@@ -102,8 +196,33 @@ namespace CubbyFlow
 		return m_tolerance;
 	}
 
+	void FDMMGPCGSolver3::SetTolerance(double tolerance)
+	{
+		m_tolerance = tolerance;
+	}
+
 	double FDMMGPCGSolver3::GetLastResidual() const
 	{
 		return m_lastResidualNorm;
 	}
+
+	CGMethod FDMMGPCGSolver3::GetCGMethod() const
+	{
+		return m_cgMethod;
+	}
+
+	void FDMMGPCGSolver3::SetCGMethod(CGMethod method)
+	{
+		m_cgMethod = method;
+	}
+
+	void FDMMGPCGSolver3::ClearPipelinedVectors()
+	{
+		m_u.Clear();
+		m_w.Clear();
+		m_m.Clear();
+		m_n.Clear();
+		m_z.Clear();
+		m_p.Clear();
+	}
 }
\ No newline at end of file
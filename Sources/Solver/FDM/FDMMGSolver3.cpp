@@ -60,6 +60,33 @@ namespace CubbyFlow
 
 		m_mgParams.restrictFunc = FDMMGUtils3::Restrict;
 		m_mgParams.correctFunc = FDMMGUtils3::Correct;
+
+		m_mgMatrixFreeParams.maxNumberOfLevels = maxNumberOfLevels;
+		m_mgMatrixFreeParams.numberOfRestrictionIter = numberOfRestrictionIter;
+		m_mgMatrixFreeParams.numberOfCorrectionIter = numberOfCorrectionIter;
+		m_mgMatrixFreeParams.numberOfCoarsestIter = numberOfCoarsestIter;
+		m_mgMatrixFreeParams.numberOfFinalIter = numberOfFinalIter;
+		m_mgMatrixFreeParams.maxTolerance = maxTolerance;
+		m_mgMatrixFreeParams.relaxFunc = [sorFactor, useRedBlackOrdering](const FDMMatrixFree3& A, const FDMVector3& b,
+			unsigned int numberOfIterations, double maxTolerance, FDMVector3* x, FDMVector3* buffer)
+		{
+			UNUSED_VARIABLE(maxTolerance);
+			UNUSED_VARIABLE(buffer);
+
+			for (unsigned int iter = 0; iter < numberOfIterations; ++iter)
+			{
+				if (useRedBlackOrdering)
+				{
+					FDMGaussSeidelSolver3::RelaxRedBlack(A, b, sorFactor, x);
+				}
+				else
+				{
+					FDMGaussSeidelSolver3::Relax(A, b, sorFactor, x);
+				}
+			}
+		};
+		m_mgMatrixFreeParams.restrictFunc = FDMMGUtils3::Restrict;
+		m_mgMatrixFreeParams.correctFunc = FDMMGUtils3::Correct;
 		m_sorFactor = sorFactor;
 		m_useRedBlackOrdering = useRedBlackOrdering;
 	}
@@ -69,6 +96,11 @@ namespace CubbyFlow
 		return m_mgParams;
 	}
 
+	const MGParameters<FDMMatrixFreeBLAS3>& FDMMGSolver3::GetMatrixFreeParams() const
+	{
+		return m_mgMatrixFreeParams;
+	}
+
 	double FDMMGSolver3::GetSORFactor() const
 	{
 		return m_sorFactor;
@@ -79,6 +111,22 @@ namespace CubbyFlow
 		return m_useRedBlackOrdering;
 	}
 
+	double FDMMGSolver3::GetTolerance() const
+	{
+		return m_mgParams.maxTolerance;
+	}
+
+	void FDMMGSolver3::SetTolerance(double tolerance)
+	{
+		m_mgParams.maxTolerance = tolerance;
+		m_mgMatrixFreeParams.maxTolerance = tolerance;
+	}
+
+	double FDMMGSolver3::GetLastResidual() const
+	{
+		return m_lastResidualNorm;
+	}
+
 	bool FDMMGSolver3::Solve(FDMLinearSystem3* system)
 	{
 		UNUSED_VARIABLE(system);
@@ -90,6 +138,22 @@ namespace CubbyFlow
 	{
 		FDMMGVector3 buffer = system->x;
 		auto result = MGVCycle(system->A, m_mgParams, &system->x, &system->b, &buffer);
+		m_lastResidualNorm = result.lastResidualNorm;
 		return result.lastResidualNorm < m_mgParams.maxTolerance;
 	}
+
+	bool FDMMGSolver3::SolveMatrixFree(FDMMatrixFreeLinearSystem3* system)
+	{
+		UNUSED_VARIABLE(system);
+
+		return false;
+	}
+
+	bool FDMMGSolver3::SolveMatrixFree(FDMMGMatrixFreeLinearSystem3* system)
+	{
+		FDMMGMatrixFreeVector3 buffer = system->x;
+		auto result = MGVCycle(system->A, m_mgMatrixFreeParams, &system->x, &system->b, &buffer);
+		m_lastResidualNorm = result.lastResidualNorm;
+		return result.lastResidualNorm < m_mgMatrixFreeParams.maxTolerance;
+	}
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 *************************************************************************/
 #include <Solver/FLIP/FLIPSolver3.h>
 
+#include <array>
+
 namespace CubbyFlow
 {
 	FLIPSolver3::FLIPSolver3() :
@@ -103,27 +105,50 @@ namespace CubbyFlow
 			flow->GridSpacing().CastTo<float>(),
 			flow->GetWOrigin().CastTo<float>());
 
-		auto sampler = [uSampler, vSampler, wSampler](const Vector3D& x)
-		{
-			const auto xf = x.CastTo<float>();
-			double u = uSampler(xf);
-			double v = vSampler(xf);
-			double w = wSampler(xf);
-			return Vector3D(u, v, w);
-		};
-
-		// Transfer delta to the particles
-		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		auto flowSampler = flow->LinearSampler();
+
+		// Transfer delta to the particles in blocks, so the grid values of a
+		// block are looked up with the batch samplers.
+		constexpr size_t blockSize = 64;
+
+		ParallelRangeFor(ZERO_SIZE, numberOfParticles, [&](size_t begin, size_t end)
 		{
-			Vector3D flipVel = velocities[i] + sampler(positions[i]);
+			std::array<Vector3F, blockSize> pts;
+			std::array<float, blockSize> uDelta, vDelta, wDelta;
+			std::array<Vector3D, blockSize> picVels;
 
-			if (m_picBlendingFactor > 0.0) 
+			for (size_t blockBegin = begin; blockBegin < end; blockBegin += blockSize)
 			{
-				Vector3D picVel = flow->Sample(positions[i]);
-				flipVel = Lerp(flipVel, picVel, m_picBlendingFactor);
+				const size_t count = std::min(blockSize, end - blockBegin);
+
+				for (size_t n = 0; n < count; ++n)
+				{
+					pts[n] = positions[blockBegin + n].CastTo<float>();
+				}
+
+				const ConstArrayAccessor1<Vector3F> blockPts(count, pts.data());
+				uSampler(blockPts, ArrayAccessor1<float>(count, uDelta.data()));
+				vSampler(blockPts, ArrayAccessor1<float>(count, vDelta.data()));
+				wSampler(blockPts, ArrayAccessor1<float>(count, wDelta.data()));
+
+				if (m_picBlendingFactor > 0.0)
+				{
+					flowSampler(ConstArrayAccessor1<Vector3D>(count, positions.data() + blockBegin), ArrayAccessor1<Vector3D>(count, picVels.data()));
+				}
+
+				for (size_t n = 0; n < count; ++n)
+				{
+					const size_t i = blockBegin + n;
+					Vector3D flipVel = velocities[i] + Vector3D(uDelta[n], vDelta[n], wDelta[n]);
+
+					if (m_picBlendingFactor > 0.0)
+					{
+						flipVel = Lerp(flipVel, picVels[n], m_picBlendingFactor);
+					}
+
+					velocities[i] = flipVel;
+				}
 			}
-
-			velocities[i] = flipVel;
 		});
 	}
 
@@ -313,16 +313,7 @@ namespace CubbyFlow
 
 			for (size_t i = 0; i < n; ++i)
 			{
-				auto grid = m_grids->GetAdvectableScalarDataAt(i);
-				auto grid0 = grid->Clone();
-
-				m_advectionSolver->Advect(
-					*grid0,
-					*vel,
-					timeIntervalInSeconds,
-					grid.get(),
-					*GetColliderSDF());
-				ExtrapolateIntoCollider(grid.get());
+				ComputeScalarDataAdvection(i, timeIntervalInSeconds);
 			}
 
 			// Solve advections for custom vector fields.
@@ -383,6 +374,20 @@ namespace CubbyFlow
 		}
 	}
 
+	void GridFluidSolver3::ComputeScalarDataAdvection(size_t index, double timeIntervalInSeconds)
+	{
+		auto grid = m_grids->GetAdvectableScalarDataAt(index);
+		auto grid0 = grid->Clone();
+
+		m_advectionSolver->Advect(
+			*grid0,
+			*GetVelocity(),
+			timeIntervalInSeconds,
+			grid.get(),
+			*GetColliderSDF());
+		ExtrapolateIntoCollider(grid.get());
+	}
+
 	ScalarField3Ptr GridFluidSolver3::GetFluidSDF() const
 	{
 		return std::make_shared<ConstantScalarField3>(-std::numeric_limits<double>::max());
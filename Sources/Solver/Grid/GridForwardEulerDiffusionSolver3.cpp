@@ -87,15 +87,24 @@ namespace CubbyFlow
 
 		BuildMarkers(source.Resolution(), pos, boundarySDF, fluidSDF);
 
-		source.ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		src.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
 		{
-			if (m_markers(i, j, k) == FLUID)
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				(*dest)(i, j, k) = source(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian(src, m_markers, h, i, j, k);
-			}
-			else
-			{
-				(*dest)(i, j, k) = source(i, j, k);
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						if (m_markers(i, j, k) == FLUID)
+						{
+							(*dest)(i, j, k) = source(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian(src, m_markers, h, i, j, k);
+						}
+						else
+						{
+							(*dest)(i, j, k) = source(i, j, k);
+						}
+					}
+				}
 			}
 		});
 	}
@@ -114,15 +123,24 @@ namespace CubbyFlow
 
 		BuildMarkers(source.Resolution(), pos, boundarySDF, fluidSDF);
 
-		source.ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		src.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
 		{
-			if (m_markers(i, j, k) == FLUID)
-			{
-				(*dest)(i, j, k) = src(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian(src, m_markers, h, i, j, k);
-			}
-			else
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				(*dest)(i, j, k) = source(i, j, k);
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						if (m_markers(i, j, k) == FLUID)
+						{
+							(*dest)(i, j, k) = src(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian(src, m_markers, h, i, j, k);
+						}
+						else
+						{
+							(*dest)(i, j, k) = source(i, j, k);
+						}
+					}
+				}
 			}
 		});
 	}
@@ -148,31 +166,58 @@ namespace CubbyFlow
 
 		BuildMarkers(source.GetUSize(), uPos, boundarySDF, fluidSDF);
 
-		source.ParallelForEachUIndex([&](size_t i, size_t j, size_t k)
+		u.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
 		{
-			if (!IsInsideSDF(boundarySDF.Sample(uPos(i, j, k))))
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				u(i, j, k) = uSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(uSrc, h, i, j, k);
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						if (m_markers(i, j, k) != BOUNDARY)
+						{
+							u(i, j, k) = uSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(uSrc, h, i, j, k);
+						}
+					}
+				}
 			}
 		});
 
 		BuildMarkers(source.GetVSize(), vPos, boundarySDF, fluidSDF);
 
-		source.ParallelForEachVIndex([&](size_t i, size_t j, size_t k)
+		v.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
 		{
-			if (!IsInsideSDF(boundarySDF.Sample(vPos(i, j, k))))
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				v(i, j, k) = vSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(vSrc, h, i, j, k);
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						if (m_markers(i, j, k) != BOUNDARY)
+						{
+							v(i, j, k) = vSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(vSrc, h, i, j, k);
+						}
+					}
+				}
 			}
 		});
 
 		BuildMarkers(source.GetWSize(), wPos, boundarySDF, fluidSDF);
 
-		source.ParallelForEachUIndex([&](size_t i, size_t j, size_t k)
+		w.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
 		{
-			if (!IsInsideSDF(boundarySDF.Sample(wPos(i, j, k))))
+			for (size_t k = kBegin; k < kEnd; ++k)
 			{
-				w(i, j, k) = wSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(wSrc, h, i, j, k);
+				for (size_t j = jBegin; j < jEnd; ++j)
+				{
+					for (size_t i = iBegin; i < iEnd; ++i)
+					{
+						if (m_markers(i, j, k) != BOUNDARY)
+						{
+							w(i, j, k) = wSrc(i, j, k) + diffusionCoefficient * timeIntervalInSeconds * Laplacian3(wSrc, h, i, j, k);
+						}
+					}
+				}
 			}
 		});
 	}
@@ -185,7 +230,7 @@ namespace CubbyFlow
 	{
 		m_markers.Resize(size);
 
-		m_markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+		m_markers.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
 			if (IsInsideSDF(boundarySDF.Sample(pos(i, j, k))))
 			{
@@ -14,10 +14,15 @@
 // https://github.com/christopherbatty/FluidRigidCoupling2D
 //
 
+#include <FDM/FDMCompressedSystemUtils3.h>
 #include <LevelSet/LevelSetUtils.h>
 #include <Solver/FDM/FDMICCGSolver3.h>
 #include <Solver/Grid/GridFractionalBoundaryConditionSolver3.h>
 #include <Solver/Grid/GridFractionalSinglePhasePressureSolver3.h>
+#include <Utils/Timer.h>
+
+#include <array>
+#include <utility>
 
 namespace CubbyFlow
 {
@@ -324,6 +329,8 @@ namespace CubbyFlow
 		}
 
 		void BuildSingleSystem(MatrixCSRD* A, VectorND* x, VectorND* b,
+			Array3<size_t>* coordToIndex,
+			std::vector<size_t>* rowToCoord,
 			const Array3<float>& fluidSDF,
 			const Array3<float>& uWeights,
 			const Array3<float>& vWeights,
@@ -341,209 +348,228 @@ namespace CubbyFlow
 
 			const auto fluidSDFAcc = fluidSDF.ConstAccessor();
 
-			A->Clear();
-			b->Clear();
+			// The sparsity pattern depends only on the cells inside the fluid
+			const bool isSamePattern = FDMCompressedSystemUtils3::NumberFluidCells(fluidSDF,
+				[](float phi) { return IsInsideSDF(phi); }, coordToIndex, rowToCoord);
+			const size_t numRows = rowToCoord->size();
+			const auto coordToIndexAcc = coordToIndex->ConstAccessor();
 
-			size_t numRows = 0;
-			Array3<size_t> coordToIndex(size);
-			fluidSDF.ForEachIndex([&](size_t i, size_t j, size_t k)
+			const auto toCoord = [&](size_t row, size_t* i, size_t* j, size_t* k)
 			{
-				const size_t cIdx = fluidSDFAcc.Index(i, j, k);
-				const double centerPhi = fluidSDF[cIdx];
-
-				if (IsInsideSDF(centerPhi))
-				{
-					coordToIndex[cIdx] = numRows++;
-				}
-			});
+				const size_t cIdx = (*rowToCoord)[row];
+				*i = cIdx % size.x;
+				*j = (cIdx / size.x) % size.y;
+				*k = cIdx / (size.x * size.y);
+			};
 
-			fluidSDF.ForEachIndex([&](size_t i, size_t j, size_t k)
+			const auto countFunc = [&](size_t row)
 			{
-				const size_t cIdx = fluidSDFAcc.Index(i, j, k);
-				const double centerPhi = fluidSDF[cIdx];
+				size_t i, j, k;
+				toCoord(row, &i, &j, &k);
+
+				size_t count = 1;
+				count += (i + 1 < size.x && IsInsideSDF(fluidSDFAcc(i + 1, j, k))) ? 1 : 0;
+				count += (i > 0 && IsInsideSDF(fluidSDFAcc(i - 1, j, k))) ? 1 : 0;
+				count += (j + 1 < size.y && IsInsideSDF(fluidSDFAcc(i, j + 1, k))) ? 1 : 0;
+				count += (j > 0 && IsInsideSDF(fluidSDFAcc(i, j - 1, k))) ? 1 : 0;
+				count += (k + 1 < size.z && IsInsideSDF(fluidSDFAcc(i, j, k + 1))) ? 1 : 0;
+				count += (k > 0 && IsInsideSDF(fluidSDFAcc(i, j, k - 1))) ? 1 : 0;
+
+				return count;
+			};
+
+			// Fills the row and its right-hand side
+			const auto fillFunc = [&](size_t row, double* nonZeros, size_t* columnIndices)
+			{
+				size_t i, j, k;
+				toCoord(row, &i, &j, &k);
 
-				if (IsInsideSDF(centerPhi))
-				{
-					double bijk = 0.0;
+				const double centerPhi = fluidSDFAcc[(*rowToCoord)[row]];
 
-					std::vector<double> row(1, 0.0);
-					std::vector<size_t> colIdx(1, coordToIndex[cIdx]);
+				double bijk = 0.0;
 
-					double term;
+				FDMStencilRow3 stencil;
+				stencil.Set(FDMStencilRow3::CENTER, 0.0, row);
 
-					if (i + 1 < size.x)
+				double term;
+
+				if (i + 1 < size.x)
+				{
+					term = uWeights(i + 1, j, k) * invHSqr.x;
+					const double rightPhi = fluidSDF(i + 1, j, k);
+					
+					if (IsInsideSDF(rightPhi))
 					{
-						term = uWeights(i + 1, j, k) * invHSqr.x;
-						const double rightPhi = fluidSDF(i + 1, j, k);
-						
-						if (IsInsideSDF(rightPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i + 1, j, k));
-						}
-						else 
-						{
-							double theta = FractionInsideSDF(centerPhi, rightPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
-						
-						bijk += uWeights(i + 1, j, k) * input.GetU(i + 1, j, k) * invH.x;
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::RIGHT, -term, coordToIndexAcc(i + 1, j, k));
 					}
-					else
+					else 
 					{
-						bijk += input.GetU(i + 1, j, k) * invH.x;
+						double theta = FractionInsideSDF(centerPhi, rightPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
+					
+					bijk += uWeights(i + 1, j, k) * input.GetU(i + 1, j, k) * invH.x;
+				}
+				else
+				{
+					bijk += input.GetU(i + 1, j, k) * invH.x;
+				}
 
-					if (i > 0)
+				if (i > 0)
+				{
+					term = uWeights(i, j, k) * invHSqr.x;
+					const double leftPhi = fluidSDF(i - 1, j, k);
+					
+					if (IsInsideSDF(leftPhi))
 					{
-						term = uWeights(i, j, k) * invHSqr.x;
-						const double leftPhi = fluidSDF(i - 1, j, k);
-						
-						if (IsInsideSDF(leftPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i - 1, j, k));
-						}
-						else
-						{
-							double theta = FractionInsideSDF(centerPhi, leftPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
-
-						bijk -= uWeights(i, j, k) * input.GetU(i, j, k) * invH.x;
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::LEFT, -term, coordToIndexAcc(i - 1, j, k));
 					}
 					else
 					{
-						bijk -= input.GetU(i, j, k) * invH.x;
+						double theta = FractionInsideSDF(centerPhi, leftPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
 
-					if (j + 1 < size.y)
-					{
-						term = vWeights(i, j + 1, k) * invHSqr.y;
-						const double upPhi = fluidSDF(i, j + 1, k);
+					bijk -= uWeights(i, j, k) * input.GetU(i, j, k) * invH.x;
+				}
+				else
+				{
+					bijk -= input.GetU(i, j, k) * invH.x;
+				}
 
-						if (IsInsideSDF(upPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i, j + 1, k));
-						}
-						else
-						{
-							double theta = FractionInsideSDF(centerPhi, upPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
-						
-						bijk += vWeights(i, j + 1, k) * input.GetV(i, j + 1, k) * invH.y;
+				if (j + 1 < size.y)
+				{
+					term = vWeights(i, j + 1, k) * invHSqr.y;
+					const double upPhi = fluidSDF(i, j + 1, k);
+
+					if (IsInsideSDF(upPhi))
+					{
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::UP, -term, coordToIndexAcc(i, j + 1, k));
 					}
 					else
 					{
-						bijk += input.GetV(i, j + 1, k) * invH.y;
+						double theta = FractionInsideSDF(centerPhi, upPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
+					
+					bijk += vWeights(i, j + 1, k) * input.GetV(i, j + 1, k) * invH.y;
+				}
+				else
+				{
+					bijk += input.GetV(i, j + 1, k) * invH.y;
+				}
 
-					if (j > 0)
+				if (j > 0)
+				{
+					term = vWeights(i, j, k) * invHSqr.y;
+					const double downPhi = fluidSDF(i, j - 1, k);
+					
+					if (IsInsideSDF(downPhi))
 					{
-						term = vWeights(i, j, k) * invHSqr.y;
-						const double downPhi = fluidSDF(i, j - 1, k);
-						
-						if (IsInsideSDF(downPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i, j - 1, k));
-						}
-						else
-						{
-							double theta = FractionInsideSDF(centerPhi, downPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
-
-						bijk -= vWeights(i, j, k) * input.GetV(i, j, k) * invH.y;
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::DOWN, -term, coordToIndexAcc(i, j - 1, k));
 					}
 					else
 					{
-						bijk -= input.GetV(i, j, k) * invH.y;
+						double theta = FractionInsideSDF(centerPhi, downPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
 
-					if (k + 1 < size.z)
-					{
-						term = wWeights(i, j, k + 1) * invHSqr.z;
-						const double frontPhi = fluidSDF(i, j, k + 1);
-						
-						if (IsInsideSDF(frontPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i, j, k + 1));
-						}
-						else
-						{
-							double theta = FractionInsideSDF(centerPhi, frontPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
+					bijk -= vWeights(i, j, k) * input.GetV(i, j, k) * invH.y;
+				}
+				else
+				{
+					bijk -= input.GetV(i, j, k) * invH.y;
+				}
 
-						bijk += wWeights(i, j, k + 1) * input.GetW(i, j, k + 1) * invH.z;
+				if (k + 1 < size.z)
+				{
+					term = wWeights(i, j, k + 1) * invHSqr.z;
+					const double frontPhi = fluidSDF(i, j, k + 1);
+					
+					if (IsInsideSDF(frontPhi))
+					{
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::FRONT, -term, coordToIndexAcc(i, j, k + 1));
 					}
 					else
 					{
-						bijk += input.GetW(i, j, k + 1) * invH.z;
+						double theta = FractionInsideSDF(centerPhi, frontPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
 
-					if (k > 0) 
-					{
-						term = wWeights(i, j, k) * invHSqr.z;
-						const double backPhi = fluidSDF(i, j, k - 1);
-						
-						if (IsInsideSDF(backPhi))
-						{
-							row[0] += term;
-							row.push_back(-term);
-							colIdx.push_back(coordToIndex(i, j, k - 1));
-						}
-						else
-						{
-							double theta = FractionInsideSDF(centerPhi, backPhi);
-							theta = std::max(theta, 0.01);
-							row[0] += term / theta;
-						}
+					bijk += wWeights(i, j, k + 1) * input.GetW(i, j, k + 1) * invH.z;
+				}
+				else
+				{
+					bijk += input.GetW(i, j, k + 1) * invH.z;
+				}
 
-						bijk -= wWeights(i, j, k) * input.GetW(i, j, k) * invH.z;
+				if (k > 0) 
+				{
+					term = wWeights(i, j, k) * invHSqr.z;
+					const double backPhi = fluidSDF(i, j, k - 1);
+					
+					if (IsInsideSDF(backPhi))
+					{
+						stencil.values[FDMStencilRow3::CENTER] += term;
+						stencil.Set(FDMStencilRow3::BACK, -term, coordToIndexAcc(i, j, k - 1));
 					}
 					else
 					{
-						bijk -= input.GetW(i, j, k) * invH.z;
+						double theta = FractionInsideSDF(centerPhi, backPhi);
+						theta = std::max(theta, 0.01);
+						stencil.values[FDMStencilRow3::CENTER] += term / theta;
 					}
 
-					// Accumulate contributions from the moving boundary
-					double boundaryContribution =
-						(1.0 - uWeights(i + 1, j, k)) * boundaryVel(uPos(i + 1, j, k)).x * invH.x -
-						(1.0 - uWeights(i, j, k)) * boundaryVel(uPos(i, j, k)).x * invH.x +
-						(1.0 - vWeights(i, j + 1, k)) * boundaryVel(vPos(i, j + 1, k)).y * invH.y -
-						(1.0 - vWeights(i, j, k)) * boundaryVel(vPos(i, j, k)).y * invH.y +
-						(1.0 - wWeights(i, j, k + 1)) * boundaryVel(wPos(i, j, k + 1)).z * invH.z -
-						(1.0 - wWeights(i, j, k)) * boundaryVel(wPos(i, j, k)).z * invH.z;
-					bijk += boundaryContribution;
-
-					// If row.center is near-zero, the cell is likely inside a solid boundary.
-					if (row[0] < std::numeric_limits<double>::epsilon())
-					{
-						row[0] = 1.0;
-						bijk = 0.0;
-					}
+					bijk -= wWeights(i, j, k) * input.GetW(i, j, k) * invH.z;
+				}
+				else
+				{
+					bijk -= input.GetW(i, j, k) * invH.z;
+				}
 
-					A->AddRow(row, colIdx);
-					b->Append(bijk);
+				// Accumulate contributions from the moving boundary
+				double boundaryContribution =
+					(1.0 - uWeights(i + 1, j, k)) * boundaryVel(uPos(i + 1, j, k)).x * invH.x -
+					(1.0 - uWeights(i, j, k)) * boundaryVel(uPos(i, j, k)).x * invH.x +
+					(1.0 - vWeights(i, j + 1, k)) * boundaryVel(vPos(i, j + 1, k)).y * invH.y -
+					(1.0 - vWeights(i, j, k)) * boundaryVel(vPos(i, j, k)).y * invH.y +
+					(1.0 - wWeights(i, j, k + 1)) * boundaryVel(wPos(i, j, k + 1)).z * invH.z -
+					(1.0 - wWeights(i, j, k)) * boundaryVel(wPos(i, j, k)).z * invH.z;
+				bijk += boundaryContribution;
+
+				// If row.center is near-zero, the cell is likely inside a solid boundary.
+				if (stencil.values[FDMStencilRow3::CENTER] < std::numeric_limits<double>::epsilon())
+				{
+					stencil.values[FDMStencilRow3::CENTER] = 1.0;
+					bijk = 0.0;
 				}
-			});
 
-			x->Resize(b->size(), 0.0);
+				stencil.Write(nonZeros, columnIndices);
+				(*b)[row] = bijk;
+			};
+
+			b->Resize(numRows);
+
+			if (isSamePattern && A->Rows() == numRows)
+			{
+				A->ParallelRefill(fillFunc);
+			}
+			else
+			{
+				A->ParallelBuild(numRows, numRows, countFunc, fillFunc);
+			}
+
+			x->Resize(numRows, 0.0);
 		}
 	}
 
@@ -566,13 +592,42 @@ namespace CubbyFlow
 		const ScalarField3& fluidSDF,
 		bool useCompressed)
 	{
-		UNUSED_VARIABLE(timeIntervalInSeconds);
+		Timer timer;
 
 		BuildWeights(input, boundarySDF, boundaryVelocity, fluidSDF);
 		BuildSystem(input, useCompressed);
 
 		if (m_systemSolver != nullptr)
 		{
+			GridPressureSolverStats3 stats;
+
+			// The solve-specific settings are restored after the solve
+			SystemSolverSettingsGuard settingsGuard(m_systemSolver.get());
+
+			if (m_useWarmStart)
+			{
+				m_fluidMask.Resize(m_fluidSDF[0].size());
+				m_fluidMask.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					m_fluidMask(i, j, k) = IsInsideSDF(m_fluidSDF[0](i, j, k));
+				});
+
+				stats.isWarmStarted = ComputeWarmStartPressure(m_fluidMask, timeIntervalInSeconds, &m_warmStartPressure);
+				if (stats.isWarmStarted)
+				{
+					SetInitialGuess(useCompressed);
+				}
+			}
+
+			m_systemSolver->SetUseInitialGuess(stats.isWarmStarted);
+
+			stats.maxDivergence = GetMaxDivergence(useCompressed);
+			stats.cfl = ComputeCFL(input, timeIntervalInSeconds);
+			if (m_useAdaptiveTolerance)
+			{
+				m_systemSolver->SetTolerance(ComputeAdaptiveTolerance(stats.maxDivergence, stats.cfl));
+			}
+
 			// Solve the system
 			if (m_mgSystemSolver == nullptr)
 			{
@@ -592,6 +647,18 @@ namespace CubbyFlow
 			{
 				m_mgSystemSolver->Solve(&m_mgSystem);
 			}
+
+			if (m_useWarmStart)
+			{
+				StoreWarmStartPressure(GetPressure(), m_fluidMask, timeIntervalInSeconds);
+			}
+
+			stats.numberOfIterations = m_systemSolver->GetLastNumberOfIterations();
+			stats.lastResidual = m_systemSolver->GetLastResidual();
+			stats.residualHistory = m_systemSolver->GetLastResidualHistory();
+			stats.tolerance = m_systemSolver->GetTolerance();
+			stats.elapsedTimeInSeconds = timer.DurationInSeconds();
+			AddStats(std::move(stats));
 		}
 
 		// Apply pressure gradient
@@ -760,15 +827,47 @@ namespace CubbyFlow
 		const auto acc = m_fluidSDF[0].ConstAccessor();
 		m_system.x.Resize(acc.size());
 
-		size_t row = 0;
-		m_fluidSDF[0].ForEachIndex([&](size_t i, size_t j, size_t k)
+		m_compSystem.x.ParallelForEachIndex([&](size_t row)
 		{
-			if (IsInsideSDF(acc(i, j, k)))
+			m_system.x[m_rowToCoord[row]] = m_compSystem.x[row];
+		});
+	}
+
+	void GridFractionalSinglePhasePressureSolver3::SetInitialGuess(bool useCompressed)
+	{
+		if (m_mgSystemSolver == nullptr)
+		{
+			if (useCompressed)
 			{
-				m_system.x(i, j, k) = m_compSystem.x[row];
-				++row;
+				m_compSystem.x.ParallelForEachIndex([&](size_t row)
+				{
+					m_compSystem.x[row] = m_warmStartPressure[m_rowToCoord[row]];
+				});
 			}
-		});
+			else
+			{
+				m_system.x.Set(m_warmStartPressure);
+			}
+		}
+		else
+		{
+			m_mgSystem.x.levels.front().Set(m_warmStartPressure);
+		}
+	}
+
+	double GridFractionalSinglePhasePressureSolver3::GetMaxDivergence(bool useCompressed) const
+	{
+		if (m_mgSystemSolver == nullptr)
+		{
+			if (useCompressed)
+			{
+				return FDMCompressedBLAS3::LInfNorm(m_compSystem.b);
+			}
+
+			return FDMBLAS3::LInfNorm(m_system.b);
+		}
+
+		return FDMBLAS3::LInfNorm(m_mgSystem.b.levels.front());
 	}
 
 	void GridFractionalSinglePhasePressureSolver3::BuildSystem(const FaceCenteredGrid3& input, bool useCompressed)
@@ -802,7 +901,7 @@ namespace CubbyFlow
 			{
 				BuildSingleSystem(
 					&m_compSystem.A, &m_compSystem.x, &m_compSystem.b,
-					m_fluidSDF[0], m_uWeights[0], m_vWeights[0], m_wWeights[0],
+					&m_coordToIndex, &m_rowToCoord, m_fluidSDF[0], m_uWeights[0], m_vWeights[0], m_wWeights[0],
 					m_boundaryVel, *finer);
 			}
 			else
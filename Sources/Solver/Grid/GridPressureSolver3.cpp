@@ -7,9 +7,89 @@
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
 #include <Solver/Grid/GridPressureSolver3.h>
+#include <Utils/Parallel.h>
+
+#include <utility>
 
 namespace CubbyFlow
 {
+	namespace
+	{
+		// Remaps the pressure of the cells that were fluid onto the cells that
+		// are fluid. Newly filled cells take the average of their neighbors
+		// that were fluid, and the cells outside the fluid are set to zero.
+		void RemapPressure(
+			const FDMVector3& prevPressure,
+			const Array3<char>& prevFluid,
+			const Array3<char>& fluid,
+			double scale,
+			FDMVector3* result)
+		{
+			const Size3 size = fluid.size();
+			result->Resize(size);
+
+			result->ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				double p = 0.0;
+
+				if (fluid(i, j, k))
+				{
+					if (prevFluid(i, j, k))
+					{
+						p = prevPressure(i, j, k);
+					}
+					else
+					{
+						// Newly filled cell: average of the neighbors that were fluid
+						double sum = 0.0;
+						int count = 0;
+
+						const auto add = [&](size_t ii, size_t jj, size_t kk)
+						{
+							if (prevFluid(ii, jj, kk))
+							{
+								sum += prevPressure(ii, jj, kk);
+								++count;
+							}
+						};
+
+						if (i > 0)
+						{
+							add(i - 1, j, k);
+						}
+						if (i + 1 < size.x)
+						{
+							add(i + 1, j, k);
+						}
+						if (j > 0)
+						{
+							add(i, j - 1, k);
+						}
+						if (j + 1 < size.y)
+						{
+							add(i, j + 1, k);
+						}
+						if (k > 0)
+						{
+							add(i, j, k - 1);
+						}
+						if (k + 1 < size.z)
+						{
+							add(i, j, k + 1);
+						}
+
+						if (count > 0)
+						{
+							p = sum / count;
+						}
+					}
+				}
+
+				(*result)(i, j, k) = scale * p;
+			});
+		}
+	}
+
 	GridPressureSolver3::GridPressureSolver3()
 	{
 		// Do nothing
@@ -19,4 +99,160 @@ namespace CubbyFlow
 	{
 		// Do nothing
 	}
+
+	bool GridPressureSolver3::GetUseWarmStart() const
+	{
+		return m_useWarmStart;
+	}
+
+	void GridPressureSolver3::SetUseWarmStart(bool useWarmStart)
+	{
+		m_useWarmStart = useWarmStart;
+	}
+
+	bool GridPressureSolver3::GetUseAdaptiveTolerance() const
+	{
+		return m_useAdaptiveTolerance;
+	}
+
+	void GridPressureSolver3::SetUseAdaptiveTolerance(bool useAdaptiveTolerance)
+	{
+		m_useAdaptiveTolerance = useAdaptiveTolerance;
+	}
+
+	double GridPressureSolver3::GetRelativeTolerance() const
+	{
+		return m_relativeTolerance;
+	}
+
+	void GridPressureSolver3::SetRelativeTolerance(double relativeTolerance)
+	{
+		m_relativeTolerance = std::max(relativeTolerance, 0.0);
+	}
+
+	double GridPressureSolver3::GetMinTolerance() const
+	{
+		return m_minTolerance;
+	}
+
+	void GridPressureSolver3::SetMinTolerance(double minTolerance)
+	{
+		m_minTolerance = std::max(minTolerance, 0.0);
+	}
+
+	const GridPressureSolverStats3& GridPressureSolver3::GetLastStats() const
+	{
+		return m_lastStats;
+	}
+
+	const std::deque<GridPressureSolverStats3>& GridPressureSolver3::GetStatsHistory() const
+	{
+		return m_statsHistory;
+	}
+
+	void GridPressureSolver3::ClearStatsHistory()
+	{
+		m_statsHistory.clear();
+	}
+
+	size_t GridPressureSolver3::GetMaxStatsHistoryLength() const
+	{
+		return m_maxStatsHistoryLength;
+	}
+
+	void GridPressureSolver3::SetMaxStatsHistoryLength(size_t maxLength)
+	{
+		m_maxStatsHistoryLength = maxLength;
+
+		while (m_statsHistory.size() > m_maxStatsHistoryLength)
+		{
+			m_statsHistory.pop_front();
+		}
+	}
+
+	GridPressureSolver3::SystemSolverSettingsGuard::SystemSolverSettingsGuard(FDMLinearSystemSolver3* solver) :
+		m_solver(solver), m_useInitialGuess(solver->GetUseInitialGuess()), m_tolerance(solver->GetTolerance())
+	{
+		// Do nothing
+	}
+
+	GridPressureSolver3::SystemSolverSettingsGuard::~SystemSolverSettingsGuard()
+	{
+		m_solver->SetUseInitialGuess(m_useInitialGuess);
+		m_solver->SetTolerance(m_tolerance);
+	}
+
+	double GridPressureSolver3::ComputeAdaptiveTolerance(double maxDivergence, double cfl) const
+	{
+		return std::max(m_minTolerance, m_relativeTolerance * maxDivergence / std::max(1.0, cfl));
+	}
+
+	void GridPressureSolver3::AddStats(GridPressureSolverStats3 stats)
+	{
+		if (m_maxStatsHistoryLength > 0)
+		{
+			if (m_statsHistory.size() == m_maxStatsHistoryLength)
+			{
+				m_statsHistory.pop_front();
+			}
+
+			m_statsHistory.push_back(stats);
+		}
+
+		m_lastStats = std::move(stats);
+	}
+
+	double GridPressureSolver3::ComputeCFL(const FaceCenteredGrid3& input, double timeIntervalInSeconds)
+	{
+		const Size3 size = input.Resolution();
+		const double& (*_max)(const double&, const double&) = std::max<double>;
+
+		const double maxVel = ParallelReduce(ZERO_SIZE, size.z, 0.0,
+			[&](size_t kBegin, size_t kEnd, double init)
+		{
+			for (size_t k = kBegin; k < kEnd; ++k)
+			{
+				for (size_t j = 0; j < size.y; ++j)
+				{
+					for (size_t i = 0; i < size.x; ++i)
+					{
+						init = std::max(init, input.ValueAtCellCenter(i, j, k).AbsMax());
+					}
+				}
+			}
+
+			return init;
+		}, _max);
+
+		return maxVel * timeIntervalInSeconds / input.GridSpacing().Min();
+	}
+
+	bool GridPressureSolver3::ComputeWarmStartPressure(
+		const Array3<char>& fluid,
+		double timeIntervalInSeconds,
+		FDMVector3* result) const
+	{
+		if (m_prevPressure.size() != fluid.size() || m_prevTimeInterval <= 0.0)
+		{
+			return false;
+		}
+
+		// The solved pressure is scaled by the time interval
+		const double scale = timeIntervalInSeconds / m_prevTimeInterval;
+		RemapPressure(m_prevPressure, m_prevFluid, fluid, scale, result);
+
+		return true;
+	}
+
+	void GridPressureSolver3::StoreWarmStartPressure(
+		const FDMVector3& pressure,
+		const Array3<char>& fluid,
+		double timeIntervalInSeconds)
+	{
+		m_prevPressure.Resize(pressure.size());
+		m_prevPressure.Set(pressure);
+		m_prevFluid.Resize(fluid.size());
+		m_prevFluid.Set(fluid);
+		m_prevTimeInterval = timeIntervalInSeconds;
+	}
 }
\ No newline at end of file
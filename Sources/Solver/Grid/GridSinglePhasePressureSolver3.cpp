@@ -6,16 +6,21 @@
 > Created Time: 2017/08/14
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
+#include <FDM/FDMCompressedSystemUtils3.h>
 #include <LevelSet/LevelSetUtils.h>
 #include <Solver/FDM/FDMICCGSolver3.h>
 #include <Solver/Grid/GridBlockedBoundaryConditionSolver3.h>
 #include <Solver/Grid/GridSinglePhasePressureSolver3.h>
+#include <Utils/Timer.h>
+
+#include <array>
+#include <utility>
 
 namespace CubbyFlow
 {
-	const char FLUID = 0;
-	const char AIR = 1;
-	const char BOUNDARY = 2;
+	const char FLUID = FDMMatrixFree3::FLUID;
+	const char AIR = FDMMatrixFree3::AIR;
+	const char BOUNDARY = FDMMatrixFree3::BOUNDARY;
 
 	const double DEFAULT_TOLERANCE = 1e-6;
 
@@ -91,7 +96,25 @@ namespace CubbyFlow
 			});
 		}
 
+		void BuildSingleSystem(FDMMatrixFree3* A, FDMVector3* b,
+			const Array3<char>& markers,
+			const FaceCenteredGrid3& input)
+		{
+			const Vector3D invH = 1.0 / input.GridSpacing();
+
+			A->markers.Resize(markers.size());
+			A->markers.Set(markers);
+			A->invHSqr = invH * invH;
+
+			b->ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				(*b)(i, j, k) = (markers(i, j, k) == FLUID) ? input.DivergenceAtCellCenter(i, j, k) : 0.0;
+			});
+		}
+
 		void BuildSingleSystem(MatrixCSRD* A, VectorND* x, VectorND* b,
+			Array3<size_t>* coordToIndex,
+			std::vector<size_t>* rowToCoord,
 			const Array3<char>& markers,
 			const FaceCenteredGrid3& input)
 		{
@@ -101,109 +124,131 @@ namespace CubbyFlow
 
 			const auto markerAcc = markers.ConstAccessor();
 
-			A->Clear();
-			b->Clear();
+			// The sparsity pattern depends only on the fluid cells
+			const bool isSamePattern = FDMCompressedSystemUtils3::NumberFluidCells(markers,
+				[](char marker) { return marker == FLUID; }, coordToIndex, rowToCoord);
+			const size_t numRows = rowToCoord->size();
 
-			size_t numRows = 0;
-			Array3<size_t> coordToIndex(size);
-			markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+			const auto toCoord = [&](size_t row, size_t* i, size_t* j, size_t* k)
 			{
-				const size_t cIdx = markerAcc.Index(i, j, k);
+				const size_t cIdx = (*rowToCoord)[row];
+				*i = cIdx % size.x;
+				*j = (cIdx / size.x) % size.y;
+				*k = cIdx / (size.x * size.y);
+			};
 
-				if (markerAcc[cIdx] == FLUID)
-				{
-					coordToIndex[cIdx] = numRows++;
-				}
-			});
+			const auto countFunc = [&](size_t row)
+			{
+				size_t i, j, k;
+				toCoord(row, &i, &j, &k);
+
+				size_t count = 1;
+				count += (i + 1 < size.x && markerAcc(i + 1, j, k) == FLUID) ? 1 : 0;
+				count += (i > 0 && markerAcc(i - 1, j, k) == FLUID) ? 1 : 0;
+				count += (j + 1 < size.y && markerAcc(i, j + 1, k) == FLUID) ? 1 : 0;
+				count += (j > 0 && markerAcc(i, j - 1, k) == FLUID) ? 1 : 0;
+				count += (k + 1 < size.z && markerAcc(i, j, k + 1) == FLUID) ? 1 : 0;
+				count += (k > 0 && markerAcc(i, j, k - 1) == FLUID) ? 1 : 0;
 
-			markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+				return count;
+			};
+
+			const auto fillFunc = [&](size_t row, double* nonZeros, size_t* columnIndices)
 			{
-				const size_t cIdx = markerAcc.Index(i, j, k);
+				size_t i, j, k;
+				toCoord(row, &i, &j, &k);
 
-				if (markerAcc[cIdx] == FLUID)
-				{
-					b->Append(input.DivergenceAtCellCenter(i, j, k));
+				FDMStencilRow3 stencil;
+				stencil.Set(FDMStencilRow3::CENTER, 0.0, row);
 
-					std::vector<double> row(1, 0.0);
-					std::vector<size_t> colIdx(1, coordToIndex[cIdx]);
+				if (i + 1 < size.x && markers(i + 1, j, k) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.x;
+					const size_t rIdx = markerAcc.Index(i + 1, j, k);
 
-					if (i + 1 < size.x && markers(i + 1, j, k) != BOUNDARY)
+					if (markers[rIdx] == FLUID)
 					{
-						row[0] += invHSqr.x;
-						const size_t rIdx = markerAcc.Index(i + 1, j, k);
-
-						if (markers[rIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.x);
-							colIdx.push_back(coordToIndex[rIdx]);
-						}
+						stencil.Set(FDMStencilRow3::RIGHT, -invHSqr.x, (*coordToIndex)[rIdx]);
 					}
+				}
 
-					if (i > 0 && markers(i - 1, j, k) != BOUNDARY)
-					{
-						row[0] += invHSqr.x;
-						const size_t lIdx = markerAcc.Index(i - 1, j, k);
+				if (i > 0 && markers(i - 1, j, k) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.x;
+					const size_t lIdx = markerAcc.Index(i - 1, j, k);
 
-						if (markers[lIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.x);
-							colIdx.push_back(coordToIndex[lIdx]);
-						}
+					if (markers[lIdx] == FLUID)
+					{
+						stencil.Set(FDMStencilRow3::LEFT, -invHSqr.x, (*coordToIndex)[lIdx]);
 					}
+				}
 
-					if (j + 1 < size.y && markers(i, j + 1, k) != BOUNDARY)
-					{
-						row[0] += invHSqr.y;
-						const size_t uIdx = markerAcc.Index(i, j + 1, k);
+				if (j + 1 < size.y && markers(i, j + 1, k) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.y;
+					const size_t uIdx = markerAcc.Index(i, j + 1, k);
 
-						if (markers[uIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.y);
-							colIdx.push_back(coordToIndex[uIdx]);
-						}
+					if (markers[uIdx] == FLUID)
+					{
+						stencil.Set(FDMStencilRow3::UP, -invHSqr.y, (*coordToIndex)[uIdx]);
 					}
+				}
 
-					if (j > 0 && markers(i, j - 1, k) != BOUNDARY)
-					{
-						row[0] += invHSqr.y;
-						const size_t dIdx = markerAcc.Index(i, j - 1, k);
+				if (j > 0 && markers(i, j - 1, k) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.y;
+					const size_t dIdx = markerAcc.Index(i, j - 1, k);
 
-						if (markers[dIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.y);
-							colIdx.push_back(coordToIndex[dIdx]);
-						}
+					if (markers[dIdx] == FLUID)
+					{
+						stencil.Set(FDMStencilRow3::DOWN, -invHSqr.y, (*coordToIndex)[dIdx]);
 					}
+				}
 
-					if (k + 1 < size.z && markers(i, j, k + 1) != BOUNDARY)
-					{
-						row[0] += invHSqr.z;
-						const size_t fIdx = markerAcc.Index(i, j, k + 1);
+				if (k + 1 < size.z && markers(i, j, k + 1) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.z;
+					const size_t fIdx = markerAcc.Index(i, j, k + 1);
 
-						if (markers[fIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.z);
-							colIdx.push_back(coordToIndex[fIdx]);
-						}
+					if (markers[fIdx] == FLUID)
+					{
+						stencil.Set(FDMStencilRow3::FRONT, -invHSqr.z, (*coordToIndex)[fIdx]);
 					}
+				}
 
-					if (k > 0 && markers(i, j, k - 1) != BOUNDARY)
-					{
-						row[0] += invHSqr.z;
-						const size_t bIdx = markerAcc.Index(i, j, k - 1);
+				if (k > 0 && markers(i, j, k - 1) != BOUNDARY)
+				{
+					stencil.values[FDMStencilRow3::CENTER] += invHSqr.z;
+					const size_t bIdx = markerAcc.Index(i, j, k - 1);
 
-						if (markers[bIdx] == FLUID)
-						{
-							row.push_back(-invHSqr.z);
-							colIdx.push_back(coordToIndex[bIdx]);
-						}
+					if (markers[bIdx] == FLUID)
+					{
+						stencil.Set(FDMStencilRow3::BACK, -invHSqr.z, (*coordToIndex)[bIdx]);
 					}
-
-					A->AddRow(row, colIdx);
 				}
+
+				stencil.Write(nonZeros, columnIndices);
+			};
+
+			if (isSamePattern && A->Rows() == numRows)
+			{
+				A->ParallelRefill(fillFunc);
+			}
+			else
+			{
+				A->ParallelBuild(numRows, numRows, countFunc, fillFunc);
+			}
+
+			b->Resize(numRows);
+			b->ParallelForEachIndex([&](size_t row)
+			{
+				size_t i, j, k;
+				toCoord(row, &i, &j, &k);
+
+				(*b)[row] = input.DivergenceAtCellCenter(i, j, k);
 			});
 
-			x->Resize(b->size(), 0.0);
+			x->Resize(numRows, 0.0);
 		}
 	}
 
@@ -226,18 +271,67 @@ namespace CubbyFlow
 		const ScalarField3& fluidSDF,
 		bool useCompressed)
 	{
-		UNUSED_VARIABLE(timeIntervalInSeconds);
 		UNUSED_VARIABLE(boundaryVelocity);
 
+		Timer timer;
+
 		const auto pos = input.CellCenterPosition();
 
 		BuildMarkers(input.Resolution(), pos, boundarySDF, fluidSDF);
-		BuildSystem(input, useCompressed);
+
+		if (m_useMatrixFree)
+		{
+			BuildMatrixFreeSystem(input);
+		}
+		else
+		{
+			BuildSystem(input, useCompressed);
+		}
 
 		if (m_systemSolver != nullptr)
 		{
+			GridPressureSolverStats3 stats;
+
+			// The solve-specific settings are restored after the solve
+			SystemSolverSettingsGuard settingsGuard(m_systemSolver.get());
+
+			if (m_useWarmStart)
+			{
+				m_fluidMask.Resize(m_markers[0].size());
+				m_fluidMask.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					m_fluidMask(i, j, k) = (m_markers[0](i, j, k) == FLUID);
+				});
+
+				stats.isWarmStarted = ComputeWarmStartPressure(m_fluidMask, timeIntervalInSeconds, &m_warmStartPressure);
+				if (stats.isWarmStarted)
+				{
+					SetInitialGuess(useCompressed);
+				}
+			}
+
+			m_systemSolver->SetUseInitialGuess(stats.isWarmStarted);
+
+			stats.maxDivergence = GetMaxDivergence(useCompressed);
+			stats.cfl = ComputeCFL(input, timeIntervalInSeconds);
+			if (m_useAdaptiveTolerance)
+			{
+				m_systemSolver->SetTolerance(ComputeAdaptiveTolerance(stats.maxDivergence, stats.cfl));
+			}
+
 			// Solve the system
-			if (m_mgSystemSolver == nullptr)
+			if (m_useMatrixFree)
+			{
+				if (m_mgSystemSolver == nullptr)
+				{
+					m_systemSolver->SolveMatrixFree(&m_matrixFreeSystem);
+				}
+				else
+				{
+					m_mgSystemSolver->SolveMatrixFree(&m_mgMatrixFreeSystem);
+				}
+			}
+			else if (m_mgSystemSolver == nullptr)
 			{
 				if (useCompressed)
 				{
@@ -258,6 +352,18 @@ namespace CubbyFlow
 
 			// Apply pressure gradient
 			ApplyPressureGradient(input, output);
+
+			if (m_useWarmStart)
+			{
+				StoreWarmStartPressure(GetPressure(), m_fluidMask, timeIntervalInSeconds);
+			}
+
+			stats.numberOfIterations = m_systemSolver->GetLastNumberOfIterations();
+			stats.lastResidual = m_systemSolver->GetLastResidual();
+			stats.residualHistory = m_systemSolver->GetLastResidualHistory();
+			stats.tolerance = m_systemSolver->GetTolerance();
+			stats.elapsedTimeInSeconds = timer.DurationInSeconds();
+			AddStats(std::move(stats));
 		}
 	}
 
@@ -280,17 +386,29 @@ namespace CubbyFlow
 		{
 			// In case of non-mg system, use flat structure.
 			m_mgSystem.Clear();
+			m_mgMatrixFreeSystem.Clear();
 		}
 		else
 		{
 			// In case of mg system, use multi-level structure.
 			m_system.Clear();
 			m_compSystem.Clear();
+			m_matrixFreeSystem.Clear();
 		}
 	}
 
 	const FDMVector3& GridSinglePhasePressureSolver3::GetPressure() const
 	{
+		if (m_useMatrixFree)
+		{
+			if (m_mgSystemSolver == nullptr)
+			{
+				return m_matrixFreeSystem.x;
+			}
+
+			return m_mgMatrixFreeSystem.x.levels.front();
+		}
+
 		if (m_mgSystemSolver == nullptr)
 		{
 			return m_system.x;
@@ -299,6 +417,28 @@ namespace CubbyFlow
 		return m_mgSystem.x.levels.front();
 	}
 
+	bool GridSinglePhasePressureSolver3::GetUseMatrixFree() const
+	{
+		return m_useMatrixFree;
+	}
+
+	void GridSinglePhasePressureSolver3::SetUseMatrixFree(bool useMatrixFree)
+	{
+		m_useMatrixFree = useMatrixFree;
+
+		if (m_useMatrixFree)
+		{
+			m_system.Clear();
+			m_compSystem.Clear();
+			m_mgSystem.Clear();
+		}
+		else
+		{
+			m_matrixFreeSystem.Clear();
+			m_mgMatrixFreeSystem.Clear();
+		}
+	}
+
 	void GridSinglePhasePressureSolver3::BuildMarkers(
 		const Size3& size,
 		const std::function<Vector3D(size_t, size_t, size_t)>& pos,
@@ -404,15 +544,68 @@ namespace CubbyFlow
 		const auto acc = m_markers[0].ConstAccessor();
 		m_system.x.Resize(acc.size());
 
-		size_t row = 0;
-		m_markers[0].ForEachIndex([&](size_t i, size_t j, size_t k)
+		m_compSystem.x.ParallelForEachIndex([&](size_t row)
+		{
+			m_system.x[m_rowToCoord[row]] = m_compSystem.x[row];
+		});
+	}
+
+	void GridSinglePhasePressureSolver3::SetInitialGuess(bool useCompressed)
+	{
+		if (m_useMatrixFree)
 		{
-			if (acc(i, j, k) == FLUID)
+			if (m_mgSystemSolver == nullptr)
 			{
-				m_system.x(i, j, k) = m_compSystem.x[row];
-				++row;
+				m_matrixFreeSystem.x.Set(m_warmStartPressure);
 			}
-		});
+			else
+			{
+				m_mgMatrixFreeSystem.x.levels.front().Set(m_warmStartPressure);
+			}
+		}
+		else if (m_mgSystemSolver == nullptr)
+		{
+			if (useCompressed)
+			{
+				m_compSystem.x.ParallelForEachIndex([&](size_t row)
+				{
+					m_compSystem.x[row] = m_warmStartPressure[m_rowToCoord[row]];
+				});
+			}
+			else
+			{
+				m_system.x.Set(m_warmStartPressure);
+			}
+		}
+		else
+		{
+			m_mgSystem.x.levels.front().Set(m_warmStartPressure);
+		}
+	}
+
+	double GridSinglePhasePressureSolver3::GetMaxDivergence(bool useCompressed) const
+	{
+		if (m_useMatrixFree)
+		{
+			if (m_mgSystemSolver == nullptr)
+			{
+				return FDMMatrixFreeBLAS3::LInfNorm(m_matrixFreeSystem.b);
+			}
+
+			return FDMMatrixFreeBLAS3::LInfNorm(m_mgMatrixFreeSystem.b.levels.front());
+		}
+
+		if (m_mgSystemSolver == nullptr)
+		{
+			if (useCompressed)
+			{
+				return FDMCompressedBLAS3::LInfNorm(m_compSystem.b);
+			}
+
+			return FDMBLAS3::LInfNorm(m_system.b);
+		}
+
+		return FDMBLAS3::LInfNorm(m_mgSystem.b.levels.front());
 	}
 
 	void GridSinglePhasePressureSolver3::BuildSystem(const FaceCenteredGrid3& input, bool useCompressed)
@@ -444,7 +637,7 @@ namespace CubbyFlow
 		{
 			if (useCompressed)
 			{
-				BuildSingleSystem(&m_compSystem.A, &m_compSystem.x, &m_compSystem.b, m_markers[0], *finer);
+				BuildSingleSystem(&m_compSystem.A, &m_compSystem.x, &m_compSystem.b, &m_coordToIndex, &m_rowToCoord, m_markers[0], *finer);
 			}
 			else
 			{
@@ -478,6 +671,52 @@ namespace CubbyFlow
 		}
 	}
 
+	void GridSinglePhasePressureSolver3::BuildMatrixFreeSystem(const FaceCenteredGrid3& input)
+	{
+		const Size3 size = input.Resolution();
+
+		if (m_mgSystemSolver == nullptr)
+		{
+			m_matrixFreeSystem.Resize(size);
+			BuildSingleSystem(&m_matrixFreeSystem.A, &m_matrixFreeSystem.b, m_markers[0], input);
+
+			return;
+		}
+
+		// Build levels
+		const size_t maxLevels = m_mgSystemSolver->GetParams().maxNumberOfLevels;
+		FDMMGUtils3::ResizeArrayWithFinest(size, maxLevels, &m_mgMatrixFreeSystem.x.levels);
+		FDMMGUtils3::ResizeArrayWithFinest(size, maxLevels, &m_mgMatrixFreeSystem.b.levels);
+
+		const size_t numLevels = m_mgMatrixFreeSystem.x.levels.size();
+		m_mgMatrixFreeSystem.A.levels.resize(numLevels);
+
+		// Build top level
+		const FaceCenteredGrid3* finer = &input;
+		BuildSingleSystem(&m_mgMatrixFreeSystem.A.levels.front(), &m_mgMatrixFreeSystem.b.levels.front(), m_markers[0], *finer);
+
+		// Build sub-levels
+		FaceCenteredGrid3 coarser;
+		for (size_t l = 1; l < numLevels; ++l)
+		{
+			auto res = finer->Resolution();
+			auto h = finer->GridSpacing();
+			const auto o = finer->Origin();
+			res.x = res.x >> 1;
+			res.y = res.y >> 1;
+			res.z = res.z >> 1;
+			h *= 2.0;
+
+			// Down sample
+			coarser.Resize(res, h, o);
+			coarser.Fill(finer->Sampler());
+
+			BuildSingleSystem(&m_mgMatrixFreeSystem.A.levels[l], &m_mgMatrixFreeSystem.b.levels[l], m_markers[l], coarser);
+
+			finer = &coarser;
+		}
+	}
+
 	void GridSinglePhasePressureSolver3::ApplyPressureGradient(const FaceCenteredGrid3& input, FaceCenteredGrid3* output)
 	{
 		Size3 size = input.Resolution();
@@ -0,0 +1,609 @@
+/*************************************************************************
+> File Name: FIMLevelSetSolver3.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Three-dimensional parallel fast iterative method (FIM) implementation.
+> Created Time: 2018/01/12
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <FDM/FDMUtils.h>
+#include <LevelSet/LevelSetUtils.h>
+#include <Solver/LevelSet/FIMLevelSetSolver3.h>
+#include <Utils/Parallel.h>
+
+#include <array>
+#include <vector>
+
+namespace CubbyFlow
+{
+	static const char UNKNOWN = 0;
+	static const char KNOWN = 1;
+	static const char TRIAL = 2;
+
+	static const double FAR_AWAY = std::numeric_limits<double>::max();
+	static const size_t NO_NEIGHBOR = std::numeric_limits<size_t>::max();
+
+	// Returns the linear indices of the six neighbors of given point in
+	// (i - 1, i + 1, j - 1, j + 1, k - 1, k + 1) order
+	inline std::array<size_t, 6> GetNeighbors(const Size3& size, size_t i, size_t j, size_t k)
+	{
+		const size_t strideY = size.x;
+		const size_t strideZ = size.x * size.y;
+		const size_t index = i + strideY * j + strideZ * k;
+
+		return std::array<size_t, 6>
+		{
+			(i > 0) ? index - 1 : NO_NEIGHBOR,
+			(i + 1 < size.x) ? index + 1 : NO_NEIGHBOR,
+			(j > 0) ? index - strideY : NO_NEIGHBOR,
+			(j + 1 < size.y) ? index + strideY : NO_NEIGHBOR,
+			(k > 0) ? index - strideZ : NO_NEIGHBOR,
+			(k + 1 < size.z) ? index + strideZ : NO_NEIGHBOR
+		};
+	}
+
+	// Returns the neighbor of given point in the direction of GetNeighbors
+	inline Point3UI GetNeighbor(const Point3UI& pt, size_t direction)
+	{
+		Point3UI neighbor = pt;
+
+		if (direction % 2 == 0)
+		{
+			--neighbor[direction / 2];
+		}
+		else
+		{
+			++neighbor[direction / 2];
+		}
+
+		return neighbor;
+	}
+
+	// Find geometric solution near the boundary
+	inline double SolveNearBoundary(
+		const double* input,
+		const std::array<size_t, 6>& neighbors,
+		const Vector3D& gridSpacing,
+		double sign,
+		size_t index)
+	{
+		std::array<bool, 3> hasAxis = { false, false, false };
+		Vector3D phiAxis(FAR_AWAY, FAR_AWAY, FAR_AWAY);
+
+		for (size_t d = 0; d < 6; ++d)
+		{
+			if (neighbors[d] != NO_NEIGHBOR && IsInsideSDF(sign * input[neighbors[d]]))
+			{
+				hasAxis[d / 2] = true;
+				phiAxis[d / 2] = std::min(phiAxis[d / 2], sign * input[neighbors[d]]);
+			}
+		}
+
+		const double phi = std::abs(input[index]);
+		double denomSqr = 0.0;
+
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			if (hasAxis[axis])
+			{
+				const double distToBnd = gridSpacing[axis] * phi / (phi + std::abs(phiAxis[axis]));
+
+				denomSqr += 1.0 / Square(distToBnd);
+			}
+		}
+
+		return sign / std::sqrt(denomSqr);
+	}
+
+	// Solve the upwind discretization of |grad(dist)| = 1
+	inline double SolveEikonal(
+		const double* dist,
+		const std::array<size_t, 6>& neighbors,
+		const Vector3D& invGridSpacingSqr)
+	{
+		std::array<double, 3> phi = { FAR_AWAY, FAR_AWAY, FAR_AWAY };
+		std::array<double, 3> weight = { invGridSpacingSqr.x, invGridSpacingSqr.y, invGridSpacingSqr.z };
+
+		for (size_t d = 0; d < 6; ++d)
+		{
+			if (neighbors[d] != NO_NEIGHBOR)
+			{
+				phi[d / 2] = std::min(phi[d / 2], dist[neighbors[d]]);
+			}
+		}
+
+		// Sort the axes by the upwind values
+		for (size_t m = 0; m < 2; ++m)
+		{
+			for (size_t n = 0; n < 2 - m; ++n)
+			{
+				if (phi[n + 1] < phi[n])
+				{
+					std::swap(phi[n], phi[n + 1]);
+					std::swap(weight[n], weight[n + 1]);
+				}
+			}
+		}
+
+		double solution = FAR_AWAY;
+		double a = 0.0;
+		double b = 0.0;
+		double c = -1.0;
+
+		// Add the axes one by one while they are upwind to the solution
+		for (size_t m = 0; m < 3 && phi[m] < solution; ++m)
+		{
+			a += weight[m];
+			b -= phi[m] * weight[m];
+			c += Square(phi[m]) * weight[m];
+
+			const double det = b * b - a * c;
+			if (det < 0.0)
+			{
+				break;
+			}
+
+			solution = (-b + std::sqrt(det)) / a;
+		}
+
+		return solution;
+	}
+
+	FIMLevelSetSolver3::FIMLevelSetSolver3()
+	{
+		// Do nothing
+	}
+
+	void FIMLevelSetSolver3::Reinitialize(
+		const ScalarGrid3& inputSDF,
+		double maxDistance,
+		ScalarGrid3* outputSDF)
+	{
+		if (!inputSDF.HasSameShape(*outputSDF))
+		{
+			throw std::invalid_argument("inputSDF and outputSDF have not same shape.");
+		}
+
+		Size3 size = inputSDF.GetDataSize();
+		Vector3D gridSpacing = inputSDF.GridSpacing();
+		Vector3D invGridSpacing = 1.0 / gridSpacing;
+		Vector3D invGridSpacingSqr = invGridSpacing * invGridSpacing;
+
+		auto inputAcc = inputSDF.GetConstDataAccessor();
+		const double* input = inputAcc.data();
+
+		Array3<double> phi(size);
+		Array3<double> dist(size);
+		Array3<char> isActive(size);
+
+		// Solve geometrically near the boundary
+		phi.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			const size_t index = inputAcc.Index(i, j, k);
+			const std::array<size_t, 6> neighbors = GetNeighbors(size, i, j, k);
+			const bool isInside = IsInsideSDF(input[index]);
+
+			phi[index] = input[index];
+
+			for (size_t d = 0; d < 6; ++d)
+			{
+				if (neighbors[d] != NO_NEIGHBOR && IsInsideSDF(input[neighbors[d]]) != isInside)
+				{
+					phi[index] = SolveNearBoundary(input, neighbors, gridSpacing, isInside ? -1.0 : 1.0, index);
+					break;
+				}
+			}
+		});
+
+		std::vector<Point3UI> activeList;
+		std::vector<Point3UI> nextList;
+		std::vector<double> solutions;
+		std::vector<char> isConverged;
+		std::vector<char> isImprovable;
+
+		// As in FMM, the outside is solved from the inside values first, and
+		// then the inside is solved from the new outside values
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			const double sign = (pass == 0) ? 1.0 : -1.0;
+
+			auto isKnown = [&](size_t index)
+			{
+				return IsInsideSDF(sign * phi[index]);
+			};
+
+			// Activate the unknown points next to the known points
+			dist.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				const size_t index = inputAcc.Index(i, j, k);
+				const std::array<size_t, 6> neighbors = GetNeighbors(size, i, j, k);
+
+				dist[index] = isKnown(index) ? sign * phi[index] : FAR_AWAY;
+				isActive[index] = 0;
+
+				if (!isKnown(index))
+				{
+					for (size_t d = 0; d < 6; ++d)
+					{
+						if (neighbors[d] != NO_NEIGHBOR && isKnown(neighbors[d]))
+						{
+							isActive[index] = 1;
+							break;
+						}
+					}
+				}
+			});
+
+			activeList.clear();
+			isActive.ForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				if (isActive(i, j, k))
+				{
+					activeList.emplace_back(i, j, k);
+				}
+			});
+
+			while (!activeList.empty())
+			{
+				const size_t n = activeList.size();
+				solutions.resize(n);
+				isConverged.resize(n);
+				isImprovable.resize(6 * n);
+
+				// Update the active points from the current values (Jacobi)
+				ParallelFor(ZERO_SIZE, n, [&](size_t m)
+				{
+					const Point3UI& pt = activeList[m];
+					solutions[m] = SolveEikonal(dist.data(), GetNeighbors(size, pt.x, pt.y, pt.z), invGridSpacingSqr);
+				});
+
+				ParallelFor(ZERO_SIZE, n, [&](size_t m)
+				{
+					double& value = dist(activeList[m]);
+
+					if (solutions[m] < value && solutions[m] <= maxDistance)
+					{
+						value = solutions[m];
+						isConverged[m] = 0;
+					}
+					else
+					{
+						isConverged[m] = 1;
+					}
+				});
+
+				// Find the neighbors of the converged points that can be improved
+				ParallelFor(ZERO_SIZE, n, [&](size_t m)
+				{
+					const Point3UI& pt = activeList[m];
+					const std::array<size_t, 6> neighbors = GetNeighbors(size, pt.x, pt.y, pt.z);
+
+					for (size_t d = 0; d < 6; ++d)
+					{
+						const size_t neighbor = neighbors[d];
+						isImprovable[6 * m + d] = 0;
+
+						if (isConverged[m] && neighbor != NO_NEIGHBOR && !isActive[neighbor] && !isKnown(neighbor))
+						{
+							const Point3UI npt = GetNeighbor(pt, d);
+							const double solution = SolveEikonal(dist.data(), GetNeighbors(size, npt.x, npt.y, npt.z), invGridSpacingSqr);
+
+							isImprovable[6 * m + d] = solution < dist[neighbor] && solution <= maxDistance;
+						}
+					}
+				});
+
+				nextList.clear();
+
+				for (size_t m = 0; m < n; ++m)
+				{
+					if (isConverged[m])
+					{
+						isActive(activeList[m]) = 0;
+					}
+					else
+					{
+						nextList.push_back(activeList[m]);
+					}
+				}
+
+				for (size_t m = 0; m < n; ++m)
+				{
+					for (size_t d = 0; d < 6; ++d)
+					{
+						if (isImprovable[6 * m + d])
+						{
+							const Point3UI neighbor = GetNeighbor(activeList[m], d);
+
+							if (!isActive(neighbor))
+							{
+								isActive(neighbor) = 1;
+								nextList.push_back(neighbor);
+							}
+						}
+					}
+				}
+
+				activeList.swap(nextList);
+			}
+
+			// Points beyond maxDistance keep their values
+			phi.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				if (!IsInsideSDF(sign * phi(i, j, k)) && dist(i, j, k) < FAR_AWAY)
+				{
+					phi(i, j, k) = sign * dist(i, j, k);
+				}
+			});
+		}
+
+		auto output = outputSDF->GetDataAccessor();
+		phi.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			output(i, j, k) = phi(i, j, k);
+		});
+	}
+
+	void FIMLevelSetSolver3::Extrapolate(
+		const ScalarGrid3& input,
+		const ScalarField3& sdf,
+		double maxDistance,
+		ScalarGrid3* output)
+	{
+		if (!input.HasSameShape(*output))
+		{
+			throw std::invalid_argument("input and output have not same shape.");
+		}
+
+		Array3<double> sdfGrid(input.GetDataSize());
+		auto pos = input.GetDataPosition();
+		sdfGrid.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			sdfGrid(i, j, k) = sdf.Sample(pos(i, j, k));
+		});
+
+		Extrapolate(
+			input.GetConstDataAccessor(),
+			sdfGrid.ConstAccessor(),
+			input.GridSpacing(),
+			maxDistance,
+			output->GetDataAccessor());
+	}
+
+	void FIMLevelSetSolver3::Extrapolate(
+		const CollocatedVectorGrid3& input,
+		const ScalarField3& sdf,
+		double maxDistance,
+		CollocatedVectorGrid3* output)
+	{
+		if (!input.HasSameShape(*output))
+		{
+			throw std::invalid_argument("input and output have not same shape.");
+		}
+
+		Array3<double> sdfGrid(input.GetDataSize());
+		auto pos = input.GetDataPosition();
+		sdfGrid.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			sdfGrid(i, j, k) = sdf.Sample(pos(i, j, k));
+		});
+
+		const Vector3D gridSpacing = input.GridSpacing();
+
+		Array3<double> u(input.GetDataSize());
+		Array3<double> u0(input.GetDataSize());
+		Array3<double> v(input.GetDataSize());
+		Array3<double> v0(input.GetDataSize());
+		Array3<double> w(input.GetDataSize());
+		Array3<double> w0(input.GetDataSize());
+
+		input.ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		{
+			u(i, j, k) = input(i, j, k).x;
+			v(i, j, k) = input(i, j, k).y;
+			w(i, j, k) = input(i, j, k).z;
+		});
+
+		Extrapolate(u, sdfGrid.ConstAccessor(), gridSpacing, maxDistance, u0);
+		Extrapolate(v, sdfGrid.ConstAccessor(), gridSpacing, maxDistance, v0);
+		Extrapolate(w, sdfGrid.ConstAccessor(), gridSpacing, maxDistance, w0);
+
+		output->ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		{
+			(*output)(i, j, k).x = u0(i, j, k);
+			(*output)(i, j, k).y = v0(i, j, k);
+			(*output)(i, j, k).z = w0(i, j, k);
+		});
+	}
+
+	void FIMLevelSetSolver3::Extrapolate(
+		const FaceCenteredGrid3& input,
+		const ScalarField3& sdf,
+		double maxDistance,
+		FaceCenteredGrid3* output)
+	{
+		if (!input.HasSameShape(*output))
+		{
+			throw std::invalid_argument("inputSDF and outputSDF have not same shape.");
+		}
+
+		const Vector3D gridSpacing = input.GridSpacing();
+
+		auto u = input.GetUConstAccessor();
+		auto uPos = input.GetUPosition();
+		Array3<double> sdfAtU(u.size());
+		input.ParallelForEachUIndex([&](size_t i, size_t j, size_t k)
+		{
+			sdfAtU(i, j, k) = sdf.Sample(uPos(i, j, k));
+		});
+
+		Extrapolate(u, sdfAtU, gridSpacing, maxDistance, output->GetUAccessor());
+
+		auto v = input.GetVConstAccessor();
+		auto vPos = input.GetVPosition();
+		Array3<double> sdfAtV(v.size());
+		input.ParallelForEachVIndex([&](size_t i, size_t j, size_t k)
+		{
+			sdfAtV(i, j, k) = sdf.Sample(vPos(i, j, k));
+		});
+
+		Extrapolate(v, sdfAtV, gridSpacing, maxDistance, output->GetVAccessor());
+
+		auto w = input.GetWConstAccessor();
+		auto wPos = input.GetWPosition();
+		Array3<double> sdfAtW(w.size());
+		input.ParallelForEachWIndex([&](size_t i, size_t j, size_t k)
+		{
+			sdfAtW(i, j, k) = sdf.Sample(wPos(i, j, k));
+		});
+
+		Extrapolate(w, sdfAtW, gridSpacing, maxDistance, output->GetWAccessor());
+	}
+
+	void FIMLevelSetSolver3::Extrapolate(
+		const ConstArrayAccessor3<double>& input,
+		const ConstArrayAccessor3<double>& sdf,
+		const Vector3D& gridSpacing,
+		double maxDistance,
+		ArrayAccessor3<double> output)
+	{
+		Size3 size = input.size();
+		Vector3D invGridSpacing = 1.0 / gridSpacing;
+
+		// Only the points outside of the surface and within maxDistance change
+		Array3<char> markers(size);
+		markers.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			const bool isActive = !IsInsideSDF(sdf(i, j, k)) && sdf(i, j, k) <= maxDistance;
+
+			markers(i, j, k) = isActive ? UNKNOWN : KNOWN;
+			output(i, j, k) = input(i, j, k);
+		});
+
+		// A point is ready once all the neighbors closer to the surface are known
+		auto isReady = [&](const Point3UI& pt)
+		{
+			const size_t index = sdf.Index(pt);
+			const std::array<size_t, 6> neighbors = GetNeighbors(size, pt.x, pt.y, pt.z);
+
+			for (size_t d = 0; d < 6; ++d)
+			{
+				const size_t neighbor = neighbors[d];
+
+				if (neighbor != NO_NEIGHBOR && sdf[neighbor] < sdf[index] && markers[neighbor] != KNOWN)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		std::vector<Point3UI> front;
+		std::vector<Point3UI> candidates;
+		std::vector<double> values;
+		std::vector<char> isCandidateReady;
+
+		markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			const Point3UI pt(i, j, k);
+
+			if (markers(pt) == UNKNOWN && isReady(pt))
+			{
+				markers(pt) = TRIAL;
+				front.push_back(pt);
+			}
+		});
+
+		while (!front.empty())
+		{
+			const size_t n = front.size();
+			values.resize(n);
+
+			// Take the weighted average of the known upwind neighbors
+			ParallelFor(ZERO_SIZE, n, [&](size_t m)
+			{
+				const Point3UI& pt = front[m];
+				const size_t index = sdf.Index(pt);
+				const std::array<size_t, 6> neighbors = GetNeighbors(size, pt.x, pt.y, pt.z);
+				const Vector3D grad = Gradient3(sdf, gridSpacing, pt.x, pt.y, pt.z).Normalized();
+				const std::array<double, 6> weights =
+				{
+					std::max(grad.x, 0.0) * invGridSpacing.x, -std::min(grad.x, 0.0) * invGridSpacing.x,
+					std::max(grad.y, 0.0) * invGridSpacing.y, -std::min(grad.y, 0.0) * invGridSpacing.y,
+					std::max(grad.z, 0.0) * invGridSpacing.z, -std::min(grad.z, 0.0) * invGridSpacing.z
+				};
+
+				double sum = 0.0;
+				double count = 0.0;
+
+				for (size_t d = 0; d < 6; ++d)
+				{
+					const size_t neighbor = neighbors[d];
+
+					if (neighbor != NO_NEIGHBOR && sdf[neighbor] < sdf[index])
+					{
+						double weight = weights[d];
+
+						// If gradient is zero, then just assign 1 to weight
+						if (weight < std::numeric_limits<double>::epsilon())
+						{
+							weight = 1.0;
+						}
+
+						sum += weight * output[neighbor];
+						count += weight;
+					}
+				}
+
+				values[m] = (count > 0.0) ? sum / count : output[index];
+			});
+
+			ParallelFor(ZERO_SIZE, n, [&](size_t m)
+			{
+				output(front[m]) = values[m];
+				markers(front[m]) = KNOWN;
+			});
+
+			// Collect the downwind neighbors and keep the ones that became ready
+			candidates.clear();
+
+			for (const Point3UI& pt : front)
+			{
+				const size_t index = sdf.Index(pt);
+				const std::array<size_t, 6> neighbors = GetNeighbors(size, pt.x, pt.y, pt.z);
+
+				for (size_t d = 0; d < 6; ++d)
+				{
+					const size_t neighbor = neighbors[d];
+
+					if (neighbor != NO_NEIGHBOR && markers[neighbor] == UNKNOWN && sdf[neighbor] > sdf[index])
+					{
+						markers[neighbor] = TRIAL;
+						candidates.push_back(GetNeighbor(pt, d));
+					}
+				}
+			}
+
+			isCandidateReady.resize(candidates.size());
+			ParallelFor(ZERO_SIZE, candidates.size(), [&](size_t m)
+			{
+				isCandidateReady[m] = isReady(candidates[m]);
+			});
+
+			front.clear();
+
+			for (size_t m = 0; m < candidates.size(); ++m)
+			{
+				if (isCandidateReady[m])
+				{
+					front.push_back(candidates[m]);
+				}
+				else
+				{
+					markers(candidates[m]) = UNKNOWN;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
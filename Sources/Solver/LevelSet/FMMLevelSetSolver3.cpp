@@ -9,8 +9,11 @@
 #include <FDM/FDMUtils.h>
 #include <LevelSet/LevelSetUtils.h>
 #include <Solver/LevelSet/FMMLevelSetSolver3.h>
+#include <Utils/Parallel.h>
 
+#include <array>
 #include <queue>
+#include <vector>
 
 namespace CubbyFlow
 {
@@ -253,6 +256,109 @@ namespace CubbyFlow
 		return solution;
 	}
 
+	// Find geometric solution near the boundary for a point of a narrow band
+	inline double SolveQuadNearBoundary(
+		const std::vector<double>& phi,
+		const std::array<size_t, 6>& neighbors,
+		const Vector3D& gridSpacing,
+		double sign,
+		size_t n)
+	{
+		std::array<bool, 3> hasAxis = { false, false, false };
+		const double maxValue = std::numeric_limits<double>::max();
+		Vector3D phiAxis(maxValue, maxValue, maxValue);
+
+		for (size_t d = 0; d < 6; ++d)
+		{
+			const size_t neighbor = neighbors[d];
+			if (neighbor != NarrowBand3::NOT_IN_BAND && IsInsideSDF(sign * phi[neighbor]))
+			{
+				hasAxis[d / 2] = true;
+				phiAxis[d / 2] = std::min(phiAxis[d / 2], sign * phi[neighbor]);
+			}
+		}
+
+		assert(hasAxis[0] || hasAxis[1] || hasAxis[2]);
+
+		double denomSqr = 0.0;
+
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			if (hasAxis[axis])
+			{
+				const double distToBnd
+					= gridSpacing[axis] * std::abs(phi[n])
+					/ (std::abs(phi[n]) + std::abs(phiAxis[axis]));
+
+				denomSqr += 1.0 / Square(distToBnd);
+			}
+		}
+
+		double solution = 1.0 / std::sqrt(denomSqr);
+
+		return sign * solution;
+	}
+
+	// Solve quad for a point of a narrow band
+	inline double SolveQuad(
+		const std::vector<char>& markers,
+		const std::vector<double>& phi,
+		const std::array<size_t, 6>& neighbors,
+		const Vector3D& gridSpacing,
+		const Vector3D& invGridSpacingSqr)
+	{
+		std::array<bool, 3> hasAxis = { false, false, false };
+		const double maxValue = std::numeric_limits<double>::max();
+		Vector3D phiAxis(maxValue, maxValue, maxValue);
+
+		for (size_t d = 0; d < 6; ++d)
+		{
+			const size_t neighbor = neighbors[d];
+			if (neighbor != NarrowBand3::NOT_IN_BAND && markers[neighbor] == KNOWN)
+			{
+				hasAxis[d / 2] = true;
+				phiAxis[d / 2] = std::min(phiAxis[d / 2], phi[neighbor]);
+			}
+		}
+
+		assert(hasAxis[0] || hasAxis[1] || hasAxis[2]);
+
+		double solution = 0.0;
+
+		// Initial guess
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			if (hasAxis[axis])
+			{
+				solution = std::max(solution, phiAxis[axis] + gridSpacing[axis]);
+			}
+		}
+
+		// Solve quad
+		double a = 0.0;
+		double b = 0.0;
+		double c = -1.0;
+
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			if (hasAxis[axis])
+			{
+				a += invGridSpacingSqr[axis];
+				b -= phiAxis[axis] * invGridSpacingSqr[axis];
+				c += Square(phiAxis[axis]) * invGridSpacingSqr[axis];
+			}
+		}
+
+		double det = b * b - a * c;
+
+		if (det > 0.0)
+		{
+			solution = (-b + std::sqrt(det)) / a;
+		}
+
+		return solution;
+	}
+
 	FMMLevelSetSolver3::FMMLevelSetSolver3()
 	{
 		// Do nothing
@@ -430,6 +536,150 @@ namespace CubbyFlow
 		}
 	}
 
+	void FMMLevelSetSolver3::ReinitializeNarrowBand(
+		const ScalarGrid3& inputSDF,
+		const NarrowBand3& band,
+		double maxDistance,
+		ScalarGrid3* outputSDF)
+	{
+		if (!inputSDF.HasSameShape(*outputSDF))
+		{
+			throw std::invalid_argument("inputSDF and outputSDF have not same shape.");
+		}
+
+		if (band.GetGridSize() != inputSDF.GetDataSize())
+		{
+			throw std::invalid_argument("band and inputSDF have not same size.");
+		}
+
+		const size_t n = band.size();
+		Vector3D gridSpacing = inputSDF.GridSpacing();
+		Vector3D invGridSpacing = 1.0 / gridSpacing;
+		Vector3D invGridSpacingSqr = invGridSpacing * invGridSpacing;
+
+		auto output = outputSDF->GetDataAccessor();
+
+		if (&inputSDF != outputSDF)
+		{
+			inputSDF.ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+			{
+				output(i, j, k) = inputSDF(i, j, k);
+			});
+		}
+
+		// March on a compact copy of the band
+		std::vector<double> phi(n);
+		std::vector<std::array<size_t, 6>> neighbors(n);
+		std::vector<char> markers(n);
+
+		ParallelFor(ZERO_SIZE, n, [&](size_t m)
+		{
+			phi[m] = output(band[m]);
+			neighbors[m] = band.GetNeighbors(m);
+		});
+
+		// Solve geometrically near the boundary, in the same order as the full grid
+		for (size_t m = 0; m < n; ++m)
+		{
+			bool hasInsideNeighbor = false;
+			bool hasOutsideNeighbor = false;
+
+			for (size_t neighbor : neighbors[m])
+			{
+				if (neighbor != NarrowBand3::NOT_IN_BAND)
+				{
+					if (IsInsideSDF(phi[neighbor]))
+					{
+						hasInsideNeighbor = true;
+					}
+					else
+					{
+						hasOutsideNeighbor = true;
+					}
+				}
+			}
+
+			if (!IsInsideSDF(phi[m]) && hasInsideNeighbor)
+			{
+				phi[m] = SolveQuadNearBoundary(phi, neighbors[m], gridSpacing, 1.0, m);
+			}
+			else if (IsInsideSDF(phi[m]) && hasOutsideNeighbor)
+			{
+				phi[m] = SolveQuadNearBoundary(phi, neighbors[m], gridSpacing, -1.0, m);
+			}
+		}
+
+		for (int sign = 0; sign < 2; ++sign)
+		{
+			// Build markers
+			ParallelFor(ZERO_SIZE, n, [&](size_t m)
+			{
+				markers[m] = IsInsideSDF(phi[m]) ? KNOWN : UNKNOWN;
+			});
+
+			auto compare = [&](size_t a, size_t b)
+			{
+				return phi[a] > phi[b];
+			};
+
+			// Enqueue initial candidates
+			std::priority_queue<size_t, std::vector<size_t>, decltype(compare)> trial(compare);
+			for (size_t m = 0; m < n; ++m)
+			{
+				if (markers[m] == KNOWN)
+				{
+					continue;
+				}
+
+				for (size_t neighbor : neighbors[m])
+				{
+					if (neighbor != NarrowBand3::NOT_IN_BAND && markers[neighbor] == KNOWN)
+					{
+						trial.push(m);
+						markers[m] = TRIAL;
+						break;
+					}
+				}
+			}
+
+			// Propagate
+			while (!trial.empty())
+			{
+				const size_t m = trial.top();
+				trial.pop();
+
+				markers[m] = KNOWN;
+				phi[m] = SolveQuad(markers, phi, neighbors[m], gridSpacing, invGridSpacingSqr);
+
+				if (phi[m] > maxDistance)
+				{
+					break;
+				}
+
+				for (size_t neighbor : neighbors[m])
+				{
+					if (neighbor != NarrowBand3::NOT_IN_BAND && markers[neighbor] == UNKNOWN)
+					{
+						markers[neighbor] = TRIAL;
+						phi[neighbor] = SolveQuad(markers, phi, neighbors[neighbor], gridSpacing, invGridSpacingSqr);
+						trial.push(neighbor);
+					}
+				}
+			}
+
+			// Flip the sign
+			ParallelFor(ZERO_SIZE, n, [&](size_t m)
+			{
+				phi[m] = -phi[m];
+			});
+		}
+
+		ParallelFor(ZERO_SIZE, n, [&](size_t m)
+		{
+			output(band[m]) = phi[m];
+		});
+	}
+
 	void FMMLevelSetSolver3::Extrapolate(
 		const ScalarGrid3& input,
 		const ScalarField3& sdf,
@@ -546,6 +796,30 @@ namespace CubbyFlow
 		Extrapolate(w, sdfAtW, gridSpacing, maxDistance, output->GetWAccessor());
 	}
 
+	void FMMLevelSetSolver3::ExtrapolateNarrowBand(
+		const FaceCenteredGrid3& input,
+		const ScalarField3& sdf,
+		const NarrowBand3& band,
+		double maxDistance,
+		FaceCenteredGrid3* output)
+	{
+		if (!input.HasSameShape(*output))
+		{
+			throw std::invalid_argument("inputSDF and outputSDF have not same shape.");
+		}
+
+		if (band.GetGridSize() != input.Resolution())
+		{
+			throw std::invalid_argument("band and input have not same size.");
+		}
+
+		const Vector3D gridSpacing = input.GridSpacing();
+
+		ExtrapolateNarrowBand(input.GetUConstAccessor(), input.GetUPosition(), sdf, band, 0, gridSpacing, maxDistance, output->GetUAccessor());
+		ExtrapolateNarrowBand(input.GetVConstAccessor(), input.GetVPosition(), sdf, band, 1, gridSpacing, maxDistance, output->GetVAccessor());
+		ExtrapolateNarrowBand(input.GetWConstAccessor(), input.GetWPosition(), sdf, band, 2, gridSpacing, maxDistance, output->GetWAccessor());
+	}
+
 	void FMMLevelSetSolver3::Extrapolate(
 		const ConstArrayAccessor3<double>& input,
 		const ConstArrayAccessor3<double>& sdf,
@@ -782,4 +1056,161 @@ namespace CubbyFlow
 			markers(i, j, k) = KNOWN;
 		}
 	}
+
+	void FMMLevelSetSolver3::ExtrapolateNarrowBand(
+		const ConstArrayAccessor3<double>& input,
+		const Grid3::DataPositionFunc& inputPosition,
+		const ScalarField3& sdf,
+		const NarrowBand3& band,
+		size_t axis,
+		const Vector3D& gridSpacing,
+		double maxDistance,
+		ArrayAccessor3<double> output)
+	{
+		const Size3 size = input.size();
+		const size_t numberOfFaces = 2 * band.size();
+		Vector3D invGridSpacing = 1.0 / gridSpacing;
+
+		// Build markers
+		std::vector<Point3UI> faces(numberOfFaces);
+		std::vector<double> sdfAtFaces(numberOfFaces);
+		std::vector<char> markers(numberOfFaces, UNKNOWN);
+
+		band.ParallelForEachFaceIndex(axis, [&](size_t f, size_t i, size_t j, size_t k)
+		{
+			faces[f] = Point3UI(i, j, k);
+			sdfAtFaces[f] = sdf.Sample(inputPosition(i, j, k));
+			if (IsInsideSDF(sdfAtFaces[f]))
+			{
+				markers[f] = KNOWN;
+			}
+			output(i, j, k) = input(i, j, k);
+		});
+
+		// Returns the band face indices of the six neighbors of the face
+		auto getNeighbors = [&](const Point3UI& face)
+		{
+			std::array<size_t, 6> neighbors;
+			for (size_t d = 0; d < 3; ++d)
+			{
+				Point3UI lower = face;
+				Point3UI upper = face;
+				--lower[d];
+				++upper[d];
+
+				neighbors[2 * d] = (face[d] > 0) ? band.FaceIndexOf(axis, lower.x, lower.y, lower.z) : NarrowBand3::NOT_IN_BAND;
+				neighbors[2 * d + 1] = (face[d] + 1 < size[d]) ? band.FaceIndexOf(axis, upper.x, upper.y, upper.z) : NarrowBand3::NOT_IN_BAND;
+			}
+
+			return neighbors;
+		};
+
+		// Same central difference as Gradient3, sampling the faces outside of the band
+		auto getGradient = [&](size_t f)
+		{
+			const Point3UI& face = faces[f];
+			Vector3D grad;
+
+			for (size_t d = 0; d < 3; ++d)
+			{
+				double values[2];
+
+				for (size_t side = 0; side < 2; ++side)
+				{
+					Point3UI pt = face;
+					if (side == 0 && face[d] > 0)
+					{
+						--pt[d];
+					}
+					else if (side == 1 && face[d] + 1 < size[d])
+					{
+						++pt[d];
+					}
+
+					const size_t idx = band.FaceIndexOf(axis, pt.x, pt.y, pt.z);
+					values[side] = (idx != NarrowBand3::NOT_IN_BAND) ? sdfAtFaces[idx] : sdf.Sample(inputPosition(pt.x, pt.y, pt.z));
+				}
+
+				grad[d] = 0.5 * (values[1] - values[0]) / gridSpacing[d];
+			}
+
+			return grad;
+		};
+
+		auto compare = [&](size_t a, size_t b)
+		{
+			return sdfAtFaces[a] > sdfAtFaces[b];
+		};
+
+		// Enqueue initial candidates
+		std::priority_queue<size_t, std::vector<size_t>, decltype(compare)> trial(compare);
+		band.ForEachFaceIndex(axis, [&](size_t f, size_t, size_t, size_t)
+		{
+			if (markers[f] == KNOWN)
+			{
+				return;
+			}
+
+			for (size_t neighbor : getNeighbors(faces[f]))
+			{
+				if (neighbor != NarrowBand3::NOT_IN_BAND && markers[neighbor] == KNOWN)
+				{
+					trial.push(f);
+					markers[f] = TRIAL;
+					return;
+				}
+			}
+		});
+
+		// Propagate
+		while (!trial.empty())
+		{
+			const size_t f = trial.top();
+			trial.pop();
+
+			if (sdfAtFaces[f] > maxDistance)
+			{
+				break;
+			}
+
+			Vector3D grad = getGradient(f).Normalized();
+			const std::array<size_t, 6> neighbors = getNeighbors(faces[f]);
+
+			double sum = 0.0;
+			double count = 0.0;
+
+			for (size_t d = 0; d < 6; ++d)
+			{
+				const size_t neighbor = neighbors[d];
+				if (neighbor == NarrowBand3::NOT_IN_BAND)
+				{
+					continue;
+				}
+
+				if (markers[neighbor] == KNOWN)
+				{
+					double weight = ((d % 2 == 0) ? std::max(grad[d / 2], 0.0) : -std::min(grad[d / 2], 0.0)) * invGridSpacing[d / 2];
+
+					// If gradient is zero, then just assign 1 to weight
+					if (weight < std::numeric_limits<double>::epsilon())
+					{
+						weight = 1.0;
+					}
+
+					sum += weight * output(faces[neighbor]);
+					count += weight;
+				}
+				else if (markers[neighbor] == UNKNOWN)
+				{
+					markers[neighbor] = TRIAL;
+					trial.push(neighbor);
+				}
+			}
+
+			assert(count > 0.0);
+
+			output(faces[f]) = sum / count;
+			markers[f] = KNOWN;
+		}
+	}
 }
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include <FDM/FDMUtils.h>
 #include <Solver/LevelSet/IterativeLevelSetSolver3.h>
 #include <Utils/Logger.h>
+#include <Utils/Parallel.h>
+
+#include <vector>
 
 namespace CubbyFlow
 {
@@ -53,29 +56,7 @@ namespace CubbyFlow
 		{
 			inputSDF.ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
 			{
-				double s = Sign(outputAcc, gridSpacing, i, j, k);
-
-				std::array<double, 2> dx, dy, dz;
-
-				GetDerivatives(outputAcc, gridSpacing, i, j, k, &dx, &dy, &dz);
-
-				// Explicit Euler step
-				double val = outputAcc(i, j, k) -
-					dtau * std::max(s, 0.0) *
-					(std::sqrt(Square(std::max(dx[0], 0.0)) +
-						Square(std::min(dx[1], 0.0)) +
-						Square(std::max(dy[0], 0.0)) +
-						Square(std::min(dy[1], 0.0)) +
-						Square(std::max(dz[0], 0.0)) +
-						Square(std::min(dz[1], 0.0))) - 1.0) -
-					dtau * std::min(s, 0.0) *
-					(std::sqrt(Square(std::min(dx[0], 0.0)) +
-						Square(std::max(dx[1], 0.0)) +
-						Square(std::min(dy[0], 0.0)) +
-						Square(std::max(dy[1], 0.0)) +
-						Square(std::min(dz[0], 0.0)) +
-						Square(std::max(dz[1], 0.0))) - 1.0);
-				tempAcc(i, j, k) = val;
+				tempAcc(i, j, k) = ComputeReinitializeStep(outputAcc, gridSpacing, dtau, i, j, k);
 			});
 
 			std::swap(tempAcc, outputAcc);
@@ -85,6 +66,56 @@ namespace CubbyFlow
 		CopyRange3(outputAcc, size.x, size.y, size.z, &outputSDFAcc);
 	}
 
+	void IterativeLevelSetSolver3::ReinitializeNarrowBand(
+		const ScalarGrid3& inputSDF,
+		const NarrowBand3& band,
+		double maxDistance,
+		ScalarGrid3* outputSDF)
+	{
+		const Vector3D gridSpacing = inputSDF.GridSpacing();
+
+		if (!inputSDF.HasSameShape(*outputSDF))
+		{
+			throw std::invalid_argument("inputSDF and outputSDF have not same shape.");
+		}
+
+		if (band.GetGridSize() != inputSDF.GetDataSize())
+		{
+			throw std::invalid_argument("band and inputSDF have not same size.");
+		}
+
+		ArrayAccessor3<double> outputAcc = outputSDF->GetDataAccessor();
+
+		if (&inputSDF != outputSDF)
+		{
+			const Size3 size = inputSDF.GetDataSize();
+			CopyRange3(inputSDF.GetConstDataAccessor(), size.x, size.y, size.z, &outputAcc);
+		}
+
+		const double dtau = PseudoTimeStep(outputAcc, gridSpacing, band);
+		const unsigned int numberOfIterations = DistanceToNumberOfIterations(maxDistance, dtau);
+
+		std::vector<double> temp(band.size());
+
+		CUBBYFLOW_INFO << "Reinitializing narrow band of " << band.size()
+			<< " points with pseudoTimeStep: " << dtau
+			<< " numberOfIterations: " << numberOfIterations;
+
+		for (unsigned int n = 0; n < numberOfIterations; ++n)
+		{
+			ParallelFor(ZERO_SIZE, band.size(), [&](size_t m)
+			{
+				const Point3UI& pt = band[m];
+				temp[m] = ComputeReinitializeStep(outputAcc, gridSpacing, dtau, pt.x, pt.y, pt.z);
+			});
+
+			ParallelFor(ZERO_SIZE, band.size(), [&](size_t m)
+			{
+				outputAcc(band[m]) = temp[m];
+			});
+		}
+	}
+
 	void IterativeLevelSetSolver3::Extrapolate(
 		const ScalarGrid3& input,
 		const ScalarField3& sdf,
@@ -307,4 +338,58 @@ namespace CubbyFlow
 
 		return dtau;
 	}
+
+	double IterativeLevelSetSolver3::PseudoTimeStep(
+		ConstArrayAccessor3<double> sdf,
+		const Vector3D& gridSpacing,
+		const NarrowBand3& band) const
+	{
+		const double h = std::max({ gridSpacing.x, gridSpacing.y, gridSpacing.z });
+
+		double maxS = -std::numeric_limits<double>::max();
+		double dtau = m_maxCFL * h;
+
+		band.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			double s = Sign(sdf, gridSpacing, i, j, k);
+			maxS = std::max(s, maxS);
+		});
+
+		while (dtau * maxS / h > m_maxCFL)
+		{
+			dtau *= 0.5;
+		}
+
+		return dtau;
+	}
+
+	double IterativeLevelSetSolver3::ComputeReinitializeStep(
+		ConstArrayAccessor3<double> sdf,
+		const Vector3D& gridSpacing,
+		double dtau,
+		size_t i, size_t j, size_t k) const
+	{
+		double s = Sign(sdf, gridSpacing, i, j, k);
+
+		std::array<double, 2> dx, dy, dz;
+
+		GetDerivatives(sdf, gridSpacing, i, j, k, &dx, &dy, &dz);
+
+		// Explicit Euler step
+		return sdf(i, j, k) -
+			dtau * std::max(s, 0.0) *
+			(std::sqrt(Square(std::max(dx[0], 0.0)) +
+				Square(std::min(dx[1], 0.0)) +
+				Square(std::max(dy[0], 0.0)) +
+				Square(std::min(dy[1], 0.0)) +
+				Square(std::max(dz[0], 0.0)) +
+				Square(std::min(dz[1], 0.0))) - 1.0) -
+			dtau * std::min(s, 0.0) *
+			(std::sqrt(Square(std::min(dx[0], 0.0)) +
+				Square(std::max(dx[1], 0.0)) +
+				Square(std::min(dy[0], 0.0)) +
+				Square(std::max(dy[1], 0.0)) +
+				Square(std::min(dz[0], 0.0)) +
+				Square(std::max(dz[1], 0.0))) - 1.0);
+	}
 }
\ No newline at end of file
@@ -14,6 +14,9 @@
 #include <Utils/Logger.h>
 #include <Utils/Timer.h>
 
+#include <array>
+#include <cmath>
+
 namespace CubbyFlow
 {
 	LevelSetLiquidSolver3::LevelSetLiquidSolver3() :
@@ -63,6 +66,28 @@ namespace CubbyFlow
 		m_isGlobalCompensationEnabled = isEnabled;
 	}
 
+	void LevelSetLiquidSolver3::SetIsNarrowBandEnabled(bool isEnabled)
+	{
+		m_isNarrowBandEnabled = isEnabled;
+		m_narrowBand.Clear();
+	}
+
+	double LevelSetLiquidSolver3::GetNarrowBandWidth() const
+	{
+		return m_narrowBandWidth;
+	}
+
+	void LevelSetLiquidSolver3::SetNarrowBandWidth(double width)
+	{
+		m_narrowBandWidth = std::max(width, 3.0);
+		m_narrowBand.Clear();
+	}
+
+	const NarrowBand3& LevelSetLiquidSolver3::GetNarrowBand() const
+	{
+		return m_narrowBand;
+	}
+
 	double LevelSetLiquidSolver3::ComputeVolume() const
 	{
 		auto sdf = GetSignedDistanceField();
@@ -84,6 +109,14 @@ namespace CubbyFlow
 	{
 		UNUSED_VARIABLE(timeIntervalInSeconds);
 
+		// Emitters can write anywhere in the grid, so the band is rebuilt from
+		// scratch when one is attached
+		if (m_isNarrowBandEnabled &&
+			(m_narrowBand.GetGridSize() != GetSignedDistanceField()->GetDataSize() || GetEmitter() != nullptr))
+		{
+			BuildNarrowBand();
+		}
+
 		// Measure current volume
 		m_lastKnownVolume = ComputeVolume();
 
@@ -127,6 +160,34 @@ namespace CubbyFlow
 		GridFluidSolver3::ComputeAdvection(timeIntervalInSeconds);
 	}
 
+	void LevelSetLiquidSolver3::ComputeScalarDataAdvection(size_t index, double timeIntervalInSeconds)
+	{
+		if (!m_isNarrowBandEnabled || index != m_signedDistanceFieldId)
+		{
+			GridFluidSolver3::ComputeScalarDataAdvection(index, timeIntervalInSeconds);
+			return;
+		}
+
+		auto sdf = GetSignedDistanceField();
+
+		// Grow the band so that it covers the interface after the advection
+		const double currentCFL = GetCFL(timeIntervalInSeconds);
+		m_narrowBand.Dilate(static_cast<size_t>(std::ceil(currentCFL)) + 1);
+
+		GetAdvectionSolver()->AdvectNarrowBand(
+			*sdf,
+			*GetVelocity(),
+			timeIntervalInSeconds,
+			m_narrowBand,
+			sdf.get(),
+			*GetColliderSDF());
+
+		if (GetCollider() != nullptr)
+		{
+			ExtrapolateIntoCollider(sdf.get());
+		}
+	}
+
 	ScalarField3Ptr LevelSetLiquidSolver3::GetFluidSDF() const
 	{
 		return GetSignedDistanceField();
@@ -134,6 +195,27 @@ namespace CubbyFlow
 
 	void LevelSetLiquidSolver3::Reinitialize(double currentCfl)
 	{
+		if (m_isNarrowBandEnabled)
+		{
+			auto sdf = GetSignedDistanceField();
+			const double width = m_narrowBandWidth * sdf->GridSpacing().Max();
+
+			if (m_levelSetSolver != nullptr)
+			{
+				m_levelSetSolver->ReinitializeNarrowBand(*sdf, m_narrowBand, width, sdf.get());
+			}
+
+			if (GetCollider() != nullptr)
+			{
+				ExtrapolateIntoCollider(sdf.get());
+			}
+
+			m_narrowBand.Trim(sdf->GetDataAccessor(), width);
+
+			CUBBYFLOW_INFO << "Narrow band size: " << m_narrowBand.size();
+			return;
+		}
+
 		if (m_levelSetSolver != nullptr)
 		{
 			auto sdf = GetSignedDistanceField();
@@ -150,11 +232,27 @@ namespace CubbyFlow
 		}
 	}
 
+	void LevelSetLiquidSolver3::BuildNarrowBand()
+	{
+		auto sdf = GetSignedDistanceField();
+		const double width = m_narrowBandWidth * sdf->GridSpacing().Max();
+
+		m_narrowBand.Build(sdf->GetDataAccessor(), width);
+
+		CUBBYFLOW_INFO << "Built narrow band of " << m_narrowBand.size() << " points";
+	}
+
 	void LevelSetLiquidSolver3::ExtrapolateVelocityToAir(double currentCFL)
 	{
 		auto sdf = GetSignedDistanceField();
 		auto vel = GetGridSystemData()->GetVelocity();
 
+		if (m_isNarrowBandEnabled)
+		{
+			ExtrapolateVelocityToAirNarrowBand(currentCFL);
+			return;
+		}
+
 		auto u = vel->GetUAccessor();
 		auto v = vel->GetVAccessor();
 		auto w = vel->GetWAccessor();
@@ -212,11 +310,50 @@ namespace CubbyFlow
 		CUBBYFLOW_INFO << "Max velocity extrapolation distance: " << maxDist;
 
 		FMMLevelSetSolver3 fmmSolver;
+
 		fmmSolver.Extrapolate(*vel, *sdf, maxDist, vel.get());
 
 		ApplyBoundaryCondition();
 	}
 
+	void LevelSetLiquidSolver3::ExtrapolateVelocityToAirNarrowBand(double currentCFL)
+	{
+		auto sdf = GetSignedDistanceField();
+		auto vel = GetGridSystemData()->GetVelocity();
+
+		// All the air faces are reset as in the dense path. Gravity, advection
+		// and the faces that leave the band as the interface moves would
+		// otherwise leave stale velocities outside of the band, which the
+		// velocity advection and the CFL number still read. The clamped SDF
+		// keeps the right sign outside of the band.
+		const std::array<ArrayAccessor3<double>, 3> accessors = { vel->GetUAccessor(), vel->GetVAccessor(), vel->GetWAccessor() };
+		const std::array<Grid3::DataPositionFunc, 3> positions = { vel->GetUPosition(), vel->GetVPosition(), vel->GetWPosition() };
+
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			ArrayAccessor3<double> acc = accessors[axis];
+			const Grid3::DataPositionFunc& pos = positions[axis];
+
+			acc.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				if (!IsInsideSDF(sdf->Sample(pos(i, j, k))))
+				{
+					acc(i, j, k) = 0.0;
+				}
+			});
+		}
+
+		const double h = sdf->GridSpacing().Max();
+		const double maxDist = std::min(std::max(2.0 * currentCFL, m_minReinitializeDistance), m_narrowBandWidth) * h;
+
+		CUBBYFLOW_INFO << "Max velocity extrapolation distance: " << maxDist;
+
+		FMMLevelSetSolver3 fmmSolver;
+		fmmSolver.ExtrapolateNarrowBand(*vel, *sdf, m_narrowBand, maxDist, vel.get());
+
+		ApplyBoundaryCondition();
+	}
+
 	void LevelSetLiquidSolver3::AddVolume(double volDiff)
 	{
 		auto sdf = GetSignedDistanceField();
@@ -240,6 +377,16 @@ namespace CubbyFlow
 		{
 			double dist = volDiff / dVdh;
 
+			// The clamped values outside of the narrow band stay as they are
+			if (m_isNarrowBandEnabled)
+			{
+				m_narrowBand.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+				{
+					(*sdf)(i, j, k) += dist;
+				});
+				return;
+			}
+
 			sdf->ParallelForEachDataPointIndex([&](size_t i, size_t j, size_t k)
 			{
 				(*sdf)(i, j, k) += dist; 
@@ -19,4 +19,16 @@ namespace CubbyFlow
 	{
 		// Do nothing
 	}
+
+	void LevelSetSolver3::ReinitializeNarrowBand(
+		const ScalarGrid3& inputSDF,
+		const NarrowBand3& band,
+		double maxDistance,
+		ScalarGrid3* outputSDF)
+	{
+		UNUSED_VARIABLE(band);
+
+		const auto input = inputSDF.Clone();
+		Reinitialize(*input, maxDistance, outputSDF);
+	}
 }
\ No newline at end of file
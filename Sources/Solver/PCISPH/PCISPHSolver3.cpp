@@ -10,6 +10,7 @@
 #include <Solver/PCISPH/PCISPHSolver3.h>
 #include <SPH/SPHStdKernel3.h>
 #include <Utils/Logger.h>
+#include <Utils/Parallel.h>
 
 namespace CubbyFlow
 {
@@ -81,8 +82,9 @@ namespace CubbyFlow
 		});
 
 		unsigned int maxNumIter = 0;
-		double maxDensityError;
+		double maxDensityError = 0.0;
 		double densityErrorRatio = 0.0;
+		double (*absMax)(double, double) = AbsMax<double>;
 
 		for (unsigned int k = 0; k < m_maxNumberOfIterations; ++k)
 		{
@@ -96,44 +98,45 @@ namespace CubbyFlow
 			// Resolve collisions
 			ResolveCollision(m_tempPositions, m_tempVelocities);
 
-			// Compute pressure from density error
-			ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+			// Compute pressure from density error and find the max density error
+			maxDensityError = ParallelReduce(ZERO_SIZE, numberOfParticles, 0.0,
+				[&](size_t begin, size_t end, double init)
 			{
-				double weightSum = 0.0;
-				const auto& neighbors = particles->NeighborLists()[i];
-
-				for (size_t j : neighbors)
-				{
-					double dist = m_tempPositions[j].DistanceTo(m_tempPositions[i]);
-					weightSum += kernel(dist);
-				}
-				weightSum += kernel(0);
-
-				double density = mass * weightSum;
-				double densityError = (density - targetDensity);
-				double pressure = delta * densityError;
-
-				if (pressure < 0.0)
+				for (size_t i = begin; i < end; ++i)
 				{
-					pressure *= GetNegativePressureScale();
-					densityError *= GetNegativePressureScale();
+					double weightSum = 0.0;
+
+					particles->ForEachNeighbor(i, [&](size_t j)
+					{
+						double dist = m_tempPositions[j].DistanceTo(m_tempPositions[i]);
+						weightSum += kernel(dist);
+					});
+					weightSum += kernel(0);
+
+					double density = mass * weightSum;
+					double densityError = (density - targetDensity);
+					double pressure = delta * densityError;
+
+					if (pressure < 0.0)
+					{
+						pressure *= GetNegativePressureScale();
+						densityError *= GetNegativePressureScale();
+					}
+
+					p[i] += pressure;
+					ds[i] = density;
+					m_densityErrors[i] = densityError;
+					init = absMax(init, densityError);
 				}
 
-				p[i] += pressure;
-				ds[i] = density;
-				m_densityErrors[i] = densityError;
-			});
+				return init;
+			}, absMax);
 
-			// Compute pressure gradient force
+			// Compute pressure gradient force. The force is evaluated at the
+			// current positions, which AccumulateForces has already copied into
+			// the SoA arrays, so nothing is reloaded in this loop.
 			m_pressureForces.Set(Vector3D());
-			SPHSolver3::AccumulatePressureForce(x, ds.ConstAccessor(), p, m_pressureForces.Accessor());
-
-			// Compute max density error
-			maxDensityError = 0.0;
-			for (size_t i = 0; i < numberOfParticles; ++i)
-			{
-				maxDensityError = AbsMax(maxDensityError, m_densityErrors[i]);
-			}
+			AccumulatePressureForceSoA(GetPositionsSoA(), ds.ConstAccessor(), p, m_pressureForces.Accessor());
 
 			densityErrorRatio = maxDensityError / targetDensity;
 			maxNumIter = k + 1;
@@ -173,18 +176,33 @@ namespace CubbyFlow
 		m_densityErrors.Resize(numberOfParticles);
 	}
 
-	double PCISPHSolver3::ComputeDelta(double timeStepInSeconds) const
+	double PCISPHSolver3::ComputeDelta(double timeStepInSeconds)
 	{
 		auto particles = GetSPHSystemData();
 		const double kernelRadius = particles->GetKernelRadius();
+		const double targetSpacing = particles->GetTargetSpacing();
+
+		// The lattice sum only depends on the kernel radius and the target
+		// spacing, so it is computed again only when one of them has changed.
+		if (kernelRadius != m_deltaKernelRadius || targetSpacing != m_deltaTargetSpacing)
+		{
+			m_deltaDenom = ComputeDeltaDenom(kernelRadius, targetSpacing);
+			m_deltaKernelRadius = kernelRadius;
+			m_deltaTargetSpacing = targetSpacing;
+		}
+
+		return (std::fabs(m_deltaDenom) > 0.0) ? -1 / (ComputeBeta(timeStepInSeconds) * m_deltaDenom) : 0;
+	}
 
+	double PCISPHSolver3::ComputeDeltaDenom(double kernelRadius, double targetSpacing)
+	{
 		Array1<Vector3D> points;
 		BccLatticePointGenerator pointsGenerator;
 		Vector3D origin;
 		BoundingBox3D sampleBound(origin, origin);
 		sampleBound.Expand(1.5 * kernelRadius);
 
-		pointsGenerator.Generate(sampleBound, particles->GetTargetSpacing(), &points);
+		pointsGenerator.Generate(sampleBound, targetSpacing, &points);
 
 		SPHSpikyKernel3 kernel(kernelRadius);
 
@@ -211,7 +229,7 @@ namespace CubbyFlow
 
 		denom += -denom1.Dot(denom1) - denom2;
 
-		return (std::fabs(denom) > 0.0) ? -1 / (ComputeBeta(timeStepInSeconds) * denom) : 0;
+		return denom;
 	}
 
 	double PCISPHSolver3::ComputeBeta(double timeStepInSeconds) const
@@ -12,8 +12,25 @@
 #include <Utils/Logger.h>
 #include <Utils/Timer.h>
 
+#include <array>
+
 namespace CubbyFlow
 {
+	// Number of cells, along each axis, between the cell a particle is binned
+	// into and the farthest node its transfer stencil writes. The trilinear
+	// stencil of a face-centered grid reaches one node past the particle's
+	// cell, and the sampler may round the particle into a neighboring cell
+	// of the one used for binning.
+	static const size_t TRANSFER_STENCIL_REACH = 2;
+
+	// Edge length of the particle blocks in cells. Same-colored blocks are
+	// one block apart, so the nodes written from two of them are disjoint as
+	// long as a block is at least as wide as the stencil reaches on both
+	// sides.
+	static const size_t PARTICLE_BLOCK_SIZE = 4;
+	static_assert(PARTICLE_BLOCK_SIZE >= 2 * TRANSFER_STENCIL_REACH,
+		"Particle blocks must be wider than the reach of the transfer stencil");
+
 	PICSolver3::PICSolver3() :
 		PICSolver3({ 1, 1, 1 }, { 1, 1, 1 }, { 0, 0, 0 })
 	{
@@ -128,7 +145,6 @@ namespace CubbyFlow
 		auto flow = GetGridSystemData()->GetVelocity();
 		auto positions = m_particles->GetPositions();
 		auto velocities = m_particles->GetVelocities();
-		size_t numberOfParticles = m_particles->NumberOfParticles();
 
 		// Clear velocity to zero
 		flow->Fill(Vector3D());
@@ -158,7 +174,7 @@ namespace CubbyFlow
 			flow->GetWConstAccessor(),
 			flow->GridSpacing(),
 			flow->GetWOrigin());
-		for (size_t i = 0; i < numberOfParticles; ++i)
+		ParallelForEachParticleInBlocks([&](size_t i)
 		{
 			std::array<Point3UI, 8> indices;
 			std::array<double, 8> weights;
@@ -186,7 +202,7 @@ namespace CubbyFlow
 				wWeight(indices[j]) += weights[j];
 				m_wMarkers(indices[j]) = 1;
 			}
-		}
+		});
 
 		uWeight.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 		{
@@ -217,10 +233,13 @@ namespace CubbyFlow
 		auto positions = m_particles->GetPositions();
 		auto velocities = m_particles->GetVelocities();
 		size_t numberOfParticles = m_particles->NumberOfParticles();
+		auto flowSampler = flow->LinearSampler();
 
-		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		ParallelRangeFor(ZERO_SIZE, numberOfParticles, [&](size_t begin, size_t end)
 		{
-			velocities[i] = flow->Sample(positions[i]);
+			flowSampler(
+				ConstArrayAccessor1<Vector3D>(end - begin, positions.data() + begin),
+				ArrayAccessor1<Vector3D>(end - begin, velocities.data() + begin));
 		});
 	}
 
@@ -232,61 +251,85 @@ namespace CubbyFlow
 		size_t numberOfParticles = m_particles->NumberOfParticles();
 		int domainBoundaryFlag = GetClosedDomainBoundaryFlag();
 		BoundingBox3D boundingBox = flow->BoundingBox();
+		auto flowSampler = flow->LinearSampler();
 
-		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
-		{
-			Vector3D pt0 = positions[i];
-			Vector3D pt1 = pt0;
-			Vector3D vel = velocities[i];
-
-			// Adaptive time-stepping
-			unsigned int numSubSteps = static_cast<unsigned int>(std::max(GetMaxCFL(), 1.0));
-			double dt = timeIntervalInSeconds / numSubSteps;
-			for (unsigned int t = 0; t < numSubSteps; ++t)
-			{
-				Vector3D vel0 = flow->Sample(pt0);
+		// Adaptive time-stepping
+		unsigned int numSubSteps = static_cast<unsigned int>(std::max(GetMaxCFL(), 1.0));
+		double dt = timeIntervalInSeconds / numSubSteps;
 
-				// Mid-point rule
-				Vector3D midPt = pt0 + 0.5 * dt * vel0;
-				Vector3D midVel = flow->Sample(midPt);
-				pt1 = pt0 + dt * midVel;
+		// The particles are advected in blocks, so the velocities of a block
+		// are looked up with one call to the batch sampler.
+		constexpr size_t blockSize = 64;
 
-				pt0 = pt1;
-			}
+		ParallelRangeFor(ZERO_SIZE, numberOfParticles, [&](size_t begin, size_t end)
+		{
+			std::array<Vector3D, blockSize> pts, midPts, vels;
 
-			if ((domainBoundaryFlag & DIRECTION_LEFT) && pt1.x <= boundingBox.lowerCorner.x)
+			for (size_t blockBegin = begin; blockBegin < end; blockBegin += blockSize)
 			{
-				pt1.x = boundingBox.lowerCorner.x;
-				vel.x = 0.0;
+				const size_t count = std::min(blockSize, end - blockBegin);
+
+				std::copy(positions.data() + blockBegin, positions.data() + blockBegin + count, pts.begin());
+
+				for (unsigned int t = 0; t < numSubSteps; ++t)
+				{
+					flowSampler(ConstArrayAccessor1<Vector3D>(count, pts.data()), ArrayAccessor1<Vector3D>(count, vels.data()));
+
+					// Mid-point rule
+					for (size_t n = 0; n < count; ++n)
+					{
+						midPts[n] = pts[n] + 0.5 * dt * vels[n];
+					}
+
+					flowSampler(ConstArrayAccessor1<Vector3D>(count, midPts.data()), ArrayAccessor1<Vector3D>(count, vels.data()));
+
+					for (size_t n = 0; n < count; ++n)
+					{
+						pts[n] = pts[n] + dt * vels[n];
+					}
+				}
+
+				for (size_t n = 0; n < count; ++n)
+				{
+					const size_t i = blockBegin + n;
+					Vector3D pt1 = pts[n];
+					Vector3D vel = velocities[i];
+
+					if ((domainBoundaryFlag & DIRECTION_LEFT) && pt1.x <= boundingBox.lowerCorner.x)
+					{
+						pt1.x = boundingBox.lowerCorner.x;
+						vel.x = 0.0;
+					}
+					if ((domainBoundaryFlag & DIRECTION_RIGHT) && pt1.x >= boundingBox.upperCorner.x)
+					{
+						pt1.x = boundingBox.upperCorner.x;
+						vel.x = 0.0;
+					}
+					if ((domainBoundaryFlag & DIRECTION_DOWN) && pt1.y <= boundingBox.lowerCorner.y)
+					{
+						pt1.y = boundingBox.lowerCorner.y;
+						vel.y = 0.0;
+					}
+					if ((domainBoundaryFlag & DIRECTION_UP) && pt1.y >= boundingBox.upperCorner.y)
+					{
+						pt1.y = boundingBox.upperCorner.y;
+						vel.y = 0.0;
+					}
+					if ((domainBoundaryFlag & DIRECTION_BACK) && pt1.z <= boundingBox.lowerCorner.z)
+					{
+						pt1.z = boundingBox.lowerCorner.z;
+						vel.z = 0.0;
+					}
+					if ((domainBoundaryFlag & DIRECTION_FRONT) && pt1.z >= boundingBox.upperCorner.z)
+					{
+						pt1.z = boundingBox.upperCorner.z;
+						vel.z = 0.0;
+					}
+
+					positions[i] = pt1;
+					velocities[i] = vel;
+				}
 			}
-			if ((domainBoundaryFlag & DIRECTION_RIGHT) && pt1.x >= boundingBox.upperCorner.x)
-			{
-				pt1.x = boundingBox.upperCorner.x;
-				vel.x = 0.0;
-			}
-			if ((domainBoundaryFlag & DIRECTION_DOWN) && pt1.y <= boundingBox.lowerCorner.y)
-			{
-				pt1.y = boundingBox.lowerCorner.y;
-				vel.y = 0.0;
-			}
-			if ((domainBoundaryFlag & DIRECTION_UP) && pt1.y >= boundingBox.upperCorner.y)
-			{
-				pt1.y = boundingBox.upperCorner.y;
-				vel.y = 0.0;
-			}
-			if ((domainBoundaryFlag & DIRECTION_BACK) && pt1.z <= boundingBox.lowerCorner.z)
-			{
-				pt1.z = boundingBox.lowerCorner.z;
-				vel.z = 0.0;
-			}
-			if ((domainBoundaryFlag & DIRECTION_FRONT) && pt1.z >= boundingBox.upperCorner.z)
-			{
-				pt1.z = boundingBox.upperCorner.z;
-				vel.z = 0.0;
-			}
-
-			positions[i] = pt1;
-			velocities[i] = vel;
 		});
 
 		Collider3Ptr col = GetCollider();
@@ -299,6 +342,97 @@ namespace CubbyFlow
 		}
 	}
 
+	void PICSolver3::BinParticlesIntoBlocks()
+	{
+		auto flow = GetGridSystemData()->GetVelocity();
+		auto positions = m_particles->GetPositions();
+		size_t numberOfParticles = m_particles->NumberOfParticles();
+		const Size3 resolution = flow->Resolution();
+		const Vector3D& gridSpacing = flow->GridSpacing();
+		const Vector3D& origin = flow->Origin();
+
+		const Size3 numBlocks(
+			(resolution.x + PARTICLE_BLOCK_SIZE - 1) / PARTICLE_BLOCK_SIZE,
+			(resolution.y + PARTICLE_BLOCK_SIZE - 1) / PARTICLE_BLOCK_SIZE,
+			(resolution.z + PARTICLE_BLOCK_SIZE - 1) / PARTICLE_BLOCK_SIZE);
+		const size_t numberOfBlocks = numBlocks.x * numBlocks.y * numBlocks.z;
+		m_numberOfParticleBlocks = numBlocks;
+
+		// Find the block of each particle
+		m_particleBlockIndices.Resize(numberOfParticles);
+		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
+		{
+			const Vector3D x = (positions[i] - origin) / gridSpacing;
+			const size_t ci = static_cast<size_t>(std::clamp(std::floor(x.x), 0.0, resolution.x - 1.0));
+			const size_t cj = static_cast<size_t>(std::clamp(std::floor(x.y), 0.0, resolution.y - 1.0));
+			const size_t ck = static_cast<size_t>(std::clamp(std::floor(x.z), 0.0, resolution.z - 1.0));
+
+			m_particleBlockIndices[i] =
+				ci / PARTICLE_BLOCK_SIZE + numBlocks.x * (
+				cj / PARTICLE_BLOCK_SIZE + numBlocks.y * (
+				ck / PARTICLE_BLOCK_SIZE));
+		});
+
+		// Stable counting sort of the particles by block. The particles are
+		// split into chunks, each chunk counts its particles per block, and the
+		// counts are scanned into the write offsets of each chunk.
+		const size_t numberOfChunks = std::clamp(
+			numberOfParticles / numberOfBlocks,
+			ONE_SIZE,
+			static_cast<size_t>(GetMaxNumberOfThreads()));
+		const size_t chunkSize = (numberOfParticles + numberOfChunks - 1) / numberOfChunks;
+
+		// offsets[c * numberOfBlocks + b] is the number of particles in block b
+		// in chunk c
+		std::vector<size_t> offsets(numberOfChunks * numberOfBlocks, 0);
+
+		ParallelFor(ZERO_SIZE, numberOfChunks, [&](size_t c)
+		{
+			size_t* counts = offsets.data() + c * numberOfBlocks;
+			const size_t end = std::min((c + 1) * chunkSize, numberOfParticles);
+
+			for (size_t i = c * chunkSize; i < end; ++i)
+			{
+				++counts[m_particleBlockIndices[i]];
+			}
+		});
+
+		// Turn the counts into offsets within each block, then lay the blocks
+		// out in order
+		m_blockStarts.resize(numberOfBlocks + 1);
+		ParallelFor(ZERO_SIZE, numberOfBlocks, [&](size_t b)
+		{
+			size_t count = 0;
+			for (size_t c = 0; c < numberOfChunks; ++c)
+			{
+				const size_t n = offsets[c * numberOfBlocks + b];
+				offsets[c * numberOfBlocks + b] = count;
+				count += n;
+			}
+
+			m_blockStarts[b + 1] = count;
+		});
+
+		m_blockStarts[0] = 0;
+		for (size_t b = 1; b <= numberOfBlocks; ++b)
+		{
+			m_blockStarts[b] += m_blockStarts[b - 1];
+		}
+
+		m_particlesSortedByBlock.Resize(numberOfParticles);
+		ParallelFor(ZERO_SIZE, numberOfChunks, [&](size_t c)
+		{
+			size_t* chunkOffsets = offsets.data() + c * numberOfBlocks;
+			const size_t end = std::min((c + 1) * chunkSize, numberOfParticles);
+
+			for (size_t i = c * chunkSize; i < end; ++i)
+			{
+				const size_t block = m_particleBlockIndices[i];
+				m_particlesSortedByBlock[m_blockStarts[block] + chunkOffsets[block]++] = i;
+			}
+		});
+	}
+
 	void PICSolver3::ExtrapolateVelocityToAir() const
 	{
 		auto vel = GetGridSystemData()->GetVelocity();
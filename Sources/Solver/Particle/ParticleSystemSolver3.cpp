@@ -66,6 +66,17 @@ namespace CubbyFlow
 		m_gravity = newGravity;
 	}
 
+	unsigned int ParticleSystemSolver3::GetParticleSortingInterval() const
+	{
+		return m_particleSortingInterval;
+	}
+
+	void ParticleSystemSolver3::SetParticleSortingInterval(unsigned int interval)
+	{
+		m_particleSortingInterval = interval;
+		m_numberOfTimeStepsSinceSorting = 0;
+	}
+
 	const ParticleSystemData3Ptr& ParticleSystemSolver3::GetParticleSystemData() const
 	{
 		return m_particleSystemData;
@@ -164,6 +175,14 @@ namespace CubbyFlow
 		CUBBYFLOW_INFO << "Update emitter took "
 			<< timer.DurationInSeconds() << " seconds";
 
+		// Sort particles
+		if (m_particleSortingInterval > 0 &&
+			++m_numberOfTimeStepsSinceSorting >= m_particleSortingInterval)
+		{
+			m_particleSystemData->SortParticles(2.0 * m_particleSystemData->GetRadius());
+			m_numberOfTimeStepsSinceSorting = 0;
+		}
+
 		// Allocate buffers
 		size_t n = m_particleSystemData->NumberOfParticles();
 		m_newPositions.Resize(n);
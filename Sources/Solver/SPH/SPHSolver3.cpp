@@ -12,6 +12,9 @@
 #include <Utils/PhysicsHelpers.h>
 #include <Utils/Timer.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace CubbyFlow
 {
 	static double TIME_STEP_LIMIT_BY_SPEED_FACTOR = 0.4;
@@ -98,6 +101,16 @@ namespace CubbyFlow
 		m_timeStepLimitScale = std::max(newScale, 0.0);
 	}
 
+	bool SPHSolver3::GetUseNeighborLists() const
+	{
+		return m_useNeighborLists;
+	}
+
+	void SPHSolver3::SetUseNeighborLists(bool onoff)
+	{
+		m_useNeighborLists = onoff;
+	}
+
 	SPHSystemData3Ptr SPHSolver3::GetSPHSystemData() const
 	{
 		return std::dynamic_pointer_cast<SPHSystemData3>(GetParticleSystemData());
@@ -129,6 +142,10 @@ namespace CubbyFlow
 
 	void SPHSolver3::AccumulateForces(double timeStepInSeconds)
 	{
+		// Positions and velocities stay the same until the time integration, so
+		// the force passes of this step share one SoA copy of them
+		UpdateSoAArrays();
+
 		AccumulateNonPressureForces(timeStepInSeconds);
 		AccumulatePressureForce(timeStepInSeconds);
 	}
@@ -141,7 +158,10 @@ namespace CubbyFlow
 
 		Timer timer;
 		particles->BuildNeighborSearcher();
-		particles->BuildNeighborLists();
+		if (m_useNeighborLists)
+		{
+			particles->BuildNeighborLists();
+		}
 		particles->UpdateDensities();
 
 		CUBBYFLOW_INFO << "Building neighbor lists and updating densities took "
@@ -168,6 +188,18 @@ namespace CubbyFlow
 			<< maxDensity / particles->GetTargetDensity();
 	}
 
+	void SPHSolver3::UpdateSoAArrays()
+	{
+		auto particles = GetSPHSystemData();
+		m_positionsSoA.Load(particles->GetPositions());
+		m_velocitiesSoA.Load(particles->GetVelocities());
+	}
+
+	const SoAArray3D& SPHSolver3::GetPositionsSoA() const
+	{
+		return m_positionsSoA;
+	}
+
 	void SPHSolver3::AccumulateNonPressureForces(double timeStepInSeconds)
 	{
 		ParticleSystemSolver3::AccumulateForces(timeStepInSeconds);
@@ -179,13 +211,12 @@ namespace CubbyFlow
 		UNUSED_VARIABLE(timeStepInSeconds);
 
 		auto particles = GetSPHSystemData();
-		auto x = particles->GetPositions();
 		auto d = particles->GetDensities();
 		auto p = particles->GetPressures();
 		auto f = particles->GetForces();
 
 		ComputePressure();
-		AccumulatePressureForce(x, d, p, f);
+		AccumulatePressureForceSoA(m_positionsSoA, d, p, f);
 	}
 
 	void SPHSolver3::ComputePressure()
@@ -211,26 +242,60 @@ namespace CubbyFlow
 		const ConstArrayAccessor1<double>& densities,
 		const ConstArrayAccessor1<double>& pressures,
 		ArrayAccessor1<Vector3D> pressureForces)
+	{
+		m_tempPositionsSoA.Load(positions);
+		AccumulatePressureForceSoA(m_tempPositionsSoA, densities, pressures, pressureForces);
+	}
+
+	void SPHSolver3::AccumulatePressureForceSoA(
+		const SoAArray3D& positions,
+		const ConstArrayAccessor1<double>& densities,
+		const ConstArrayAccessor1<double>& pressures,
+		ArrayAccessor1<Vector3D> pressureForces)
 	{
 		auto particles = GetSPHSystemData();
 		size_t numberOfParticles = particles->NumberOfParticles();
 
 		const double massSquared = Square(particles->GetMass());
-		const SPHSpikyKernel3 kernel(particles->GetKernelRadius());
+		const double h = particles->GetKernelRadius();
+
+		// Spiky kernel gradient magnitude is c * (1 - r / h)^2, evaluated in
+		// place instead of through SPHSpikyKernel3
+		const double gradientCoefficient = 45.0 / (PI_DOUBLE * h * h * h * h);
+		const double invH = 1.0 / h;
+
+		const double* px = positions.X().data();
+		const double* py = positions.Y().data();
+		const double* pz = positions.Z().data();
 
 		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
 		{
-			const auto& neighbors = particles->NeighborLists()[i];
-			for (size_t j : neighbors)
+			const double xi = px[i];
+			const double yi = py[i];
+			const double zi = pz[i];
+			const double pressureOverDensitySquared = pressures[i] / (densities[i] * densities[i]);
+
+			double fx = 0.0;
+			double fy = 0.0;
+			double fz = 0.0;
+
+			particles->ForEachNeighbor(i, [&](size_t j)
 			{
-				double dist = positions[i].DistanceTo(positions[j]);
-				if (dist > 0.0)
-				{
-					Vector3D dir = (positions[j] - positions[i]) / dist;
-					pressureForces[i] -= massSquared * (pressures[i] / (densities[i] * densities[i])
-						+ pressures[j] / (densities[j] * densities[j])) * kernel.Gradient(dist, dir);
-				}
-			}
+				const double dx = px[j] - xi;
+				const double dy = py[j] - yi;
+				const double dz = pz[j] - zi;
+				const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+				const double invDist = (dist > 0.0) ? 1.0 / dist : 0.0;
+				const double x = std::max(1.0 - dist * invH, 0.0);
+
+				const double scale = (pressureOverDensitySquared + pressures[j] / (densities[j] * densities[j]))
+					* gradientCoefficient * x * x * invDist;
+				fx += scale * dx;
+				fy += scale * dy;
+				fz += scale * dz;
+			});
+
+			pressureForces[i] -= massSquared * Vector3D(fx, fy, fz);
 		});
 	}
 
@@ -238,23 +303,44 @@ namespace CubbyFlow
 	{
 		auto particles = GetSPHSystemData();
 		size_t numberOfParticles = particles->NumberOfParticles();
-		auto x = particles->GetPositions();
-		auto v = particles->GetVelocities();
 		auto d = particles->GetDensities();
 		auto f = particles->GetForces();
 
 		const double massSquared = Square(particles->GetMass());
-		const SPHSpikyKernel3 kernel(particles->GetKernelRadius());
+		const double h = particles->GetKernelRadius();
+
+		// Spiky kernel second derivative is c * (1 - r / h), evaluated in place
+		// as above
+		const double laplacianCoefficient = 90.0 / (PI_DOUBLE * h * h * h * h * h);
+		const double invH = 1.0 / h;
+
+		const double* px = m_positionsSoA.X().data();
+		const double* py = m_positionsSoA.Y().data();
+		const double* pz = m_positionsSoA.Z().data();
+		const double* vx = m_velocitiesSoA.X().data();
+		const double* vy = m_velocitiesSoA.Y().data();
+		const double* vz = m_velocitiesSoA.Z().data();
 
 		ParallelFor(ZERO_SIZE, numberOfParticles, [&](size_t i)
 		{
-			const auto& neighbors = particles->NeighborLists()[i];
-			for (size_t j : neighbors)
-			{
-				double dist = x[i].DistanceTo(x[j]);
+			double fx = 0.0;
+			double fy = 0.0;
+			double fz = 0.0;
 
-				f[i] += GetViscosityCoefficient() * massSquared * (v[j] - v[i]) / d[j] * kernel.SecondDerivative(dist);
-			}
+			particles->ForEachNeighbor(i, [&](size_t j)
+			{
+				const double dx = px[j] - px[i];
+				const double dy = py[j] - py[i];
+				const double dz = pz[j] - pz[i];
+				const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+				const double scale = laplacianCoefficient * std::max(1.0 - dist * invH, 0.0) / d[j];
+				fx += scale * (vx[j] - vx[i]);
+				fy += scale * (vy[j] - vy[i]);
+				fz += scale * (vz[j] - vz[i]);
+			});
+
+			f[i] += GetViscosityCoefficient() * massSquared * Vector3D(fx, fy, fz);
 		});
 	}
 
@@ -276,14 +362,13 @@ namespace CubbyFlow
 			double weightSum = 0.0;
 			Vector3D smoothedVelocity;
 
-			const auto& neighbors = particles->NeighborLists()[i];
-			for (size_t j : neighbors)
+			particles->ForEachNeighbor(i, [&](size_t j)
 			{
 				double dist = x[i].DistanceTo(x[j]);
 				double wj = mass / d[j] * kernel(dist);
 				weightSum += wj;
 				smoothedVelocity += wj * v[j];
-			}
+			});
 
 			double wi = mass / d[i];
 			weightSum += wi;
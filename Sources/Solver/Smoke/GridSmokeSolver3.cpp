@@ -189,39 +189,41 @@ namespace CubbyFlow
 			auto uPos = vel->GetUPosition();
 			auto vPos = vel->GetVPosition();
 			auto wPos = vel->GetWPosition();
+			const auto& denSampler = den->LinearSampler();
+			const auto& tempSampler = temp->LinearSampler();
 
 			if (std::abs(up.x) > std::numeric_limits<double>::epsilon())
 			{
-				vel->ParallelForEachUIndex([&](size_t i, size_t j, size_t k)
+				u.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 				{
 					Vector3D pt = uPos(i, j, k);
 					double fBuoy =
-						m_buoyancySmokeDensityFactor * den->Sample(pt) +
-						m_buoyancyTemperatureFactor * (temp->Sample(pt) - tAmb);
+						m_buoyancySmokeDensityFactor * denSampler(pt) +
+						m_buoyancyTemperatureFactor * (tempSampler(pt) - tAmb);
 					u(i, j, k) += timeIntervalInSeconds * fBuoy * up.x;
 				});
 			}
 
 			if (std::abs(up.y) > std::numeric_limits<double>::epsilon())
 			{
-				vel->ParallelForEachVIndex([&](size_t i, size_t j, size_t k)
+				v.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 				{
 					Vector3D pt = vPos(i, j, k);
 					double fBuoy =
-						m_buoyancySmokeDensityFactor * den->Sample(pt) +
-						m_buoyancyTemperatureFactor * (temp->Sample(pt) - tAmb);
+						m_buoyancySmokeDensityFactor * denSampler(pt) +
+						m_buoyancyTemperatureFactor * (tempSampler(pt) - tAmb);
 					v(i, j, k) += timeIntervalInSeconds * fBuoy * up.y;
 				});
 			}
 
 			if (std::abs(up.z) > std::numeric_limits<double>::epsilon())
 			{
-				vel->ParallelForEachWIndex([&](size_t i, size_t j, size_t k)
+				w.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
 				{
 					Vector3D pt = wPos(i, j, k);
 					double fBuoy =
-						m_buoyancySmokeDensityFactor * den->Sample(pt) +
-						m_buoyancyTemperatureFactor * (temp->Sample(pt) - tAmb);
+						m_buoyancySmokeDensityFactor * denSampler(pt) +
+						m_buoyancyTemperatureFactor * (tempSampler(pt) - tAmb);
 					w(i, j, k) += timeIntervalInSeconds * fBuoy * up.z;
 				});
 			}
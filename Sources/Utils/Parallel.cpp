@@ -7,20 +7,54 @@
 > Copyright (c) 2018, Chan-Ho Chris Ohk
 *************************************************************************/
 #include <Utils/Parallel.h>
+#include <Utils/ThreadPool.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <string>
 #include <thread>
 
-static unsigned int MAX_NUMBER_OF_THREADS = std::thread::hardware_concurrency();
-
 namespace CubbyFlow
 {
+	namespace
+	{
+		unsigned int DefaultNumberOfThreads()
+		{
+			const char* env = std::getenv("CUBBYFLOW_NUM_THREADS");
+			if (env != nullptr)
+			{
+				try
+				{
+					const int numThreads = std::stoi(env);
+					if (numThreads > 0)
+					{
+						return static_cast<unsigned int>(numThreads);
+					}
+				}
+				catch (const std::exception&)
+				{
+					// Falls back to the hardware concurrency
+				}
+			}
+
+			return std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		unsigned int& MaxNumberOfThreads()
+		{
+			static unsigned int maxNumberOfThreads = DefaultNumberOfThreads();
+			return maxNumberOfThreads;
+		}
+	}
+
 	void SetMaxNumberOfThreads(unsigned int numThreads)
 	{
-		MAX_NUMBER_OF_THREADS = std::max(numThreads, 1u);
+		MaxNumberOfThreads() = std::max(numThreads, 1u);
+		ThreadPool::GetInstance().Resize(MaxNumberOfThreads() - 1);
 	}
 
 	unsigned int GetMaxNumberOfThreads()
 	{
-		return MAX_NUMBER_OF_THREADS;
+		return MaxNumberOfThreads();
 	}
 }
\ No newline at end of file
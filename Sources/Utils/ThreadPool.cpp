@@ -0,0 +1,272 @@
+/*************************************************************************
+> File Name: ThreadPool.cpp
+> Project Name: CubbyFlow
+> Author: Chan-Ho Chris Ohk
+> Purpose: Persistent work-stealing thread pool for CubbyFlow.
+> Created Time: 2018/01/06
+> Copyright (c) 2018, Chan-Ho Chris Ohk
+*************************************************************************/
+#include <Utils/Parallel.h>
+#include <Utils/ThreadPool.h>
+
+#include <limits>
+
+namespace CubbyFlow
+{
+	namespace
+	{
+		// Number of polling rounds before an idle worker goes to sleep.
+		constexpr int NUM_SPIN_ROUNDS = 64;
+
+		thread_local size_t workerQueueIndex = std::numeric_limits<size_t>::max();
+	}
+
+	ThreadPool& ThreadPool::GetInstance()
+	{
+		static ThreadPool instance;
+		return instance;
+	}
+
+	ThreadPool::ThreadPool()
+	{
+		const unsigned int numThreads = GetMaxNumberOfThreads();
+		StartWorkers(numThreads > 0 ? numThreads - 1 : 0);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		StopWorkers();
+	}
+
+	void ThreadPool::Resize(unsigned int numWorkers)
+	{
+		if (numWorkers == m_workers.size())
+		{
+			return;
+		}
+
+		StopWorkers();
+		StartWorkers(numWorkers);
+	}
+
+	unsigned int ThreadPool::NumberOfWorkers() const
+	{
+		return static_cast<unsigned int>(m_workers.size());
+	}
+
+	void ThreadPool::Run(TaskGroup& group, size_t numTasks)
+	{
+		if (numTasks == 0)
+		{
+			return;
+		}
+
+		// Nothing to share; run inline
+		if (m_workers.empty() || numTasks == 1)
+		{
+			for (size_t i = 0; i < numTasks; ++i)
+			{
+				group.Execute(i);
+			}
+
+			return;
+		}
+
+		group.m_numPendingTasks.store(numTasks);
+		group.m_hasException.store(false);
+		group.m_exception = nullptr;
+
+		const size_t queueIndex = CurrentQueueIndex();
+		WorkQueue& queue = *m_queues[queueIndex];
+
+		{
+			// Pushed in reverse so that the owner pops the tasks in order
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			for (size_t i = numTasks - 1; i > 0; --i)
+			{
+				queue.tasks.push_back(Task{ &group, i });
+			}
+		}
+
+		m_numQueuedTasks.fetch_add(numTasks - 1);
+		WakeWorkers();
+
+		ExecuteTask(Task{ &group, 0 });
+
+		// Help the others until the group is done
+		Task task{ nullptr, 0 };
+		while (group.m_numPendingTasks.load(std::memory_order_acquire) > 0)
+		{
+			if (TryPopOrSteal(queueIndex, &task))
+			{
+				ExecuteTask(task);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		if (group.m_hasException.load(std::memory_order_acquire))
+		{
+			std::rethrow_exception(group.m_exception);
+		}
+	}
+
+	void ThreadPool::StartWorkers(unsigned int numWorkers)
+	{
+		m_isStopping = false;
+
+		m_queues.clear();
+		for (unsigned int i = 0; i <= numWorkers; ++i)
+		{
+			m_queues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		m_workers.reserve(numWorkers);
+		for (unsigned int i = 0; i < numWorkers; ++i)
+		{
+			m_workers.emplace_back(&ThreadPool::WorkerLoop, this, static_cast<size_t>(i));
+		}
+	}
+
+	void ThreadPool::StopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_isStopping = true;
+		}
+
+		m_sleepCondition.notify_all();
+
+		for (std::thread& worker : m_workers)
+		{
+			if (worker.joinable())
+			{
+				worker.join();
+			}
+		}
+
+		m_workers.clear();
+	}
+
+	void ThreadPool::WorkerLoop(size_t queueIndex)
+	{
+		workerQueueIndex = queueIndex;
+
+		Task task{ nullptr, 0 };
+		while (true)
+		{
+			if (TryPopOrSteal(queueIndex, &task))
+			{
+				ExecuteTask(task);
+				continue;
+			}
+
+			// Parallel calls usually come in bursts, so poll a little before sleeping
+			bool hasWork = false;
+			for (int i = 0; i < NUM_SPIN_ROUNDS && !hasWork; ++i)
+			{
+				std::this_thread::yield();
+				hasWork = m_numQueuedTasks.load() > 0 || m_isStopping;
+			}
+
+			if (!hasWork)
+			{
+				std::unique_lock<std::mutex> lock(m_sleepMutex);
+				++m_numSleepingWorkers;
+				m_sleepCondition.wait(lock, [this]()
+				{
+					return m_isStopping || m_numQueuedTasks.load() > 0;
+				});
+				--m_numSleepingWorkers;
+			}
+
+			if (m_isStopping)
+			{
+				return;
+			}
+		}
+	}
+
+	size_t ThreadPool::CurrentQueueIndex() const
+	{
+		// Threads that are not workers of this pool share the last queue
+		if (workerQueueIndex < m_workers.size())
+		{
+			return workerQueueIndex;
+		}
+
+		return m_workers.size();
+	}
+
+	bool ThreadPool::TryPopOrSteal(size_t queueIndex, Task* task)
+	{
+		if (m_numQueuedTasks.load() == 0)
+		{
+			return false;
+		}
+
+		// Own queue first, newest task
+		{
+			WorkQueue& queue = *m_queues[queueIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				*task = queue.tasks.back();
+				queue.tasks.pop_back();
+				--m_numQueuedTasks;
+				return true;
+			}
+		}
+
+		// Steal the oldest task from the others
+		const size_t numQueues = m_queues.size();
+		for (size_t i = 1; i < numQueues; ++i)
+		{
+			WorkQueue& queue = *m_queues[(queueIndex + i) % numQueues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				*task = queue.tasks.front();
+				queue.tasks.pop_front();
+				--m_numQueuedTasks;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::WakeWorkers()
+	{
+		if (m_numSleepingWorkers.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_sleepCondition.notify_all();
+		}
+	}
+
+	void ThreadPool::ExecuteTask(const Task& task)
+	{
+		TaskGroup* group = task.group;
+
+		// An exception must not skip the count below, or the owner would wait
+		// forever; it is rethrown by the owner instead
+		try
+		{
+			group->Execute(task.index);
+		}
+		catch (...)
+		{
+			bool hasException = false;
+			if (group->m_hasException.compare_exchange_strong(hasException, true, std::memory_order_acq_rel))
+			{
+				group->m_exception = std::current_exception();
+			}
+		}
+
+		// The group may be destroyed by its owner right after this
+		group->m_numPendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "MemPerfTestsUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <Animation/Frame.h>
+#include <Solver/PCISPH/PCISPHSolver3.h>
+
+using namespace CubbyFlow;
+
+namespace
+{
+    void RunBlock(bool useNeighborLists)
+    {
+        const size_t n = 50;
+        const double spacing = 0.02;
+
+        const size_t mem0 = GetCurrentRSS();
+
+        auto solver = PCISPHSolver3::Builder()
+            .WithTargetDensity(1000.0)
+            .WithTargetSpacing(spacing)
+            .MakeShared();
+        solver->SetUseNeighborLists(useNeighborLists);
+
+        auto particles = solver->GetSPHSystemData();
+
+        SPHSystemData3::VectorData positions;
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    positions.Append(spacing * Vector3D(
+                        static_cast<double>(i),
+                        static_cast<double>(j),
+                        static_cast<double>(k)));
+                }
+            }
+        }
+        particles->AddParticles(positions);
+
+        const size_t mem1 = GetCurrentRSS();
+
+        const auto msg1 = MakeReadableByteSize(mem1 - mem0);
+
+        CUBBYFLOW_PRINT_INFO("Start mem. usage: %f %s.\n", msg1.first, msg1.second.c_str());
+
+        solver->Update(Frame(0, 0.01));
+
+        const size_t mem2 = GetCurrentRSS();
+
+        const auto msg2 = MakeReadableByteSize(mem2 - mem0);
+
+        CUBBYFLOW_PRINT_INFO("Single update mem. usage: %f %s.\n", msg2.first, msg2.second.c_str());
+
+        const auto msg3 = MakeReadableByteSize(
+            particles->NeighborLists().Indices().size() * sizeof(size_t));
+
+        CUBBYFLOW_PRINT_INFO("Neighbor lists: %f %s.\n", msg3.first, msg3.second.c_str());
+    }
+}
+
+// Runs first so that it does not benefit from the heap grown by the other test
+TEST(PCISPHSolver3, MemoryWithoutNeighborLists)
+{
+    RunBlock(false);
+}
+
+TEST(PCISPHSolver3, MemoryWithNeighborLists)
+{
+    RunBlock(true);
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "benchmark/benchmark.h"
+
+#include <Collider/RigidBodyCollider3.h>
+#include <Emitter/VolumeParticleEmitter3.h>
+#include <Geometry/Box3.h>
+#include <Geometry/Cylinder3.h>
+#include <Solver/DFSPH/DFSPHSolver3.h>
+#include <Solver/PCISPH/PCISPHSolver3.h>
+#include <Surface/Implicit/ImplicitSurfaceSet3.h>
+
+#include <memory>
+
+using CubbyFlow::BoundingBox3D;
+using CubbyFlow::Vector3D;
+
+namespace
+{
+    // Same scene as the dam-breaking example of SPHSim
+    void SetUpDamBreaking(CubbyFlow::SPHSolver3* solver, double targetSpacing)
+    {
+        using namespace CubbyFlow;
+
+        BoundingBox3D domain(Vector3D(), Vector3D(3, 2, 1.5));
+        const double lz = domain.Depth();
+
+        solver->SetPseudoViscosityCoefficient(0.0);
+
+        BoundingBox3D sourceBound(domain);
+        sourceBound.Expand(-targetSpacing);
+
+        const auto box1 = Box3::GetBuilder()
+            .WithLowerCorner({ 0, 0, 0 })
+            .WithUpperCorner({ 0.5 + 0.001, 0.75 + 0.001, 0.75 * lz + 0.001 })
+            .MakeShared();
+
+        const auto box2 = Box3::GetBuilder()
+            .WithLowerCorner({ 2.5 - 0.001, 0, 0.25 * lz - 0.001 })
+            .WithUpperCorner({ 3.5 + 0.001, 0.75 + 0.001, 1.5 * lz + 0.001 })
+            .MakeShared();
+
+        const auto boxSet = ImplicitSurfaceSet3::GetBuilder()
+            .WithExplicitSurfaces({ box1, box2 })
+            .MakeShared();
+
+        const auto emitter = VolumeParticleEmitter3::GetBuilder()
+            .WithSurface(boxSet)
+            .WithMaxRegion(sourceBound)
+            .WithSpacing(targetSpacing)
+            .MakeShared();
+
+        solver->SetEmitter(emitter);
+
+        const auto cyl1 = Cylinder3::GetBuilder()
+            .WithCenter({ 1, 0.375, 0.375 })
+            .WithRadius(0.1)
+            .WithHeight(0.75)
+            .MakeShared();
+
+        const auto cyl2 = Cylinder3::GetBuilder()
+            .WithCenter({ 1.5, 0.375, 0.75 })
+            .WithRadius(0.1)
+            .WithHeight(0.75)
+            .MakeShared();
+
+        const auto cyl3 = Cylinder3::GetBuilder()
+            .WithCenter({ 2, 0.375, 1.125 })
+            .WithRadius(0.1)
+            .WithHeight(0.75)
+            .MakeShared();
+
+        const auto box = Box3::GetBuilder()
+            .WithIsNormalFlipped(true)
+            .WithBoundingBox(domain)
+            .MakeShared();
+
+        const auto surfaceSet = ImplicitSurfaceSet3::GetBuilder()
+            .WithExplicitSurfaces({ cyl1, cyl2, cyl3, box })
+            .MakeShared();
+
+        const auto collider = RigidBodyCollider3::GetBuilder()
+            .WithSurface(surfaceSet)
+            .MakeShared();
+
+        solver->SetCollider(collider);
+    }
+}
+
+template <typename Solver>
+class DamBreaking : public ::benchmark::Fixture
+{
+protected:
+    std::shared_ptr<Solver> solver;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        // Target spacing is given in millimeters
+        const double targetSpacing = 0.001 * static_cast<double>(state.range(0));
+
+        solver = Solver::GetBuilder()
+            .WithTargetDensity(1000.0)
+            .WithTargetSpacing(targetSpacing)
+            .MakeShared();
+
+        SetUpDamBreaking(solver.get(), targetSpacing);
+    }
+
+    void RunFrames(benchmark::State& state)
+    {
+        while (state.KeepRunning())
+        {
+            for (CubbyFlow::Frame frame(0, 1.0 / 60.0); frame.index < 100; ++frame)
+            {
+                solver->Update(frame);
+            }
+        }
+
+        state.counters["Particles"] = static_cast<double>(solver->GetSPHSystemData()->NumberOfParticles());
+    }
+};
+
+BENCHMARK_TEMPLATE_DEFINE_F(DamBreaking, PCISPHSolver3, CubbyFlow::PCISPHSolver3)(benchmark::State& state)
+{
+    // Same as the dam-breaking example of SPHSim
+    solver->SetTimeStepLimitScale(10.0);
+
+    RunFrames(state);
+}
+
+BENCHMARK_REGISTER_F(DamBreaking, PCISPHSolver3)
+->Arg(50)
+->Arg(30)
+->Iterations(1)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+BENCHMARK_TEMPLATE_DEFINE_F(DamBreaking, DFSPHSolver3, CubbyFlow::DFSPHSolver3)(benchmark::State& state)
+{
+    RunFrames(state);
+}
+
+BENCHMARK_REGISTER_F(DamBreaking, DFSPHSolver3)
+->Arg(50)
+->Arg(30)
+->Iterations(1)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "benchmark/benchmark.h"
+
+#include <Solver/FDM/FDMCGSolver3.h>
+#include <Utils/Parallel.h>
+
+using CubbyFlow::CGMethod;
+using CubbyFlow::FDMLinearSystem3;
+
+class FDMCGSolver3 : public ::benchmark::Fixture
+{
+public:
+    FDMLinearSystem3 system;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto dim = static_cast<size_t>(state.range(0));
+
+        // Poisson equation with Dirichlet boundaries
+        system.A.Resize(dim, dim, dim);
+        system.x.Resize(dim, dim, dim);
+        system.b.Resize(dim, dim, dim);
+
+        system.A.ForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            system.A(i, j, k).center = 6.0;
+            system.A(i, j, k).right = (i + 1 < dim) ? -1.0 : 0.0;
+            system.A(i, j, k).up = (j + 1 < dim) ? -1.0 : 0.0;
+            system.A(i, j, k).front = (k + 1 < dim) ? -1.0 : 0.0;
+            system.b(i, j, k) = (j == 0) ? 1.0 : 0.0;
+        });
+    }
+
+    // Bytes read and written per grid point in one iteration, with 32 bytes
+    // per matrix row and 8 bytes per vector element.
+    static double BytesPerPoint(CGMethod method)
+    {
+        switch (method)
+        {
+        case CGMethod::Fused:
+            // MVMDot (A, d, q), CGUpdate (d, q, x, r, x, r), AXPlusY (r, d, d)
+            return 48.0 + 48.0 + 24.0;
+        case CGMethod::Pipelined:
+            // Set (m), pre-conditioner copy (w, m), MVM (A, m, n),
+            // PipelinedCGUpdate (10 reads, 8 writes)
+            return 8.0 + 16.0 + 48.0 + 144.0;
+        default:
+            // MVM (A, d, q), Dot (d, q), AXPlusY (d, x, x), AXPlusY (q, r, r),
+            // pre-conditioner copy (r, s), Dot (r, s), AXPlusY (d, s, d)
+            return 48.0 + 16.0 + 24.0 + 24.0 + 16.0 + 16.0 + 24.0;
+        }
+    }
+
+    void Solve(benchmark::State& state, CGMethod method)
+    {
+        const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+        CubbyFlow::SetMaxNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+
+        CubbyFlow::FDMCGSolver3 solver(1000, 1e-6);
+        solver.SetCGMethod(method);
+
+        int64_t numIterations = 0;
+        while (state.KeepRunning())
+        {
+            solver.Solve(&system);
+            numIterations += solver.GetLastNumberOfIterations();
+        }
+
+        const double bytesPerIteration = BytesPerPoint(method) * static_cast<double>(system.x.size().x * system.x.size().y * system.x.size().z);
+
+        state.SetBytesProcessed(static_cast<int64_t>(bytesPerIteration * static_cast<double>(numIterations)));
+        state.counters["Iterations"] = solver.GetLastNumberOfIterations();
+        state.counters["BytesPerIteration"] = bytesPerIteration;
+
+        CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+    }
+};
+
+BENCHMARK_DEFINE_F(FDMCGSolver3, Solve)(benchmark::State& state)
+{
+    Solve(state, CGMethod::Standard);
+}
+
+BENCHMARK_REGISTER_F(FDMCGSolver3, Solve)->Args({ 1 << 6, 1 })->Args({ 1 << 6, 8 })->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FDMCGSolver3, SolveFused)(benchmark::State& state)
+{
+    Solve(state, CGMethod::Fused);
+}
+
+BENCHMARK_REGISTER_F(FDMCGSolver3, SolveFused)->Args({ 1 << 6, 1 })->Args({ 1 << 6, 8 })->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FDMCGSolver3, SolvePipelined)(benchmark::State& state)
+{
+    Solve(state, CGMethod::Pipelined);
+}
+
+BENCHMARK_REGISTER_F(FDMCGSolver3, SolvePipelined)->Args({ 1 << 6, 1 })->Args({ 1 << 6, 8 })->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Unit(benchmark::kMillisecond);
\ No newline at end of file
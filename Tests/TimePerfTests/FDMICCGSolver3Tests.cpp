@@ -0,0 +1,63 @@
+#include "benchmark/benchmark.h"
+
+#include <Solver/FDM/FDMICCGSolver3.h>
+#include <Utils/Parallel.h>
+
+using CubbyFlow::FDMLinearSystem3;
+
+class FDMICCGSolver3 : public ::benchmark::Fixture
+{
+public:
+    FDMLinearSystem3 system;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto dim = static_cast<size_t>(state.range(0));
+
+        // Poisson equation with Dirichlet boundaries
+        system.A.Resize(dim, dim, dim);
+        system.x.Resize(dim, dim, dim);
+        system.b.Resize(dim, dim, dim);
+
+        system.A.ForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            system.A(i, j, k).center = 6.0;
+            system.A(i, j, k).right = (i + 1 < dim) ? -1.0 : 0.0;
+            system.A(i, j, k).up = (j + 1 < dim) ? -1.0 : 0.0;
+            system.A(i, j, k).front = (k + 1 < dim) ? -1.0 : 0.0;
+            system.b(i, j, k) = (j == 0) ? 1.0 : 0.0;
+        });
+    }
+
+    void Solve(benchmark::State& state, bool useMulticolorPreconditioner)
+    {
+        const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+        CubbyFlow::SetMaxNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+
+        CubbyFlow::FDMICCGSolver3 solver(1000, 1e-6);
+        solver.SetUseMulticolorPreconditioner(useMulticolorPreconditioner);
+
+        while (state.KeepRunning())
+        {
+            solver.Solve(&system);
+        }
+
+        state.counters["Iterations"] = solver.GetLastNumberOfIterations();
+
+        CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+    }
+};
+
+BENCHMARK_DEFINE_F(FDMICCGSolver3, Solve)(benchmark::State& state)
+{
+    Solve(state, false);
+}
+
+BENCHMARK_REGISTER_F(FDMICCGSolver3, Solve)->Args({ 1 << 6, 1 })->Args({ 1 << 6, 8 })->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FDMICCGSolver3, SolveMulticolor)(benchmark::State& state)
+{
+    Solve(state, true);
+}
+
+BENCHMARK_REGISTER_F(FDMICCGSolver3, SolveMulticolor)->Args({ 1 << 6, 1 })->Args({ 1 << 6, 8 })->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Unit(benchmark::kMillisecond);
\ No newline at end of file
@@ -13,6 +13,7 @@ using CubbyFlow::FDMVector2;
 using CubbyFlow::FDMMatrix3;
 using CubbyFlow::FDMVector3;
 using CubbyFlow::FDMCompressedLinearSystem3;
+using CubbyFlow::FDMMatrixFree3;
 using CubbyFlow::Size3;
 
 class FDMBLAS2 : public ::benchmark::Fixture
@@ -72,6 +73,52 @@ public:
     }
 };
 
+class FDMMatrixFreeBLAS3 : public ::benchmark::Fixture
+{
+public:
+    FDMMatrix3 m;
+    FDMMatrixFree3 mf;
+    FDMVector3 a;
+    FDMVector3 b;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto dim = static_cast<size_t>(state.range(0));
+
+        m.Resize(dim, dim, dim);
+        mf.markers.Resize(dim, dim, dim);
+        mf.invHSqr = CubbyFlow::Vector3D(1.0, 1.0, 1.0);
+        a.Resize(dim, dim, dim);
+        b.Resize(dim, dim, dim);
+
+        std::mt19937 rng;
+        std::uniform_real_distribution<> d(0.0, 1.0);
+
+        // Pool of fluid with a solid floor and air above
+        mf.markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            if (j == 0)
+            {
+                mf.markers(i, j, k) = FDMMatrixFree3::BOUNDARY;
+            }
+            else if (j > dim * 3 / 4)
+            {
+                mf.markers(i, j, k) = FDMMatrixFree3::AIR;
+            }
+            else
+            {
+                mf.markers(i, j, k) = FDMMatrixFree3::FLUID;
+            }
+
+            m(i, j, k).center = 6.0;
+            m(i, j, k).right = -1.0;
+            m(i, j, k).up = -1.0;
+            m(i, j, k).front = -1.0;
+            a(i, j, k) = d(rng);
+        });
+    }
+};
+
 class FDMCompressedBLAS3 : public ::benchmark::Fixture
 {
 public:
@@ -192,6 +239,63 @@ BENCHMARK_DEFINE_F(FDMBLAS3, MVM)(benchmark::State& state)
 
 BENCHMARK_REGISTER_F(FDMBLAS3, MVM)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
 
+BENCHMARK_DEFINE_F(FDMBLAS3, ResidualSlab)(benchmark::State& state)
+{
+    // Per-point residual in z-slabs, the order before the tiled traversal
+    const Size3 size = m.size();
+    FDMVector3 r(size);
+
+    while (state.KeepRunning())
+    {
+        m.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            r(i, j, k) =
+                b(i, j, k) -
+                m(i, j, k).center * a(i, j, k) -
+                ((i > 0) ? m(i - 1, j, k).right * a(i - 1, j, k) : 0.0) -
+                ((i + 1 < size.x) ? m(i, j, k).right * a(i + 1, j, k) : 0.0) -
+                ((j > 0) ? m(i, j - 1, k).up * a(i, j - 1, k) : 0.0) -
+                ((j + 1 < size.y) ? m(i, j, k).up * a(i, j + 1, k) : 0.0) -
+                ((k > 0) ? m(i, j, k - 1).front * a(i, j, k - 1) : 0.0) -
+                ((k + 1 < size.z) ? m(i, j, k).front * a(i, j, k + 1) : 0.0);
+        });
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMBLAS3, ResidualSlab)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMBLAS3, Residual)(benchmark::State& state)
+{
+    FDMVector3 r(m.size());
+
+    while (state.KeepRunning())
+    {
+        CubbyFlow::FDMBLAS3::Residual(m, a, b, &r);
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMBLAS3, Residual)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMMatrixFreeBLAS3, StoredMVM)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        CubbyFlow::FDMBLAS3::MVM(m, a, &b);
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMMatrixFreeBLAS3, StoredMVM)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMMatrixFreeBLAS3, MVM)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        CubbyFlow::FDMMatrixFreeBLAS3::MVM(mf, a, &b);
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMMatrixFreeBLAS3, MVM)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
 BENCHMARK_DEFINE_F(FDMCompressedBLAS3, MVM)(benchmark::State& state)
 {
     while (state.KeepRunning())
@@ -200,4 +304,59 @@ BENCHMARK_DEFINE_F(FDMCompressedBLAS3, MVM)(benchmark::State& state)
     }
 }
 
-BENCHMARK_REGISTER_F(FDMCompressedBLAS3, MVM)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
\ No newline at end of file
+BENCHMARK_REGISTER_F(FDMCompressedBLAS3, MVM)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMBLAS3, Dot)(benchmark::State& state)
+{
+    double sum = 0.0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(sum += CubbyFlow::FDMBLAS3::Dot(a, a));
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMBLAS3, Dot)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMBLAS3, L2Norm)(benchmark::State& state)
+{
+    double sum = 0.0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(sum += CubbyFlow::FDMBLAS3::L2Norm(a));
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMBLAS3, L2Norm)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMBLAS3, LInfNorm)(benchmark::State& state)
+{
+    double sum = 0.0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(sum += CubbyFlow::FDMBLAS3::LInfNorm(a));
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMBLAS3, LInfNorm)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMCompressedBLAS3, Dot)(benchmark::State& state)
+{
+    double sum = 0.0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(sum += CubbyFlow::FDMCompressedBLAS3::Dot(system.b, system.b));
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMCompressedBLAS3, Dot)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
+
+BENCHMARK_DEFINE_F(FDMCompressedBLAS3, LInfNorm)(benchmark::State& state)
+{
+    double sum = 0.0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(sum += CubbyFlow::FDMCompressedBLAS3::LInfNorm(system.b));
+    }
+}
+
+BENCHMARK_REGISTER_F(FDMCompressedBLAS3, LInfNorm)->Arg(1 << 4)->Arg(1 << 6)->Arg(1 << 8);
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "benchmark/benchmark.h"
+
+#include <Array/Array1.h>
+#include <Solver/APIC/APICSolver3.h>
+#include <Solver/FLIP/FLIPSolver3.h>
+#include <Utils/Parallel.h>
+
+#include <random>
+
+using CubbyFlow::Array1;
+using CubbyFlow::Vector3D;
+
+namespace
+{
+    template <typename Solver>
+    class TransferBenchmarkSolver : public Solver
+    {
+    public:
+        TransferBenchmarkSolver() :
+            Solver({ 128, 128, 128 }, { 1.0 / 128.0, 1.0 / 128.0, 1.0 / 128.0 }, { 0, 0, 0 })
+        {
+            // Do nothing
+        }
+
+        using Solver::TransferFromParticlesToGrids;
+    };
+}
+
+template <typename Solver>
+class ParticleToGridTransfer : public ::benchmark::Fixture
+{
+protected:
+    std::mt19937 rng{ 0 };
+    std::uniform_real_distribution<> dist{ 0.0, 1.0 };
+    TransferBenchmarkSolver<Solver> solver;
+    unsigned int numThreads = 1;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const size_t n = static_cast<size_t>(state.range(0));
+        numThreads = static_cast<unsigned int>(state.range(1));
+
+        // Half-filled tank, like a typical hybrid liquid scene
+        Array1<Vector3D> positions(n);
+        Array1<Vector3D> velocities(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            positions[i] = Vector3D(dist(rng), 0.5 * dist(rng), dist(rng));
+            velocities[i] = Vector3D(dist(rng), dist(rng), dist(rng));
+        }
+
+        auto particles = solver.GetParticleSystemData();
+        particles->Resize(0);
+        particles->AddParticles(positions, velocities);
+    }
+};
+
+BENCHMARK_TEMPLATE_DEFINE_F(ParticleToGridTransfer, FLIPSolver3, CubbyFlow::FLIPSolver3)(benchmark::State& state)
+{
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(numThreads);
+
+    while (state.KeepRunning())
+    {
+        solver.TransferFromParticlesToGrids();
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(ParticleToGridTransfer, FLIPSolver3)
+->Unit(benchmark::kMillisecond)
+->UseRealTime()
+->Args({ 1 << 20, 1 })
+->Args({ 1 << 20, 2 })
+->Args({ 1 << 20, 4 })
+->Args({ 1 << 20, 8 })
+->Args({ 1 << 22, 1 })
+->Args({ 1 << 22, 2 })
+->Args({ 1 << 22, 4 })
+->Args({ 1 << 22, 8 });
+
+BENCHMARK_TEMPLATE_DEFINE_F(ParticleToGridTransfer, APICSolver3, CubbyFlow::APICSolver3)(benchmark::State& state)
+{
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(numThreads);
+
+    while (state.KeepRunning())
+    {
+        solver.TransferFromParticlesToGrids();
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(ParticleToGridTransfer, APICSolver3)
+->Unit(benchmark::kMillisecond)
+->UseRealTime()
+->Args({ 1 << 20, 1 })
+->Args({ 1 << 20, 2 })
+->Args({ 1 << 20, 4 })
+->Args({ 1 << 20, 8 })
+->Args({ 1 << 22, 1 })
+->Args({ 1 << 22, 2 })
+->Args({ 1 << 22, 4 })
+->Args({ 1 << 22, 8 });
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "benchmark/benchmark.h"
+
+#include <Array/Array1.h>
+#include <Grid/FaceCenteredGrid3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using CubbyFlow::Array1;
+using CubbyFlow::Vector3D;
+
+class FaceCenteredGrid3 : public ::benchmark::Fixture
+{
+public:
+    CubbyFlow::FaceCenteredGrid3 grid;
+    Array1<Vector3D> points;
+    Array1<Vector3D> values;
+
+    // Samples 1M points in a 128^3 velocity grid. The first argument selects
+    // the order of the points: 0 for random order, 1 for the points sorted by
+    // the cell which contains them.
+    void SetUp(const ::benchmark::State& state)
+    {
+        const size_t n = 128;
+        const double h = 1.0 / n;
+
+        grid.Resize(n, n, n, h, h, h);
+        grid.Fill([](const Vector3D& x)
+        {
+            return Vector3D(std::sin(3.0 * x.y), std::cos(2.0 * x.z), x.x * x.y);
+        });
+
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<> dist(0.0, 1.0);
+
+        std::vector<Vector3D> pts(1 << 20);
+        for (auto& pt : pts)
+        {
+            pt = Vector3D(dist(rng), dist(rng), dist(rng));
+        }
+
+        if (state.range(0) == 1)
+        {
+            const auto cell = [&](const Vector3D& pt)
+            {
+                const auto i = static_cast<size_t>(pt.x / h);
+                const auto j = static_cast<size_t>(pt.y / h);
+                const auto k = static_cast<size_t>(pt.z / h);
+
+                return i + n * (j + n * k);
+            };
+
+            std::sort(pts.begin(), pts.end(), [&](const Vector3D& a, const Vector3D& b)
+            {
+                return cell(a) < cell(b);
+            });
+        }
+
+        points.Resize(pts.size());
+        std::copy(pts.begin(), pts.end(), points.begin());
+        values.Resize(pts.size());
+    }
+};
+
+BENCHMARK_DEFINE_F(FaceCenteredGrid3, Sample)(benchmark::State& state)
+{
+    const auto sampler = grid.LinearSampler();
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            values[i] = sampler(points[i]);
+        }
+
+        benchmark::DoNotOptimize(values.data());
+    }
+}
+
+BENCHMARK_REGISTER_F(FaceCenteredGrid3, Sample)
+->Arg(0)
+->Arg(1)
+->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FaceCenteredGrid3, SampleBatch)(benchmark::State& state)
+{
+    const auto sampler = grid.LinearSampler();
+
+    while (state.KeepRunning())
+    {
+        sampler(points.ConstAccessor(), values.Accessor());
+
+        benchmark::DoNotOptimize(values.data());
+    }
+}
+
+BENCHMARK_REGISTER_F(FaceCenteredGrid3, SampleBatch)
+->Arg(0)
+->Arg(1)
+->Unit(benchmark::kMillisecond);
\ No newline at end of file
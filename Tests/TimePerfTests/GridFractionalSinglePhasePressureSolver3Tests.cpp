@@ -4,6 +4,8 @@
 #include <Field/ConstantVectorField3.h>
 #include <Grid/CellCenteredScalarGrid3.h>
 #include <Grid/FaceCenteredGrid3.h>
+#include <Solver/FDM/FDMAMGPCGSolver3.h>
+#include <Solver/FDM/FDMICCGSolver3.h>
 #include <Solver/Grid/GridFractionalSinglePhasePressureSolver3.h>
 #include <Vector/Vector3.h>
 
@@ -12,6 +14,8 @@ using CubbyFlow::FaceCenteredGrid3;
 using CubbyFlow::CellCenteredScalarGrid3;
 using CubbyFlow::ConstantScalarField3;
 using CubbyFlow::ConstantVectorField3;
+using CubbyFlow::FDMAMGPCGSolver3;
+using CubbyFlow::FDMICCGSolver3;
 
 class GridFractionalSinglePhasePressureSolver3 : public ::benchmark::Fixture
 {
@@ -72,4 +76,44 @@ BENCHMARK_REGISTER_F(GridFractionalSinglePhasePressureSolver3, Solve)
 ->Args({ 128, 64, 0 })
 ->Args({ 128, 64, 1 })
 ->Args({ 128, 32, 0 })
-->Args({ 128, 32, 1 });
\ No newline at end of file
+->Args({ 128, 32, 1 });
+
+BENCHMARK_DEFINE_F(GridFractionalSinglePhasePressureSolver3, SolveCompressedICCG)(benchmark::State& state)
+{
+    const auto iccg = std::make_shared<FDMICCGSolver3>(1000, 1e-6);
+    solver.SetLinearSystemSolver(iccg);
+
+    while (state.KeepRunning())
+    {
+        solver.Solve(vel, 1.0, &vel,
+            ConstantScalarField3(std::numeric_limits<double>::max()),
+            ConstantVectorField3({ 0, 0, 0 }),
+            fluidSDF, true);
+    }
+
+    state.counters["Iterations"] = iccg->GetLastNumberOfIterations();
+}
+
+BENCHMARK_REGISTER_F(GridFractionalSinglePhasePressureSolver3, SolveCompressedICCG)
+->Args({ 64, 48 })
+->Args({ 128, 96 });
+
+BENCHMARK_DEFINE_F(GridFractionalSinglePhasePressureSolver3, SolveCompressedAMGPCG)(benchmark::State& state)
+{
+    const auto amg = std::make_shared<FDMAMGPCGSolver3>(1000, 1e-6);
+    solver.SetLinearSystemSolver(amg);
+
+    while (state.KeepRunning())
+    {
+        solver.Solve(vel, 1.0, &vel,
+            ConstantScalarField3(std::numeric_limits<double>::max()),
+            ConstantVectorField3({ 0, 0, 0 }),
+            fluidSDF, true);
+    }
+
+    state.counters["Iterations"] = amg->GetLastNumberOfIterations();
+}
+
+BENCHMARK_REGISTER_F(GridFractionalSinglePhasePressureSolver3, SolveCompressedAMGPCG)
+->Args({ 64, 48 })
+->Args({ 128, 96 });
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "benchmark/benchmark.h"
+
+#include <Field/ConstantVectorField3.h>
+#include <Grid/CellCenteredScalarGrid3.h>
+#include <LevelSet/NarrowBand3.h>
+#include <SemiLagrangian/CubicSemiLagrangian3.h>
+#include <Solver/LevelSet/ENOLevelSetSolver3.h>
+#include <Solver/LevelSet/FIMLevelSetSolver3.h>
+#include <Solver/LevelSet/FMMLevelSetSolver3.h>
+#include <Utils/Parallel.h>
+
+using CubbyFlow::CellCenteredScalarGrid3;
+using CubbyFlow::NarrowBand3;
+using CubbyFlow::Vector3D;
+
+class LevelSetSolver3 : public ::benchmark::Fixture
+{
+public:
+    // Narrow band width and reinitialization distance in number of cells
+    static constexpr double BAND_WIDTH = 5.0;
+
+    CellCenteredScalarGrid3 sdf;
+    CellCenteredScalarGrid3 output;
+    NarrowBand3 band;
+    double h = 0.0;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+        h = 1.0 / static_cast<double>(n);
+
+        sdf.Resize(n, n, n, h, h, h);
+        sdf.Fill([](const Vector3D& x)
+        {
+            return (x - Vector3D(0.5, 0.45, 0.55)).Length() - 0.3;
+        });
+
+        band.Build(sdf.GetDataAccessor(), BAND_WIDTH * h);
+
+        output = sdf;
+    }
+};
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, FMMReinitialize)(benchmark::State& state)
+{
+    CubbyFlow::FMMLevelSetSolver3 solver;
+
+    while (state.KeepRunning())
+    {
+        solver.Reinitialize(sdf, BAND_WIDTH * h, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, FMMReinitialize)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, FMMReinitializeNarrowBand)(benchmark::State& state)
+{
+    CubbyFlow::FMMLevelSetSolver3 solver;
+
+    while (state.KeepRunning())
+    {
+        solver.ReinitializeNarrowBand(sdf, band, BAND_WIDTH * h, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, FMMReinitializeNarrowBand)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, FIMReinitialize)(benchmark::State& state)
+{
+    CubbyFlow::FIMLevelSetSolver3 solver;
+
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+
+    while (state.KeepRunning())
+    {
+        solver.Reinitialize(sdf, BAND_WIDTH * h, &output);
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, FIMReinitialize)
+    ->Args({ 1 << 7, 1 })->Args({ 1 << 7, 2 })->Args({ 1 << 7, 4 })->Args({ 1 << 7, 8 })
+    ->Args({ 1 << 8, 1 })->Args({ 1 << 8, 8 })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, ENOReinitialize)(benchmark::State& state)
+{
+    CubbyFlow::ENOLevelSetSolver3 solver;
+
+    while (state.KeepRunning())
+    {
+        solver.Reinitialize(sdf, BAND_WIDTH * h, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, ENOReinitialize)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, ENOReinitializeNarrowBand)(benchmark::State& state)
+{
+    CubbyFlow::ENOLevelSetSolver3 solver;
+
+    while (state.KeepRunning())
+    {
+        solver.ReinitializeNarrowBand(sdf, band, BAND_WIDTH * h, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, ENOReinitializeNarrowBand)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, Advect)(benchmark::State& state)
+{
+    CubbyFlow::CubicSemiLagrangian3 solver;
+    CubbyFlow::ConstantVectorField3 flow(Vector3D(0.3, -0.5, 0.2));
+
+    while (state.KeepRunning())
+    {
+        solver.Advect(sdf, flow, 2.0 * h, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, Advect)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(LevelSetSolver3, AdvectNarrowBand)(benchmark::State& state)
+{
+    CubbyFlow::CubicSemiLagrangian3 solver;
+    CubbyFlow::ConstantVectorField3 flow(Vector3D(0.3, -0.5, 0.2));
+
+    while (state.KeepRunning())
+    {
+        solver.AdvectNarrowBand(sdf, flow, 2.0 * h, band, &output);
+    }
+}
+
+BENCHMARK_REGISTER_F(LevelSetSolver3, AdvectNarrowBand)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
\ No newline at end of file
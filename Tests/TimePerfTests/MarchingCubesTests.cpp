@@ -0,0 +1,60 @@
+#include "benchmark/benchmark.h"
+
+#include <Array/Array3.h>
+#include <MarchingCubes/MarchingCubes.h>
+#include <Utils/Parallel.h>
+
+#include <cmath>
+
+using CubbyFlow::Vector3D;
+
+class MarchingCubes : public ::benchmark::Fixture
+{
+public:
+    CubbyFlow::Array3<double> grid;
+    double h = 0.0;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+        h = 1.0 / static_cast<double>(n);
+
+        // Wavy sphere to have a large surface
+        grid.Resize(n, n, n);
+        grid.ParallelForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            const Vector3D x = h * Vector3D(i, j, k);
+            const Vector3D r = x - Vector3D(0.5, 0.45, 0.55);
+            grid(i, j, k) = r.Length() - 0.3 - 0.05 * std::sin(20.0 * x.x) * std::sin(20.0 * x.y) * std::sin(20.0 * x.z);
+        });
+    }
+};
+
+BENCHMARK_DEFINE_F(MarchingCubes, Serial)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        CubbyFlow::TriangleMesh3 mesh;
+        CubbyFlow::MarchingCubes(grid.ConstAccessor(), Vector3D(h, h, h), Vector3D(), &mesh, 0.0, CubbyFlow::DIRECTION_ALL, CubbyFlow::ExecutionPolicy::Serial);
+        benchmark::DoNotOptimize(mesh.NumberOfTriangles());
+    }
+}
+
+BENCHMARK_REGISTER_F(MarchingCubes, Serial)->Arg(1 << 7)->Arg(1 << 8)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(MarchingCubes, Parallel)(benchmark::State& state)
+{
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+
+    while (state.KeepRunning())
+    {
+        CubbyFlow::TriangleMesh3 mesh;
+        CubbyFlow::MarchingCubes(grid.ConstAccessor(), Vector3D(h, h, h), Vector3D(), &mesh, 0.0, CubbyFlow::DIRECTION_ALL, CubbyFlow::ExecutionPolicy::Parallel);
+        benchmark::DoNotOptimize(mesh.NumberOfTriangles());
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(MarchingCubes, Parallel)->Args({ 1 << 7, 1 })->Args({ 1 << 7, 8 })->Args({ 1 << 8, 1 })->Args({ 1 << 8, 8 })->Unit(benchmark::kMillisecond);
\ No newline at end of file
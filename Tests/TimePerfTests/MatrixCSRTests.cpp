@@ -0,0 +1,119 @@
+#include "benchmark/benchmark.h"
+
+#include <Matrix/MatrixCSR.h>
+#include <Vector/VectorN.h>
+
+#include <vector>
+
+using CubbyFlow::MatrixCSRD;
+using CubbyFlow::VectorND;
+
+class MatrixCSR : public ::benchmark::Fixture
+{
+public:
+    MatrixCSRD mat;
+    VectorND x;
+    VectorND y;
+
+    // Builds the compressed pressure matrix of a pool filled up to 3/4 of the
+    // domain height with a solid sphere in the middle, so the rows have from
+    // one to seven non-zeros.
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+        const double radius = 0.25 * static_cast<double>(n);
+        const double center = 0.5 * static_cast<double>(n);
+
+        const auto isFluid = [&](size_t i, size_t j, size_t k)
+        {
+            const double dx = i + 0.5 - center;
+            const double dy = j + 0.5 - center;
+            const double dz = k + 0.5 - center;
+
+            return 4 * j < 3 * n && dx * dx + dy * dy + dz * dz > radius * radius;
+        };
+
+        std::vector<size_t> coordToIndex(n * n * n, 0);
+        std::vector<size_t> rowToCoord;
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (isFluid(i, j, k))
+                    {
+                        coordToIndex[i + n * (j + n * k)] = rowToCoord.size();
+                        rowToCoord.push_back(i + n * (j + n * k));
+                    }
+                }
+            }
+        }
+
+        const size_t numRows = rowToCoord.size();
+
+        // Neighbors in the ascending order of the column indices
+        const auto forEachNeighbor = [&](size_t row, const auto& func)
+        {
+            const size_t idx = rowToCoord[row];
+            const size_t i = idx % n;
+            const size_t j = (idx / n) % n;
+            const size_t k = idx / (n * n);
+
+            if (k > 0 && isFluid(i, j, k - 1)) { func(idx - n * n); }
+            if (j > 0 && isFluid(i, j - 1, k)) { func(idx - n); }
+            if (i > 0 && isFluid(i - 1, j, k)) { func(idx - 1); }
+            func(idx);
+            if (i + 1 < n && isFluid(i + 1, j, k)) { func(idx + 1); }
+            if (j + 1 < n && isFluid(i, j + 1, k)) { func(idx + n); }
+            if (k + 1 < n && isFluid(i, j, k + 1)) { func(idx + n * n); }
+        };
+
+        mat.ParallelBuild(numRows, numRows, [&](size_t row)
+        {
+            size_t count = 0;
+            forEachNeighbor(row, [&](size_t) { ++count; });
+            return count;
+        }, [&](size_t row, double* nonZeros, size_t* columnIndices)
+        {
+            size_t count = 0;
+            forEachNeighbor(row, [&](size_t idx)
+            {
+                nonZeros[count] = (idx == rowToCoord[row]) ? 6.0 : -1.0;
+                columnIndices[count] = coordToIndex[idx];
+                ++count;
+            });
+        });
+
+        x.Resize(numRows, 1.0);
+        y.Resize(numRows, 0.0);
+    }
+};
+
+BENCHMARK_DEFINE_F(MatrixCSR, MVMExpression)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        y = mat * x;
+    }
+
+    state.counters["NonZeros"] = static_cast<double>(mat.NumberOfNonZeros());
+}
+
+BENCHMARK_REGISTER_F(MatrixCSR, MVMExpression)
+->Arg(64)
+->Arg(128);
+
+BENCHMARK_DEFINE_F(MatrixCSR, MVM)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        mat.MVM(x, &y);
+    }
+
+    state.counters["NonZeros"] = static_cast<double>(mat.NumberOfNonZeros());
+}
+
+BENCHMARK_REGISTER_F(MatrixCSR, MVM)
+->Arg(64)
+->Arg(128);
\ No newline at end of file
@@ -4,6 +4,44 @@
 #include <Utils/Parallel.h>
 
 #include <random>
+#include <thread>
+
+namespace
+{
+    // The spawn-per-call loop that ParallelRangeFor used before the thread
+    // pool, kept here as the baseline.
+    template <typename Function>
+    void SpawnPerCallParallelRangeFor(size_t beginIndex, size_t endIndex, const Function& function)
+    {
+        const unsigned int numThreads = CubbyFlow::GetMaxNumberOfThreads();
+
+        size_t n = endIndex - beginIndex + 1;
+        size_t slice = static_cast<size_t>(std::round(n / static_cast<double>(numThreads)));
+        slice = std::max(slice, size_t(1));
+
+        std::vector<std::thread> pool;
+        pool.reserve(numThreads);
+        size_t i1 = beginIndex;
+        size_t i2 = std::min(beginIndex + slice, endIndex);
+
+        for (unsigned int i = 0; i + 1 < numThreads && i1 < endIndex; ++i)
+        {
+            pool.emplace_back(function, i1, i2);
+            i1 = i2;
+            i2 = std::min(i2 + slice, endIndex);
+        }
+
+        if (i1 < endIndex)
+        {
+            pool.emplace_back(function, i1, endIndex);
+        }
+
+        for (std::thread& t : pool)
+        {
+            t.join();
+        }
+    }
+}
 
 class Parallel : public ::benchmark::Fixture
 {
@@ -89,4 +127,69 @@ BENCHMARK_REGISTER_F(Parallel, ParallelRangeFor)
 ->Args({ 1 << 24, 1 })
 ->Args({ 1 << 24, 2 })
 ->Args({ 1 << 24, 4 })
+->Args({ 1 << 24, 8 });
+
+BENCHMARK_DEFINE_F(Parallel, SpawnPerCallParallelRangeFor)(benchmark::State& state)
+{
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(numThreads);
+
+    while (state.KeepRunning())
+    {
+        SpawnPerCallParallelRangeFor(CubbyFlow::ZERO_SIZE, n,
+            [this](size_t iBegin, size_t iEnd)
+        {
+            for (size_t i = iBegin; i < iEnd; ++i)
+            {
+                c[i] = 1.0 / std::sqrt(a[i] / b[i] + 1.0);
+            }
+        });
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(Parallel, SpawnPerCallParallelRangeFor)
+->UseRealTime()
+->Args({ 1 << 8, 1 })
+->Args({ 1 << 8, 2 })
+->Args({ 1 << 8, 4 })
+->Args({ 1 << 8, 8 })
+->Args({ 1 << 16, 1 })
+->Args({ 1 << 16, 2 })
+->Args({ 1 << 16, 4 })
+->Args({ 1 << 16, 8 })
+->Args({ 1 << 24, 1 })
+->Args({ 1 << 24, 2 })
+->Args({ 1 << 24, 4 })
+->Args({ 1 << 24, 8 });
+
+BENCHMARK_DEFINE_F(Parallel, NestedParallelFor)(benchmark::State& state)
+{
+    const unsigned int oldNumThreads = CubbyFlow::GetMaxNumberOfThreads();
+    CubbyFlow::SetMaxNumberOfThreads(numThreads);
+
+    const size_t numOuter = 64;
+    const size_t numInner = n / numOuter;
+
+    while (state.KeepRunning())
+    {
+        CubbyFlow::ParallelFor(CubbyFlow::ZERO_SIZE, numOuter, [&](size_t j)
+        {
+            CubbyFlow::ParallelFor(CubbyFlow::ZERO_SIZE, numInner, [&](size_t i)
+            {
+                const size_t idx = i + j * numInner;
+                c[idx] = 1.0 / std::sqrt(a[idx] / b[idx] + 1.0);
+            });
+        });
+    }
+
+    CubbyFlow::SetMaxNumberOfThreads(oldNumThreads);
+}
+
+BENCHMARK_REGISTER_F(Parallel, NestedParallelFor)
+->UseRealTime()
+->Args({ 1 << 16, 1 })
+->Args({ 1 << 16, 8 })
+->Args({ 1 << 24, 1 })
 ->Args({ 1 << 24, 8 });
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "benchmark/benchmark.h"
+
+#include <Particle/ParticleSystemData3.h>
+#include <Utils/Constants.h>
+#include <Vector/Vector3.h>
+
+#include <cmath>
+#include <random>
+
+using CubbyFlow::Vector3D;
+
+class ParticleSystemData3 : public ::benchmark::Fixture
+{
+protected:
+    CubbyFlow::ParticleSystemData3 particles;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+
+        std::mt19937 rng{ 0 };
+        std::uniform_real_distribution<> dist{ 0.0, 1.0 };
+
+        CubbyFlow::ParticleSystemData3::VectorData positions(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            positions[i] = Vector3D(dist(rng), dist(rng), dist(rng));
+        }
+
+        particles.Resize(0);
+        particles.AddParticles(positions);
+    }
+
+    // Radius that gives about 30 neighbors per particle
+    static double SearchRadius(size_t n)
+    {
+        return std::cbrt(30.0 / (4.0 / 3.0 * CubbyFlow::PI_DOUBLE * static_cast<double>(n)));
+    }
+};
+
+BENCHMARK_DEFINE_F(ParticleSystemData3, BuildNeighborLists)(benchmark::State& state)
+{
+    const double radius = SearchRadius(particles.NumberOfParticles());
+    particles.BuildNeighborSearcher(radius);
+
+    while (state.KeepRunning())
+    {
+        particles.BuildNeighborLists(radius);
+    }
+}
+
+BENCHMARK_REGISTER_F(ParticleSystemData3, BuildNeighborLists)
+->Arg(1 << 10)
+->Arg(1 << 15)
+->Arg(1 << 20)
+->Unit(benchmark::kMillisecond);
\ No newline at end of file
@@ -2,9 +2,12 @@
 
 #include <Array/Array1.h>
 #include <Searcher/PointParallelHashGridSearcher3.h>
+#include <Utils/Parallel.h>
 #include <Vector/Vector3.h>
 
+#include <limits>
 #include <random>
+#include <vector>
 
 using CubbyFlow::Array1;
 using CubbyFlow::Vector3D;
@@ -47,6 +50,94 @@ BENCHMARK_REGISTER_F(PointParallelHashGridSearcher3, Build)
 ->Arg(1 << 10)
 ->Arg(1 << 20);
 
+// Comparison sort-based build used before the counting sort, kept as the
+// baseline. Only the tables are built since the grid internals are private.
+static void BuildWithComparisonSort(
+    const CubbyFlow::PointParallelHashGridSearcher3& grid,
+    const Array1<Vector3D>& points,
+    std::vector<size_t>* keys,
+    std::vector<size_t>* startIndexTable,
+    std::vector<size_t>* endIndexTable,
+    std::vector<size_t>* sortedIndices,
+    std::vector<Vector3D>* sortedPoints)
+{
+    using CubbyFlow::ParallelFor;
+    using CubbyFlow::ZERO_SIZE;
+
+    const size_t numberOfPoints = points.size();
+    const size_t numberOfBuckets = 64 * 64 * 64;
+
+    std::vector<size_t> tempKeys(numberOfPoints);
+    startIndexTable->assign(numberOfBuckets, std::numeric_limits<size_t>::max());
+    endIndexTable->assign(numberOfBuckets, std::numeric_limits<size_t>::max());
+    keys->resize(numberOfPoints);
+    sortedIndices->resize(numberOfPoints);
+    sortedPoints->resize(numberOfPoints);
+
+    ParallelFor(ZERO_SIZE, numberOfPoints, [&](size_t i)
+    {
+        (*sortedIndices)[i] = i;
+        tempKeys[i] = grid.GetHashKeyFromBucketIndex(grid.GetBucketIndex(points[i]));
+    });
+
+    CubbyFlow::ParallelSort(sortedIndices->begin(), sortedIndices->end(), [&tempKeys](size_t indexA, size_t indexB)
+    {
+        return tempKeys[indexA] < tempKeys[indexB];
+    });
+
+    ParallelFor(ZERO_SIZE, numberOfPoints, [&](size_t i)
+    {
+        (*sortedPoints)[i] = points[(*sortedIndices)[i]];
+        (*keys)[i] = tempKeys[(*sortedIndices)[i]];
+    });
+
+    (*startIndexTable)[(*keys)[0]] = 0;
+    (*endIndexTable)[(*keys)[numberOfPoints - 1]] = numberOfPoints;
+
+    ParallelFor(static_cast<size_t>(1), numberOfPoints, [&](size_t i)
+    {
+        if ((*keys)[i] > (*keys)[i - 1])
+        {
+            (*startIndexTable)[(*keys)[i]] = i;
+            (*endIndexTable)[(*keys)[i - 1]] = i;
+        }
+    });
+}
+
+BENCHMARK_DEFINE_F(PointParallelHashGridSearcher3, BuildComparisonSort)(benchmark::State& state)
+{
+    CubbyFlow::PointParallelHashGridSearcher3 grid(64, 64, 64, 1.0 / 64.0);
+    std::vector<size_t> keys, startIndexTable, endIndexTable, sortedIndices;
+    std::vector<Vector3D> sortedPoints;
+
+    while (state.KeepRunning())
+    {
+        BuildWithComparisonSort(grid, points, &keys, &startIndexTable, &endIndexTable, &sortedIndices, &sortedPoints);
+    }
+}
+
+BENCHMARK_REGISTER_F(PointParallelHashGridSearcher3, BuildComparisonSort)
+->Arg(100000)
+->Arg(1000000)
+->Arg(10000000)
+->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(PointParallelHashGridSearcher3, BuildCountingSort)(benchmark::State& state)
+{
+    CubbyFlow::PointParallelHashGridSearcher3 grid(64, 64, 64, 1.0 / 64.0);
+
+    while (state.KeepRunning())
+    {
+        grid.Build(points);
+    }
+}
+
+BENCHMARK_REGISTER_F(PointParallelHashGridSearcher3, BuildCountingSort)
+->Arg(100000)
+->Arg(1000000)
+->Arg(10000000)
+->Unit(benchmark::kMillisecond);
+
 BENCHMARK_DEFINE_F(PointParallelHashGridSearcher3, ForEachNearbyPoints)(benchmark::State& state)
 {
     CubbyFlow::PointParallelHashGridSearcher3 grid(64, 64, 64, 1.0 / 64.0);
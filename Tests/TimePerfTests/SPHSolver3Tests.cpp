@@ -0,0 +1,235 @@
+#include "benchmark/benchmark.h"
+
+#include <Array/Array1.h>
+#include <SPH/SPHStdKernel3.h>
+#include <Solver/SPH/SPHSolver3.h>
+#include <Math/MathUtils.h>
+#include <Utils/Parallel.h>
+
+#include <algorithm>
+#include <random>
+
+using CubbyFlow::Array1;
+using CubbyFlow::Vector3D;
+
+class SPHSolver3ForBenchmark : public CubbyFlow::SPHSolver3
+{
+public:
+    using CubbyFlow::SPHSolver3::AccumulatePressureForce;
+    using CubbyFlow::SPHSolver3::AccumulatePressureForceSoA;
+    using CubbyFlow::SPHSolver3::GetPositionsSoA;
+    using CubbyFlow::SPHSolver3::UpdateSoAArrays;
+    using CubbyFlow::SPHSolver3::OnAdvanceTimeStep;
+};
+
+class SPHSolver3 : public ::benchmark::Fixture
+{
+protected:
+    SPHSolver3ForBenchmark solver;
+    Array1<Vector3D> pressureForces;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+
+        std::mt19937 rng{ 0 };
+        std::uniform_real_distribution<> dist{ 0.0, 1.0 };
+
+        auto particles = solver.GetSPHSystemData();
+        particles->Resize(0);
+
+        // About 30 neighbors per particle in the unit cube
+        particles->SetTargetSpacing(std::cbrt(1.0 / static_cast<double>(n)));
+
+        CubbyFlow::SPHSystemData3::VectorData positions(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            positions[i] = Vector3D(dist(rng), dist(rng), dist(rng));
+        }
+        particles->AddParticles(positions);
+
+        particles->BuildNeighborSearcher();
+        particles->BuildNeighborLists();
+        particles->UpdateDensities();
+
+        auto p = particles->GetPressures();
+        for (size_t i = 0; i < n; ++i)
+        {
+            p[i] = dist(rng);
+        }
+
+        pressureForces.Resize(n);
+    }
+};
+
+// Array-of-structs implementation used before the SoA kernel, kept as the
+// baseline.
+static void AccumulatePressureForceAoS(
+    const CubbyFlow::SPHSystemData3& particles,
+    Array1<Vector3D>* pressureForces)
+{
+    auto positions = particles.GetPositions();
+    auto densities = particles.GetDensities();
+    auto pressures = particles.GetPressures();
+    auto forces = pressureForces->Accessor();
+
+    const double massSquared = CubbyFlow::Square(particles.GetMass());
+    const CubbyFlow::SPHSpikyKernel3 kernel(particles.GetKernelRadius());
+
+    CubbyFlow::ParallelFor(CubbyFlow::ZERO_SIZE, particles.NumberOfParticles(), [&](size_t i)
+    {
+        const auto neighbors = particles.NeighborLists()[i];
+        for (size_t j : neighbors)
+        {
+            double dist = positions[i].DistanceTo(positions[j]);
+            if (dist > 0.0)
+            {
+                Vector3D dir = (positions[j] - positions[i]) / dist;
+                forces[i] -= massSquared * (pressures[i] / (densities[i] * densities[i])
+                    + pressures[j] / (densities[j] * densities[j])) * kernel.Gradient(dist, dir);
+            }
+        }
+    });
+}
+
+BENCHMARK_DEFINE_F(SPHSolver3, AccumulatePressureForceAoS)(benchmark::State& state)
+{
+    auto particles = solver.GetSPHSystemData();
+
+    while (state.KeepRunning())
+    {
+        AccumulatePressureForceAoS(*particles, &pressureForces);
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3, AccumulatePressureForceAoS)
+->Arg(1 << 12)
+->Arg(1 << 16)
+->Arg(1 << 20)
+->Unit(benchmark::kMillisecond);
+
+// Includes the copy of the positions into the SoA scratch arrays on every
+// call, so it is directly comparable with the AoS baseline.
+BENCHMARK_DEFINE_F(SPHSolver3, AccumulatePressureForceSoA)(benchmark::State& state)
+{
+    auto particles = solver.GetSPHSystemData();
+
+    while (state.KeepRunning())
+    {
+        solver.AccumulatePressureForce(
+            particles->GetPositions(), particles->GetDensities(),
+            particles->GetPressures(), pressureForces.Accessor());
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3, AccumulatePressureForceSoA)
+->Arg(1 << 12)
+->Arg(1 << 16)
+->Arg(1 << 20)
+->Unit(benchmark::kMillisecond);
+
+// Kernel only, on positions copied once. This is what the force passes of a
+// time-step and the PCISPH iterations pay after UpdateSoAArrays.
+BENCHMARK_DEFINE_F(SPHSolver3, AccumulatePressureForceSoAPreloaded)(benchmark::State& state)
+{
+    auto particles = solver.GetSPHSystemData();
+    solver.UpdateSoAArrays();
+
+    while (state.KeepRunning())
+    {
+        solver.AccumulatePressureForceSoA(
+            solver.GetPositionsSoA(), particles->GetDensities(),
+            particles->GetPressures(), pressureForces.Accessor());
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3, AccumulatePressureForceSoAPreloaded)
+->Arg(1 << 12)
+->Arg(1 << 16)
+->Arg(1 << 20)
+->Unit(benchmark::kMillisecond);
+
+// The per-step copy on its own.
+BENCHMARK_DEFINE_F(SPHSolver3, UpdateSoAArrays)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        solver.UpdateSoAArrays();
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3, UpdateSoAArrays)
+->Arg(1 << 12)
+->Arg(1 << 16)
+->Arg(1 << 20)
+->Unit(benchmark::kMillisecond);
+
+// Full time-step on a resting block whose particles are stored in random
+// order, like a fluid that has been mixing for a while.
+class SPHSolver3Step : public ::benchmark::Fixture
+{
+protected:
+    SPHSolver3ForBenchmark solver;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        const auto n = static_cast<size_t>(state.range(0));
+        const double spacing = 1.0 / static_cast<double>(n);
+
+        solver.SetGravity(Vector3D());
+
+        auto particles = solver.GetSPHSystemData();
+        particles->Resize(0);
+        particles->SetTargetSpacing(spacing);
+
+        CubbyFlow::SPHSystemData3::VectorData positions;
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    positions.Append(spacing * Vector3D(
+                        static_cast<double>(i),
+                        static_cast<double>(j),
+                        static_cast<double>(k)));
+                }
+            }
+        }
+
+        std::mt19937 rng{ 0 };
+        std::shuffle(positions.begin(), positions.end(), rng);
+        particles->AddParticles(positions);
+    }
+};
+
+BENCHMARK_DEFINE_F(SPHSolver3Step, RandomOrder)(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        solver.OnAdvanceTimeStep(1e-4);
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3Step, RandomOrder)
+->Arg(16)
+->Arg(48)
+->Arg(96)
+->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SPHSolver3Step, MortonOrder)(benchmark::State& state)
+{
+    auto particles = solver.GetSPHSystemData();
+    particles->SortParticles(particles->GetKernelRadius());
+
+    while (state.KeepRunning())
+    {
+        solver.OnAdvanceTimeStep(1e-4);
+    }
+}
+
+BENCHMARK_REGISTER_F(SPHSolver3Step, MortonOrder)
+->Arg(16)
+->Arg(48)
+->Arg(96)
+->Unit(benchmark::kMillisecond);
\ No newline at end of file
@@ -311,4 +311,53 @@ TEST(Array3, ParallelForEachIndex)
 		size_t idx = i + (4 * (j + 3 * k)) + 1;
 		EXPECT_FLOAT_EQ(static_cast<float>(idx), arr1(i, j, k));
 	});
+}
+
+TEST(Array3, ParallelForEachTile)
+{
+	Array3<int> arr1(13, 7, 10, 0);
+
+	arr1.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+	{
+		EXPECT_LE(iEnd - iBegin, 4u);
+		EXPECT_LE(jEnd - jBegin, 3u);
+		EXPECT_LE(kEnd - kBegin, 2u);
+
+		for (size_t k = kBegin; k < kEnd; ++k)
+		{
+			for (size_t j = jBegin; j < jEnd; ++j)
+			{
+				for (size_t i = iBegin; i < iEnd; ++i)
+				{
+					++arr1(i, j, k);
+				}
+			}
+		}
+	}, Size3(4, 3, 2));
+
+	arr1.ForEach([&](int val)
+	{
+		EXPECT_EQ(1, val);
+	});
+
+	Array3<int> arr2(300, 9, 17, 0);
+
+	arr2.ParallelForEachTile([&](size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+	{
+		for (size_t k = kBegin; k < kEnd; ++k)
+		{
+			for (size_t j = jBegin; j < jEnd; ++j)
+			{
+				for (size_t i = iBegin; i < iEnd; ++i)
+				{
+					++arr2(i, j, k);
+				}
+			}
+		}
+	});
+
+	arr2.ForEach([&](int val)
+	{
+		EXPECT_EQ(1, val);
+	});
 }
\ No newline at end of file
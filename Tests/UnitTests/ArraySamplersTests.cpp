@@ -214,4 +214,59 @@ TEST(CubicArraySampler3, Sample)
 	double s0 = sampler(Vector3D(1.5, 1.8, 1.2));
 	EXPECT_LT(3.0, s0);
 	EXPECT_GT(6.0, s0);
+}
+
+TEST(LinearArraySampler3, SampleBatch)
+{
+	Array3<double> grid(4, 4, 4);
+	for (size_t k = 0; k < 4; ++k)
+	{
+		for (size_t j = 0; j < 4; ++j)
+		{
+			for (size_t i = 0; i < 4; ++i)
+			{
+				grid(i, j, k) = static_cast<double>(i * i + j + 2 * k);
+			}
+		}
+	}
+
+	Vector3D gridSpacing(1.0, 0.5, 2.0), gridOrigin(0.1, 0.2, -0.3);
+	LinearArraySampler3<double, double> sampler(
+		grid.ConstAccessor(), gridSpacing, gridOrigin);
+
+	Array1<Vector3D> points =
+	{
+		Vector3D(1.5, 0.8, 1.2),
+		Vector3D(-1.0, 0.2, 3.0),
+		Vector3D(2.9, 1.9, 6.0),
+		Vector3D(0.3, 0.7, 0.1)
+	};
+	for (int i = 0; i < 20; ++i)
+	{
+		points.Append(Vector3D(0.37 * i - 1.0, 0.11 * i, 0.5 * i - 0.5));
+	}
+	Array1<double> values(points.size());
+
+	sampler(points.ConstAccessor(), values.Accessor());
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(sampler(points[i]), values[i]);
+	}
+
+	// Degenerate dimension of a single element
+	Array3<double> flat(5, 1, 3);
+	flat.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		flat(i, j, k) = static_cast<double>(3 * i + k * k + j);
+	});
+
+	LinearArraySampler3<double, double> flatSampler(
+		flat.ConstAccessor(), gridSpacing, gridOrigin);
+	flatSampler(points.ConstAccessor(), values.Accessor());
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(flatSampler(points[i]), values[i]);
+	}
 }
\ No newline at end of file
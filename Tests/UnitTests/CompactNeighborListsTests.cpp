@@ -0,0 +1,52 @@
+#include "pch.h"
+
+#include <Particle/CompactNeighborLists.h>
+
+using namespace CubbyFlow;
+
+TEST(CompactNeighborLists, Constructors)
+{
+	CompactNeighborLists lists;
+	EXPECT_EQ(0u, lists.size());
+	EXPECT_EQ(0u, lists.NumberOfNeighbors());
+	EXPECT_EQ(1u, lists.Starts().size());
+	EXPECT_EQ(0u, lists.Starts()[0]);
+}
+
+TEST(CompactNeighborLists, Build)
+{
+	CompactNeighborLists lists;
+
+	// The i-th list holds i, i + 1, ..., 2i - 1
+	lists.Build(100, [](size_t i)
+	{
+		return i;
+	}, [](size_t i, size_t* neighbors)
+	{
+		for (size_t j = 0; j < i; ++j)
+		{
+			neighbors[j] = i + j;
+		}
+	});
+
+	EXPECT_EQ(100u, lists.size());
+	EXPECT_EQ(99u * 100u / 2u, lists.NumberOfNeighbors());
+	EXPECT_EQ(101u, lists.Starts().size());
+	EXPECT_EQ(lists.NumberOfNeighbors(), lists.Indices().size());
+
+	for (size_t i = 0; i < lists.size(); ++i)
+	{
+		const auto neighbors = lists[i];
+		EXPECT_EQ(i * (i - 1) / 2, lists.Starts()[i]);
+		EXPECT_EQ(i, neighbors.size());
+
+		for (size_t j = 0; j < neighbors.size(); ++j)
+		{
+			EXPECT_EQ(i + j, neighbors[j]);
+		}
+	}
+
+	lists.Clear();
+	EXPECT_EQ(0u, lists.size());
+	EXPECT_EQ(0u, lists.NumberOfNeighbors());
+}
\ No newline at end of file
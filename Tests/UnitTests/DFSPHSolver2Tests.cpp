@@ -0,0 +1,34 @@
+#include "pch.h"
+
+#include <Solver/DFSPH/DFSPHSolver2.h>
+
+using namespace CubbyFlow;
+
+TEST(DFSPHSolver2, UpdateEmpty)
+{
+	// Empty solver test
+	DFSPHSolver2 solver;
+	Frame frame(0, 0.01);
+	solver.Update(frame++);
+	solver.Update(frame);
+}
+
+TEST(DFSPHSolver2, Parameters)
+{
+	DFSPHSolver2 solver;
+
+	solver.SetMaxDensityErrorRatio(5.0);
+	EXPECT_DOUBLE_EQ(5.0, solver.GetMaxDensityErrorRatio());
+
+	solver.SetMaxDensityErrorRatio(-1.0);
+	EXPECT_DOUBLE_EQ(0.0, solver.GetMaxDensityErrorRatio());
+
+	solver.SetMaxDivergenceErrorRatio(5.0);
+	EXPECT_DOUBLE_EQ(5.0, solver.GetMaxDivergenceErrorRatio());
+
+	solver.SetMaxDivergenceErrorRatio(-1.0);
+	EXPECT_DOUBLE_EQ(0.0, solver.GetMaxDivergenceErrorRatio());
+
+	solver.SetMaxNumberOfIterations(10);
+	EXPECT_DOUBLE_EQ(10, solver.GetMaxNumberOfIterations());
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "pch.h"
+
+#include <Collider/RigidBodyCollider3.h>
+#include <Geometry/Box3.h>
+#include <PointGenerator/BccLatticePointGenerator.h>
+#include <Solver/DFSPH/DFSPHSolver3.h>
+
+using namespace CubbyFlow;
+
+TEST(DFSPHSolver3, UpdateEmpty)
+{
+	// Empty solver test
+	DFSPHSolver3 solver;
+	Frame frame(0, 0.01);
+	solver.Update(frame++);
+	solver.Update(frame);
+}
+
+TEST(DFSPHSolver3, Parameters)
+{
+	DFSPHSolver3 solver;
+
+	solver.SetMaxDensityErrorRatio(5.0);
+	EXPECT_DOUBLE_EQ(5.0, solver.GetMaxDensityErrorRatio());
+
+	solver.SetMaxDensityErrorRatio(-1.0);
+	EXPECT_DOUBLE_EQ(0.0, solver.GetMaxDensityErrorRatio());
+
+	solver.SetMaxDivergenceErrorRatio(5.0);
+	EXPECT_DOUBLE_EQ(5.0, solver.GetMaxDivergenceErrorRatio());
+
+	solver.SetMaxDivergenceErrorRatio(-1.0);
+	EXPECT_DOUBLE_EQ(0.0, solver.GetMaxDivergenceErrorRatio());
+
+	solver.SetMaxNumberOfIterations(10);
+	EXPECT_DOUBLE_EQ(10, solver.GetMaxNumberOfIterations());
+}
+
+TEST(DFSPHSolver3, RestingBlock)
+{
+	const double targetSpacing = 0.05;
+
+	DFSPHSolver3 solver(1000.0, targetSpacing, 1.8);
+	solver.SetPseudoViscosityCoefficient(0.0);
+
+	auto particles = solver.GetSPHSystemData();
+
+	Array1<Vector3D> points;
+	BccLatticePointGenerator pointsGenerator;
+	pointsGenerator.Generate(BoundingBox3D(Vector3D(0.05, 0.05, 0.05), Vector3D(0.35, 0.35, 0.35)), targetSpacing, &points);
+	particles->AddParticles(points.ConstAccessor());
+
+	Box3Ptr box = std::make_shared<Box3>(Vector3D(), Vector3D(0.4, 1.0, 0.4));
+	box->isNormalFlipped = true;
+	solver.SetCollider(std::make_shared<RigidBodyCollider3>(box));
+
+	for (Frame frame(0, 1.0 / 60.0); frame.index < 30; ++frame)
+	{
+		solver.Update(frame);
+	}
+
+	particles->BuildNeighborSearcher();
+	particles->BuildNeighborLists();
+	particles->UpdateDensities();
+
+	auto densities = particles->GetDensities();
+	auto positions = particles->GetPositions();
+
+	double densitySum = 0.0;
+	double maxHeight = 0.0;
+	for (size_t i = 0; i < particles->NumberOfParticles(); ++i)
+	{
+		densitySum += densities[i];
+		maxHeight = std::max(maxHeight, positions[i].y);
+	}
+
+	// The block should settle without being squashed by the large time-steps
+	const double averageDensity = densitySum / static_cast<double>(particles->NumberOfParticles());
+	EXPECT_LT(averageDensity, 1.05 * particles->GetTargetDensity());
+	EXPECT_GT(maxHeight, 0.15);
+}
\ No newline at end of file
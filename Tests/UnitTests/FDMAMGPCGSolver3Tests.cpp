@@ -0,0 +1,101 @@
+#include "pch.h"
+
+#include <FDMLinearSystemSolverTestHelper3.h>
+
+#include <Solver/FDM/FDMAMGPCGSolver3.h>
+#include <Solver/FDM/FDMCGSolver3.h>
+
+#include <random>
+
+using namespace CubbyFlow;
+
+namespace
+{
+    // Replaces the RHS with random values of zero mean, which keeps the pure
+    // Neumann problem consistent and excites all the frequencies.
+    void RandomizeRHS(double* b, size_t n)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<> d(-1.0, 1.0);
+
+        double mean = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            b[i] = d(rng);
+            mean += b[i];
+        }
+        mean /= static_cast<double>(n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            b[i] -= mean;
+        }
+    }
+}
+
+TEST(FDMAMGPCGSolver3, SolveLowRes)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 3, 3, 3 });
+
+    FDMAMGPCGSolver3 solver(100, 1e-9);
+    EXPECT_TRUE(solver.Solve(&system));
+
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+    EXPECT_EQ(1u, solver.GetNumberOfLevels());
+}
+
+TEST(FDMAMGPCGSolver3, Solve)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 32, 32, 32 });
+    RandomizeRHS(system.b.data(), 32 * 32 * 32);
+
+    FDMLinearSystem3 systemCG = system;
+
+    FDMAMGPCGSolver3 solver(100, 1e-9);
+    EXPECT_TRUE(solver.Solve(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+    EXPECT_LT(1u, solver.GetNumberOfLevels());
+
+    FDMCGSolver3 solverCG(1000, 1e-9);
+    EXPECT_TRUE(solverCG.Solve(&systemCG));
+    EXPECT_LT(solver.GetLastNumberOfIterations(), solverCG.GetLastNumberOfIterations() / 4);
+
+    // The system is a pure Neumann problem, so the solutions can differ by a constant
+    double offset = 0.0;
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        offset += system.x(i, j, k) - systemCG.x(i, j, k);
+    });
+    offset /= static_cast<double>(system.x.Width() * system.x.Height() * system.x.Depth());
+
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        EXPECT_NEAR(systemCG.x(i, j, k), system.x(i, j, k) - offset, 1e-6);
+    });
+}
+
+TEST(FDMAMGPCGSolver3, SolveCompressed)
+{
+    FDMCompressedLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestCompressedLinearSystem(&system, { 24, 17, 30 });
+    RandomizeRHS(system.b.data(), system.b.size());
+
+    FDMCompressedLinearSystem3 systemCG = system;
+
+    FDMAMGPCGSolver3 solver(100, 1e-9);
+    EXPECT_TRUE(solver.SolveCompressed(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+    EXPECT_LT(1u, solver.GetNumberOfLevels());
+
+    FDMCGSolver3 solverCG(1000, 1e-9);
+    EXPECT_TRUE(solverCG.SolveCompressed(&systemCG));
+    EXPECT_LT(solver.GetLastNumberOfIterations(), solverCG.GetLastNumberOfIterations() / 4);
+
+    const double offset = system.x.Avg() - systemCG.x.Avg();
+    for (size_t i = 0; i < system.x.size(); ++i)
+    {
+        EXPECT_NEAR(systemCG.x[i], system.x[i] - offset, 1e-6);
+    }
+}
\ No newline at end of file
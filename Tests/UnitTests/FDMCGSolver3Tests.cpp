@@ -26,4 +26,32 @@ TEST(FDMCGSolver3, SolveCompressed)
     solver.SolveCompressed(&system);
 
     EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+}
+
+TEST(FDMCGSolver3, SolveFusedAndPipelined)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 31, 32, 33 });
+
+    FDMCGSolver3 solver(500, 1e-9);
+    EXPECT_EQ(CGMethod::Standard, solver.GetCGMethod());
+    EXPECT_TRUE(solver.Solve(&system));
+    const FDMVector3 expected = system.x;
+    const unsigned int numIter = solver.GetLastNumberOfIterations();
+
+    for (CGMethod method : { CGMethod::Fused, CGMethod::Pipelined })
+    {
+        solver.SetCGMethod(method);
+        EXPECT_EQ(method, solver.GetCGMethod());
+        EXPECT_TRUE(solver.Solve(&system));
+        EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+        EXPECT_LE(solver.GetLastNumberOfIterations(), numIter + 5);
+        ASSERT_EQ(solver.GetLastNumberOfIterations() + 1, solver.GetLastResidualHistory().size());
+        EXPECT_DOUBLE_EQ(solver.GetLastResidual(), solver.GetLastResidualHistory().back());
+
+        expected.ForEachIndex([&](size_t i, size_t j, size_t k)
+        {
+            EXPECT_NEAR(expected(i, j, k), system.x(i, j, k), 1e-7);
+        });
+    }
 }
\ No newline at end of file
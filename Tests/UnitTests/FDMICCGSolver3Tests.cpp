@@ -37,4 +37,116 @@ TEST(FDMICCGSolver3, SolveCompressed)
     solver.SolveCompressed(&system);
 
     EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+}
+
+TEST(FDMICCGSolver3, SolveSinglePrecision)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 32, 32, 32 });
+
+    FDMLinearSystem3 systemDouble = system;
+
+    FDMICCGSolver3 solver(100, 1e-4);
+    EXPECT_FALSE(solver.GetUseSinglePrecision());
+    EXPECT_TRUE(solver.Solve(&systemDouble));
+
+    solver.SetUseSinglePrecision(true);
+    EXPECT_TRUE(solver.GetUseSinglePrecision());
+    EXPECT_TRUE(solver.Solve(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        EXPECT_NEAR(systemDouble.x(i, j, k), system.x(i, j, k), 1e-3);
+    });
+}
+
+TEST(FDMICCGSolver3, SolveSinglePrecisionTightTolerance)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 32, 32, 32 });
+
+    FDMLinearSystem3 systemDouble = system;
+
+    // Below what a float-only PCG can reach relative to the right-hand side
+    FDMICCGSolver3 solver(500, 1e-10);
+    EXPECT_TRUE(solver.Solve(&systemDouble));
+
+    solver.SetUseSinglePrecision(true);
+    EXPECT_TRUE(solver.Solve(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+    EXPECT_GT(solver.GetMaxNumberOfIterations(), solver.GetLastNumberOfIterations());
+    ASSERT_EQ(solver.GetLastNumberOfIterations() + 1, solver.GetLastResidualHistory().size());
+    EXPECT_DOUBLE_EQ(solver.GetLastResidual(), solver.GetLastResidualHistory().back());
+
+    // The system is a pure Neumann problem, so the solutions can differ by a constant
+    double offset = 0.0;
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        offset += system.x(i, j, k) - systemDouble.x(i, j, k);
+    });
+    offset /= static_cast<double>(system.x.Width() * system.x.Height() * system.x.Depth());
+
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        EXPECT_NEAR(systemDouble.x(i, j, k), system.x(i, j, k) - offset, 1e-8);
+    });
+}
+
+TEST(FDMICCGSolver3, SolveMulticolor)
+{
+    FDMLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestLinearSystem(&system, { 31, 32, 33 });
+
+    FDMLinearSystem3 systemNatural = system;
+
+    FDMICCGSolver3 solver(200, 1e-6);
+    EXPECT_FALSE(solver.GetUseMulticolorPreconditioner());
+    EXPECT_TRUE(solver.Solve(&systemNatural));
+
+    solver.SetUseMulticolorPreconditioner(true);
+    EXPECT_TRUE(solver.GetUseMulticolorPreconditioner());
+    EXPECT_TRUE(solver.Solve(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+
+    // The system is a pure Neumann problem, so the solutions can differ by a constant
+    double offset = 0.0;
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        offset += system.x(i, j, k) - systemNatural.x(i, j, k);
+    });
+    offset /= static_cast<double>(system.x.Width() * system.x.Height() * system.x.Depth());
+
+    system.x.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        EXPECT_NEAR(systemNatural.x(i, j, k), system.x(i, j, k) - offset, 1e-4);
+    });
+
+    FDMICCGSolver3 solverF(200, 1e-4);
+    solverF.SetUseMulticolorPreconditioner(true);
+    solverF.SetUseSinglePrecision(true);
+    EXPECT_TRUE(solverF.Solve(&system));
+    EXPECT_GT(solverF.GetTolerance(), solverF.GetLastResidual());
+}
+
+TEST(FDMICCGSolver3, SolveCompressedMulticolor)
+{
+    FDMCompressedLinearSystem3 system;
+    FDMLinearSystemSolverTestHelper3::BuildTestCompressedLinearSystem(&system, { 16, 17, 18 });
+
+    FDMCompressedLinearSystem3 systemNatural = system;
+
+    FDMICCGSolver3 solver(200, 1e-6);
+    EXPECT_TRUE(solver.SolveCompressed(&systemNatural));
+
+    solver.SetUseMulticolorPreconditioner(true);
+    EXPECT_TRUE(solver.SolveCompressed(&system));
+    EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+
+    // The system is a pure Neumann problem, so the solutions can differ by a constant
+    const double offset = system.x.Avg() - systemNatural.x.Avg();
+    for (size_t i = 0; i < system.x.size(); ++i)
+    {
+        EXPECT_NEAR(systemNatural.x[i], system.x[i] - offset, 1e-4);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "pch.h"
+
+#include <FDM/FDMLinearSystem3.h>
+#include <Utils/Parallel.h>
+
+#include <random>
+
+using namespace CubbyFlow;
+
+namespace
+{
+	void FillRandom(FDMVector3* v, std::mt19937* rng)
+	{
+		std::uniform_real_distribution<> d(-1.0, 1.0);
+		v->ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			(*v)(i, j, k) = d(*rng);
+		});
+	}
+}
+
+TEST(FDMBLAS3, Dot)
+{
+	std::mt19937 rng(0);
+	FDMVector3 a(17, 9, 23);
+	FDMVector3 b(17, 9, 23);
+	FillRandom(&a, &rng);
+	FillRandom(&b, &rng);
+
+	double expected = 0.0;
+	a.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		expected += a(i, j, k) * b(i, j, k);
+	});
+
+	const double result = FDMBLAS3::Dot(a, b);
+	EXPECT_NEAR(expected, result, 1e-12);
+
+	// Same bits for the same number of threads
+	for (int n = 0; n < 10; ++n)
+	{
+		EXPECT_EQ(result, FDMBLAS3::Dot(a, b));
+	}
+}
+
+TEST(FDMBLAS3, Norms)
+{
+	std::mt19937 rng(0);
+	FDMVector3 v(13, 31, 7);
+	FillRandom(&v, &rng);
+	v(3, 20, 4) = -5.0;
+
+	double sumSquared = 0.0;
+	v.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		sumSquared += v(i, j, k) * v(i, j, k);
+	});
+
+	EXPECT_NEAR(std::sqrt(sumSquared), FDMBLAS3::L2Norm(v), 1e-12);
+	EXPECT_DOUBLE_EQ(5.0, FDMBLAS3::LInfNorm(v));
+}
+
+TEST(FDMBLAS3F, MatchesDoublePrecision)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> d(-1.0, 1.0);
+
+	FDMMatrix3 m(11, 9, 7);
+	FDMVector3 v(11, 9, 7);
+	FDMVector3F vF(11, 9, 7);
+	m.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		m(i, j, k).center = 6.0;
+		m(i, j, k).right = d(rng);
+		m(i, j, k).up = d(rng);
+		m(i, j, k).front = d(rng);
+		vF(i, j, k) = static_cast<float>(d(rng));
+		v(i, j, k) = vF(i, j, k);
+	});
+
+	// Accumulated in double, so only the inputs are rounded
+	EXPECT_NEAR(FDMBLAS3::Dot(v, v), FDMBLAS3F::Dot(vF, vF), 1e-12);
+	EXPECT_DOUBLE_EQ(FDMBLAS3::LInfNorm(v), FDMBLAS3F::LInfNorm(vF));
+
+	FDMVector3 result(11, 9, 7);
+	FDMVector3F resultF(11, 9, 7);
+	FDMBLAS3::MVM(m, v, &result);
+	FDMBLAS3F::MVM(m, vF, &resultF);
+	result.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_FLOAT_EQ(static_cast<float>(result(i, j, k)), resultF(i, j, k));
+	});
+
+	FDMBLAS3::Residual(m, v, v, &result);
+	FDMBLAS3F::Residual(m, vF, vF, &resultF);
+	result.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_FLOAT_EQ(static_cast<float>(result(i, j, k)), resultF(i, j, k));
+	});
+
+	// Evaluated in double from the double-precision vectors
+	FDMBLAS3F::Residual(m, v, v, &resultF);
+	result.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_EQ(static_cast<float>(result(i, j, k)), resultF(i, j, k));
+	});
+}
+
+TEST(FDMCompressedBLAS3, DotAndNorms)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> d(-1.0, 1.0);
+
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+
+	VectorND a(1001);
+	VectorND b(1001);
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		a[i] = d(rng);
+		b[i] = d(rng);
+	}
+	a[500] = 3.0;
+
+	double expected = 0.0;
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		expected += a[i] * b[i];
+	}
+
+	for (unsigned int numThreads : { 1u, 3u, 8u })
+	{
+		SetMaxNumberOfThreads(numThreads);
+
+		const double result = FDMCompressedBLAS3::Dot(a, b);
+		EXPECT_NEAR(expected, result, 1e-12);
+		EXPECT_EQ(result, FDMCompressedBLAS3::Dot(a, b));
+
+		EXPECT_NEAR(std::sqrt(FDMCompressedBLAS3::Dot(a, a)), FDMCompressedBLAS3::L2Norm(a), 1e-15);
+		EXPECT_DOUBLE_EQ(3.0, FDMCompressedBLAS3::LInfNorm(a));
+	}
+
+	SetMaxNumberOfThreads(oldNumThreads);
+}
+
+TEST(FDMMatrixFreeBLAS3, MatchesStoredMatrix)
+{
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<int> m(0, 5);
+
+	for (const Size3& size : { Size3(1, 5, 4), Size3(2, 3, 3), Size3(17, 9, 13) })
+	{
+		FDMMatrixFree3 a;
+		a.markers.Resize(size);
+		a.invHSqr = Vector3D(1.0, 4.0, 0.25);
+		a.markers.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			// Mostly fluid cells
+			const int r = m(rng);
+			a.markers(i, j, k) = (r < 4) ? FDMMatrixFree3::FLUID : static_cast<char>(r - 3);
+		});
+
+		// Equivalent stored matrix
+		FDMMatrix3 stored(size);
+		stored.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			auto& row = stored(i, j, k);
+			row.center = row.right = row.up = row.front = 0.0;
+
+			if (a.markers(i, j, k) != FDMMatrixFree3::FLUID)
+			{
+				row.center = 1.0;
+				return;
+			}
+
+			auto add = [&](bool inside, size_t ni, size_t nj, size_t nk, double w, double* off)
+			{
+				if (inside && a.markers(ni, nj, nk) != FDMMatrixFree3::BOUNDARY)
+				{
+					row.center += w;
+					if (off != nullptr && a.markers(ni, nj, nk) == FDMMatrixFree3::FLUID)
+					{
+						*off -= w;
+					}
+				}
+			};
+
+			add(i + 1 < size.x, i + 1, j, k, a.invHSqr.x, &row.right);
+			add(i > 0, i - 1, j, k, a.invHSqr.x, nullptr);
+			add(j + 1 < size.y, i, j + 1, k, a.invHSqr.y, &row.up);
+			add(j > 0, i, j - 1, k, a.invHSqr.y, nullptr);
+			add(k + 1 < size.z, i, j, k + 1, a.invHSqr.z, &row.front);
+			add(k > 0, i, j, k - 1, a.invHSqr.z, nullptr);
+		});
+
+		FDMVector3 x(size);
+		FDMVector3 b(size);
+		FillRandom(&x, &rng);
+		FillRandom(&b, &rng);
+
+		FDMVector3 expected(size);
+		FDMVector3 result(size);
+		FDMBLAS3::MVM(stored, x, &expected);
+		FDMMatrixFreeBLAS3::MVM(a, x, &result);
+		result.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected(i, j, k), result(i, j, k), 1e-12);
+
+			double center, offDiagonal;
+			a.Row(i, j, k, x, &center, &offDiagonal);
+			EXPECT_NEAR(expected(i, j, k), center * x(i, j, k) + offDiagonal, 1e-12);
+		});
+
+		FDMBLAS3::Residual(stored, x, b, &expected);
+		FDMMatrixFreeBLAS3::Residual(a, x, b, &result);
+		result.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected(i, j, k), result(i, j, k), 1e-12);
+		});
+	}
+}
+
+TEST(FDMBLAS3, FusedKernels)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> d(-1.0, 1.0);
+
+	const Size3 size(37, 9, 11);
+	FDMMatrix3 m(size);
+	m.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		m(i, j, k).center = 6.0;
+		m(i, j, k).right = d(rng);
+		m(i, j, k).up = d(rng);
+		m(i, j, k).front = d(rng);
+	});
+
+	std::vector<FDMVector3> v(10, FDMVector3(size));
+	for (auto& vec : v)
+	{
+		FillRandom(&vec, &rng);
+	}
+
+	// q = Ad, d.q
+	FDMVector3 expected(size);
+	FDMVector3 result(size);
+	FDMBLAS3::MVM(m, v[0], &expected);
+	const double dq = FDMBLAS3::MVMDot(m, v[0], &result);
+	EXPECT_NEAR(FDMBLAS3::Dot(v[0], expected), dq, 1e-10);
+	result.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_EQ(expected(i, j, k), result(i, j, k));
+	});
+
+	// x = x + alpha * d, r = r - alpha * q, r.r
+	const double alpha = 0.3;
+	const double beta = -0.7;
+	FDMVector3 x = v[2];
+	FDMVector3 r = v[3];
+	const double rr = FDMBLAS3::CGUpdate(alpha, v[0], v[1], &x, &r);
+
+	FDMVector3 xExpected = v[2];
+	FDMVector3 rExpected = v[3];
+	FDMBLAS3::AXPlusY(alpha, v[0], xExpected, &xExpected);
+	FDMBLAS3::AXPlusY(-alpha, v[1], rExpected, &rExpected);
+	EXPECT_NEAR(FDMBLAS3::Dot(rExpected, rExpected), rr, 1e-10);
+	x.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_EQ(xExpected(i, j, k), x(i, j, k));
+		EXPECT_EQ(rExpected(i, j, k), r(i, j, k));
+	});
+
+	// Pipelined recurrences
+	const FDMVector3& n = v[0];
+	const FDMVector3& mv = v[1];
+	std::vector<FDMVector3> pv(v.begin() + 2, v.end());
+	std::vector<FDMVector3> ev = pv;
+	double ru, wu;
+	FDMBLAS3::PipelinedCGUpdate(alpha, beta, n, mv,
+		&pv[0], &pv[1], &pv[2], &pv[3], &pv[4], &pv[5], &pv[6], &pv[7], &ru, &wu);
+
+	// z, q, s, p, x, r, u, w
+	FDMBLAS3::AXPlusY(beta, ev[0], n, &ev[0]);
+	FDMBLAS3::AXPlusY(beta, ev[1], mv, &ev[1]);
+	FDMBLAS3::AXPlusY(beta, ev[2], ev[7], &ev[2]);
+	FDMBLAS3::AXPlusY(beta, ev[3], ev[6], &ev[3]);
+	FDMBLAS3::AXPlusY(alpha, ev[3], ev[4], &ev[4]);
+	FDMBLAS3::AXPlusY(-alpha, ev[2], ev[5], &ev[5]);
+	FDMBLAS3::AXPlusY(-alpha, ev[1], ev[6], &ev[6]);
+	FDMBLAS3::AXPlusY(-alpha, ev[0], ev[7], &ev[7]);
+	EXPECT_NEAR(FDMBLAS3::Dot(ev[5], ev[6]), ru, 1e-10);
+	EXPECT_NEAR(FDMBLAS3::Dot(ev[7], ev[6]), wu, 1e-10);
+	for (size_t l = 0; l < pv.size(); ++l)
+	{
+		pv[l].ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_EQ(ev[l](i, j, k), pv[l](i, j, k));
+		});
+	}
+}
\ No newline at end of file
@@ -4,6 +4,66 @@
 
 using namespace CubbyFlow;
 
+namespace
+{
+	void BuildTestSystem(FDMMGLinearSystem3* system, size_t levels)
+	{
+		system->ResizeWithCoarsest({ 4, 4, 4 }, levels);
+
+		// Simple Poisson eq.
+		for (size_t l = 0; l < system->GetNumberOfLevels(); ++l)
+		{
+			double invdx = pow(0.5, l);
+			FDMMatrix3& A = system->A[l];
+			FDMVector3& b = system->b[l];
+
+			system->x[l].Set(0);
+
+			A.ForEachIndex([&](size_t i, size_t j, size_t k)
+			{
+				if (i > 0)
+				{
+					A(i, j, k).center += invdx * invdx;
+				}
+				if (i < A.Width() - 1)
+				{
+					A(i, j, k).center += invdx * invdx;
+					A(i, j, k).right -= invdx * invdx;
+				}
+
+				if (j > 0)
+				{
+					A(i, j, k).center += invdx * invdx;
+				}
+				else
+				{
+					b(i, j, k) += invdx;
+				}
+
+				if (j < A.Height() - 1)
+				{
+					A(i, j, k).center += invdx * invdx;
+					A(i, j, k).up -= invdx * invdx;
+				}
+				else
+				{
+					b(i, j, k) -= invdx;
+				}
+
+				if (k > 0)
+				{
+					A(i, j, k).center += invdx * invdx;
+				}
+				if (k < A.Depth() - 1)
+				{
+					A(i, j, k).center += invdx * invdx;
+					A(i, j, k).front -= invdx * invdx;
+				}
+			});
+		}
+	}
+}
+
 TEST(FDMMGPCGSolver3, Solve)
 {
 	const size_t levels = 4;
@@ -64,4 +124,31 @@ TEST(FDMMGPCGSolver3, Solve)
 
 	FDMMGPCGSolver3 solver(50, levels, 5, 5, 10, 10, 1e-4, 1.5, false);
 	EXPECT_TRUE(solver.Solve(&system));
+}
+
+TEST(FDMMGPCGSolver3, SolveFusedAndPipelined)
+{
+	const size_t levels = 4;
+	FDMMGLinearSystem3 system;
+	BuildTestSystem(&system, levels);
+
+	FDMMGPCGSolver3 solver(50, levels, 5, 5, 10, 10, 1e-9, 1.5, false);
+	EXPECT_EQ(CGMethod::Standard, solver.GetCGMethod());
+	EXPECT_TRUE(solver.Solve(&system));
+	const FDMVector3 expected = system.x.levels.front();
+	const unsigned int numIter = solver.GetLastNumberOfIterations();
+
+	for (CGMethod method : { CGMethod::Fused, CGMethod::Pipelined })
+	{
+		solver.SetCGMethod(method);
+		EXPECT_EQ(method, solver.GetCGMethod());
+		EXPECT_TRUE(solver.Solve(&system));
+		EXPECT_GT(solver.GetTolerance(), solver.GetLastResidual());
+		EXPECT_LE(solver.GetLastNumberOfIterations(), numIter + 2);
+
+		expected.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected(i, j, k), system.x.levels.front()(i, j, k), 1e-7);
+		});
+	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "pch.h"
 
+#include <Array/Array1.h>
 #include <Grid/FaceCenteredGrid3.h>
 
 using namespace CubbyFlow;
@@ -304,6 +305,48 @@ TEST(FaceCenteredGrid3, Sample)
 	});
 }
 
+TEST(FaceCenteredGrid3, Samplers)
+{
+	FaceCenteredGrid3 grid(5, 8, 6, 2.0, 3.0, 1.5);
+	grid.Fill([&](const Vector3D& x)
+	{
+		return Vector3D(3.0 * x.y + 1.0, 5.0 * x.z + 7.0, -1.0 * x.x - 9.0);
+	});
+
+	auto linearSampler = grid.LinearSampler();
+	auto cubicSampler = grid.CubicSampler();
+	auto sampler = grid.Sampler();
+
+	Array1<Vector3D> points;
+	auto pos = grid.CellCenterPosition();
+	grid.ForEachCellIndex([&](size_t i, size_t j, size_t k)
+	{
+		points.Append(pos(i, j, k) + Vector3D(0.3, -0.2, 0.1));
+	});
+
+	Array1<Vector3D> values(points.size());
+	linearSampler(points.ConstAccessor(), values.Accessor());
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		const Vector3D& x = points[i];
+		Vector3D expected = grid.Sample(x);
+		EXPECT_EQ(expected, linearSampler(x));
+		EXPECT_EQ(expected, sampler(x));
+		EXPECT_EQ(expected, values[i]);
+
+		// Cubic interpolation is exact for linear fields away from the boundary
+		Vector3D cubic = cubicSampler(x);
+		Vector3D exact = Vector3D(3.0 * x.y + 1.0, 5.0 * x.z + 7.0, -1.0 * x.x - 9.0);
+		if (x.x > 4.0 && x.x < 6.0 && x.y > 6.0 && x.y < 18.0 && x.z > 3.0 && x.z < 6.0)
+		{
+			EXPECT_NEAR(exact.x, cubic.x, 1e-6);
+			EXPECT_NEAR(exact.y, cubic.y, 1e-6);
+			EXPECT_NEAR(exact.z, cubic.z, 1e-6);
+		}
+	}
+}
+
 TEST(FaceCenteredGrid3, Builder)
 {
 	{
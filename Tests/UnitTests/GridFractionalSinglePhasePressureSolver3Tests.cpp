@@ -1,6 +1,8 @@
 #include "pch.h"
 
 #include <Grid/CellCenteredScalarGrid3.h>
+#include <Solver/FDM/FDMAMGPCGSolver3.h>
+#include <Solver/FDM/FDMICCGSolver3.h>
 #include <Solver/Grid/GridFractionalSinglePhasePressureSolver3.h>
 
 using namespace CubbyFlow;
@@ -168,4 +170,102 @@ TEST(GridFractionalSinglePhasePressureSolver3, SolveFreeSurfaceCompressed)
             }
         }
     }
+}
+
+TEST(GridFractionalSinglePhasePressureSolver3, SolveCompressedAMGPCG)
+{
+    const size_t n = 20;
+
+    FaceCenteredGrid3 vel(n, n, n);
+    CellCenteredScalarGrid3 fluidSDF(n, n, n);
+
+    // Irregular fluid region: a pool with a drop above it
+    vel.Fill([](const Vector3D& x)
+    {
+        return Vector3D(std::sin(x.x + x.z), std::cos(0.5 * x.y), 0.1 * x.z);
+    });
+
+    fluidSDF.Fill([&](const Vector3D& x)
+    {
+        const double pool = x.y - 6.0;
+        const double drop = x.DistanceTo(Vector3D(10.0, 13.0, 10.0)) - 4.0;
+        return std::min(pool, drop);
+    });
+
+    FaceCenteredGrid3 velICCG(vel);
+
+    GridFractionalSinglePhasePressureSolver3 solver;
+    solver.SetLinearSystemSolver(std::make_shared<FDMAMGPCGSolver3>(100, 1e-12));
+    solver.Solve(vel, 1.0, &vel,
+        ConstantScalarField3(std::numeric_limits<double>::max()),
+        ConstantVectorField3({ 0, 0, 0 }),
+        fluidSDF, true);
+
+    GridFractionalSinglePhasePressureSolver3 solverICCG;
+    solverICCG.SetLinearSystemSolver(std::make_shared<FDMICCGSolver3>(1000, 1e-12));
+    solverICCG.Solve(velICCG, 1.0, &velICCG,
+        ConstantScalarField3(std::numeric_limits<double>::max()),
+        ConstantVectorField3({ 0, 0, 0 }),
+        fluidSDF, true);
+
+    const auto amg = std::dynamic_pointer_cast<FDMAMGPCGSolver3>(solver.GetLinearSystemSolver());
+    const auto iccg = std::dynamic_pointer_cast<FDMICCGSolver3>(solverICCG.GetLinearSystemSolver());
+    EXPECT_LT(1u, amg->GetNumberOfLevels());
+    EXPECT_LT(amg->GetLastNumberOfIterations(), iccg->GetLastNumberOfIterations());
+
+    const auto& pressure = solver.GetPressure();
+    const auto& pressureICCG = solverICCG.GetPressure();
+    pressure.ForEachIndex([&](size_t i, size_t j, size_t k)
+    {
+        EXPECT_NEAR(pressureICCG(i, j, k), pressure(i, j, k), 1e-6);
+    });
+}
+
+TEST(GridFractionalSinglePhasePressureSolver3, RestoresLinearSystemSolverSettings)
+{
+    const size_t n = 16;
+
+    FaceCenteredGrid3 vel(n, n, n);
+    CellCenteredScalarGrid3 fluidSDF(n, n, n);
+
+    vel.Fill([](const Vector3D& x)
+    {
+        return Vector3D(std::sin(x.x + x.z), std::cos(0.5 * x.y), 0.1 * x.z);
+    });
+
+    fluidSDF.Fill([&](const Vector3D& x)
+    {
+        return x.y - 10.0;
+    });
+
+    const auto linearSolver = std::make_shared<FDMICCGSolver3>(1000, 1e-9);
+
+    GridFractionalSinglePhasePressureSolver3 solver;
+    solver.SetLinearSystemSolver(linearSolver);
+    solver.SetUseAdaptiveTolerance(true);
+    solver.SetUseWarmStart(true);
+
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        FaceCenteredGrid3 output(vel);
+        solver.Solve(vel, 0.1, &output,
+            ConstantScalarField3(std::numeric_limits<double>::max()),
+            ConstantVectorField3({ 0, 0, 0 }),
+            fluidSDF);
+
+        EXPECT_NE(1e-9, solver.GetLastStats().tolerance);
+        EXPECT_EQ(frame > 0, solver.GetLastStats().isWarmStarted);
+        EXPECT_DOUBLE_EQ(1e-9, linearSolver->GetTolerance());
+        EXPECT_FALSE(linearSolver->GetUseInitialGuess());
+    }
+
+    solver.SetUseAdaptiveTolerance(false);
+    FaceCenteredGrid3 output(vel);
+    solver.Solve(vel, 0.1, &output,
+        ConstantScalarField3(std::numeric_limits<double>::max()),
+        ConstantVectorField3({ 0, 0, 0 }),
+        fluidSDF);
+
+    EXPECT_DOUBLE_EQ(1e-9, solver.GetLastStats().tolerance);
+    EXPECT_DOUBLE_EQ(1e-9, linearSolver->GetTolerance());
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "pch.h"
 
 #include <Grid/CellCenteredScalarGrid3.h>
+#include <Solver/FDM/FDMCGSolver3.h>
+#include <Solver/FDM/FDMMGPCGSolver3.h>
 #include <Solver/Grid/GridSinglePhasePressureSolver3.h>
 
+#include <stdexcept>
+
 using namespace CubbyFlow;
 
 TEST(GridSinglePhasePressureSolver3, SolveSinglePhase)
@@ -422,4 +426,278 @@ TEST(GridSinglePhasePressureSolver3, SolveFreeSurfaceWithBoundary)
 			}
 		}
 	}
+}
+
+TEST(GridSinglePhasePressureSolver3, SolveMatrixFree)
+{
+	const Size3 res(32, 32, 32);
+	const Vector3D h(1.0 / 32.0, 1.0 / 32.0, 1.0 / 32.0);
+
+	FaceCenteredGrid3 vel(res, h);
+	CellCenteredScalarGrid3 fluidSDF(res, h);
+	CellCenteredScalarGrid3 boundarySDF(res, h);
+
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.y), std::cos(2.0 * x.z), x.x * x.y);
+	});
+
+	// Solid sphere in the lower half of a pool
+	boundarySDF.Fill([](const Vector3D& x)
+	{
+		return x.DistanceTo(Vector3D(0.5, 0.3, 0.5)) - 0.2;
+	});
+	fluidSDF.Fill([](const Vector3D& x)
+	{
+		return x.y - 0.7;
+	});
+
+	const std::vector<FDMLinearSystemSolver3Ptr> solvers =
+	{
+		std::make_shared<FDMCGSolver3>(500, 1e-9),
+		std::make_shared<FDMMGPCGSolver3>(200, 4, 5, 5, 10, 10, 1e-9, 1.5, true)
+	};
+
+	for (const auto& linearSolver : solvers)
+	{
+		FaceCenteredGrid3 stored(res, h);
+		FaceCenteredGrid3 matrixFree(res, h);
+
+		GridSinglePhasePressureSolver3 solver;
+		solver.SetLinearSystemSolver(linearSolver);
+		EXPECT_FALSE(solver.GetUseMatrixFree());
+		solver.Solve(vel, 1.0, &stored, boundarySDF, ConstantVectorField3({ 0, 0, 0 }), fluidSDF);
+
+		solver.SetUseMatrixFree(true);
+		EXPECT_TRUE(solver.GetUseMatrixFree());
+		solver.Solve(vel, 1.0, &matrixFree, boundarySDF, ConstantVectorField3({ 0, 0, 0 }), fluidSDF);
+
+		matrixFree.ForEachUIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(stored.GetU(i, j, k), matrixFree.GetU(i, j, k), 1e-6);
+		});
+		matrixFree.ForEachVIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(stored.GetV(i, j, k), matrixFree.GetV(i, j, k), 1e-6);
+		});
+		matrixFree.ForEachWIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(stored.GetW(i, j, k), matrixFree.GetW(i, j, k), 1e-6);
+		});
+	}
+}
+
+TEST(GridSinglePhasePressureSolver3, SolveWarmStart)
+{
+	const Size3 res(32, 32, 32);
+	const Vector3D h(1.0 / 32.0, 1.0 / 32.0, 1.0 / 32.0);
+
+	FaceCenteredGrid3 vel(res, h);
+	FaceCenteredGrid3 vel2(res, h);
+	CellCenteredScalarGrid3 fluidSDF(res, h);
+
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.x + x.y), std::cos(2.0 * x.y), x.x * x.z);
+	});
+
+	// Next step: slightly changed velocity with the same surface
+	vel2.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.x + x.y), std::cos(2.0 * x.y), x.x * x.z) + Vector3D(0.0, 1e-3 * x.x * x.y, 0.0);
+	});
+
+	fluidSDF.Fill([](const Vector3D& x)
+	{
+		return x.y - 0.7;
+	});
+
+	for (bool useCompressed : { false, true })
+	{
+		FaceCenteredGrid3 output(res, h);
+		FaceCenteredGrid3 expected(res, h);
+
+		GridSinglePhasePressureSolver3 reference;
+		reference.SetLinearSystemSolver(std::make_shared<FDMCGSolver3>(500, 1e-9));
+		reference.Solve(vel2, 1.0, &expected, ConstantScalarField3(std::numeric_limits<double>::max()),
+			ConstantVectorField3({ 0, 0, 0 }), fluidSDF, useCompressed);
+		const unsigned int coldIterations = reference.GetLastStats().numberOfIterations;
+		EXPECT_FALSE(reference.GetLastStats().isWarmStarted);
+
+		GridSinglePhasePressureSolver3 solver;
+		solver.SetLinearSystemSolver(std::make_shared<FDMCGSolver3>(500, 1e-9));
+		EXPECT_FALSE(solver.GetUseWarmStart());
+		solver.SetUseWarmStart(true);
+		EXPECT_TRUE(solver.GetUseWarmStart());
+
+		solver.Solve(vel, 1.0, &output, ConstantScalarField3(std::numeric_limits<double>::max()),
+			ConstantVectorField3({ 0, 0, 0 }), fluidSDF, useCompressed);
+		EXPECT_FALSE(solver.GetLastStats().isWarmStarted);
+
+		solver.Solve(vel2, 1.0, &output, ConstantScalarField3(std::numeric_limits<double>::max()),
+			ConstantVectorField3({ 0, 0, 0 }), fluidSDF, useCompressed);
+
+		const auto& stats = solver.GetLastStats();
+		EXPECT_TRUE(stats.isWarmStarted);
+		EXPECT_LT(stats.numberOfIterations, coldIterations * 4 / 5);
+		EXPECT_GT(1e-9, stats.lastResidual);
+		EXPECT_DOUBLE_EQ(1e-9, stats.tolerance);
+		EXPECT_LE(0.0, stats.elapsedTimeInSeconds);
+		ASSERT_EQ(stats.numberOfIterations + 1, stats.residualHistory.size());
+		EXPECT_DOUBLE_EQ(stats.lastResidual, stats.residualHistory.back());
+		EXPECT_LT(stats.residualHistory.back(), stats.residualHistory.front());
+		EXPECT_EQ(2u, solver.GetStatsHistory().size());
+
+		solver.ClearStatsHistory();
+		EXPECT_EQ(0u, solver.GetStatsHistory().size());
+
+		output.ForEachUIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected.GetU(i, j, k), output.GetU(i, j, k), 1e-6);
+		});
+		output.ForEachVIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected.GetV(i, j, k), output.GetV(i, j, k), 1e-6);
+		});
+		output.ForEachWIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_NEAR(expected.GetW(i, j, k), output.GetW(i, j, k), 1e-6);
+		});
+	}
+}
+
+TEST(GridSinglePhasePressureSolver3, SolveAdaptiveTolerance)
+{
+	const Size3 res(16, 16, 16);
+	const Vector3D h(1.0 / 16.0, 1.0 / 16.0, 1.0 / 16.0);
+
+	FaceCenteredGrid3 vel(res, h);
+	FaceCenteredGrid3 output(res, h);
+	CellCenteredScalarGrid3 fluidSDF(res, h);
+
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.x + x.y), std::cos(2.0 * x.y), x.x * x.z);
+	});
+	fluidSDF.Fill([](const Vector3D& x)
+	{
+		return x.y - 0.7;
+	});
+
+	const auto linearSolver = std::make_shared<FDMCGSolver3>(500, 1e-9);
+
+	GridSinglePhasePressureSolver3 solver;
+	solver.SetLinearSystemSolver(linearSolver);
+	solver.SetUseAdaptiveTolerance(true);
+	solver.SetRelativeTolerance(1e-4);
+	solver.SetMinTolerance(1e-12);
+	EXPECT_TRUE(solver.GetUseAdaptiveTolerance());
+	EXPECT_DOUBLE_EQ(1e-4, solver.GetRelativeTolerance());
+	EXPECT_DOUBLE_EQ(1e-12, solver.GetMinTolerance());
+
+	const double dt = 0.1;
+	solver.Solve(vel, dt, &output, ConstantScalarField3(std::numeric_limits<double>::max()),
+		ConstantVectorField3({ 0, 0, 0 }), fluidSDF);
+
+	const auto& stats = solver.GetLastStats();
+	EXPECT_LT(0.0, stats.maxDivergence);
+	EXPECT_LT(1.0, stats.cfl);
+	EXPECT_DOUBLE_EQ(1e-4 * stats.maxDivergence / stats.cfl, stats.tolerance);
+	EXPECT_GT(stats.tolerance, stats.lastResidual);
+
+	// The linear system solver keeps its own settings
+	EXPECT_DOUBLE_EQ(1e-9, linearSolver->GetTolerance());
+	EXPECT_FALSE(linearSolver->GetUseInitialGuess());
+
+	solver.SetUseAdaptiveTolerance(false);
+	solver.Solve(vel, dt, &output, ConstantScalarField3(std::numeric_limits<double>::max()),
+		ConstantVectorField3({ 0, 0, 0 }), fluidSDF);
+
+	EXPECT_DOUBLE_EQ(1e-9, solver.GetLastStats().tolerance);
+	EXPECT_DOUBLE_EQ(1e-9, linearSolver->GetTolerance());
+}
+
+TEST(GridSinglePhasePressureSolver3, StatsHistoryLength)
+{
+	const Size3 res(8, 8, 8);
+	const Vector3D h(1.0 / 8.0, 1.0 / 8.0, 1.0 / 8.0);
+
+	FaceCenteredGrid3 vel(res, h);
+	FaceCenteredGrid3 output(res, h);
+
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.x + x.y), std::cos(2.0 * x.y), x.x * x.z);
+	});
+
+	GridSinglePhasePressureSolver3 solver;
+	solver.SetLinearSystemSolver(std::make_shared<FDMCGSolver3>(100, 1e-9));
+	solver.SetMaxStatsHistoryLength(3);
+	EXPECT_EQ(3u, solver.GetMaxStatsHistoryLength());
+
+	for (int frame = 0; frame < 5; ++frame)
+	{
+		solver.Solve(vel, 1.0, &output);
+		EXPECT_EQ(std::min(frame + 1, 3), static_cast<int>(solver.GetStatsHistory().size()));
+	}
+
+	solver.SetMaxStatsHistoryLength(1);
+	EXPECT_EQ(1u, solver.GetStatsHistory().size());
+
+	solver.SetMaxStatsHistoryLength(0);
+	solver.Solve(vel, 1.0, &output);
+	EXPECT_EQ(0u, solver.GetStatsHistory().size());
+	EXPECT_LT(0u, solver.GetLastStats().numberOfIterations);
+}
+
+namespace
+{
+	class ThrowingSolver3 final : public FDMLinearSystemSolver3
+	{
+	public:
+		bool Solve(FDMLinearSystem3*) override
+		{
+			throw std::runtime_error("Solve failed");
+		}
+
+		double GetTolerance() const override
+		{
+			return m_tolerance;
+		}
+
+		void SetTolerance(double tolerance) override
+		{
+			m_tolerance = tolerance;
+		}
+
+	private:
+		double m_tolerance = 1e-9;
+	};
+}
+
+TEST(GridSinglePhasePressureSolver3, SolveRestoresSettingsOnException)
+{
+	const Size3 res(8, 8, 8);
+	const Vector3D h(1.0 / 8.0, 1.0 / 8.0, 1.0 / 8.0);
+
+	FaceCenteredGrid3 vel(res, h);
+	FaceCenteredGrid3 output(res, h);
+
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(std::sin(3.0 * x.x + x.y), std::cos(2.0 * x.y), x.x * x.z);
+	});
+
+	const auto linearSolver = std::make_shared<ThrowingSolver3>();
+	linearSolver->SetUseInitialGuess(true);
+
+	GridSinglePhasePressureSolver3 solver;
+	solver.SetLinearSystemSolver(linearSolver);
+	solver.SetUseAdaptiveTolerance(true);
+
+	EXPECT_THROW(solver.Solve(vel, 1.0, &output), std::runtime_error);
+
+	EXPECT_DOUBLE_EQ(1e-9, linearSolver->GetTolerance());
+	EXPECT_TRUE(linearSolver->GetUseInitialGuess());
+	EXPECT_EQ(0u, solver.GetStatsHistory().size());
 }
\ No newline at end of file
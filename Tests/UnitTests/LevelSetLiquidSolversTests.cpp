@@ -5,6 +5,8 @@
 #include <Size/Size2.h>
 #include <Size/Size3.h>
 #include <Solver/LevelSet/LevelSetLiquidSolver2.h>
+#include <Solver/LevelSet/FIMLevelSetSolver3.h>
+#include <Solver/LevelSet/FMMLevelSetSolver3.h>
 #include <Solver/LevelSet/LevelSetLiquidSolver3.h>
 #include <Surface/Implicit/ImplicitSurface2.h>
 #include <Surface/Implicit/ImplicitSurfaceSet2.h>
@@ -67,4 +69,160 @@ TEST(LevelSetLiquidSolver3, ComputeVolume)
 	const double ans = 4.0 / 3.0 * Cubic(radius) * PI_DOUBLE;
 
 	EXPECT_NEAR(ans, volume, 0.001);
+}
+
+TEST(LevelSetLiquidSolver3, NarrowBand)
+{
+	auto setUp = [](LevelSetLiquidSolver3* solver)
+	{
+		auto data = solver->GetGridSystemData();
+		double dx = 1.0 / 24.0;
+		data->Resize(Size3(24, 24, 24), Vector3D(dx, dx, dx), Vector3D());
+
+		BoundingBox3D domain = data->GetBoundingBox();
+		ImplicitSurfaceSet3 surfaceSet;
+		surfaceSet.AddExplicitSurface(std::make_shared<Sphere3>(domain.MidPoint() + Vector3D(0.0, 0.1, 0.0), 0.2));
+
+		solver->GetSignedDistanceField()->Fill([&](const Vector3D& x)
+		{
+			return surfaceSet.SignedDistance(x);
+		});
+	};
+
+	LevelSetLiquidSolver3 dense;
+	setUp(&dense);
+
+	LevelSetLiquidSolver3 narrow;
+	setUp(&narrow);
+	narrow.SetIsNarrowBandEnabled(true);
+	EXPECT_DOUBLE_EQ(6.0, narrow.GetNarrowBandWidth());
+
+	for (Frame frame(0, 1.0 / 60.0); frame.index < 3; ++frame)
+	{
+		dense.Update(frame);
+		narrow.Update(frame);
+	}
+
+	const NarrowBand3& band = narrow.GetNarrowBand();
+	EXPECT_GT(band.size(), 0u);
+	EXPECT_LT(band.size(), 24u * 24u * 24u);
+
+	auto denseSDF = dense.GetSignedDistanceField();
+	auto narrowSDF = narrow.GetSignedDistanceField();
+	const double h = 1.0 / 24.0;
+
+	// The interface and the volume agree with the full-grid solver
+	denseSDF->ForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+	{
+		if (std::fabs((*denseSDF)(i, j, k)) < 2.0 * h)
+		{
+			EXPECT_TRUE(band.Contains(i, j, k));
+			EXPECT_NEAR((*denseSDF)(i, j, k), (*narrowSDF)(i, j, k), 0.25 * h);
+		}
+		else if (!band.Contains(i, j, k))
+		{
+			EXPECT_DOUBLE_EQ(std::copysign(6.0 * h, (*denseSDF)(i, j, k)), (*narrowSDF)(i, j, k));
+		}
+	});
+
+	EXPECT_NEAR(dense.ComputeVolume(), narrow.ComputeVolume(), 0.01 * dense.ComputeVolume());
+}
+
+TEST(LevelSetLiquidSolver3, NarrowBandMovingInterface)
+{
+	// A slab of liquid rising at unit speed crosses more than the band width
+	const double h = 1.0 / 24.0;
+	const double bottom0 = 0.3;
+	const double top0 = 0.5;
+
+	LevelSetLiquidSolver3 solver;
+	auto data = solver.GetGridSystemData();
+	data->Resize(Size3(24, 24, 24), Vector3D(h, h, h), Vector3D());
+	data->GetVelocity()->Fill(Vector3D(0.0, 1.0, 0.0));
+
+	solver.SetGravity(Vector3D());
+	solver.SetIsNarrowBandEnabled(true);
+	solver.GetSignedDistanceField()->Fill([&](const Vector3D& x)
+	{
+		return std::max(bottom0 - x.y, x.y - top0);
+	});
+
+	Frame frame(0, 1.0 / 60.0);
+	for (; frame.index < 20; ++frame)
+	{
+		solver.Update(frame);
+	}
+
+	const double t = frame.TimeInSeconds();
+	const double bottom = bottom0 + t;
+	const double top = top0 + t;
+	ASSERT_LT(solver.GetNarrowBandWidth() * h, t);
+
+	auto sdf = solver.GetSignedDistanceField();
+	EXPECT_NEAR(0.0, sdf->Sample(Vector3D(0.5, bottom, 0.5)), 0.5 * h);
+	EXPECT_NEAR(0.0, sdf->Sample(Vector3D(0.5, top, 0.5)), 0.5 * h);
+
+	// Away from the band, the air is at rest as in the dense mode, including
+	// the faces that were in the band at the start
+	const double margin = (solver.GetNarrowBandWidth() + 3.0) * h;
+	auto vel = data->GetVelocity();
+	auto vPos = vel->GetVPosition();
+	vel->ForEachVIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double y = vPos(i, j, k).y;
+		if (y < bottom - margin || y > top + margin)
+		{
+			EXPECT_DOUBLE_EQ(0.0, vel->GetV(i, j, k)) << y;
+		}
+	});
+
+	EXPECT_NEAR(1.0, vel->GetV(12, 16, 12), 1e-3);
+	EXPECT_NEAR(1.0 / (60.0 * h), solver.GetCFL(1.0 / 60.0), 1e-3);
+}
+
+TEST(LevelSetLiquidSolver3, FIMLevelSetSolver)
+{
+	auto setUp = [](LevelSetLiquidSolver3* solver)
+	{
+		auto data = solver->GetGridSystemData();
+		double dx = 1.0 / 24.0;
+		data->Resize(Size3(24, 24, 24), Vector3D(dx, dx, dx), Vector3D());
+
+		BoundingBox3D domain = data->GetBoundingBox();
+		ImplicitSurfaceSet3 surfaceSet;
+		surfaceSet.AddExplicitSurface(std::make_shared<Sphere3>(domain.MidPoint() + Vector3D(0.0, 0.1, 0.0), 0.2));
+
+		solver->GetSignedDistanceField()->Fill([&](const Vector3D& x)
+		{
+			return surfaceSet.SignedDistance(x);
+		});
+	};
+
+	LevelSetLiquidSolver3 fmm;
+	setUp(&fmm);
+	fmm.SetLevelSetSolver(std::make_shared<FMMLevelSetSolver3>());
+
+	LevelSetLiquidSolver3 fim;
+	setUp(&fim);
+	fim.SetLevelSetSolver(std::make_shared<FIMLevelSetSolver3>());
+
+	for (Frame frame(0, 1.0 / 60.0); frame.index < 3; ++frame)
+	{
+		fmm.Update(frame);
+		fim.Update(frame);
+	}
+
+	auto fmmSDF = fmm.GetSignedDistanceField();
+	auto fimSDF = fim.GetSignedDistanceField();
+	const double h = 1.0 / 24.0;
+
+	fmmSDF->ForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+	{
+		if (std::fabs((*fmmSDF)(i, j, k)) < 2.0 * h)
+		{
+			EXPECT_NEAR((*fmmSDF)(i, j, k), (*fimSDF)(i, j, k), 0.25 * h);
+		}
+	});
+
+	EXPECT_NEAR(fmm.ComputeVolume(), fim.ComputeVolume(), 0.02 * fmm.ComputeVolume());
 }
\ No newline at end of file
@@ -4,10 +4,12 @@
 #include <Grid/CellCenteredScalarGrid3.h>
 #include <Solver/LevelSet/ENOLevelSetSolver2.h>
 #include <Solver/LevelSet/ENOLevelSetSolver3.h>
+#include <Solver/LevelSet/FIMLevelSetSolver3.h>
 #include <Solver/LevelSet/FMMLevelSetSolver2.h>
 #include <Solver/LevelSet/FMMLevelSetSolver3.h>
 #include <Solver/LevelSet/UpwindLevelSetSolver2.h>
 #include <Solver/LevelSet/UpwindLevelSetSolver3.h>
+#include <Utils/Parallel.h>
 
 using namespace CubbyFlow;
 
@@ -203,6 +205,37 @@ TEST(ENOLevelSetSolver3, Extrapolate)
 	}
 }
 
+TEST(ENOLevelSetSolver3, ReinitializeNarrowBand)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), dense(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return 1.2 * ((x - Vector3D(20, 15, 20)).Length() - 8.0);
+	});
+
+	ENOLevelSetSolver3 solver;
+	solver.Reinitialize(sdf, 3.0, &dense);
+
+	NarrowBand3 band;
+	band.Build(sdf.GetDataAccessor(), 6.0);
+
+	CellCenteredScalarGrid3 narrow(sdf);
+	solver.ReinitializeNarrowBand(narrow, band, 3.0, &narrow);
+
+	band.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double exact = (sdf.GetDataPosition()(i, j, k) - Vector3D(20, 15, 20)).Length() - 8.0;
+		if (std::fabs(exact) < 2.0)
+		{
+			EXPECT_NEAR(dense(i, j, k), narrow(i, j, k), 0.05)
+				<< i << ", " << j << ", " << k;
+			EXPECT_NEAR(exact, narrow(i, j, k), 0.2)
+				<< i << ", " << j << ", " << k;
+		}
+	});
+}
+
 TEST(FMMLevelSetSolver2, Reinitialize)
 {
 	CellCenteredScalarGrid2 sdf(40, 30), temp(40, 30);
@@ -297,4 +330,217 @@ TEST(FMMLevelSetSolver3, Extrapolate)
 			}
 		}
 	}
+}
+
+TEST(FMMLevelSetSolver3, ReinitializeNarrowBand)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), dense(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return 1.2 * ((x - Vector3D(20.3, 15.1, 19.7)).Length() - 8.0);
+	});
+
+	FMMLevelSetSolver3 solver;
+	solver.Reinitialize(sdf, 3.0, &dense);
+
+	NarrowBand3 band;
+	band.Build(sdf.GetDataAccessor(), 5.0);
+
+	CellCenteredScalarGrid3 narrow(sdf);
+	solver.ReinitializeNarrowBand(narrow, band, 3.0, &narrow);
+
+	band.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		if (std::fabs(dense(i, j, k)) < 3.0)
+		{
+			EXPECT_NEAR(dense(i, j, k), narrow(i, j, k), 1e-12)
+				<< i << ", " << j << ", " << k;
+		}
+	});
+
+	// Points outside of the band are left as they are
+	EXPECT_DOUBLE_EQ(sdf(0, 0, 0), narrow(0, 0, 0));
+}
+
+TEST(FMMLevelSetSolver3, ExtrapolateNarrowBand)
+{
+	FaceCenteredGrid3 vel(40, 30, 50), dense(40, 30, 50);
+	CellCenteredScalarGrid3 sdf(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return (x - Vector3D(20.3, 15.1, 19.7)).Length() - 8.0;
+	});
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(x.y, std::sin(x.z), x.x * x.z);
+	});
+
+	FMMLevelSetSolver3 solver;
+	solver.Extrapolate(vel, sdf, 3.0, &dense);
+
+	NarrowBand3 band;
+	band.Build(sdf.GetDataAccessor(), 5.0);
+
+	FaceCenteredGrid3 narrow(vel);
+	solver.ExtrapolateNarrowBand(narrow, sdf, band, 3.0, &narrow);
+
+	vel.ForEachUIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(dense.GetU(i, j, k), narrow.GetU(i, j, k), 1e-12);
+	});
+	vel.ForEachVIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(dense.GetV(i, j, k), narrow.GetV(i, j, k), 1e-12);
+	});
+	vel.ForEachWIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(dense.GetW(i, j, k), narrow.GetW(i, j, k), 1e-12);
+	});
+}
+
+TEST(FIMLevelSetSolver3, Reinitialize)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), temp(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return (x - Vector3D(20, 20, 20)).Length() - 8.0;
+	});
+
+	FIMLevelSetSolver3 solver;
+	solver.Reinitialize(sdf, 5.0, &temp);
+
+	for (size_t k = 0; k < 50; ++k)
+	{
+		for (size_t j = 0; j < 30; ++j)
+		{
+			for (size_t i = 0; i < 40; ++i)
+			{
+				EXPECT_NEAR(sdf(i, j, k), temp(i, j, k), 0.9)
+					<< i << ", " << j << ", " << k;
+			}
+		}
+	}
+}
+
+TEST(FIMLevelSetSolver3, ReinitializeCompareWithFMM)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), fmm(40, 30, 50), fim(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return 1.2 * ((x - Vector3D(20.3, 15.1, 19.7)).Length() - 8.0);
+	});
+
+	FMMLevelSetSolver3 fmmSolver;
+	fmmSolver.Reinitialize(sdf, 5.0, &fmm);
+
+	FIMLevelSetSolver3 fimSolver;
+	fimSolver.Reinitialize(sdf, 5.0, &fim);
+
+	double maxErrorFMM = 0.0;
+	double maxErrorFIM = 0.0;
+
+	sdf.ForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+	{
+		if (std::fabs(fmm(i, j, k)) < 4.0)
+		{
+			EXPECT_NEAR(fmm(i, j, k), fim(i, j, k), 0.1)
+				<< i << ", " << j << ", " << k;
+
+			const double exact = sdf(i, j, k) / 1.2;
+			maxErrorFMM = std::max(maxErrorFMM, std::fabs(fmm(i, j, k) - exact));
+			maxErrorFIM = std::max(maxErrorFIM, std::fabs(fim(i, j, k) - exact));
+		}
+	});
+
+	EXPECT_NEAR(maxErrorFMM, maxErrorFIM, 0.05);
+}
+
+TEST(FIMLevelSetSolver3, ReinitializeIsThreadIndependent)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), serial(40, 30, 50), parallel(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return 1.2 * ((x - Vector3D(20.3, 15.1, 19.7)).Length() - 8.0);
+	});
+
+	FIMLevelSetSolver3 solver;
+
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+	SetMaxNumberOfThreads(1);
+	solver.Reinitialize(sdf, 5.0, &serial);
+	SetMaxNumberOfThreads(4);
+	solver.Reinitialize(sdf, 5.0, &parallel);
+	SetMaxNumberOfThreads(oldNumThreads);
+
+	sdf.ForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_EQ(serial(i, j, k), parallel(i, j, k))
+			<< i << ", " << j << ", " << k;
+	});
+}
+
+TEST(FIMLevelSetSolver3, Extrapolate)
+{
+	CellCenteredScalarGrid3 sdf(40, 30, 50), temp(40, 30, 50);
+	CellCenteredScalarGrid3 field(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return (x - Vector3D(20, 20, 20)).Length() - 8.0;
+	});
+	field.Fill(5.0);
+
+	FIMLevelSetSolver3 solver;
+	solver.Extrapolate(field, sdf, 5.0, &temp);
+
+	for (size_t k = 0; k < 50; ++k)
+	{
+		for (size_t j = 0; j < 30; ++j)
+		{
+			for (size_t i = 0; i < 40; ++i)
+			{
+				EXPECT_DOUBLE_EQ(5.0, temp(i, j, k))
+					<< i << ", " << j << ", " << k;
+			}
+		}
+	}
+}
+
+TEST(FIMLevelSetSolver3, ExtrapolateCompareWithFMM)
+{
+	FaceCenteredGrid3 vel(40, 30, 50), fmm(40, 30, 50), fim(40, 30, 50);
+	CellCenteredScalarGrid3 sdf(40, 30, 50);
+
+	sdf.Fill([](const Vector3D& x)
+	{
+		return (x - Vector3D(20.3, 15.1, 19.7)).Length() - 8.0;
+	});
+	vel.Fill([](const Vector3D& x)
+	{
+		return Vector3D(x.y, std::sin(x.z), x.x * x.z);
+	});
+
+	FMMLevelSetSolver3 fmmSolver;
+	fmmSolver.Extrapolate(vel, sdf, 3.0, &fmm);
+
+	FIMLevelSetSolver3 fimSolver;
+	fimSolver.Extrapolate(vel, sdf, 3.0, &fim);
+
+	vel.ForEachUIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(fmm.GetU(i, j, k), fim.GetU(i, j, k), 1e-12);
+	});
+	vel.ForEachVIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(fmm.GetV(i, j, k), fim.GetV(i, j, k), 1e-12);
+	});
+	vel.ForEachWIndex([&](size_t i, size_t j, size_t k)
+	{
+		EXPECT_NEAR(fmm.GetW(i, j, k), fim.GetW(i, j, k), 1e-12);
+	});
 }
\ No newline at end of file
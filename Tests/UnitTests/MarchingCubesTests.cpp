@@ -0,0 +1,102 @@
+#include "pch.h"
+
+#include <Array/Array3.h>
+#include <MarchingCubes/MarchingCubes.h>
+#include <Utils/Parallel.h>
+
+#include <random>
+
+using namespace CubbyFlow;
+
+namespace
+{
+	void ExpectSameMesh(const TriangleMesh3& expected, const TriangleMesh3& actual)
+	{
+		ASSERT_EQ(expected.NumberOfPoints(), actual.NumberOfPoints());
+		ASSERT_EQ(expected.NumberOfNormals(), actual.NumberOfNormals());
+		ASSERT_EQ(expected.NumberOfTriangles(), actual.NumberOfTriangles());
+
+		for (size_t i = 0; i < expected.NumberOfPoints(); ++i)
+		{
+			EXPECT_EQ(expected.Point(i), actual.Point(i));
+			EXPECT_EQ(expected.Normal(i), actual.Normal(i));
+		}
+
+		for (size_t i = 0; i < expected.NumberOfTriangles(); ++i)
+		{
+			EXPECT_EQ(expected.PointIndex(i), actual.PointIndex(i));
+			EXPECT_EQ(expected.NormalIndex(i), actual.NormalIndex(i));
+		}
+	}
+}
+
+TEST(MarchingCubes, ConnectedSphere)
+{
+	Array3<double> grid(24, 20, 28);
+	grid.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		grid(i, j, k) = (Vector3D(i, j, k) - Vector3D(11.5, 9.0, 14.2)).Length() - 7.3;
+	});
+
+	TriangleMesh3 serial;
+	MarchingCubes(grid.ConstAccessor(), Vector3D(1, 1, 1), Vector3D(), &serial, 0, DIRECTION_ALL, ExecutionPolicy::Serial);
+
+	TriangleMesh3 parallel;
+	MarchingCubes(grid.ConstAccessor(), Vector3D(1, 1, 1), Vector3D(), &parallel, 0, DIRECTION_ALL, ExecutionPolicy::Parallel);
+
+	EXPECT_GT(serial.NumberOfTriangles(), 0u);
+	ExpectSameMesh(serial, parallel);
+
+	// Every vertex is shared by the neighboring triangles of the closed surface
+	std::vector<size_t> valences(parallel.NumberOfPoints(), 0);
+	for (size_t i = 0; i < parallel.NumberOfTriangles(); ++i)
+	{
+		for (size_t v = 0; v < 3; ++v)
+		{
+			++valences[parallel.PointIndex(i)[v]];
+		}
+	}
+
+	for (size_t valence : valences)
+	{
+		EXPECT_GE(valence, 3u);
+	}
+}
+
+TEST(MarchingCubes, SerialAndParallelAreIdentical)
+{
+	std::mt19937 rng{ 0 };
+	std::uniform_real_distribution<> dist{ -1.0, 1.0 };
+
+	Array3<double> grid(17, 13, 31);
+	grid.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		grid(i, j, k) = dist(rng);
+	});
+
+	const int bndFlags[] = { DIRECTION_NONE, DIRECTION_ALL, DIRECTION_LEFT | DIRECTION_UP | DIRECTION_BACK };
+	const size_t numberOfThreads[] = { 1, 3, 8 };
+	const unsigned int maxNumberOfThreads = GetMaxNumberOfThreads();
+
+	for (int bndFlag : bndFlags)
+	{
+		TriangleMesh3 serial;
+		serial.AddPoint(Vector3D(-1, -1, -1));
+		serial.AddNormal(Vector3D(0, 1, 0));
+		MarchingCubes(grid.ConstAccessor(), Vector3D(0.5, 1.0, 0.25), Vector3D(1, 2, 3), &serial, 0.1, bndFlag, ExecutionPolicy::Serial);
+
+		for (size_t n : numberOfThreads)
+		{
+			SetMaxNumberOfThreads(static_cast<unsigned int>(n));
+
+			TriangleMesh3 parallel;
+			parallel.AddPoint(Vector3D(-1, -1, -1));
+			parallel.AddNormal(Vector3D(0, 1, 0));
+			MarchingCubes(grid.ConstAccessor(), Vector3D(0.5, 1.0, 0.25), Vector3D(1, 2, 3), &parallel, 0.1, bndFlag, ExecutionPolicy::Parallel);
+
+			ExpectSameMesh(serial, parallel);
+		}
+	}
+
+	SetMaxNumberOfThreads(maxNumberOfThreads);
+}
\ No newline at end of file
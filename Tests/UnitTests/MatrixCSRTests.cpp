@@ -538,6 +538,119 @@ TEST(MatrixCSR, Builders)
 	}
 }
 
+TEST(MatrixCSR, ParallelBuild)
+{
+	// Tridiagonal matrix
+	const size_t n = 100;
+
+	MatrixCSRD matA;
+	for (size_t i = 0; i < n; ++i)
+	{
+		std::vector<double> row = { 2.0 + i };
+		std::vector<size_t> colIdx = { i };
+
+		if (i > 0)
+		{
+			row.push_back(-1.0);
+			colIdx.push_back(i - 1);
+		}
+		if (i + 1 < n)
+		{
+			row.push_back(-1.0);
+			colIdx.push_back(i + 1);
+		}
+
+		matA.AddRow(row, colIdx);
+	}
+
+	const auto countFunc = [&](size_t i)
+	{
+		return size_t(1) + (i > 0 ? 1 : 0) + (i + 1 < n ? 1 : 0);
+	};
+
+	double scale = 1.0;
+	const auto fillFunc = [&](size_t i, double* nonZeros, size_t* columnIndices)
+	{
+		if (i > 0)
+		{
+			*nonZeros++ = -scale;
+			*columnIndices++ = i - 1;
+		}
+
+		*nonZeros++ = scale * (2.0 + i);
+		*columnIndices++ = i;
+
+		if (i + 1 < n)
+		{
+			*nonZeros = -scale;
+			*columnIndices = i + 1;
+		}
+	};
+
+	MatrixCSRD matB;
+	matB.ParallelBuild(n, n, countFunc, fillFunc);
+	EXPECT_EQ(n, matB.Rows());
+	EXPECT_EQ(n, matB.Cols());
+	EXPECT_EQ(3 * n - 2, matB.NumberOfNonZeros());
+	EXPECT_TRUE(matA.IsEqual(matB));
+
+	scale = 2.0;
+	matB.ParallelRefill(fillFunc);
+	EXPECT_TRUE((2.0 * matA).IsEqual(matB));
+
+	// Rebuilding into a used matrix
+	MatrixCSRD matC = { { 1.0, 2.0 }, { 3.0, 4.0 } };
+	scale = 1.0;
+	matC.ParallelBuild(n, n, countFunc, fillFunc);
+	EXPECT_TRUE(matA.IsEqual(matC));
+
+	matC.ParallelBuild(0, 0, countFunc, fillFunc);
+	EXPECT_EQ(0u, matC.Rows());
+	EXPECT_EQ(0u, matC.NumberOfNonZeros());
+}
+
+TEST(MatrixCSR, MVM)
+{
+	// Rectangular matrix with rows of very different lengths
+	const size_t rows = 300;
+	const size_t cols = 200;
+
+	MatrixCSRD mat;
+	mat.ParallelBuild(rows, cols, [&](size_t i)
+	{
+		return (i % 50 == 0) ? cols : i % 4;
+	}, [&](size_t i, double* nonZeros, size_t* columnIndices)
+	{
+		const size_t n = (i % 50 == 0) ? cols : i % 4;
+		for (size_t jj = 0; jj < n; ++jj)
+		{
+			nonZeros[jj] = static_cast<double>(i + 1) / static_cast<double>(jj + 1);
+			columnIndices[jj] = (n == cols) ? jj : 3 * jj + i % 7;
+		}
+	});
+
+	VectorND vec(cols);
+	vec.ForEachIndex([&](size_t i)
+	{
+		vec[i] = std::sin(static_cast<double>(i));
+	});
+
+	const VectorND expected = mat * vec;
+
+	VectorND result;
+	mat.MVM(vec, &result);
+	EXPECT_EQ(rows, result.size());
+
+	for (size_t i = 0; i < rows; ++i)
+	{
+		EXPECT_DOUBLE_EQ(expected[i], result[i]);
+	}
+
+	MatrixCSRD empty;
+	empty.MVM(VectorND(), &result);
+	EXPECT_EQ(0u, result.size());
+}
+
 TEST(MatrixCSR, OperatorOverloadings)
 {
 	const MatrixCSRD matA = { { 1.0, 2.0, 3.0 }, { 4.0, 5.0, 6.0 } };
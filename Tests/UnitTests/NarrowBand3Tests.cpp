@@ -0,0 +1,167 @@
+#include "pch.h"
+
+#include <Array/Array3.h>
+#include <LevelSet/NarrowBand3.h>
+#include <Vector/Vector3.h>
+
+#include <cmath>
+#include <set>
+
+using namespace CubbyFlow;
+
+namespace
+{
+	Array3<double> MakeSphereSDF(const Size3& size, double radius)
+	{
+		Array3<double> sdf(size);
+		sdf.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			const Vector3D x(i + 0.5, j + 0.5, k + 0.5);
+			sdf(i, j, k) = (x - Vector3D(10.0, 10.0, 10.0)).Length() - radius;
+		});
+
+		return sdf;
+	}
+}
+
+TEST(NarrowBand3, Build)
+{
+	Array3<double> sdf = MakeSphereSDF(Size3(20, 20, 20), 5.0);
+	Array3<double> sdf0(sdf);
+
+	NarrowBand3 band;
+	EXPECT_EQ(0u, band.size());
+
+	band.Build(sdf.Accessor(), 2.0);
+	EXPECT_EQ(Size3(20, 20, 20), band.GetGridSize());
+
+	size_t count = 0;
+	sdf0.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		if (std::fabs(sdf0(i, j, k)) < 2.0)
+		{
+			++count;
+			EXPECT_TRUE(band.Contains(i, j, k));
+			EXPECT_DOUBLE_EQ(sdf0(i, j, k), sdf(i, j, k));
+		}
+		else
+		{
+			EXPECT_FALSE(band.Contains(i, j, k));
+			EXPECT_DOUBLE_EQ(std::copysign(2.0, sdf0(i, j, k)), sdf(i, j, k));
+		}
+	});
+	EXPECT_EQ(count, band.size());
+
+	// Sorted with i running fastest and consistent with the lookup
+	for (size_t n = 0; n < band.size(); ++n)
+	{
+		const Point3UI& pt = band[n];
+		EXPECT_EQ(n, band.IndexOf(pt.x, pt.y, pt.z));
+
+		if (n > 0)
+		{
+			const Point3UI& prev = band[n - 1];
+			EXPECT_LT(prev.x + 20 * (prev.y + 20 * prev.z), pt.x + 20 * (pt.y + 20 * pt.z));
+		}
+	}
+
+	band.Clear();
+	EXPECT_EQ(0u, band.size());
+	EXPECT_EQ(Size3(0, 0, 0), band.GetGridSize());
+}
+
+TEST(NarrowBand3, DilateAndTrim)
+{
+	Array3<double> sdf = MakeSphereSDF(Size3(20, 20, 20), 5.0);
+
+	NarrowBand3 band;
+	band.Build(sdf.Accessor(), 1.0);
+	const size_t numberOfPoints = band.size();
+
+	band.Dilate(2);
+	EXPECT_GT(band.size(), numberOfPoints);
+
+	sdf.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double phi = (Vector3D(i + 0.5, j + 0.5, k + 0.5) - Vector3D(10.0, 10.0, 10.0)).Length() - 5.0;
+		if (std::fabs(phi) < 1.0)
+		{
+			EXPECT_TRUE(band.Contains(i, j, k));
+		}
+	});
+
+	for (size_t n = 0; n < band.size(); ++n)
+	{
+		const Point3UI& pt = band[n];
+		EXPECT_EQ(n, band.IndexOf(pt.x, pt.y, pt.z));
+
+		const std::array<size_t, 6> neighbors = band.GetNeighbors(n);
+		if (pt.x > 0)
+		{
+			EXPECT_EQ(band.IndexOf(pt.x - 1, pt.y, pt.z), neighbors[0]);
+		}
+		if (pt.z + 1 < 20)
+		{
+			EXPECT_EQ(band.IndexOf(pt.x, pt.y, pt.z + 1), neighbors[5]);
+		}
+	}
+
+	band.Trim(sdf.Accessor(), 1.0);
+	EXPECT_EQ(numberOfPoints, band.size());
+
+	for (size_t n = 0; n < band.size(); ++n)
+	{
+		const Point3UI& pt = band[n];
+		EXPECT_EQ(n, band.IndexOf(pt.x, pt.y, pt.z));
+		EXPECT_LT(std::fabs(sdf(pt)), 1.0);
+	}
+}
+
+TEST(NarrowBand3, Faces)
+{
+	Array3<double> sdf = MakeSphereSDF(Size3(20, 20, 20), 5.0);
+
+	NarrowBand3 band;
+	band.Build(sdf.Accessor(), 1.5);
+
+	for (size_t axis = 0; axis < 3; ++axis)
+	{
+		std::set<size_t> faceIndices;
+		band.ForEachFaceIndex(axis, [&](size_t f, size_t i, size_t j, size_t k)
+		{
+			EXPECT_TRUE(faceIndices.insert(f).second);
+			EXPECT_EQ(f, band.FaceIndexOf(axis, i, j, k));
+
+			// One of the adjacent points is in the band
+			Point3UI lower(i, j, k);
+			const bool hasUpper = lower[axis] < 20 && band.Contains(i, j, k);
+			bool hasLower = false;
+			if (lower[axis] > 0)
+			{
+				--lower[axis];
+				hasLower = band.Contains(lower.x, lower.y, lower.z);
+			}
+			EXPECT_TRUE(hasUpper || hasLower);
+		});
+
+		// Every face of every point is visited once
+		size_t count = 0;
+		band.ForEachIndex([&](size_t i, size_t j, size_t k)
+		{
+			Point3UI upper(i, j, k);
+			++upper[axis];
+
+			EXPECT_NE(NarrowBand3::NOT_IN_BAND, band.FaceIndexOf(axis, i, j, k));
+			EXPECT_NE(NarrowBand3::NOT_IN_BAND, band.FaceIndexOf(axis, upper.x, upper.y, upper.z));
+
+			if (upper[axis] >= 20 || !band.Contains(upper.x, upper.y, upper.z))
+			{
+				++count;
+			}
+			++count;
+		});
+		EXPECT_EQ(count, faceIndices.size());
+
+		EXPECT_EQ(NarrowBand3::NOT_IN_BAND, band.FaceIndexOf(axis, 0, 0, 0));
+	}
+}
\ No newline at end of file
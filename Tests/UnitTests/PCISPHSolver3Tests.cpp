@@ -25,4 +25,97 @@ TEST(PCISPHSolver3, Parameters)
 
 	solver.SetMaxNumberOfIterations(10);
 	EXPECT_DOUBLE_EQ(10, solver.GetMaxNumberOfIterations());
+}
+
+TEST(PCISPHSolver3, TargetSpacingChange)
+{
+	Array1<Vector3D> points;
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 6; ++j)
+		{
+			for (int i = 0; i < 6; ++i)
+			{
+				points.Append(Vector3D(0.035 * i, 0.035 * j, 0.035 * k));
+			}
+		}
+	}
+
+	// solver2 runs its first frame with a different spacing
+	PCISPHSolver3 solver1(1000.0, 0.05, 1.8);
+	PCISPHSolver3 solver2(1000.0, 0.1, 1.8);
+
+	PCISPHSolver3* solvers[2] = { &solver1, &solver2 };
+	for (PCISPHSolver3* solver : solvers)
+	{
+		solver->GetSPHSystemData()->AddParticles(points.ConstAccessor());
+		solver->Update(Frame(0, 0.01));
+	}
+
+	solver2.GetSPHSystemData()->SetTargetSpacing(0.05);
+
+	for (PCISPHSolver3* solver : solvers)
+	{
+		auto particles = solver->GetSPHSystemData();
+		particles->Resize(0);
+		particles->AddParticles(points.ConstAccessor());
+		solver->Update(Frame(1, 0.01));
+	}
+
+	auto positions1 = solver1.GetSPHSystemData()->GetPositions();
+	auto positions2 = solver2.GetSPHSystemData()->GetPositions();
+	ASSERT_EQ(positions1.size(), positions2.size());
+
+	for (size_t i = 0; i < positions1.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(positions1[i].x, positions2[i].x);
+		EXPECT_DOUBLE_EQ(positions1[i].y, positions2[i].y);
+		EXPECT_DOUBLE_EQ(positions1[i].z, positions2[i].z);
+	}
+}
+
+TEST(PCISPHSolver3, WithoutNeighborLists)
+{
+	Array1<Vector3D> points;
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 6; ++j)
+		{
+			for (int i = 0; i < 6; ++i)
+			{
+				points.Append(Vector3D(0.035 * i, 0.035 * j, 0.035 * k));
+			}
+		}
+	}
+
+	PCISPHSolver3 solver1(1000.0, 0.05, 1.8);
+	PCISPHSolver3 solver2(1000.0, 0.05, 1.8);
+	solver2.SetUseNeighborLists(false);
+
+	PCISPHSolver3* solvers[2] = { &solver1, &solver2 };
+	for (PCISPHSolver3* solver : solvers)
+	{
+		// Pseudo-viscosity runs after the positions are updated, where the
+		// walk around the new positions differs from the stored lists
+		solver->SetViscosityCoefficient(0.01);
+		solver->SetPseudoViscosityCoefficient(0.0);
+		solver->GetSPHSystemData()->AddParticles(points.ConstAccessor());
+
+		for (Frame frame(0, 0.01); frame.index < 3; ++frame)
+		{
+			solver->Update(frame);
+		}
+	}
+
+	EXPECT_EQ(points.size(), solver1.GetSPHSystemData()->NeighborLists().size());
+	EXPECT_EQ(0u, solver2.GetSPHSystemData()->NeighborLists().size());
+
+	auto x1 = solver1.GetSPHSystemData()->GetPositions();
+	auto x2 = solver2.GetSPHSystemData()->GetPositions();
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(x1[i].x, x2[i].x);
+		EXPECT_DOUBLE_EQ(x1[i].y, x2[i].y);
+		EXPECT_DOUBLE_EQ(x1[i].z, x2[i].z);
+	}
 }
\ No newline at end of file
@@ -1,9 +1,27 @@
 #include "pch.h"
 
+#include <Array/ArraySamplers3.h>
 #include <Solver/PIC/PICSolver3.h>
 
+#include <random>
+
 using namespace CubbyFlow;
 
+namespace
+{
+	class TransferTestPICSolver3 : public PICSolver3
+	{
+	public:
+		TransferTestPICSolver3(const Size3& resolution, const Vector3D& gridSpacing, const Vector3D& gridOrigin) :
+			PICSolver3(resolution, gridSpacing, gridOrigin)
+		{
+			// Do nothing
+		}
+
+		using PICSolver3::TransferFromParticlesToGrids;
+	};
+}
+
 TEST(PICSolver3, UpdateEmpty)
 {
 	PICSolver3 solver;
@@ -12,4 +30,91 @@ TEST(PICSolver3, UpdateEmpty)
 	{
 		solver.Update(frame);
 	}
+}
+
+TEST(PICSolver3, TransferFromParticlesToGrids)
+{
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+	SetMaxNumberOfThreads(4);
+
+	TransferTestPICSolver3 solver({ 13, 21, 10 }, { 0.1, 0.1, 0.1 }, { 0.3, -0.2, 0.1 });
+	auto particles = solver.GetParticleSystemData();
+	auto flow = solver.GetGridSystemData()->GetVelocity();
+	const BoundingBox3D bbox = flow->BoundingBox();
+
+	// Some particles lie outside of the domain to exercise the clamping
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dx(bbox.lowerCorner.x - 0.1, bbox.upperCorner.x + 0.1);
+	std::uniform_real_distribution<> dy(bbox.lowerCorner.y - 0.1, bbox.upperCorner.y + 0.1);
+	std::uniform_real_distribution<> dz(bbox.lowerCorner.z - 0.1, bbox.upperCorner.z + 0.1);
+	std::uniform_real_distribution<> dv(-1.0, 1.0);
+
+	const size_t numberOfParticles = 5000;
+	Array1<Vector3D> positions(numberOfParticles);
+	Array1<Vector3D> velocities(numberOfParticles);
+	for (size_t i = 0; i < numberOfParticles; ++i)
+	{
+		positions[i] = Vector3D(dx(rng), dy(rng), dz(rng));
+		velocities[i] = Vector3D(dv(rng), dv(rng), dv(rng));
+	}
+
+	particles->AddParticles(positions, velocities);
+
+	solver.TransferFromParticlesToGrids();
+
+	// Serial reference
+	Array3<double> u(flow->GetUSize());
+	Array3<double> uWeight(flow->GetUSize());
+	LinearArraySampler3<double, double> uSampler(u.ConstAccessor(), flow->GridSpacing(), flow->GetUOrigin());
+	Array3<double> v(flow->GetVSize());
+	Array3<double> vWeight(flow->GetVSize());
+	LinearArraySampler3<double, double> vSampler(v.ConstAccessor(), flow->GridSpacing(), flow->GetVOrigin());
+	Array3<double> w(flow->GetWSize());
+	Array3<double> wWeight(flow->GetWSize());
+	LinearArraySampler3<double, double> wSampler(w.ConstAccessor(), flow->GridSpacing(), flow->GetWOrigin());
+
+	for (size_t i = 0; i < numberOfParticles; ++i)
+	{
+		std::array<Point3UI, 8> indices;
+		std::array<double, 8> weights;
+
+		uSampler.GetCoordinatesAndWeights(positions[i], &indices, &weights);
+		for (int j = 0; j < 8; ++j)
+		{
+			u(indices[j]) += velocities[i].x * weights[j];
+			uWeight(indices[j]) += weights[j];
+		}
+
+		vSampler.GetCoordinatesAndWeights(positions[i], &indices, &weights);
+		for (int j = 0; j < 8; ++j)
+		{
+			v(indices[j]) += velocities[i].y * weights[j];
+			vWeight(indices[j]) += weights[j];
+		}
+
+		wSampler.GetCoordinatesAndWeights(positions[i], &indices, &weights);
+		for (int j = 0; j < 8; ++j)
+		{
+			w(indices[j]) += velocities[i].z * weights[j];
+			wWeight(indices[j]) += weights[j];
+		}
+	}
+
+	u.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double expected = (uWeight(i, j, k) > 0.0) ? u(i, j, k) / uWeight(i, j, k) : 0.0;
+		EXPECT_NEAR(expected, flow->GetU(i, j, k), 1e-12);
+	});
+	v.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double expected = (vWeight(i, j, k) > 0.0) ? v(i, j, k) / vWeight(i, j, k) : 0.0;
+		EXPECT_NEAR(expected, flow->GetV(i, j, k), 1e-12);
+	});
+	w.ForEachIndex([&](size_t i, size_t j, size_t k)
+	{
+		const double expected = (wWeight(i, j, k) > 0.0) ? w(i, j, k) / wWeight(i, j, k) : 0.0;
+		EXPECT_NEAR(expected, flow->GetW(i, j, k), 1e-12);
+	});
+
+	SetMaxNumberOfThreads(oldNumThreads);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include <numeric>
 #include <random>
+#include <stdexcept>
 
 using namespace CubbyFlow;
 
@@ -262,4 +263,105 @@ TEST(Parallel, Reduce)
 
 	int expected = std::accumulate(a.begin(), a.end(), 0);
 	EXPECT_EQ(expected, sum);
+}
+
+TEST(Parallel, NestedFor)
+{
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+	SetMaxNumberOfThreads(4);
+
+	size_t nX = 37;
+	size_t nY = 23;
+	Array2<int> a(nX, nY, 0);
+
+	ParallelFor(ZERO_SIZE, nY, [&](size_t j)
+	{
+		ParallelFor(ZERO_SIZE, nX, [&](size_t i)
+		{
+			a(i, j) += static_cast<int>(i + j * nX);
+		});
+	});
+
+	for (size_t j = 0; j < nY; ++j)
+	{
+		for (size_t i = 0; i < nX; ++i)
+		{
+			EXPECT_EQ(static_cast<int>(i + j * nX), a(i, j));
+		}
+	}
+
+	SetMaxNumberOfThreads(oldNumThreads);
+}
+
+TEST(Parallel, ForException)
+{
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+	SetMaxNumberOfThreads(4);
+
+	std::vector<int> a(1000, 0);
+
+	// The exception reaches the caller instead of blocking the join
+	EXPECT_THROW(ParallelFor(ZERO_SIZE, a.size(), [&](size_t i)
+	{
+		if (i == 500)
+		{
+			throw std::runtime_error("Task failed");
+		}
+
+		a[i] = 1;
+	}), std::runtime_error);
+
+	EXPECT_THROW(ParallelFor(ZERO_SIZE, size_t(8), [&](size_t j)
+	{
+		ParallelFor(ZERO_SIZE, size_t(100), [&](size_t i)
+		{
+			if (i == 42 && j == 3)
+			{
+				throw std::runtime_error("Nested task failed");
+			}
+		});
+	}), std::runtime_error);
+
+	// The pool is still usable
+	ParallelFor(ZERO_SIZE, a.size(), [&](size_t i)
+	{
+		a[i] = 2;
+	});
+	EXPECT_EQ(2000, std::accumulate(a.begin(), a.end(), 0));
+
+	SetMaxNumberOfThreads(oldNumThreads);
+}
+
+TEST(Parallel, SetMaxNumberOfThreads)
+{
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+
+	std::vector<double> a(1000);
+	std::iota(a.begin(), a.end(), 0.0);
+
+	for (unsigned int numThreads : { 1u, 3u, 8u })
+	{
+		SetMaxNumberOfThreads(numThreads);
+		EXPECT_EQ(numThreads, GetMaxNumberOfThreads());
+
+		double sum = ParallelReduce(ZERO_SIZE, a.size(), 0.0,
+			[&](size_t start, size_t end, double init)
+		{
+			double result = init;
+
+			for (size_t i = start; i < end; ++i)
+			{
+				result += a[i];
+			}
+
+			return result;
+		}, std::plus<double>());
+
+		EXPECT_DOUBLE_EQ(499500.0, sum);
+	}
+
+	SetMaxNumberOfThreads(0);
+	EXPECT_EQ(1u, GetMaxNumberOfThreads());
+
+	SetMaxNumberOfThreads(oldNumThreads);
 }
\ No newline at end of file
@@ -124,35 +124,17 @@ TEST(ParticleSystemData2, AddParticlesException)
 	ParticleSystemData2 particleSystem;
 	particleSystem.Resize(12);
 
-	try
-	{
-		particleSystem.AddParticles(
-			Array1<Vector2D>({ Vector2D(1.0, 2.0), Vector2D(4.0, 5.0) }).Accessor(),
-			Array1<Vector2D>({ Vector2D(7.0, 8.0) }).Accessor(),
-			Array1<Vector2D>({ Vector2D(5.0, 4.0), Vector2D(2.0, 1.0) }).Accessor());
-
-		EXPECT_FALSE(true) << "Invalid argument should throw exception.";
-	}
-	catch (std::invalid_argument)
-	{
-		// Do nothing -- expected exception
-	}
+	EXPECT_THROW(particleSystem.AddParticles(
+		Array1<Vector2D>({ Vector2D(1.0, 2.0), Vector2D(4.0, 5.0) }).Accessor(),
+		Array1<Vector2D>({ Vector2D(7.0, 8.0) }).Accessor(),
+		Array1<Vector2D>({ Vector2D(5.0, 4.0), Vector2D(2.0, 1.0) }).Accessor()), std::invalid_argument);
 
 	EXPECT_EQ(12u, particleSystem.NumberOfParticles());
 
-	try
-	{
-		particleSystem.AddParticles(
-			Array1<Vector2D>({ Vector2D(1.0, 2.0), Vector2D(4.0, 5.0) }).Accessor(),
-			Array1<Vector2D>({ Vector2D(7.0, 8.0), Vector2D(2.0, 1.0) }).Accessor(),
-			Array1<Vector2D>({ Vector2D(5.0, 4.0) }).Accessor());
-
-		EXPECT_FALSE(true) << "Invalid argument should throw exception.";
-	}
-	catch (std::invalid_argument)
-	{
-		// Do nothing -- expected exception
-	}
+	EXPECT_THROW(particleSystem.AddParticles(
+		Array1<Vector2D>({ Vector2D(1.0, 2.0), Vector2D(4.0, 5.0) }).Accessor(),
+		Array1<Vector2D>({ Vector2D(7.0, 8.0), Vector2D(2.0, 1.0) }).Accessor(),
+		Array1<Vector2D>({ Vector2D(5.0, 4.0) }).Accessor()), std::invalid_argument);
 
 	EXPECT_EQ(12u, particleSystem.NumberOfParticles());
 }
@@ -125,35 +125,17 @@ TEST(ParticleSystemData3, AddParticlesException)
 	ParticleSystemData3 particleSystem;
 	particleSystem.Resize(12);
 
-	try
-	{
-		particleSystem.AddParticles(
-			Array1<Vector3D>({ Vector3D(1.0, 2.0, 3.0), Vector3D(4.0, 5.0, 6.0) }).Accessor(),
-			Array1<Vector3D>({ Vector3D(7.0, 8.0, 9.0) }).Accessor(),
-			Array1<Vector3D>({ Vector3D(5.0, 4.0, 3.0), Vector3D(2.0, 1.0, 3.0) }).Accessor());
-
-		EXPECT_FALSE(true) << "Invalid argument should throw exception.";
-	}
-	catch (std::invalid_argument)
-	{
-		// Do nothing -- expected exception
-	}
+	EXPECT_THROW(particleSystem.AddParticles(
+		Array1<Vector3D>({ Vector3D(1.0, 2.0, 3.0), Vector3D(4.0, 5.0, 6.0) }).Accessor(),
+		Array1<Vector3D>({ Vector3D(7.0, 8.0, 9.0) }).Accessor(),
+		Array1<Vector3D>({ Vector3D(5.0, 4.0, 3.0), Vector3D(2.0, 1.0, 3.0) }).Accessor()), std::invalid_argument);
 
 	EXPECT_EQ(12u, particleSystem.NumberOfParticles());
 
-	try
-	{
-		particleSystem.AddParticles(
-			Array1<Vector3D>({ Vector3D(1.0, 2.0, 3.0), Vector3D(4.0, 5.0, 6.0) }).Accessor(),
-			Array1<Vector3D>({ Vector3D(7.0, 8.0, 9.0), Vector3D(2.0, 1.0, 3.0) }).Accessor(),
-			Array1<Vector3D>({ Vector3D(5.0, 4.0, 3.0) }).Accessor());
-
-		EXPECT_FALSE(true) << "Invalid argument should throw exception.";
-	}
-	catch (std::invalid_argument)
-	{
-		// Do nothing -- expected exception
-	}
+	EXPECT_THROW(particleSystem.AddParticles(
+		Array1<Vector3D>({ Vector3D(1.0, 2.0, 3.0), Vector3D(4.0, 5.0, 6.0) }).Accessor(),
+		Array1<Vector3D>({ Vector3D(7.0, 8.0, 9.0), Vector3D(2.0, 1.0, 3.0) }).Accessor(),
+		Array1<Vector3D>({ Vector3D(5.0, 4.0, 3.0) }).Accessor()), std::invalid_argument);
 
 	EXPECT_EQ(12u, particleSystem.NumberOfParticles());
 }
@@ -256,6 +238,118 @@ TEST(ParticleSystemData3, BuildNeighborLists)
 	}
 }
 
+TEST(ParticleSystemData3, Reorder)
+{
+	ParticleSystemData3 particleSystem;
+	const size_t a0 = particleSystem.AddScalarData();
+	const size_t a1 = particleSystem.AddVectorData();
+
+	ParticleSystemData3::VectorData positions(5);
+	ParticleSystemData3::VectorData velocities(5);
+	for (size_t i = 0; i < 5; ++i)
+	{
+		positions[i] = Vector3D(static_cast<double>(i), 0.0, 0.0);
+		velocities[i] = Vector3D(0.0, static_cast<double>(i), 0.0);
+	}
+	particleSystem.AddParticles(positions, velocities);
+
+	for (size_t i = 0; i < 5; ++i)
+	{
+		particleSystem.ScalarDataAt(a0)[i] = 10.0 * static_cast<double>(i);
+		particleSystem.VectorDataAt(a1)[i] = Vector3D(0.0, 0.0, static_cast<double>(i));
+	}
+
+	particleSystem.BuildNeighborSearcher(1.5);
+	particleSystem.BuildNeighborLists(1.5);
+
+	std::vector<size_t> userData = { 0, 1, 2, 3, 4 };
+	particleSystem.SetOnReorderCallback([&](ParticleSystemData3* data, const std::vector<size_t>& order)
+	{
+		EXPECT_EQ(&particleSystem, data);
+
+		std::vector<size_t> newUserData(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			newUserData[i] = userData[order[i]];
+		}
+		userData.swap(newUserData);
+	});
+
+	const std::vector<size_t> order = { 3, 0, 4, 1, 2 };
+	particleSystem.Reorder(order);
+
+	for (size_t i = 0; i < 5; ++i)
+	{
+		const auto oldIdx = static_cast<double>(order[i]);
+		EXPECT_DOUBLE_EQ(oldIdx, particleSystem.GetPositions()[i].x);
+		EXPECT_DOUBLE_EQ(oldIdx, particleSystem.GetVelocities()[i].y);
+		EXPECT_DOUBLE_EQ(10.0 * oldIdx, particleSystem.ScalarDataAt(a0)[i]);
+		EXPECT_DOUBLE_EQ(oldIdx, particleSystem.VectorDataAt(a1)[i].z);
+		EXPECT_EQ(order[i], userData[i]);
+	}
+
+	EXPECT_EQ(0u, particleSystem.NeighborLists().size());
+
+	EXPECT_THROW(particleSystem.Reorder({ 0, 1, 2 }), std::invalid_argument);
+}
+
+TEST(ParticleSystemData3, SortParticles)
+{
+	ParticleSystemData3 particleSystem;
+	const size_t a0 = particleSystem.AddScalarData();
+
+	// 4x4x4 lattice in reversed order
+	ParticleSystemData3::VectorData positions;
+	for (int k = 3; k >= 0; --k)
+	{
+		for (int j = 3; j >= 0; --j)
+		{
+			for (int i = 3; i >= 0; --i)
+			{
+				positions.Append(Vector3D(i, j, k));
+			}
+		}
+	}
+	particleSystem.AddParticles(positions);
+
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		particleSystem.ScalarDataAt(a0)[i] = positions[i].x + 4.0 * positions[i].y + 16.0 * positions[i].z;
+	}
+
+	EXPECT_THROW(particleSystem.SortParticles(0.0), std::invalid_argument);
+	EXPECT_THROW(particleSystem.SortParticles(-1.0), std::invalid_argument);
+	EXPECT_DOUBLE_EQ(63.0, particleSystem.ScalarDataAt(a0)[0]);
+
+	particleSystem.SortParticles(1.0);
+
+	// Each 2x2x2 block of the lattice is contiguous, and the blocks
+	// themselves follow the Z-order curve.
+	auto p = particleSystem.GetPositions();
+	for (size_t block = 0; block < 8; ++block)
+	{
+		const Vector3D blockCorner(
+			2.0 * static_cast<double>(block & 1),
+			2.0 * static_cast<double>((block >> 1) & 1),
+			2.0 * static_cast<double>((block >> 2) & 1));
+
+		for (size_t i = 0; i < 8; ++i)
+		{
+			const Vector3D expected = blockCorner + Vector3D(
+				static_cast<double>(i & 1),
+				static_cast<double>((i >> 1) & 1),
+				static_cast<double>((i >> 2) & 1));
+			EXPECT_EQ(expected, p[8 * block + i]);
+		}
+	}
+
+	// Custom data follows the particles
+	for (size_t i = 0; i < p.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(p[i].x + 4.0 * p[i].y + 16.0 * p[i].z, particleSystem.ScalarDataAt(a0)[i]);
+	}
+}
+
 TEST(ParticleSystemData3, Serialization)
 {
 	ParticleSystemData3 particleSystem;
@@ -99,6 +99,10 @@ TEST(ParticleSystemSolver3, BasicParams)
 
 	solver.SetGravity(Vector3D(3, -10, 7));
 	EXPECT_EQ(Vector3D(3, -10, 7), solver.GetGravity());
+
+	EXPECT_EQ(0u, solver.GetParticleSortingInterval());
+	solver.SetParticleSortingInterval(5);
+	EXPECT_EQ(5u, solver.GetParticleSortingInterval());
 }
 
 TEST(ParticleSystemSolver3, Update)
@@ -123,4 +127,37 @@ TEST(ParticleSystemSolver3, Update)
 		EXPECT_NE(0, data->GetVelocities()[i].y);
 		EXPECT_DOUBLE_EQ(0.0, data->GetVelocities()[i].z);
 	}
+}
+
+TEST(ParticleSystemSolver3, UpdateWithSorting)
+{
+	ParticleSystemSolver3 solver;
+	solver.SetGravity(Vector3D(0, -10, 0));
+	solver.SetParticleSortingInterval(1);
+
+	ParticleSystemData3Ptr data = solver.GetParticleSystemData();
+	const size_t id = data->AddScalarData();
+
+	ParticleSystemData3::VectorData positions(10);
+	for (size_t i = 0; i < 10; ++i)
+	{
+		positions[i] = Vector3D(static_cast<double>(9 - i), 0.0, 0.0);
+	}
+	data->AddParticles(positions.Accessor());
+
+	for (size_t i = 0; i < 10; ++i)
+	{
+		data->ScalarDataAt(id)[i] = positions[i].x;
+	}
+
+	Frame frame(0, 1.0 / 60.0);
+	solver.Update(frame);
+
+	for (size_t i = 0; i < data->NumberOfParticles(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(static_cast<double>(i), data->GetPositions()[i].x);
+		EXPECT_DOUBLE_EQ(data->GetPositions()[i].x, data->ScalarDataAt(id)[i]);
+		EXPECT_NE(0, data->GetPositions()[i].y);
+		EXPECT_NE(0, data->GetVelocities()[i].y);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "pch.h"
 
 #include <Searcher/PointParallelHashGridSearcher3.h>
+#include <Utils/Parallel.h>
+
+#include <random>
 
 using namespace CubbyFlow;
 
@@ -89,6 +92,77 @@ TEST(PointParallelHashGridSearcher3, Build)
 	EXPECT_EQ(3, searcher.EndIndexTable()[39]);
 }
 
+TEST(PointParallelHashGridSearcher3, BuildManyPoints)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(-1.0, 1.0);
+
+	// More points than buckets per thread so that the points are counted in
+	// several chunks
+	Array1<Vector3D> points(10000);
+	for (auto& point : points)
+	{
+		point = Vector3D(dist(rng), dist(rng), dist(rng));
+	}
+
+	const unsigned int oldNumThreads = GetMaxNumberOfThreads();
+
+	SetMaxNumberOfThreads(1);
+	PointParallelHashGridSearcher3 searcher1(Size3(4, 4, 4), 0.3);
+	searcher1.Build(points.Accessor());
+
+	SetMaxNumberOfThreads(4);
+	PointParallelHashGridSearcher3 searcher2(Size3(4, 4, 4), 0.3);
+	searcher2.Build(points.Accessor());
+
+	SetMaxNumberOfThreads(oldNumThreads);
+
+	// Same layout regardless of the number of threads
+	EXPECT_EQ(searcher1.Keys(), searcher2.Keys());
+	EXPECT_EQ(searcher1.SortedIndices(), searcher2.SortedIndices());
+	EXPECT_EQ(searcher1.StartIndexTable(), searcher2.StartIndexTable());
+	EXPECT_EQ(searcher1.EndIndexTable(), searcher2.EndIndexTable());
+
+	const auto& keys = searcher2.Keys();
+	const auto& sortedIndices = searcher2.SortedIndices();
+	const auto& startIndexTable = searcher2.StartIndexTable();
+	const auto& endIndexTable = searcher2.EndIndexTable();
+
+	ASSERT_EQ(points.size(), keys.size());
+
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		const size_t key = keys[i];
+		EXPECT_EQ(searcher2.GetHashKeyFromBucketIndex(searcher2.GetBucketIndex(points[sortedIndices[i]])), key);
+		EXPECT_LE(startIndexTable[key], i);
+		EXPECT_GT(endIndexTable[key], i);
+
+		// Stable within each bucket
+		if (i > 0 && keys[i - 1] == key)
+		{
+			EXPECT_LT(sortedIndices[i - 1], sortedIndices[i]);
+		}
+		else
+		{
+			EXPECT_EQ(i, startIndexTable[key]);
+		}
+	}
+
+	size_t numberOfPointsInBuckets = 0;
+	for (size_t k = 0; k < startIndexTable.size(); ++k)
+	{
+		if (startIndexTable[k] != std::numeric_limits<size_t>::max())
+		{
+			numberOfPointsInBuckets += endIndexTable[k] - startIndexTable[k];
+		}
+		else
+		{
+			EXPECT_EQ(std::numeric_limits<size_t>::max(), endIndexTable[k]);
+		}
+	}
+	EXPECT_EQ(points.size(), numberOfPointsInBuckets);
+}
+
 TEST(PointParallelHashGridSearcher3, Serialization)
 {
 	Array1<Vector3D> points =
@@ -1,9 +1,23 @@
 #include "pch.h"
 
+#include <SPH/SPHStdKernel3.h>
 #include <Solver/SPH/SPHSolver3.h>
 
+#include <random>
+
 using namespace CubbyFlow;
 
+namespace
+{
+	class SPHSolver3ForTests : public SPHSolver3
+	{
+	public:
+		using SPHSolver3::AccumulatePressureForce;
+		using SPHSolver3::AccumulateViscosityForce;
+		using SPHSolver3::UpdateSoAArrays;
+	};
+}
+
 TEST(SPHSolver3, UpdateEmpty)
 {
 	// Empty solver test
@@ -56,5 +70,81 @@ TEST(SPHSolver3, Parameters)
 	solver.SetTimeStepLimitScale(-1.0);
 	EXPECT_DOUBLE_EQ(0.0, solver.GetTimeStepLimitScale());
 
+	EXPECT_TRUE(solver.GetUseNeighborLists());
+	solver.SetUseNeighborLists(false);
+	EXPECT_FALSE(solver.GetUseNeighborLists());
+
 	EXPECT_TRUE(solver.GetSPHSystemData() != nullptr);
+}
+
+TEST(SPHSolver3, AccumulateNeighborForces)
+{
+	SPHSolver3ForTests solver;
+	solver.SetViscosityCoefficient(0.1);
+
+	auto particles = solver.GetSPHSystemData();
+	particles->SetTargetSpacing(0.05);
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(0.0, 1.0);
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		particles->AddParticle(
+			Vector3D(0.5 * dist(rng), 0.5 * dist(rng), 0.5 * dist(rng)),
+			Vector3D(dist(rng) - 0.5, dist(rng) - 0.5, dist(rng) - 0.5));
+	}
+
+	particles->BuildNeighborSearcher();
+	particles->BuildNeighborLists();
+	particles->UpdateDensities();
+
+	const size_t n = particles->NumberOfParticles();
+	auto x = particles->GetPositions();
+	auto v = particles->GetVelocities();
+	auto d = particles->GetDensities();
+	auto p = particles->GetPressures();
+	for (size_t i = 0; i < n; ++i)
+	{
+		p[i] = dist(rng);
+	}
+
+	// Reference forces with the kernel object
+	const double massSquared = Square(particles->GetMass());
+	const SPHSpikyKernel3 kernel(particles->GetKernelRadius());
+	Array1<Vector3D> expectedPressureForces(n);
+	Array1<Vector3D> expectedViscosityForces(n);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j : particles->NeighborLists()[i])
+		{
+			double distance = x[i].DistanceTo(x[j]);
+			if (distance > 0.0)
+			{
+				Vector3D dir = (x[j] - x[i]) / distance;
+				expectedPressureForces[i] -= massSquared * (p[i] / (d[i] * d[i]) + p[j] / (d[j] * d[j])) * kernel.Gradient(distance, dir);
+			}
+
+			expectedViscosityForces[i] += solver.GetViscosityCoefficient() * massSquared * (v[j] - v[i]) / d[j] * kernel.SecondDerivative(distance);
+		}
+	}
+
+	Array1<Vector3D> pressureForces(n);
+	solver.AccumulatePressureForce(x, d, p, pressureForces.Accessor());
+	solver.UpdateSoAArrays();
+	solver.AccumulateViscosityForce();
+
+	auto f = particles->GetForces();
+	for (size_t i = 0; i < n; ++i)
+	{
+		const double pressureTolerance = 1e-10 * std::max(expectedPressureForces[i].Length(), 1.0);
+		EXPECT_NEAR(expectedPressureForces[i].x, pressureForces[i].x, pressureTolerance);
+		EXPECT_NEAR(expectedPressureForces[i].y, pressureForces[i].y, pressureTolerance);
+		EXPECT_NEAR(expectedPressureForces[i].z, pressureForces[i].z, pressureTolerance);
+
+		const double viscosityTolerance = 1e-10 * std::max(expectedViscosityForces[i].Length(), 1.0);
+		EXPECT_NEAR(expectedViscosityForces[i].x, f[i].x, viscosityTolerance);
+		EXPECT_NEAR(expectedViscosityForces[i].y, f[i].y, viscosityTolerance);
+		EXPECT_NEAR(expectedViscosityForces[i].z, f[i].z, viscosityTolerance);
+	}
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include <SPH/SPHSystemData3.h>
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+
 using namespace CubbyFlow;
 
 TEST(SPHSystemData3, Parameters)
@@ -56,6 +60,193 @@ TEST(SPHSystemData3, Particles)
 	EXPECT_GT(1.0, midVal);
 }
 
+TEST(SPHSystemData3, UpdateDensitiesWithNeighborLists)
+{
+	SPHSystemData3 data;
+	data.SetTargetSpacing(0.1);
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(0.0, 1.0);
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		data.AddParticle(Vector3D(dist(rng), dist(rng), dist(rng)));
+	}
+
+	// Without the neighbor lists, the searcher is used
+	data.BuildNeighborSearcher();
+	EXPECT_EQ(0u, data.NeighborLists().size());
+	data.UpdateDensities();
+
+	auto den = data.GetDensities();
+	Array1<double> expected(den.size());
+	for (size_t i = 0; i < den.size(); ++i)
+	{
+		expected[i] = den[i];
+	}
+
+	data.BuildNeighborLists();
+	EXPECT_EQ(data.NumberOfParticles(), data.NeighborLists().size());
+	data.UpdateDensities();
+
+	for (size_t i = 0; i < data.NumberOfParticles(); ++i)
+	{
+		EXPECT_NEAR(expected[i], den[i], 1e-9 * expected[i]);
+	}
+}
+
+TEST(SPHSystemData3, ForEachNeighbor)
+{
+	SPHSystemData3 data;
+	data.SetTargetSpacing(0.1);
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(0.0, 1.0);
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		data.AddParticle(Vector3D(dist(rng), dist(rng), dist(rng)));
+	}
+
+	// Without the neighbor lists, the searcher buckets are walked
+	data.BuildNeighborSearcher();
+	EXPECT_EQ(0u, data.NeighborLists().size());
+
+	std::vector<std::vector<size_t>> expected(data.NumberOfParticles());
+	for (size_t i = 0; i < data.NumberOfParticles(); ++i)
+	{
+		data.ForEachNeighbor(i, [&](size_t j)
+		{
+			EXPECT_NE(i, j);
+			expected[i].push_back(j);
+		});
+		std::sort(expected[i].begin(), expected[i].end());
+	}
+
+	data.BuildNeighborLists();
+	for (size_t i = 0; i < data.NumberOfParticles(); ++i)
+	{
+		std::vector<size_t> neighbors;
+		data.ForEachNeighbor(i, [&](size_t j)
+		{
+			neighbors.push_back(j);
+		});
+		std::sort(neighbors.begin(), neighbors.end());
+
+		EXPECT_EQ(expected[i], neighbors);
+	}
+}
+
+TEST(SPHSystemData3, ForEachNeighborAfterReorder)
+{
+	SPHSystemData3 data;
+	data.SetTargetSpacing(0.1);
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(0.0, 1.0);
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		data.AddParticle(Vector3D(dist(rng), dist(rng), dist(rng)));
+	}
+
+	data.BuildNeighborSearcher();
+
+	std::vector<std::vector<size_t>> oldNeighbors(data.NumberOfParticles());
+	for (size_t i = 0; i < data.NumberOfParticles(); ++i)
+	{
+		data.ForEachNeighbor(i, [&](size_t j)
+		{
+			oldNeighbors[i].push_back(j);
+		});
+	}
+
+	std::vector<size_t> order(data.NumberOfParticles());
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), rng);
+
+	std::vector<size_t> newIndices(order.size());
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		newIndices[order[i]] = i;
+	}
+
+	// No rebuild, so the searcher must already be in the new order
+	data.Reorder(order);
+
+	for (size_t i = 0; i < data.NumberOfParticles(); ++i)
+	{
+		std::vector<size_t> expected;
+		for (size_t j : oldNeighbors[order[i]])
+		{
+			expected.push_back(newIndices[j]);
+		}
+		std::sort(expected.begin(), expected.end());
+
+		std::vector<size_t> neighbors;
+		data.ForEachNeighbor(i, [&](size_t j)
+		{
+			neighbors.push_back(j);
+		});
+		std::sort(neighbors.begin(), neighbors.end());
+
+		EXPECT_EQ(expected, neighbors);
+	}
+}
+
+TEST(SPHSystemData3, HasNeighborLists)
+{
+	SPHSystemData3 data;
+	data.SetTargetSpacing(0.1);
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> dist(0.0, 1.0);
+	for (size_t i = 0; i < 100; ++i)
+	{
+		data.AddParticle(Vector3D(dist(rng), dist(rng), dist(rng)));
+	}
+
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	const auto rebuild = [&]()
+	{
+		data.BuildNeighborSearcher();
+		data.BuildNeighborLists();
+		EXPECT_TRUE(data.HasNeighborLists());
+	};
+
+	rebuild();
+	data.BuildNeighborSearcher();
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	std::vector<size_t> order(data.NumberOfParticles());
+	std::iota(order.begin(), order.end(), 0);
+	data.Reorder(order);
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	data.SetKernelRadius(data.GetKernelRadius());
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	data.SetTargetSpacing(data.GetTargetSpacing());
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	data.SetRelativeKernelRadius(data.GetRelativeKernelRadius());
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	data.AddParticle(Vector3D(0.5, 0.5, 0.5));
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	data.SetNeighborSearcher(data.GetNeighborSearcher());
+	EXPECT_FALSE(data.HasNeighborLists());
+
+	rebuild();
+	SPHSystemData3 copy(data);
+	EXPECT_TRUE(copy.HasNeighborLists());
+}
+
 TEST(SPHSystemData3, Serialization)
 {
 	SPHSystemData3 data;
@@ -0,0 +1,74 @@
+#include "pch.h"
+
+#include <Field/CustomVectorField3.h>
+#include <Grid/CellCenteredScalarGrid3.h>
+#include <Grid/FaceCenteredGrid3.h>
+#include <SemiLagrangian/CubicSemiLagrangian3.h>
+
+using namespace CubbyFlow;
+
+namespace
+{
+	Vector3D Rotation(const Vector3D& x)
+	{
+		return Vector3D(-(x.y - 0.5), x.x - 0.5, 0.2 * (x.z - 0.5));
+	}
+}
+
+TEST(SemiLagrangian3, AdvectScalarGridWithFlowGrid)
+{
+	CellCenteredScalarGrid3 input(16, 16, 16, 1.0 / 16.0, 1.0 / 16.0, 1.0 / 16.0);
+	input.Fill([](const Vector3D& x)
+	{
+		return std::sin(4.0 * x.x) * std::cos(3.0 * x.y) + x.z;
+	});
+
+	FaceCenteredGrid3 flowGrid(16, 16, 16, 1.0 / 16.0, 1.0 / 16.0, 1.0 / 16.0);
+	flowGrid.Fill(Rotation);
+
+	// Same flow hidden behind the generic VectorField3 interface
+	CustomVectorField3 flowField([&](const Vector3D& x)
+	{
+		return flowGrid.Sample(x);
+	});
+
+	SemiLagrangian3 linearSolver;
+	CubicSemiLagrangian3 cubicSolver;
+
+	for (SemiLagrangian3* solver : { &linearSolver, static_cast<SemiLagrangian3*>(&cubicSolver) })
+	{
+		CellCenteredScalarGrid3 output1(input), output2(input);
+		solver->Advect(input, flowGrid, 0.1, &output1);
+		solver->Advect(input, flowField, 0.1, &output2);
+
+		output1.ForEachDataPointIndex([&](size_t i, size_t j, size_t k)
+		{
+			EXPECT_DOUBLE_EQ(output2(i, j, k), output1(i, j, k));
+		});
+	}
+}
+
+TEST(SemiLagrangian3, AdvectFaceCenteredGrid)
+{
+	FaceCenteredGrid3 input(16, 16, 16, 1.0 / 16.0, 1.0 / 16.0, 1.0 / 16.0);
+	input.Fill(Rotation);
+
+	SemiLagrangian3 linearSolver;
+	CubicSemiLagrangian3 cubicSolver;
+
+	for (SemiLagrangian3* solver : { &linearSolver, static_cast<SemiLagrangian3*>(&cubicSolver) })
+	{
+		FaceCenteredGrid3 output(input);
+		solver->Advect(input, input, 0.05, &output);
+
+		// Check the result against the back-traced sample of the input
+		auto uPos = output.GetUPosition();
+		output.ForEachUIndex([&](size_t i, size_t j, size_t k)
+		{
+			Vector3D pt = uPos(i, j, k);
+			Vector3D mid = pt - 0.025 * input.Sample(pt);
+			Vector3D src = pt - 0.05 * input.Sample(mid);
+			EXPECT_NEAR(input.Sample(src).x, output.GetU(i, j, k), 1e-2);
+		});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include <Array/Array1.h>
+#include <Array/SoAArray3.h>
+
+#include <cstdint>
+
+using namespace CubbyFlow;
+
+TEST(SoAArray3, Constructors)
+{
+	SoAArray3D arr0;
+	EXPECT_EQ(0u, arr0.size());
+
+	SoAArray3D arr1(9);
+	EXPECT_EQ(9u, arr1.size());
+	for (size_t i = 0; i < 9; ++i)
+	{
+		EXPECT_EQ(Vector3D(), arr1.At(i));
+	}
+}
+
+TEST(SoAArray3, Alignment)
+{
+	SoAArray3D arr(7);
+	EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(arr.X().data()) % SoAArray3D::ALIGNMENT);
+	EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(arr.Y().data()) % SoAArray3D::ALIGNMENT);
+	EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(arr.Z().data()) % SoAArray3D::ALIGNMENT);
+}
+
+TEST(SoAArray3, SetAndAt)
+{
+	SoAArray3F arr(3);
+	arr.Set(1, Vector3F(1.f, 2.f, 3.f));
+
+	EXPECT_EQ(Vector3F(1.f, 2.f, 3.f), arr.At(1));
+	EXPECT_FLOAT_EQ(1.f, arr.X()[1]);
+	EXPECT_FLOAT_EQ(2.f, arr.Y()[1]);
+	EXPECT_FLOAT_EQ(3.f, arr.Z()[1]);
+	EXPECT_EQ(Vector3F(), arr.At(0));
+
+	arr.Clear();
+	EXPECT_EQ(0u, arr.size());
+}
+
+TEST(SoAArray3, LoadAndStore)
+{
+	Array1<Vector3D> src(1000);
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = Vector3D(static_cast<double>(i), 2.0 * i, -3.0 * i);
+	}
+
+	SoAArray3D arr;
+	arr.Load(src.ConstAccessor());
+	EXPECT_EQ(src.size(), arr.size());
+
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		EXPECT_DOUBLE_EQ(src[i].x, arr.X()[i]);
+		EXPECT_DOUBLE_EQ(src[i].y, arr.Y()[i]);
+		EXPECT_DOUBLE_EQ(src[i].z, arr.Z()[i]);
+	}
+
+	Array1<Vector3D> dst(src.size());
+	arr.Store(dst.Accessor());
+
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		EXPECT_EQ(src[i], dst[i]);
+	}
+}
\ No newline at end of file